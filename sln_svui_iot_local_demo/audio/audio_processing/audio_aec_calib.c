@@ -0,0 +1,592 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if ENABLE_AEC_CALIBRATION
+
+#include <string.h>
+#include <math.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "fsl_gpio.h"
+#include "arm_math.h"
+#include "sln_flash_fs_ops.h"
+#include "sln_heap.h"
+#include "sln_mic_config.h"
+#include "sln_amplifier.h"
+#include "audio_aec_calib.h"
+
+/* The alignment sound is defined here and shared with the USB audio dump */
+#define RECTANGULAR_SOUND_WAV_DEFINE
+#include "rectangular_sound_wav.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define AEC_CALIB_FILE_MAGIC   0x43434541U /* "AECC" */
+#define AEC_CALIB_FILE_VERSION 1U
+
+/* The alignment sound is a 48kHz mono wav, its header is not played */
+#define AEC_CALIB_WAV_HEADER_SIZE 44U
+
+/* 120ms of the first mic and of the reference are captured per run, 30ms of them before the sound
+ * is seen in the reference, so the mics can also lead the reference by up to AEC_CALIB_SEARCH_US. */
+#define AEC_CALIB_CAPTURE_BLOCKS 12U
+#define AEC_CALIB_PREROLL_BLOCKS 3U
+#define AEC_CALIB_CAPTURE_SMPL   (AEC_CALIB_CAPTURE_BLOCKS * AFE_BLOCK_SMPL_COUNT)
+
+/* Mean square of a reference block, in int16 units squared, which marks the start of the sound (about -40 dBFS) */
+#define AEC_CALIB_ONSET_ENERGY 107374U
+
+/* The coarse correlation runs at 4kHz, on a low passed copy of the captured audio.
+ * The FFT is at least twice as long as the decimated audio, so the correlation does not wrap. */
+#define AEC_CALIB_DECIMATION  4U
+#define AEC_CALIB_DECIM_TAPS  31U
+#define AEC_CALIB_DECIM_SMPL  (((AEC_CALIB_CAPTURE_SMPL - AEC_CALIB_DECIM_TAPS) / AEC_CALIB_DECIMATION) + 1U)
+#define AEC_CALIB_FFT_LEN     1024U
+#define AEC_CALIB_MAX_LAG_SMPL ((AEC_CALIB_SEARCH_US * (PCM_SAMPLE_RATE_HZ / 1000U)) / 1000U)
+
+/* Frequency bins with less reference power than AEC_CALIB_PHAT_FLOOR times the mean are left out of
+ * the whitened correlation, they would only add the noise of the room */
+#define AEC_CALIB_PHAT_FLOOR 0.01f
+
+/* The correlation peak must be AEC_CALIB_MIN_PEAK_RATIO times above the mean of the searched lags */
+#define AEC_CALIB_MIN_PEAK_RATIO 4.0f
+
+#define AEC_CALIB_AMP_ON_DELAY_MS      150U
+#define AEC_CALIB_CAPTURE_TIMEOUT_MS   500U
+#define AEC_CALIB_DELAY_BETWEEN_RUNS_MS 300U
+
+#if (AEC_CALIB_FFT_LEN < (2U * AEC_CALIB_DECIM_SMPL))
+#error "AEC_CALIB_FFT_LEN is too short for the captured audio"
+#endif /* AEC_CALIB_FFT_LEN */
+
+#if ((AEC_CALIB_PREROLL_BLOCKS * AFE_BLOCK_SMPL_COUNT) < AEC_CALIB_MAX_LAG_SMPL)
+#error "AEC_CALIB_PREROLL_BLOCKS is too short for AEC_CALIB_SEARCH_US"
+#endif /* AEC_CALIB_PREROLL_BLOCKS */
+
+typedef enum _aec_calib_capture_state
+{
+    kAecCalibCaptureIdle = 0, /* Not capturing */
+    kAecCalibCaptureArmed,    /* Capturing in a loop, waiting for the sound in the reference */
+    kAecCalibCaptureRunning,  /* Sound seen, capturing the remaining blocks */
+} aec_calib_capture_state_t;
+
+typedef struct _aec_calib_file
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t delayUs;
+} aec_calib_file_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static volatile uint8_t s_captureState  = kAecCalibCaptureIdle;
+static SemaphoreHandle_t s_captureDone  = NULL;
+static int16_t *s_micCapture            = NULL;
+static int16_t *s_refCapture            = NULL;
+static uint32_t s_captureBlock          = 0; /* Next block written, the capture buffers are circular */
+static uint32_t s_captureBlocksLeft     = 0;
+
+static float s_decimTaps[AEC_CALIB_DECIM_TAPS];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _block_energy(const int16_t *block)
+{
+    uint64_t energy = 0;
+
+    for (uint32_t idx = 0; idx < AFE_BLOCK_SMPL_COUNT; idx++)
+    {
+        energy += (int32_t)block[idx] * block[idx];
+    }
+
+    return (uint32_t)(energy / AFE_BLOCK_SMPL_COUNT);
+}
+
+static void _reverse(int16_t *buf, uint32_t first, uint32_t last)
+{
+    int16_t tmp = 0;
+
+    while (first < last)
+    {
+        tmp        = buf[first];
+        buf[first] = buf[last];
+        buf[last]  = tmp;
+        first++;
+        last--;
+    }
+}
+
+/**
+ * @brief Rotate a circular capture so its oldest sample comes first.
+ */
+static void _linearize(int16_t *buf, uint32_t oldest)
+{
+    if (oldest != 0)
+    {
+        _reverse(buf, 0, oldest - 1);
+        _reverse(buf, oldest, AEC_CALIB_CAPTURE_SMPL - 1);
+        _reverse(buf, 0, AEC_CALIB_CAPTURE_SMPL - 1);
+    }
+}
+
+/**
+ * @brief Hamming windowed sinc low pass, cut at 90% of the decimated Nyquist frequency.
+ */
+static void _init_decim_taps(void)
+{
+    const float cutoff = 0.9f / (2.0f * AEC_CALIB_DECIMATION);
+    const float middle = (AEC_CALIB_DECIM_TAPS - 1) / 2.0f;
+    float sum          = 0.0f;
+    float x            = 0.0f;
+
+    for (uint32_t idx = 0; idx < AEC_CALIB_DECIM_TAPS; idx++)
+    {
+        x = (float)idx - middle;
+        s_decimTaps[idx] = (x == 0.0f) ? (2.0f * cutoff) : (sinf(2.0f * PI * cutoff * x) / (PI * x));
+        s_decimTaps[idx] *= 0.54f - 0.46f * cosf(2.0f * PI * idx / (AEC_CALIB_DECIM_TAPS - 1));
+        sum += s_decimTaps[idx];
+    }
+
+    for (uint32_t idx = 0; idx < AEC_CALIB_DECIM_TAPS; idx++)
+    {
+        s_decimTaps[idx] /= sum;
+    }
+}
+
+/**
+ * @brief Low pass and decimate a capture into the first AEC_CALIB_DECIM_SMPL samples of out,
+ *        and zero the rest of the AEC_CALIB_FFT_LEN samples. Both streams get the same filter delay.
+ */
+static void _decimate(const int16_t *in, float *out)
+{
+    const int16_t *src = NULL;
+    float acc          = 0.0f;
+
+    for (uint32_t idx = 0; idx < AEC_CALIB_DECIM_SMPL; idx++)
+    {
+        src = &in[idx * AEC_CALIB_DECIMATION];
+        acc = 0.0f;
+        for (uint32_t tap = 0; tap < AEC_CALIB_DECIM_TAPS; tap++)
+        {
+            acc += s_decimTaps[tap] * src[tap];
+        }
+        out[idx] = acc / 32768.0f;
+    }
+
+    memset(&out[AEC_CALIB_DECIM_SMPL], 0, (AEC_CALIB_FFT_LEN - AEC_CALIB_DECIM_SMPL) * sizeof(float));
+}
+
+/**
+ * @brief Coarse lag of the mics after the reference, in decimated samples, using a cross correlation
+ *        whitened in the frequency domain (GCC-PHAT). The whitening keeps the periodic part of the
+ *        alignment sound from producing several peaks of the same height.
+ *
+ * @param work   3 * AEC_CALIB_FFT_LEN floats
+ * @param lag    Pointer where the lag will be stored
+ * @param sign   Pointer where the polarity of the echo will be stored, the speaker path may invert it
+ */
+static status_t _coarse_lag(arm_rfft_fast_instance_f32 *fft, float *work, int32_t *lag, float *sign)
+{
+    float *micSpec   = &work[0];
+    float *refSpec   = &work[AEC_CALIB_FFT_LEN];
+    float *cross     = &work[2 * AEC_CALIB_FFT_LEN];
+    float *corr      = micSpec;
+    float meanPower  = 0.0f;
+    float refPower   = 0.0f;
+    float crossRe    = 0.0f;
+    float crossIm    = 0.0f;
+    float magnitude  = 0.0f;
+    float peak       = 0.0f;
+    float sum        = 0.0f;
+    int32_t maxLag   = AEC_CALIB_MAX_LAG_SMPL / AEC_CALIB_DECIMATION;
+    uint32_t bin     = 0;
+
+    /* The FFT uses its input as scratch, go through the cross buffer */
+    _decimate(s_micCapture, cross);
+    arm_rfft_fast_f32(fft, cross, micSpec, 0);
+    _decimate(s_refCapture, cross);
+    arm_rfft_fast_f32(fft, cross, refSpec, 0);
+
+    /* Packed spectra: DC and Nyquist first, then (re, im) pairs */
+    for (bin = 1; bin < (AEC_CALIB_FFT_LEN / 2); bin++)
+    {
+        meanPower += (refSpec[2 * bin] * refSpec[2 * bin]) + (refSpec[2 * bin + 1] * refSpec[2 * bin + 1]);
+    }
+    meanPower /= (AEC_CALIB_FFT_LEN / 2) - 1;
+
+    /* DC and Nyquist carry no delay information */
+    cross[0] = 0.0f;
+    cross[1] = 0.0f;
+
+    for (bin = 1; bin < (AEC_CALIB_FFT_LEN / 2); bin++)
+    {
+        refPower = (refSpec[2 * bin] * refSpec[2 * bin]) + (refSpec[2 * bin + 1] * refSpec[2 * bin + 1]);
+
+        /* mic * conj(ref) */
+        crossRe   = (micSpec[2 * bin] * refSpec[2 * bin]) + (micSpec[2 * bin + 1] * refSpec[2 * bin + 1]);
+        crossIm   = (micSpec[2 * bin + 1] * refSpec[2 * bin]) - (micSpec[2 * bin] * refSpec[2 * bin + 1]);
+        magnitude = sqrtf((crossRe * crossRe) + (crossIm * crossIm));
+
+        if ((refPower > (AEC_CALIB_PHAT_FLOOR * meanPower)) && (magnitude > 0.0f))
+        {
+            cross[2 * bin]     = crossRe / magnitude;
+            cross[2 * bin + 1] = crossIm / magnitude;
+        }
+        else
+        {
+            cross[2 * bin]     = 0.0f;
+            cross[2 * bin + 1] = 0.0f;
+        }
+    }
+
+    arm_rfft_fast_f32(fft, cross, corr, 1);
+
+    /* Negative lags are at the end of the correlation */
+    for (int32_t idx = -maxLag; idx <= maxLag; idx++)
+    {
+        magnitude = fabsf(corr[(idx < 0) ? (AEC_CALIB_FFT_LEN + idx) : idx]);
+        sum += magnitude;
+        if (magnitude > peak)
+        {
+            peak  = magnitude;
+            *lag  = idx;
+            *sign = (corr[(idx < 0) ? (AEC_CALIB_FFT_LEN + idx) : idx] < 0.0f) ? -1.0f : 1.0f;
+        }
+    }
+
+    if ((peak == 0.0f) || (peak < (AEC_CALIB_MIN_PEAK_RATIO * sum / (2 * maxLag + 1))))
+    {
+        return kStatus_NoData;
+    }
+
+    return kStatus_Success;
+}
+
+/**
+ * @brief Time domain correlation of the full rate captures at one lag, normalized by the overlap.
+ */
+static float _full_rate_corr(int32_t lag)
+{
+    int32_t first = MAX(lag, 0);
+    int32_t last  = MIN((int32_t)AEC_CALIB_CAPTURE_SMPL, (int32_t)AEC_CALIB_CAPTURE_SMPL + lag);
+    int64_t acc   = 0;
+
+    for (int32_t idx = first; idx < last; idx++)
+    {
+        acc += (int32_t)s_micCapture[idx] * s_refCapture[idx - lag];
+    }
+
+    return (float)acc / (float)(last - first);
+}
+
+/**
+ * @brief Lag of the mics after the reference, in full rate samples with a fractional part.
+ *        The coarse lag is refined at full rate around its decimated position and the peak is
+ *        interpolated with a parabola.
+ */
+static status_t _measure_lag(arm_rfft_fast_instance_f32 *fft, float *work, float *lag)
+{
+    status_t status  = kStatus_Success;
+    int32_t coarse   = 0;
+    int32_t center   = 0;
+    int32_t best     = 0;
+    float sign       = 1.0f;
+    float corr[(2 * AEC_CALIB_DECIMATION) + 1];
+    float prev       = 0.0f;
+    float next       = 0.0f;
+    float curvature  = 0.0f;
+
+    status = _coarse_lag(fft, work, &coarse, &sign);
+    if (status == kStatus_Success)
+    {
+        center = coarse * (int32_t)AEC_CALIB_DECIMATION;
+
+        for (int32_t idx = 0; idx <= (int32_t)(2 * AEC_CALIB_DECIMATION); idx++)
+        {
+            corr[idx] = sign * _full_rate_corr(center + idx - (int32_t)AEC_CALIB_DECIMATION);
+            if (corr[idx] > corr[best])
+            {
+                best = idx;
+            }
+        }
+
+        *lag = (float)(center + best - (int32_t)AEC_CALIB_DECIMATION);
+
+        if ((best > 0) && (best < (int32_t)(2 * AEC_CALIB_DECIMATION)))
+        {
+            prev      = corr[best - 1];
+            next      = corr[best + 1];
+            curvature = prev - (2.0f * corr[best]) + next;
+            if (curvature < 0.0f)
+            {
+                *lag += 0.5f * (prev - next) / curvature;
+            }
+        }
+    }
+
+    return status;
+}
+
+static float _median(float *values, uint32_t count)
+{
+    float tmp = 0.0f;
+
+    for (uint32_t i = 1; i < count; i++)
+    {
+        for (uint32_t j = i; (j > 0) && (values[j - 1] > values[j]); j--)
+        {
+            tmp           = values[j];
+            values[j]     = values[j - 1];
+            values[j - 1] = tmp;
+        }
+    }
+
+    return ((count % 2) != 0) ? values[count / 2] : ((values[(count / 2) - 1] + values[count / 2]) / 2.0f);
+}
+
+static void _capture_arm(void)
+{
+    /* The pre roll is silent if the sound starts right away */
+    memset(s_micCapture, 0, AEC_CALIB_CAPTURE_SMPL * sizeof(int16_t));
+    memset(s_refCapture, 0, AEC_CALIB_CAPTURE_SMPL * sizeof(int16_t));
+
+    taskENTER_CRITICAL();
+    s_captureBlock = 0;
+    s_captureState = kAecCalibCaptureArmed;
+    taskEXIT_CRITICAL();
+
+    /* A capture left over by a previous run is not waited for */
+    xSemaphoreTake(s_captureDone, 0);
+}
+
+static status_t _save_delay(uint32_t delayUs)
+{
+    aec_calib_file_t file             = {AEC_CALIB_FILE_MAGIC, AEC_CALIB_FILE_VERSION, delayUs};
+    sln_flash_fs_status_t statusFlash = SLN_FLASH_FS_OK;
+
+    statusFlash = sln_flash_fs_ops_save(AEC_CALIB_FILE_NAME, (uint8_t *)&file, sizeof(file));
+    if (statusFlash != SLN_FLASH_FS_OK)
+    {
+        configPRINTF(("Failed to save the AEC calibration in flash memory.\r\n"));
+        return kStatus_Fail;
+    }
+
+    return kStatus_Success;
+}
+
+void AUDIO_AEC_CALIB_Init(void)
+{
+    aec_calib_file_t file             = {0};
+    sln_flash_fs_status_t statusFlash = SLN_FLASH_FS_OK;
+    uint32_t len                      = 0;
+
+    s_captureDone = xSemaphoreCreateBinary();
+    if (s_captureDone == NULL)
+    {
+        configPRINTF(("Failed to create the AEC calibration semaphore.\r\n"));
+    }
+
+    statusFlash = sln_flash_fs_ops_read(AEC_CALIB_FILE_NAME, NULL, 0, &len);
+    if ((statusFlash == SLN_FLASH_FS_OK) && (len == sizeof(file)))
+    {
+        statusFlash = sln_flash_fs_ops_read(AEC_CALIB_FILE_NAME, (uint8_t *)&file, 0, &len);
+    }
+
+    /* No file means the board was never calibrated, keep AMP_LOOPBACK_CONST_DELAY_US */
+    if ((statusFlash == SLN_FLASH_FS_OK) && (file.magic == AEC_CALIB_FILE_MAGIC) &&
+        (file.version == AEC_CALIB_FILE_VERSION) && (file.delayUs <= AMP_LOOPBACK_MAX_CONST_DELAY_US))
+    {
+        SLN_AMP_SetLoopbackDelayUs(file.delayUs);
+        configPRINTF(("AEC calibration: loopback delay %d us\r\n", file.delayUs));
+    }
+}
+
+status_t AUDIO_AEC_CALIB_Run(uint32_t *delayUs)
+{
+    status_t status                 = kStatus_Success;
+    arm_rfft_fast_instance_f32 fft;
+    float *work                     = NULL;
+    int16_t *capture                = NULL;
+    float lags[AEC_CALIB_RUNS];
+    uint32_t validRuns              = 0;
+    float lag                       = 0.0f;
+    int32_t newDelayUs              = 0;
+
+    if (s_captureDone == NULL)
+    {
+        return kStatus_Fail;
+    }
+
+    capture = SLN_HEAP_TryAlloc(2 * AEC_CALIB_CAPTURE_SMPL * sizeof(int16_t));
+    work    = (capture != NULL) ? SLN_HEAP_TryAlloc(3 * AEC_CALIB_FFT_LEN * sizeof(float)) : NULL;
+    if ((capture == NULL) || (work == NULL))
+    {
+        configPRINTF(("AEC calibration: not enough memory\r\n"));
+        vPortFree(capture);
+        vPortFree(work);
+        return kStatus_Fail;
+    }
+
+    s_micCapture = capture;
+    s_refCapture = &capture[AEC_CALIB_CAPTURE_SMPL];
+    arm_rfft_fast_init_f32(&fft, AEC_CALIB_FFT_LEN);
+    _init_decim_taps();
+
+    /* power on the amp */
+    GPIO_PinWrite(GPIO2, 2, 1);
+    vTaskDelay(AEC_CALIB_AMP_ON_DELAY_MS);
+
+    SLN_AMP_SetVolume(AEC_CALIB_VOLUME);
+
+    for (uint32_t run = 0; run < AEC_CALIB_RUNS; run++)
+    {
+        _capture_arm();
+
+        /* Every run is a new playback session, so the loopback delay is applied again */
+        status = SLN_AMP_WriteAudioBlocking((uint8_t *)&rectangular_sound_wav[AEC_CALIB_WAV_HEADER_SIZE],
+                                            RECTANGULAR_SOUND_WAV_LEN - AEC_CALIB_WAV_HEADER_SIZE);
+        if (status != kStatus_Success)
+        {
+            configPRINTF(("AEC calibration: playback failed %d\r\n", status));
+            s_captureState = kAecCalibCaptureIdle;
+            status         = kStatus_Fail;
+            break;
+        }
+
+        if (xSemaphoreTake(s_captureDone, pdMS_TO_TICKS(AEC_CALIB_CAPTURE_TIMEOUT_MS)) != pdTRUE)
+        {
+            configPRINTF(("AEC calibration: sound not seen in the reference\r\n"));
+            s_captureState = kAecCalibCaptureIdle;
+            status         = kStatus_Timeout;
+        }
+        else
+        {
+            _linearize(s_micCapture, s_captureBlock * AFE_BLOCK_SMPL_COUNT);
+            _linearize(s_refCapture, s_captureBlock * AFE_BLOCK_SMPL_COUNT);
+
+            status = _measure_lag(&fft, work, &lag);
+            if (status == kStatus_Success)
+            {
+                lags[validRuns++] = lag;
+                configPRINTF(("AEC calibration: run %d, mics after reference by %d us\r\n", run + 1,
+                              (int)(lag * 1000000.0f / PCM_SAMPLE_RATE_HZ)));
+            }
+            else
+            {
+                configPRINTF(("AEC calibration: run %d, no clear correlation peak\r\n", run + 1));
+            }
+        }
+
+        vTaskDelay(AEC_CALIB_DELAY_BETWEEN_RUNS_MS);
+    }
+
+    /* power off the amp */
+    GPIO_PinWrite(GPIO2, 2, 0);
+
+    s_micCapture = NULL;
+    s_refCapture = NULL;
+    vPortFree(capture);
+    vPortFree(work);
+
+    if (status == kStatus_Fail)
+    {
+        return status;
+    }
+
+    /* A majority of the runs must agree on the delay */
+    if (validRuns <= (AEC_CALIB_RUNS / 2))
+    {
+        return (status == kStatus_Success) ? kStatus_NoData : status;
+    }
+
+    lag        = _median(lags, validRuns);
+    newDelayUs = (int32_t)SLN_AMP_GetLoopbackDelayUs() + (int32_t)lroundf(lag * 1000000.0f / PCM_SAMPLE_RATE_HZ);
+    if ((newDelayUs < 0) || (newDelayUs > AMP_LOOPBACK_MAX_CONST_DELAY_US))
+    {
+        configPRINTF(("AEC calibration: delay of %d us out of range\r\n", newDelayUs));
+        return kStatus_OutOfRange;
+    }
+
+    SLN_AMP_SetLoopbackDelayUs((uint32_t)newDelayUs);
+    if (delayUs != NULL)
+    {
+        *delayUs = (uint32_t)newDelayUs;
+    }
+
+    return _save_delay((uint32_t)newDelayUs);
+}
+
+status_t AUDIO_AEC_CALIB_Reset(void)
+{
+    sln_flash_fs_status_t statusFlash = SLN_FLASH_FS_OK;
+
+    SLN_AMP_SetLoopbackDelayUs(AMP_LOOPBACK_CONST_DELAY_US);
+
+    statusFlash = sln_flash_fs_ops_erase(AEC_CALIB_FILE_NAME);
+    if (statusFlash != SLN_FLASH_FS_OK)
+    {
+        configPRINTF(("Failed to delete the AEC calibration from flash memory.\r\n"));
+        return kStatus_Fail;
+    }
+
+    return kStatus_Success;
+}
+
+void AUDIO_AEC_CALIB_FeedBlock(const int16_t *micStream, const int16_t *ampStream)
+{
+    uint32_t offset = 0;
+
+    if ((s_captureState != kAecCalibCaptureArmed) && (s_captureState != kAecCalibCaptureRunning))
+    {
+        return;
+    }
+
+    offset = s_captureBlock * AFE_BLOCK_SMPL_COUNT;
+    memcpy(&s_micCapture[offset], micStream, AFE_BLOCK_SMPL_COUNT * sizeof(int16_t));
+    if (ampStream != NULL)
+    {
+        memcpy(&s_refCapture[offset], ampStream, AFE_BLOCK_SMPL_COUNT * sizeof(int16_t));
+    }
+    else
+    {
+        memset(&s_refCapture[offset], 0, AFE_BLOCK_SMPL_COUNT * sizeof(int16_t));
+    }
+    s_captureBlock = (s_captureBlock + 1) % AEC_CALIB_CAPTURE_BLOCKS;
+
+    if (s_captureState == kAecCalibCaptureArmed)
+    {
+        if ((ampStream != NULL) && (_block_energy(ampStream) >= AEC_CALIB_ONSET_ENERGY))
+        {
+            /* The onset block and the pre roll are in, capture the rest */
+            s_captureBlocksLeft = AEC_CALIB_CAPTURE_BLOCKS - AEC_CALIB_PREROLL_BLOCKS - 1U;
+            s_captureState      = kAecCalibCaptureRunning;
+        }
+    }
+    else
+    {
+        s_captureBlocksLeft--;
+        if (s_captureBlocksLeft == 0)
+        {
+            /* s_captureBlock now points to the oldest block */
+            s_captureState = kAecCalibCaptureIdle;
+            xSemaphoreGive(s_captureDone);
+        }
+    }
+}
+
+#endif /* ENABLE_AEC_CALIBRATION */
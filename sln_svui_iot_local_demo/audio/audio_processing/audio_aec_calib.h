@@ -0,0 +1,91 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _AUDIO_AEC_CALIB_H_
+#define _AUDIO_AEC_CALIB_H_
+
+#if ENABLE_AEC_CALIBRATION
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#include "fsl_common.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* File holding the calibrated loopback delay */
+#define AEC_CALIB_FILE_NAME "aec_calib.dat"
+
+/* Number of times the alignment sound is played. The delay is the median of the measures. */
+#ifndef AEC_CALIB_RUNS
+#define AEC_CALIB_RUNS 3U
+#endif /* AEC_CALIB_RUNS */
+
+/* Volume used to play the alignment sound, between 0 and 100 */
+#ifndef AEC_CALIB_VOLUME
+#define AEC_CALIB_VOLUME 30U
+#endif /* AEC_CALIB_VOLUME */
+
+/* Largest misalignment searched between the microphones and the reference, in both directions */
+#ifndef AEC_CALIB_SEARCH_US
+#define AEC_CALIB_SEARCH_US 20000U
+#endif /* AEC_CALIB_SEARCH_US */
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Apply the loopback delay stored by the last calibration, if any.
+ *        Must be called after the file system and the amplifier are initialized
+ *        and before the audio processing task starts.
+ */
+void AUDIO_AEC_CALIB_Init(void);
+
+/*!
+ * @brief Play the alignment sound, measure the misalignment between the first microphone and the
+ *        loopback reference and correct the loopback delay. The new delay is stored in the file system.
+ *        Blocks the caller for a few seconds. The microphones must be on and no audio may be playing.
+ *        The amplifier volume is left on AEC_CALIB_VOLUME.
+ *
+ * @param delayUs Pointer where the new loopback delay will be stored, may be NULL
+ *
+ * @return kStatus_Success if the delay was measured and stored,
+ *         kStatus_Timeout if the sound was not heard in the reference,
+ *         kStatus_NoData if the correlation had no clear peak,
+ *         kStatus_OutOfRange if the corrected delay does not fit the loopback ringbuffer,
+ *         kStatus_Fail otherwise.
+ */
+status_t AUDIO_AEC_CALIB_Run(uint32_t *delayUs);
+
+/*!
+ * @brief Erase the stored delay and go back to AMP_LOOPBACK_CONST_DELAY_US.
+ *
+ * @return kStatus_Success if the default delay is used again.
+ */
+status_t AUDIO_AEC_CALIB_Reset(void);
+
+/*!
+ * @brief Feed one SLN_AFE block to the calibration. Called by the audio processing task on every block,
+ *        it returns immediately unless a calibration is capturing.
+ *
+ * @param micStream Planar int16 mic block, the first AFE_BLOCK_SMPL_COUNT samples belong to the first mic
+ * @param ampStream Amplifier reference block or NULL
+ */
+void AUDIO_AEC_CALIB_FeedBlock(const int16_t *micStream, const int16_t *ampStream);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ENABLE_AEC_CALIBRATION */
+#endif /* _AUDIO_AEC_CALIB_H_ */
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "audio_deadline.h"
+#include "audio_frame_pool.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+typedef struct _audio_deadline_state
+{
+    audio_deadline_stats_t stats;
+    audio_deadline_shed_cb_t shedCallback;
+    uint32_t windowRuns;   /* Runs in the current shedding window */
+    uint32_t windowMisses; /* Misses in the current shedding window */
+} audio_deadline_state_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static audio_deadline_state_t s_states[kAudioDeadlineStageCount];
+
+/* Circular log of the most recent misses */
+static audio_deadline_miss_t s_missLog[AUDIO_DEADLINE_MISS_LOG_SIZE];
+static uint32_t s_missLogCount = 0;
+
+static const uint32_t s_budgetsUs[kAudioDeadlineStageCount] = {AFE_BLOCK_MS * 1000U, ASR_FRAME_MS * 1000U};
+
+static const char *const s_stageNames[kAudioDeadlineStageCount] = {"AFE block", "ASR frame"};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static void _log_miss(audio_deadline_stage_t stage, uint32_t elapsedUs)
+{
+    audio_deadline_state_t *state = &s_states[stage];
+    audio_deadline_miss_t miss;
+
+    /* Gather the context outside of the critical section, the stack check walks the stack */
+    miss.run        = state->stats.runs;
+    miss.elapsedUs  = elapsedUs;
+    miss.budgetUs   = state->stats.budgetUs;
+    miss.tick       = xTaskGetTickCount();
+    miss.stackFree  = uxTaskGetStackHighWaterMark(NULL);
+    miss.coreMhz    = (uint16_t)(SystemCoreClock / 1000000U);
+    miss.stage      = (uint8_t)stage;
+    miss.priority   = (uint8_t)uxTaskPriorityGet(NULL);
+    miss.freeFrames = (uint8_t)AUDIO_FRAME_POOL_GetFreeCount();
+    miss.shedding   = (uint8_t)state->stats.shedding;
+    strncpy(miss.taskName, pcTaskGetName(NULL), configMAX_TASK_NAME_LEN - 1);
+    miss.taskName[configMAX_TASK_NAME_LEN - 1] = '\0';
+
+    taskENTER_CRITICAL();
+    s_missLog[s_missLogCount % AUDIO_DEADLINE_MISS_LOG_SIZE] = miss;
+    s_missLogCount++;
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_DEADLINE_Init(void)
+{
+    memset(s_states, 0, sizeof(s_states));
+    AUDIO_DEADLINE_Reset();
+}
+
+void AUDIO_DEADLINE_Reset(void)
+{
+    taskENTER_CRITICAL();
+
+    for (uint32_t stage = 0; stage < kAudioDeadlineStageCount; stage++)
+    {
+        s_states[stage].stats.runs     = 0;
+        s_states[stage].stats.misses   = 0;
+        s_states[stage].stats.worstUs  = 0;
+        s_states[stage].stats.sheds    = 0;
+        s_states[stage].stats.budgetUs = s_budgetsUs[stage];
+    }
+
+    s_missLogCount = 0;
+
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_DEADLINE_SetShedCallback(audio_deadline_stage_t stage, audio_deadline_shed_cb_t callback)
+{
+    if (stage < kAudioDeadlineStageCount)
+    {
+        s_states[stage].shedCallback = callback;
+    }
+}
+
+void AUDIO_DEADLINE_Check(audio_deadline_stage_t stage, uint32_t cycles)
+{
+    audio_deadline_state_t *state = &s_states[stage];
+    uint32_t elapsedUs            = 0;
+    bool missed                   = false;
+    bool shedChanged              = false;
+
+    /* SystemCoreClock follows the VAD clock reduction */
+    elapsedUs = (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+    missed    = (elapsedUs > state->stats.budgetUs);
+
+    if (missed)
+    {
+        _log_miss(stage, elapsedUs);
+    }
+
+    taskENTER_CRITICAL();
+
+    state->stats.runs++;
+    if (elapsedUs > state->stats.worstUs)
+    {
+        state->stats.worstUs = elapsedUs;
+    }
+
+    state->windowRuns++;
+    if (missed)
+    {
+        state->stats.misses++;
+        state->windowMisses++;
+    }
+
+    if ((!state->stats.shedding) && (state->windowMisses >= AUDIO_DEADLINE_SHED_MISSES) &&
+        (state->shedCallback != NULL))
+    {
+        state->stats.shedding = true;
+        state->stats.sheds++;
+        state->windowRuns   = 0;
+        state->windowMisses = 0;
+        shedChanged         = true;
+    }
+    else if (state->windowRuns >= AUDIO_DEADLINE_SHED_WINDOW)
+    {
+        if (state->stats.shedding && (state->windowMisses == 0))
+        {
+            state->stats.shedding = false;
+            shedChanged           = true;
+        }
+        state->windowRuns   = 0;
+        state->windowMisses = 0;
+    }
+
+    taskEXIT_CRITICAL();
+
+    if (shedChanged && (state->shedCallback != NULL))
+    {
+        state->shedCallback(state->stats.shedding);
+    }
+}
+
+void AUDIO_DEADLINE_GetStats(audio_deadline_stage_t stage, audio_deadline_stats_t *stats)
+{
+    if ((stage < kAudioDeadlineStageCount) && (stats != NULL))
+    {
+        taskENTER_CRITICAL();
+        *stats = s_states[stage].stats;
+        taskEXIT_CRITICAL();
+    }
+}
+
+uint32_t AUDIO_DEADLINE_GetMissLog(audio_deadline_miss_t *log, uint32_t maxCount)
+{
+    uint32_t count = 0;
+
+    if (log != NULL)
+    {
+        taskENTER_CRITICAL();
+
+        count = MIN(MIN(s_missLogCount, AUDIO_DEADLINE_MISS_LOG_SIZE), maxCount);
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            log[idx] = s_missLog[(s_missLogCount - 1U - idx) % AUDIO_DEADLINE_MISS_LOG_SIZE];
+        }
+
+        taskEXIT_CRITICAL();
+    }
+
+    return count;
+}
+
+const char *AUDIO_DEADLINE_GetStageName(audio_deadline_stage_t stage)
+{
+    const char *name = "unknown";
+
+    if (stage < kAudioDeadlineStageCount)
+    {
+        name = s_stageNames[stage];
+    }
+
+    return name;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _AUDIO_DEADLINE_H_
+#define _AUDIO_DEADLINE_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#include "FreeRTOS.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Number of most recent deadline misses kept, with their context */
+#ifndef AUDIO_DEADLINE_MISS_LOG_SIZE
+#define AUDIO_DEADLINE_MISS_LOG_SIZE 8U
+#endif /* AUDIO_DEADLINE_MISS_LOG_SIZE */
+
+/* Load shedding starts once AUDIO_DEADLINE_SHED_MISSES deadlines were missed within
+ * AUDIO_DEADLINE_SHED_WINDOW runs of a stage, and stops after a full window without any miss. */
+#ifndef AUDIO_DEADLINE_SHED_MISSES
+#define AUDIO_DEADLINE_SHED_MISSES 3U
+#endif /* AUDIO_DEADLINE_SHED_MISSES */
+
+#ifndef AUDIO_DEADLINE_SHED_WINDOW
+#define AUDIO_DEADLINE_SHED_WINDOW 100U
+#endif /* AUDIO_DEADLINE_SHED_WINDOW */
+
+/*!
+ * @brief Stages checked against a real-time budget.
+ */
+typedef enum _audio_deadline_stage
+{
+    kAudioDeadlineAfe = 0, /*!< Audio processing of one 10ms block: AFE, VAD and ASR hand off */
+    kAudioDeadlineAsr,     /*!< ASR processing of one frame, ASR_FRAME_MS */
+    kAudioDeadlineStageCount
+} audio_deadline_stage_t;
+
+/*!
+ * @brief Called when a stage starts or stops shedding load. Runs in the context of the task
+ *        which recorded the stage, so it must only raise a flag.
+ *
+ * @param shed true to reduce the processing, false to restore it
+ */
+typedef void (*audio_deadline_shed_cb_t)(bool shed);
+
+/*!
+ * @brief One missed deadline and the context of the task which missed it.
+ */
+typedef struct _audio_deadline_miss
+{
+    uint32_t run;                                /*!< Run of the stage which missed, since the last reset */
+    uint32_t elapsedUs;                          /*!< Processing time */
+    uint32_t budgetUs;                           /*!< Budget of the stage */
+    uint32_t tick;                               /*!< FreeRTOS tick count */
+    uint32_t stackFree;                          /*!< Stack high water mark of the task, in words */
+    uint16_t coreMhz;                            /*!< Core clock, lowered by VAD */
+    uint8_t stage;                               /*!< audio_deadline_stage_t */
+    uint8_t priority;                            /*!< Priority of the task */
+    uint8_t freeFrames;                          /*!< Free AFE to ASR frames, low when ASR lags behind */
+    uint8_t shedding;                            /*!< Stage was already shedding load */
+    char taskName[configMAX_TASK_NAME_LEN];      /*!< Task which missed the deadline */
+} audio_deadline_miss_t;
+
+/*!
+ * @brief Deadline statistics of one stage.
+ */
+typedef struct _audio_deadline_stats
+{
+    uint32_t runs;     /*!< Runs checked since the last reset */
+    uint32_t misses;   /*!< Runs over budget since the last reset */
+    uint32_t budgetUs; /*!< Budget of one run */
+    uint32_t worstUs;  /*!< Longest run since the last reset */
+    uint32_t sheds;    /*!< Times load shedding was started */
+    bool shedding;     /*!< Load shedding is active */
+} audio_deadline_stats_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Clear the statistics. Must be called before the audio tasks start.
+ */
+void AUDIO_DEADLINE_Init(void);
+
+/*!
+ * @brief Clear the statistics and the missed deadlines log. Load shedding which is active stays on
+ *        until a full window without misses.
+ */
+void AUDIO_DEADLINE_Reset(void);
+
+/*!
+ * @brief Register the callback used to shed load when a stage keeps missing its deadline.
+ *
+ * @param stage    Checked stage
+ * @param callback Callback, NULL to disable load shedding for the stage
+ */
+void AUDIO_DEADLINE_SetShedCallback(audio_deadline_stage_t stage, audio_deadline_shed_cb_t callback);
+
+/*!
+ * @brief Compare one run of a stage with its budget. Only one task may check a given stage.
+ *
+ * @param stage  Checked stage
+ * @param cycles Duration of the run, in DWT cycles
+ */
+void AUDIO_DEADLINE_Check(audio_deadline_stage_t stage, uint32_t cycles);
+
+/*!
+ * @brief Get a copy of the statistics of a stage.
+ *
+ * @param stage Checked stage
+ * @param stats Pointer where the statistics will be copied
+ */
+void AUDIO_DEADLINE_GetStats(audio_deadline_stage_t stage, audio_deadline_stats_t *stats);
+
+/*!
+ * @brief Get a copy of the most recent missed deadlines, newest first.
+ *
+ * @param log      Array where the missed deadlines will be copied
+ * @param maxCount Size of the array
+ *
+ * @return Number of missed deadlines copied
+ */
+uint32_t AUDIO_DEADLINE_GetMissLog(audio_deadline_miss_t *log, uint32_t maxCount);
+
+/*!
+ * @brief Get the printable name of a stage.
+ *
+ * @param stage Checked stage
+ */
+const char *AUDIO_DEADLINE_GetStageName(audio_deadline_stage_t stage);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _AUDIO_DEADLINE_H_ */
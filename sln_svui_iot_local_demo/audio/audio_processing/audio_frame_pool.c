@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "audio_frame_pool.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* Frames are only touched by the CPU, so keep them in cacheable OCRAM. */
+SDK_ALIGN(static audio_frame_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) s_frames[AUDIO_FRAME_POOL_COUNT], 32);
+
+/* Stack of free frame indices */
+static uint8_t s_freeList[AUDIO_FRAME_POOL_COUNT];
+static uint32_t s_freeCount = 0;
+
+static uint32_t s_exhaustedCount = 0;
+
+#if SELF_WAKE_UP_PROTECTION
+/* Reference of each frame, only attached while the ASR self wake up engine runs */
+static int16_t (*s_refSamples)[AUDIO_FRAME_SAMPLE_COUNT] = NULL;
+
+/* Reference samples written in each frame since it was acquired */
+static uint16_t s_refCount[AUDIO_FRAME_POOL_COUNT];
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void AUDIO_FRAME_POOL_Init(void)
+{
+    taskENTER_CRITICAL();
+
+    for (uint32_t idx = 0; idx < AUDIO_FRAME_POOL_COUNT; idx++)
+    {
+        s_frames[idx].refCount = 0;
+        s_frames[idx].index    = idx;
+        s_freeList[idx]        = idx;
+    }
+    s_freeCount      = AUDIO_FRAME_POOL_COUNT;
+    s_exhaustedCount = 0;
+
+    taskEXIT_CRITICAL();
+}
+
+audio_frame_t *AUDIO_FRAME_POOL_Acquire(void)
+{
+    audio_frame_t *frame = NULL;
+
+    taskENTER_CRITICAL();
+
+    if (s_freeCount > 0)
+    {
+        s_freeCount--;
+        frame           = &s_frames[s_freeList[s_freeCount]];
+        frame->refCount = 1;
+#if SELF_WAKE_UP_PROTECTION
+        s_refCount[frame->index] = 0;
+#endif /* SELF_WAKE_UP_PROTECTION */
+    }
+    else
+    {
+        s_exhaustedCount++;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return frame;
+}
+
+void AUDIO_FRAME_POOL_Retain(audio_frame_t *frame)
+{
+    if (frame != NULL)
+    {
+        taskENTER_CRITICAL();
+        frame->refCount++;
+        taskEXIT_CRITICAL();
+    }
+}
+
+void AUDIO_FRAME_POOL_Release(audio_frame_t *frame)
+{
+    if (frame != NULL)
+    {
+        taskENTER_CRITICAL();
+
+        if (frame->refCount > 0)
+        {
+            frame->refCount--;
+            if (frame->refCount == 0)
+            {
+                s_freeList[s_freeCount] = frame->index;
+                s_freeCount++;
+            }
+        }
+
+        taskEXIT_CRITICAL();
+    }
+}
+
+uint32_t AUDIO_FRAME_POOL_GetFreeCount(void)
+{
+    return s_freeCount;
+}
+
+uint32_t AUDIO_FRAME_POOL_GetExhaustedCount(void)
+{
+    return s_exhaustedCount;
+}
+
+#if SELF_WAKE_UP_PROTECTION
+void AUDIO_FRAME_POOL_AttachRef(int16_t *buffer)
+{
+    taskENTER_CRITICAL();
+
+    memset(s_refCount, 0, sizeof(s_refCount));
+    s_refSamples = (int16_t(*)[AUDIO_FRAME_SAMPLE_COUNT])buffer;
+
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_FRAME_POOL_WriteRef(audio_frame_t *frame, uint32_t offset, const int16_t *samples, uint32_t count)
+{
+    if ((frame == NULL) || (samples == NULL) || ((offset + count) > AUDIO_FRAME_SAMPLE_COUNT))
+    {
+        return;
+    }
+
+    /* The copy of one AFE block is short, it is done with the buffer locked so a detached buffer
+     * is never written */
+    taskENTER_CRITICAL();
+
+    /* A frame attached in the middle of its filling never gets a complete reference */
+    if ((s_refSamples != NULL) && (s_refCount[frame->index] == offset))
+    {
+        memcpy(&s_refSamples[frame->index][offset], samples, count * sizeof(int16_t));
+        s_refCount[frame->index] += count;
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+int16_t *AUDIO_FRAME_POOL_GetRef(const audio_frame_t *frame)
+{
+    int16_t *ref = NULL;
+
+    if ((frame != NULL) && (s_refSamples != NULL) && (s_refCount[frame->index] == AUDIO_FRAME_SAMPLE_COUNT))
+    {
+        ref = s_refSamples[frame->index];
+    }
+
+    return ref;
+}
+#endif /* SELF_WAKE_UP_PROTECTION */
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _AUDIO_FRAME_POOL_H_
+#define _AUDIO_FRAME_POOL_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#include "sln_mic_config.h"
+#if SLN_TRACE_LATENCY
+#include "audio_latency.h"
+#endif /* SLN_TRACE_LATENCY */
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Duration in ms of one frame handed from AFE to ASR. Must be a multiple of the 10ms AFE block.
+ * VIT accepts 10ms or 30ms frames, S2I only 30ms frames. */
+#ifndef ASR_FRAME_MS
+#define ASR_FRAME_MS 30
+#endif /* ASR_FRAME_MS */
+
+#define AFE_BLOCK_MS (AFE_BLOCK_SMPL_COUNT / PCM_SAMPLES_PER_MS)
+
+#if ((ASR_FRAME_MS % AFE_BLOCK_MS) != 0) || (ASR_FRAME_MS == 0)
+#error "ASR_FRAME_MS must be a multiple of 10ms"
+#endif /* ASR_FRAME_MS */
+
+/* Sending AFE processed chunks to ASR once at ASR_FRAME_MS */
+#define AFE_BLOCKS_TO_ACCUMULATE (ASR_FRAME_MS / AFE_BLOCK_MS)
+
+/* Number of samples in one frame handed from AFE to ASR */
+#define AUDIO_FRAME_SAMPLE_COUNT (AFE_BLOCK_SMPL_COUNT * AFE_BLOCKS_TO_ACCUMULATE)
+
+/* Max audio to be buffered between AFE and ASR, in ms */
+#if VAD_BUFFER_DATA
+#define ASR_QUEUE_MS 450
+#else
+#define ASR_QUEUE_MS 150
+#endif /* VAD_BUFFER_DATA */
+
+/* Max number of ASR slots to be buffered.
+ * One slot is ASR_FRAME_MS large. */
+#define ASR_QUEUE_SLOTS (ASR_QUEUE_MS / ASR_FRAME_MS)
+
+/* Frames in the pool: every queue slot, plus the frame being filled by AFE
+ * and the frame being processed by ASR. */
+#define AUDIO_FRAME_POOL_COUNT (ASR_QUEUE_SLOTS + 2)
+
+#if SELF_WAKE_UP_PROTECTION
+/* Bytes of the buffer given to AUDIO_FRAME_POOL_AttachRef, one reference per frame */
+#define AUDIO_FRAME_POOL_REF_SIZE (AUDIO_FRAME_POOL_COUNT * AUDIO_FRAME_SAMPLE_COUNT * sizeof(int16_t))
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+/*!
+ * @brief Reference counted frame exchanged between AFE and ASR.
+ *        Only the frame pointer travels through g_xSampleQueue.
+ */
+typedef struct _audio_frame
+{
+    int16_t samples[AUDIO_FRAME_SAMPLE_COUNT]; /*!< Clean 16KHz mono audio */
+    volatile uint8_t refCount;                 /*!< Number of owners, frame returns to the pool at 0 */
+    uint8_t index;                             /*!< Position of the frame inside the pool */
+#if SLN_TRACE_LATENCY
+    audio_latency_tag_t latency;               /*!< Time stamps of the frame along the pipeline */
+#endif /* SLN_TRACE_LATENCY */
+} audio_frame_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Put all the frames back in the free list. Must be called before the
+ *        AFE to ASR queue is created.
+ */
+void AUDIO_FRAME_POOL_Init(void);
+
+/*!
+ * @brief Take a free frame from the pool. The caller owns one reference.
+ *
+ * @returns Pointer to the frame or NULL if the pool is exhausted
+ */
+audio_frame_t *AUDIO_FRAME_POOL_Acquire(void);
+
+/*!
+ * @brief Add one more owner to a frame.
+ *
+ * @param frame Pointer to an acquired frame
+ */
+void AUDIO_FRAME_POOL_Retain(audio_frame_t *frame);
+
+/*!
+ * @brief Drop one owner of a frame. The frame goes back to the pool when
+ *        the last owner releases it. NULL is ignored.
+ *
+ * @param frame Pointer to an acquired frame
+ */
+void AUDIO_FRAME_POOL_Release(audio_frame_t *frame);
+
+/*!
+ * @brief Get the number of frames currently available in the pool.
+ */
+uint32_t AUDIO_FRAME_POOL_GetFreeCount(void);
+
+/*!
+ * @brief Get the number of failed acquire attempts since power on.
+ */
+uint32_t AUDIO_FRAME_POOL_GetExhaustedCount(void);
+
+#if SELF_WAKE_UP_PROTECTION
+/*!
+ * @brief Give the pool a buffer where each frame keeps the playback reference of its samples.
+ *        The references are only written while a buffer is attached.
+ *
+ * @param buffer AUDIO_FRAME_POOL_REF_SIZE bytes buffer, or NULL to detach the current one.
+ *               Once detached, the buffer is no longer accessed and can be freed.
+ */
+void AUDIO_FRAME_POOL_AttachRef(int16_t *buffer);
+
+/*!
+ * @brief Write the reference of a part of a frame. Nothing is written if no buffer is attached.
+ *        The parts must be written in order, starting at offset 0.
+ *
+ * @param frame   Frame being filled
+ * @param offset  Index of the first sample of the part in the frame
+ * @param samples Reference samples
+ * @param count   Number of samples
+ */
+void AUDIO_FRAME_POOL_WriteRef(audio_frame_t *frame, uint32_t offset, const int16_t *samples, uint32_t count);
+
+/*!
+ * @brief Get the reference of a frame. Must be called from the task attaching the buffer.
+ *
+ * @param frame Frame owned by the caller
+ * @returns The AUDIO_FRAME_SAMPLE_COUNT reference samples, or NULL if the frame has no complete reference
+ */
+int16_t *AUDIO_FRAME_POOL_GetRef(const audio_frame_t *frame);
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _AUDIO_FRAME_POOL_H_ */
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if SLN_TRACE_LATENCY
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "audio_latency.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static audio_latency_stats_t s_stats;
+
+/* Detection notified by ASR and not yet handled by appTask */
+static audio_latency_tag_t s_pendingTag;
+static uint32_t s_pendingDetectionTs = 0;
+static uint8_t s_pendingKind         = 0;
+static bool s_pending                = false;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _cycles_to_us(uint32_t cycles)
+{
+    /* SystemCoreClock follows the VAD clock reduction */
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+}
+
+static void _hist_add(audio_latency_hist_t *hist, uint32_t us)
+{
+    uint32_t bin = 0;
+
+    if (us > 1U)
+    {
+        bin = 31U - __CLZ(us);
+    }
+    if (bin >= AUDIO_LATENCY_BIN_COUNT)
+    {
+        bin = AUDIO_LATENCY_BIN_COUNT - 1U;
+    }
+
+    if ((hist->count == 0) || (us < hist->minUs))
+    {
+        hist->minUs = us;
+    }
+    if (us > hist->maxUs)
+    {
+        hist->maxUs = us;
+    }
+
+    hist->count++;
+    hist->sumUs += us;
+    hist->bins[bin]++;
+}
+
+void AUDIO_LATENCY_Init(void)
+{
+    AUDIO_LATENCY_Reset();
+}
+
+void AUDIO_LATENCY_Reset(void)
+{
+    taskENTER_CRITICAL();
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.magic      = AUDIO_LATENCY_EXPORT_MAGIC;
+    s_stats.version    = AUDIO_LATENCY_EXPORT_VERSION;
+    s_stats.stageCount = kAudioLatencyStageCount;
+    s_stats.binCount   = AUDIO_LATENCY_BIN_COUNT;
+    s_pending          = false;
+
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_LATENCY_DetectionNotified(const audio_latency_tag_t *tag, audio_latency_detection_t kind)
+{
+    uint32_t now = AUDIO_LATENCY_GET_TIMESTAMP();
+
+    taskENTER_CRITICAL();
+
+    /* A detection which was not handled yet is overwritten, appTask only acts on the last one */
+    s_pendingTag         = *tag;
+    s_pendingDetectionTs = now;
+    s_pendingKind        = (uint8_t)kind;
+    s_pending            = true;
+
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_LATENCY_DetectionHandled(audio_latency_detection_t kind)
+{
+    uint32_t now = AUDIO_LATENCY_GET_TIMESTAMP();
+    uint32_t stageUs[kAudioLatencyStageCount];
+    audio_latency_tag_t tag;
+    uint32_t detectionTs = 0;
+    bool pending         = false;
+
+    taskENTER_CRITICAL();
+    if (s_pending && (s_pendingKind == (uint8_t)kind))
+    {
+        tag         = s_pendingTag;
+        detectionTs = s_pendingDetectionTs;
+        pending     = true;
+        s_pending   = false;
+    }
+    taskEXIT_CRITICAL();
+
+    if (pending)
+    {
+        /* Unsigned differences are correct across a single counter wrap */
+        stageUs[kAudioLatencyCaptureToAfe]      = _cycles_to_us(tag.queueTs - tag.captureTs);
+        stageUs[kAudioLatencyAfeToAsr]          = _cycles_to_us(tag.dequeueTs - tag.queueTs);
+        stageUs[kAudioLatencyAsrProcess]        = _cycles_to_us(detectionTs - tag.dequeueTs);
+        stageUs[kAudioLatencyDetectionToAction] = _cycles_to_us(now - detectionTs);
+        stageUs[kAudioLatencyCaptureToAction]   = _cycles_to_us(now - tag.captureTs);
+    }
+
+    taskENTER_CRITICAL();
+    if (pending)
+    {
+        for (uint32_t stage = 0; stage < kAudioLatencyStageCount; stage++)
+        {
+            _hist_add(&s_stats.hist[stage], stageUs[stage]);
+            s_stats.lastUs[stage] = stageUs[stage];
+        }
+
+        s_stats.detections[kind]++;
+        s_stats.lastKind = (uint8_t)kind;
+    }
+    else
+    {
+        /* Push to talk, or a detection notified before the statistics were reset */
+        s_stats.missed++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_LATENCY_GetStats(audio_latency_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        taskENTER_CRITICAL();
+        memcpy(stats, &s_stats, sizeof(s_stats));
+        taskEXIT_CRITICAL();
+    }
+}
+
+#endif /* SLN_TRACE_LATENCY */
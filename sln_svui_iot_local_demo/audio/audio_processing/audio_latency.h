@@ -0,0 +1,141 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _AUDIO_LATENCY_H_
+#define _AUDIO_LATENCY_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#include "audio_profiler.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Magic and version at the start of the exported statistics ("SLAT") */
+#define AUDIO_LATENCY_EXPORT_MAGIC   0x54414C53U
+#define AUDIO_LATENCY_EXPORT_VERSION 1U
+
+/* Histogram bins are powers of two in us: bin 0 counts latencies below 2us,
+ * bin N counts latencies in [2^N, 2^(N+1)) us, the last bin also counts everything above. */
+#define AUDIO_LATENCY_BIN_COUNT 24U
+
+/*!
+ * @brief Time stamp used to tag the audio along the pipeline. DWT cycle counter, it wraps after ~7s at 600MHz.
+ */
+#define AUDIO_LATENCY_GET_TIMESTAMP() AUDIO_PROFILER_GET_CYCLES()
+
+/*!
+ * @brief Stages of the path between the microphones and the application action.
+ */
+typedef enum _audio_latency_stage
+{
+    kAudioLatencyCaptureToAfe = 0, /*!< End of the DMA capture until SLN_AFE output of the last block of the frame */
+    kAudioLatencyAfeToAsr,         /*!< Frame queued by AFE until it was dequeued by ASR */
+    kAudioLatencyAsrProcess,       /*!< ASR processing of the frame which triggered the detection */
+    kAudioLatencyDetectionToAction,/*!< Detection notified until appTask handled it */
+    kAudioLatencyCaptureToAction,  /*!< End to end: capture until appTask handled the detection */
+    kAudioLatencyStageCount
+} audio_latency_stage_t;
+
+/*!
+ * @brief Kind of detection measured.
+ */
+typedef enum _audio_latency_detection
+{
+    kAudioLatencyWakeWord = 0,
+    kAudioLatencyCommand,
+    kAudioLatencyDetectionCount
+} audio_latency_detection_t;
+
+/*!
+ * @brief Time stamps carried by one frame from the microphones to ASR.
+ */
+typedef struct _audio_latency_tag
+{
+    uint32_t captureTs; /*!< DMA completion of the newest capture period in the frame */
+    uint32_t queueTs;   /*!< Frame queued by AFE for ASR */
+    uint32_t dequeueTs; /*!< Frame dequeued by ASR */
+} audio_latency_tag_t;
+
+/*!
+ * @brief Latency distribution of one stage.
+ */
+typedef struct __attribute__((packed)) _audio_latency_hist
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t sumUs;
+    uint32_t bins[AUDIO_LATENCY_BIN_COUNT];
+} audio_latency_hist_t;
+
+/*!
+ * @brief Statistics exported by AUDIO_LATENCY_GetStats. The layout is packed little-endian
+ *        so the structure can be dumped as is and decoded on the host.
+ */
+typedef struct __attribute__((packed)) _audio_latency_stats
+{
+    uint32_t magic;                                        /*!< AUDIO_LATENCY_EXPORT_MAGIC */
+    uint16_t version;                                      /*!< AUDIO_LATENCY_EXPORT_VERSION */
+    uint8_t stageCount;                                    /*!< kAudioLatencyStageCount */
+    uint8_t binCount;                                      /*!< AUDIO_LATENCY_BIN_COUNT */
+    uint32_t detections[kAudioLatencyDetectionCount];      /*!< Detections measured, per kind */
+    uint32_t missed;                                       /*!< Detections handled without a pending measurement */
+    uint8_t lastKind;                                      /*!< audio_latency_detection_t of the last detection */
+    uint8_t reserved[3];
+    uint32_t lastUs[kAudioLatencyStageCount];              /*!< Breakdown of the last detection */
+    audio_latency_hist_t hist[kAudioLatencyStageCount];    /*!< Distribution over all the detections */
+} audio_latency_stats_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Clear the statistics. The DWT cycle counter is started by AUDIO_PROFILER_Init.
+ */
+void AUDIO_LATENCY_Init(void);
+
+/*!
+ * @brief Clear the statistics.
+ */
+void AUDIO_LATENCY_Reset(void);
+
+/*!
+ * @brief Store the time stamps of the frame which triggered a detection.
+ *        Called by ASR right before notifying appTask.
+ *
+ * @param tag  Time stamps of the frame
+ * @param kind Wake word or voice command
+ */
+void AUDIO_LATENCY_DetectionNotified(const audio_latency_tag_t *tag, audio_latency_detection_t kind);
+
+/*!
+ * @brief Close the measurement of the last detection and add it to the histograms.
+ *        Called by appTask once the detection was handled.
+ *
+ * @param kind Wake word or voice command
+ */
+void AUDIO_LATENCY_DetectionHandled(audio_latency_detection_t kind);
+
+/*!
+ * @brief Get a copy of the statistics.
+ *
+ * @param stats Pointer where the statistics will be copied
+ */
+void AUDIO_LATENCY_GetStats(audio_latency_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _AUDIO_LATENCY_H_ */
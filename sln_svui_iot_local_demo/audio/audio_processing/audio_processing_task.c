@@ -17,6 +17,12 @@
 #include "sln_mic_config.h"
 #include "sln_afe.h"
 #include "sln_amplifier.h"
+#include "audio_frame_pool.h"
+#include "audio_profiler.h"
+#include "audio_deadline.h"
+#if ENABLE_AEC_CALIBRATION
+#include "audio_aec_calib.h"
+#endif /* ENABLE_AEC_CALIBRATION */
 #include "sln_rgb_led_driver.h"
 #include "local_sounds_task.h"
 
@@ -32,9 +38,6 @@
  * Definitions
  ******************************************************************************/
 
-/* Sending AFE processed chunks to ASR once at 3 * 10ms */
-#define AFE_BLOCKS_TO_ACCUMULATE (3)
-
 #if SLN_MIC_COUNT == 2
 #define AFE_MEM_SIZE AFE_MEM_SIZE_2MICS
 #elif SLN_MIC_COUNT == 3
@@ -43,6 +46,20 @@
 #error "UNSUPPORTED NUMBER OF MICROPHONES"
 #endif /* SLN_MIC_COUNT */
 
+/* Capture periods other than 10ms are re-cut into SLN_AFE blocks */
+#define AFE_BLOCK_STAGING (PCM_SINGLE_CH_SMPL_COUNT != AFE_BLOCK_SMPL_COUNT)
+
+#if ENABLE_AEC
+/* Mean square of the reference samples, in int16 units squared, above which the speaker is
+ * considered active (about -50 dBFS), and below which it is considered silent (about -56 dBFS). */
+#define AEC_REF_ACTIVE_ENERGY 10737U
+#define AEC_REF_SILENT_ENERGY 2693U
+
+/* AEC keeps running for AEC_REF_TAIL_BLOCKS silent 10ms blocks after the speaker stopped,
+ * so the echo tail of the room is still cancelled and the adaptation is not cut short. */
+#define AEC_REF_TAIL_BLOCKS 20U
+#endif /* ENABLE_AEC */
+
 #if ENABLE_VAD
 /* After Voice Activity detected, assume Voice Activity for next VAD_FORCED_TRUE_CALLS */
 /* The value below is for VAD_LOW_POWER_AFTER_SEC * 100, because we have 100 calls per second (10ms frames)  */
@@ -52,36 +69,49 @@
 #define VAD_ACTIVITY_FRAMES    5
 #endif /* ENABLE_VAD */
 
-/* Max number of ASR slots to be buffered.
- * One slot is 30ms large. */
-#if VAD_BUFFER_DATA
-#define ASR_QUEUE_SLOTS 15
-#else
-#define ASR_QUEUE_SLOTS 5
-#endif /* VAD_BUFFER_DATA */
-
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 
 SDK_ALIGN(static uint8_t __attribute__((section(".bss.$SRAM_DTC"))) s_afeExternalMemory[AFE_MEM_SIZE], 8);
-SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
-          s_outStream[PCM_SINGLE_CH_SMPL_COUNT * AFE_BLOCKS_TO_ACCUMULATE],
-          8);
 #if VAD_BUFFER_DATA
-SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
-          s_dummyQueueSlot[PCM_SINGLE_CH_SMPL_COUNT * AFE_BLOCKS_TO_ACCUMULATE],
-          8);
-
 static uint8_t s_forceVadEvent = 0;
 #endif /* VAD_BUFFER_DATA */
 
-static uint8_t s_outBlocksCnt = 0;
+/* Frame currently being filled with AFE output. Ownership moves to ASR once queued. */
+static audio_frame_t *s_outFrame = NULL;
+static uint8_t s_outBlocksCnt    = 0;
+
+/* Frames lost because the AFE to ASR queue was full */
+static volatile uint32_t s_asrFramesDropped = 0;
+
+/* Carries audio_frame_t pointers from AFE to ASR */
 QueueHandle_t g_xSampleQueue  = NULL;
 
-static pcmPingPong_t *s_micInputStream = NULL;
+static pcmRingBuffer_t *s_micInputStream = NULL;
+#if SLN_MIC_FLOAT_STREAM
+static pcmRingBufferFloat_t *s_micFloatInputStream = NULL;
+#endif /* SLN_MIC_FLOAT_STREAM */
 static int16_t *s_ampInputStream       = NULL;
 
+/* Ring telling which slot of the mic and amp streams holds the next period to process */
+static sln_mic_ring_t *s_micRing = NULL;
+
+#if SLN_TRACE_LATENCY
+/* Capture time stamp of the period being processed */
+static uint32_t s_captureTimestamp = 0;
+#endif /* SLN_TRACE_LATENCY */
+
+#if AFE_BLOCK_STAGING
+/* SLN_AFE block being assembled from capture periods */
+SDK_ALIGN(static int16_t s_afeMicBlock[AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT], 8);
+#if SLN_MIC_FLOAT_STREAM
+SDK_ALIGN(static float s_afeMicFloatBlock[AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT], 8);
+#endif /* SLN_MIC_FLOAT_STREAM */
+static int16_t s_afeAmpBlock[AFE_BLOCK_SMPL_COUNT];
+static uint32_t s_afeBlockFill = 0;
+#endif /* AFE_BLOCK_STAGING */
+
 volatile uint32_t g_wakeWordLength  = 0;
 volatile long unsigned int g_processedFrames = 0;
 
@@ -91,6 +121,21 @@ static TaskHandle_t s_localVoiceTaskHandle   = NULL;
 
 #if ENABLE_AEC
 static bool s_bypassAec = false;
+
+#if AEC_AUTO_BYPASS
+static bool s_autoBypassAec = true;
+#else
+static bool s_autoBypassAec = false;
+#endif /* AEC_AUTO_BYPASS */
+
+/* Reference energy gate state and counters of the 10ms blocks processed with / without AEC */
+static bool s_aecRefActive         = false;
+static uint32_t s_aecRefSilentCnt  = 0;
+static uint32_t s_aecRunBlocks     = 0;
+static uint32_t s_aecGatedBlocks   = 0;
+
+/* Set by the deadline monitor while the audio processing keeps overrunning its budget */
+static volatile bool s_shedAec = false;
 #endif /* ENABLE_AEC */
 
 /*******************************************************************************
@@ -98,11 +143,22 @@ static bool s_bypassAec = false;
  ******************************************************************************/
 
 static sln_afe_status_t _sln_afe_init(void);
-static sln_afe_status_t _sln_afe_process_audio(int16_t *micStream, int16_t *ampStream, void **cleanStream);
+static sln_afe_status_t _sln_afe_process_audio(void *micStream, int16_t *ampStream, void **cleanStream);
 static sln_afe_status_t _sln_afe_trigger_found(void);
+static void _queue_frame_for_asr(audio_frame_t *frame);
+static void _process_afe_block(int16_t *micStream, void *afeMicStream, int16_t *ampStream);
+#if AFE_BLOCK_STAGING
+static void _stage_afe_blocks(int16_t *micStream, void *afeMicStream, int16_t *ampStream);
+#endif /* AFE_BLOCK_STAGING */
 #if ENABLE_VAD
 static sln_afe_status_t _sln_afe_vad(int16_t *micStream, bool *voiceActivity);
 #endif /* ENABLE_VAD */
+#if ENABLE_AEC
+static void _afe_shed_load(bool shed);
+#endif /* ENABLE_AEC */
+#if ENABLE_AMPLIFIER && ENABLE_AEC
+static bool _aec_ref_gate(const int16_t *ampStream);
+#endif /* ENABLE_AMPLIFIER && ENABLE_AEC */
 
 /*******************************************************************************
  * Code
@@ -110,14 +166,26 @@ static sln_afe_status_t _sln_afe_vad(int16_t *micStream, bool *voiceActivity);
 
 void audio_processing_set_mic_input_buffer(int16_t *buf)
 {
-    s_micInputStream = (pcmPingPong_t *)buf;
+    s_micInputStream = (pcmRingBuffer_t *)buf;
 }
 
+#if SLN_MIC_FLOAT_STREAM
+void audio_processing_set_mic_float_input_buffer(float *buf)
+{
+    s_micFloatInputStream = (pcmRingBufferFloat_t *)buf;
+}
+#endif /* SLN_MIC_FLOAT_STREAM */
+
 void audio_processing_set_amp_input_buffer(int16_t *buf)
 {
     s_ampInputStream = buf;
 }
 
+void audio_processing_set_mic_ring(sln_mic_ring_t *ring)
+{
+    s_micRing = ring;
+}
+
 #if ENABLE_VAD
 void audio_processing_set_local_voice_task_handle(TaskHandle_t handle)
 {
@@ -140,31 +208,42 @@ bool audio_processing_get_bypass_aec(void)
 {
     return s_bypassAec;
 }
+
+void audio_processing_set_auto_bypass_aec(bool value)
+{
+    s_autoBypassAec = value;
+}
+
+bool audio_processing_get_auto_bypass_aec(void)
+{
+    return s_autoBypassAec;
+}
+
+void audio_processing_get_aec_block_counts(uint32_t *runBlocks, uint32_t *gatedBlocks)
+{
+    *runBlocks   = s_aecRunBlocks;
+    *gatedBlocks = s_aecGatedBlocks;
+}
 #endif /* ENABLE_AEC */
 
+uint32_t audio_processing_get_dropped_frames(void)
+{
+    /* A failed pool acquire drops one AFE block */
+    return s_asrFramesDropped + (AUDIO_FRAME_POOL_GetExhaustedCount() / AFE_BLOCKS_TO_ACCUMULATE);
+}
+
 void audio_processing_task(void *pvParameters)
 {
-    uint8_t pingPongIdx           = 0;
-    uint8_t pingPongAmpIdx        = 0;
+    uint32_t slotIdx              = 0;
+    uint32_t periodSeq            = 0;
+    uint32_t expectedSeq          = 0;
     uint32_t taskNotification     = 0;
-    uint32_t currentEvent         = 0;
 
     int16_t *micStream            = NULL;
+    void *afeMicStream            = NULL;
     int16_t *ampStream            = NULL;
-    void *cleanStream             = NULL;
 
     sln_afe_status_t afeStatus    = kAfeSuccess;
-    bool voiceActivity            = false;
-    bool sendPackageToAsr         = true;
-
-#if ENABLE_VAD
-    bool prevVoiceActivity        = false;
-
-    uint32_t vadStartTicks        = 0;
-    uint32_t vadEndTicks          = 0;
-    float totalVadSessionsSec  = 0;
-    float vadSessionSec        = 0;
-#endif /* ENABLE_VAD */
 
     /* SLN_AFE Initialization. */
     afeStatus = _sln_afe_init();
@@ -175,7 +254,14 @@ void audio_processing_task(void *pvParameters)
         vTaskDelete(NULL);
     }
 
-    g_xSampleQueue = xQueueCreate(ASR_QUEUE_SLOTS, PCM_SINGLE_CH_SMPL_COUNT * AFE_BLOCKS_TO_ACCUMULATE * sizeof(short));
+    AUDIO_FRAME_POOL_Init();
+
+#if ENABLE_AEC
+    /* AEC is the largest SLN_AFE cost, drop it first when the audio processing overruns */
+    AUDIO_DEADLINE_SetShedCallback(kAudioDeadlineAfe, _afe_shed_load);
+#endif /* ENABLE_AEC */
+
+    g_xSampleQueue = xQueueCreate(ASR_QUEUE_SLOTS, sizeof(audio_frame_t *));
     if (g_xSampleQueue == NULL)
     {
         configPRINTF(("Could not create queue for AFE to ASR communication. Audio processing task failed!\r\n"));
@@ -185,25 +271,25 @@ void audio_processing_task(void *pvParameters)
 
     while (1)
     {
-        /* Suspend waiting to be activated when receiving PDM mic data after Decimation. */
-        xTaskNotifyWait(0U, 0xffffffffU, &taskNotification, portMAX_DELAY);
-
-        /* Figure out if it's a PING or PONG buffer received */
-        if (taskNotification & PCM_PING_EVENT)
+        /* Process the oldest captured period, suspend waiting for the mic task if the ring is empty. */
+        if (!SLN_MIC_RING_GetReadSlot(s_micRing, &slotIdx, &periodSeq))
         {
-            pingPongIdx    = 0U;
-            pingPongAmpIdx = 0U;
-            currentEvent   = PCM_PING_EVENT;
+            xTaskNotifyWait(0U, 0xffffffffU, &taskNotification, portMAX_DELAY);
+            continue;
         }
 
-        if (taskNotification & PCM_PONG_EVENT)
+        /* Periods dropped by the mic task leave a gap in the sequence numbers.
+         * The sequence restarts from 0 when the mics are turned back on. */
+        if ((int32_t)(periodSeq - expectedSeq) > 0)
         {
-            pingPongIdx    = 1U;
-            pingPongAmpIdx = 1U;
-            currentEvent   = PCM_PONG_EVENT;
+            configPRINTF(("[AFE] %d mic periods dropped, overruns since mics on: %d\r\n",
+                          (int)(periodSeq - expectedSeq), (int)s_micRing->overruns));
         }
+        expectedSeq = periodSeq + 1;
 
-        taskNotification &= ~currentEvent;
+#if SLN_TRACE_LATENCY
+        s_captureTimestamp = SLN_MIC_RING_GetSlotTimestamp(s_micRing, slotIdx);
+#endif /* SLN_TRACE_LATENCY */
 
         /* Check if a wake word was detected and if it was, notify SLN_AFE about it */
         afeStatus = _sln_afe_trigger_found();
@@ -217,129 +303,35 @@ void audio_processing_task(void *pvParameters)
         /* If AEC is disabled, temporarily bypass audio processing while streaming audio. */
         if (LOCAL_SOUNDS_isPlaying())
         {
+            SLN_MIC_RING_CommitRead(s_micRing);
             continue;
         }
 #endif /* ENABLE_STREAMER && !ENABLE_AEC */
 
-        micStream = (*s_micInputStream)[pingPongIdx];
+        micStream = (*s_micInputStream)[slotIdx];
+#if SLN_MIC_FLOAT_STREAM
+        afeMicStream = (*s_micFloatInputStream)[slotIdx];
+#else
+        afeMicStream = micStream;
+#endif /* SLN_MIC_FLOAT_STREAM */
         if (s_ampInputStream != NULL)
         {
-            ampStream = &s_ampInputStream[pingPongAmpIdx * PCM_SINGLE_CH_SMPL_COUNT];
+            ampStream = &s_ampInputStream[slotIdx * PCM_SINGLE_CH_SMPL_COUNT];
         }
         else
         {
             ampStream = NULL;
         }
 
-        /* Use SLN_AFE on microphones and speaker data to obtain a clean stream. */
-        afeStatus = _sln_afe_process_audio(micStream, ampStream, &cleanStream);
-        if (afeStatus != kAfeSuccess)
-        {
-            configPRINTF(("ERROR [%d]: AFE audio process failed!\r\n", afeStatus));
-            RGB_LED_SetColor(LED_COLOR_RED);
-        }
-        else
-        {
-            g_processedFrames++;
-        }
-
-#if ENABLE_USB_AUDIO_DUMP
-        AUDIO_DUMP_ForwardDataOverUsb(micStream, ampStream, cleanStream);
-#endif /* ENABLE_USB_AUDIO_DUMP */
-#if ENABLE_WIFI_AUDIO_DUMP
-        AUDIO_DUMP_ForwardDataOverWiFi(micStream, ampStream, cleanStream);
-#endif /* ENABLE_WIFI_AUDIO_DUMP */
-
-#if ENABLE_VAD
-        /* Use SLN_AFE on mic stream to detect Voice Activity and Gate ASR if needed. */
-        afeStatus = _sln_afe_vad(cleanStream, &voiceActivity);
-        if (afeStatus != kAfeSuccess)
-        {
-            configPRINTF(("ERROR [%d]: AFE audio VAD failed!\r\n", afeStatus));
-            RGB_LED_SetColor(LED_COLOR_RED);
-            voiceActivity = true;
-        }
-
-        /* Do not activate VAD mechanism during playback */
-        if (prevVoiceActivity != voiceActivity)
-        {
-            if (voiceActivity == true)
-            {
-                vadEndTicks         = xTaskGetTickCount();
-                vadSessionSec       = (float)(vadEndTicks - vadStartTicks) / configTICK_RATE_HZ;
-                totalVadSessionsSec += vadSessionSec;
-                configPRINTF(("VAD: detection enabled after %d sec, total bypassing since power on: %d sec\r\n",
-                              (int)vadSessionSec, (int)totalVadSessionsSec));
-
-                /* Revert MCU frequency back to its default value when voice activity is detected
-                 * so we can resume ASR processing */
-                BOARD_RevertClock();
-
-                /* Wake up the ASR task */
-                if (s_localVoiceTaskHandle)
-                {
-                    vTaskResume(s_localVoiceTaskHandle);
-                }
-            }
-            else
-            {
-                vadStartTicks = xTaskGetTickCount();
-                configPRINTF(("VAD: no activity in last %d sec, detection disabled\r\n",
-                              VAD_FORCED_TRUE_CALLS / 100));
-
-                /* Suspend the ASR task */
-                if (s_localVoiceTaskHandle)
-                {
-                    vTaskSuspend(s_localVoiceTaskHandle);
-                }
-
-                /* Run a lower MCU frequency when no voice activity is detected, because we can bypass
-                 * ASR and save power by putting the MCU at lower MHz */
-                BOARD_ReduceClock();
-            }
-
-            prevVoiceActivity = voiceActivity;
-        }
+#if AFE_BLOCK_STAGING
+        _stage_afe_blocks(micStream, afeMicStream, ampStream);
 #else
-        /* If VAD is disabled set voiceActivity flag to true */
-        voiceActivity = true;
-#endif /* ENABLE_VAD */
+        /* One capture period is exactly one SLN_AFE block */
+        _process_afe_block(micStream, afeMicStream, ampStream);
+#endif /* AFE_BLOCK_STAGING */
 
-#if ENABLE_VAD
-#if VAD_BUFFER_DATA
-        sendPackageToAsr = true;
-#else
-        sendPackageToAsr = voiceActivity;
-#endif /* VAD_BUFFER_DATA */
-#endif /* ENABLE_VAD */
-
-        if (sendPackageToAsr)
-        {
-            /* Prepare and send clean data to ASR module */
-            memcpy(&s_outStream[s_outBlocksCnt * PCM_SINGLE_CH_SMPL_COUNT], cleanStream, PCM_SINGLE_CH_SMPL_COUNT * 2);
-            s_outBlocksCnt++;
-            if (s_outBlocksCnt == AFE_BLOCKS_TO_ACCUMULATE)
-            {
-                if (xQueueSendToBack(g_xSampleQueue, s_outStream, 0) == errQUEUE_FULL)
-                {
-#if VAD_BUFFER_DATA
-                    /* If ASR queue is full, remove the head of it, then try again to add at the back */
-                    if (xQueueReceive(g_xSampleQueue, s_dummyQueueSlot, 0) != pdPASS)
-                    {
-                        configPRINTF(("Could not receive from the queue\r\n"));
-                    }
-
-                    if (xQueueSendToBack(g_xSampleQueue, s_outStream, 0) != pdPASS)
-                    {
-                        configPRINTF(("Could not send to the queue\r\n"));
-                    }
-#else
-                    RGB_LED_SetColor(LED_COLOR_PURPLE);
-#endif /* VAD_BUFFER_DATA */
-                }
-                s_outBlocksCnt = 0;
-            }
-        }
+        /* Give the slot back to the mic task */
+        SLN_MIC_RING_CommitRead(s_micRing);
     }
 }
 
@@ -375,7 +367,11 @@ static sln_afe_status_t _sln_afe_init(void)
     afeConfig.micsPosition[2][2] = 0;
 #endif /* SLN_MIC_COUNT == 3 */
 
+#if SLN_MIC_FLOAT_STREAM
+    afeConfig.dataInType  = kAfeTypeFloat;
+#else
     afeConfig.dataInType  = kAfeTypeInt16;
+#endif /* SLN_MIC_FLOAT_STREAM */
     afeConfig.dataOutType = kAfeTypeInt16;
 
 #if ENABLE_AEC
@@ -393,21 +389,29 @@ static sln_afe_status_t _sln_afe_init(void)
     return afeStatus;
 }
 
-static sln_afe_status_t _sln_afe_process_audio(int16_t *micStream, int16_t *ampStream, void **cleanStream)
+static sln_afe_status_t _sln_afe_process_audio(void *micStream, int16_t *ampStream, void **cleanStream)
 {
     sln_afe_status_t afeStatus = kAfeSuccess;
     int16_t *refSignal         = NULL;
 
 #if ENABLE_AMPLIFIER && ENABLE_AEC
-    if ((SLN_AMP_GetState() == kSlnAmpIdle) || s_bypassAec)
+    if ((SLN_AMP_GetState() == kSlnAmpIdle) || s_bypassAec || s_shedAec || (ampStream == NULL))
     {
         /* Bypass AEC if there is no streaming (by sending NULL as refSignal).
          * Bypassing AEC greatly reduces CPU usage of SLN_AFE_Process_Audio function. */
+        refSignal      = NULL;
+        s_aecRefActive = false;
+    }
+    else if (s_autoBypassAec && !_aec_ref_gate(ampStream))
+    {
+        /* The speaker is silent, there is no echo to cancel */
         refSignal = NULL;
+        s_aecGatedBlocks++;
     }
     else
     {
         refSignal = ampStream;
+        s_aecRunBlocks++;
     }
 #endif /* ENABLE_AMPLIFIER && ENABLE_AEC */
 
@@ -416,6 +420,305 @@ static sln_afe_status_t _sln_afe_process_audio(int16_t *micStream, int16_t *ampS
     return afeStatus;
 }
 
+/*!
+ * @brief Run SLN_AFE on one 10ms block, forward the result to the audio dump and VAD,
+ *        and accumulate the clean audio in the frame handed to ASR.
+ *
+ * @param micStream    Planar int16 mic block, AFE_BLOCK_SMPL_COUNT samples per mic
+ * @param afeMicStream Planar mic block in the SLN_AFE input format
+ * @param ampStream    Amplifier reference block or NULL
+ */
+static void _process_afe_block(int16_t *micStream, void *afeMicStream, int16_t *ampStream)
+{
+    sln_afe_status_t afeStatus    = kAfeSuccess;
+    void *cleanStream             = NULL;
+    bool voiceActivity            = false;
+    bool sendPackageToAsr         = true;
+    uint32_t profStart            = 0;
+    uint32_t blockStart           = AUDIO_PROFILER_GET_CYCLES();
+
+#if ENABLE_VAD
+    static bool prevVoiceActivity     = false;
+
+    static uint32_t vadStartTicks     = 0;
+    uint32_t vadEndTicks              = 0;
+    static float totalVadSessionsSec  = 0;
+    float vadSessionSec               = 0;
+#endif /* ENABLE_VAD */
+
+#if ENABLE_AEC_CALIBRATION
+    /* Returns right away unless the AEC calibration is capturing */
+    AUDIO_AEC_CALIB_FeedBlock(micStream, ampStream);
+#endif /* ENABLE_AEC_CALIBRATION */
+
+    /* Use SLN_AFE on microphones and speaker data to obtain a clean stream. */
+    profStart = AUDIO_PROFILER_GET_CYCLES();
+    afeStatus = _sln_afe_process_audio(afeMicStream, ampStream, &cleanStream);
+    AUDIO_PROFILER_STOP(kAudioProfilerAfe, profStart);
+    if (afeStatus != kAfeSuccess)
+    {
+        configPRINTF(("ERROR [%d]: AFE audio process failed!\r\n", afeStatus));
+        RGB_LED_SetColor(LED_COLOR_RED);
+    }
+    else
+    {
+        g_processedFrames++;
+    }
+
+#if ENABLE_USB_AUDIO_DUMP
+    AUDIO_DUMP_ForwardDataOverUsb(micStream, ampStream, cleanStream);
+#endif /* ENABLE_USB_AUDIO_DUMP */
+#if ENABLE_WIFI_AUDIO_DUMP
+    AUDIO_DUMP_ForwardDataOverWiFi(micStream, ampStream, cleanStream);
+#endif /* ENABLE_WIFI_AUDIO_DUMP */
+
+#if ENABLE_VAD
+    /* Use SLN_AFE on mic stream to detect Voice Activity and Gate ASR if needed. */
+    profStart = AUDIO_PROFILER_GET_CYCLES();
+    afeStatus = _sln_afe_vad(cleanStream, &voiceActivity);
+    AUDIO_PROFILER_STOP(kAudioProfilerVad, profStart);
+    if (afeStatus != kAfeSuccess)
+    {
+        configPRINTF(("ERROR [%d]: AFE audio VAD failed!\r\n", afeStatus));
+        RGB_LED_SetColor(LED_COLOR_RED);
+        voiceActivity = true;
+    }
+
+    /* Do not activate VAD mechanism during playback */
+    if (prevVoiceActivity != voiceActivity)
+    {
+        if (voiceActivity == true)
+        {
+            vadEndTicks         = xTaskGetTickCount();
+            vadSessionSec       = (float)(vadEndTicks - vadStartTicks) / configTICK_RATE_HZ;
+            totalVadSessionsSec += vadSessionSec;
+            configPRINTF(("VAD: detection enabled after %d sec, total bypassing since power on: %d sec\r\n",
+                          (int)vadSessionSec, (int)totalVadSessionsSec));
+
+            /* Revert MCU frequency back to its default value when voice activity is detected
+             * so we can resume ASR processing */
+            BOARD_RevertClock();
+
+            /* Wake up the ASR task */
+            if (s_localVoiceTaskHandle)
+            {
+                vTaskResume(s_localVoiceTaskHandle);
+            }
+        }
+        else
+        {
+            vadStartTicks = xTaskGetTickCount();
+            configPRINTF(("VAD: no activity in last %d sec, detection disabled\r\n",
+                          VAD_FORCED_TRUE_CALLS / 100));
+
+            /* Suspend the ASR task */
+            if (s_localVoiceTaskHandle)
+            {
+                vTaskSuspend(s_localVoiceTaskHandle);
+            }
+
+            /* Run a lower MCU frequency when no voice activity is detected, because we can bypass
+             * ASR and save power by putting the MCU at lower MHz */
+            BOARD_ReduceClock();
+        }
+
+        prevVoiceActivity = voiceActivity;
+    }
+#else
+    /* If VAD is disabled set voiceActivity flag to true */
+    voiceActivity = true;
+#endif /* ENABLE_VAD */
+
+#if ENABLE_VAD
+#if VAD_BUFFER_DATA
+    sendPackageToAsr = true;
+#else
+    sendPackageToAsr = voiceActivity;
+#endif /* VAD_BUFFER_DATA */
+#endif /* ENABLE_VAD */
+
+    if (sendPackageToAsr)
+    {
+        /* Prepare and send clean data to ASR module */
+        if (s_outFrame == NULL)
+        {
+            s_outFrame = AUDIO_FRAME_POOL_Acquire();
+        }
+
+        if (s_outFrame != NULL)
+        {
+            memcpy(&s_outFrame->samples[s_outBlocksCnt * AFE_BLOCK_SMPL_COUNT], cleanStream,
+                   AFE_BLOCK_SMPL_COUNT * 2);
+#if SELF_WAKE_UP_PROTECTION
+            /* What the speaker plays for the ASR self wake up engine: the amplifier reference,
+             * or the first mic before AFE when there is no reference without AEC */
+#if ENABLE_AEC
+            AUDIO_FRAME_POOL_WriteRef(s_outFrame, s_outBlocksCnt * AFE_BLOCK_SMPL_COUNT, ampStream,
+                                      AFE_BLOCK_SMPL_COUNT);
+#else
+            AUDIO_FRAME_POOL_WriteRef(s_outFrame, s_outBlocksCnt * AFE_BLOCK_SMPL_COUNT, micStream,
+                                      AFE_BLOCK_SMPL_COUNT);
+#endif /* ENABLE_AEC */
+#endif /* SELF_WAKE_UP_PROTECTION */
+#if SLN_TRACE_LATENCY
+            /* The frame is tagged with the capture time of its newest block */
+            s_outFrame->latency.captureTs = s_captureTimestamp;
+#endif /* SLN_TRACE_LATENCY */
+            s_outBlocksCnt++;
+            if (s_outBlocksCnt == AFE_BLOCKS_TO_ACCUMULATE)
+            {
+                profStart = AUDIO_PROFILER_GET_CYCLES();
+                _queue_frame_for_asr(s_outFrame);
+                AUDIO_PROFILER_STOP(kAudioProfilerQueue, profStart);
+                s_outFrame     = NULL;
+                s_outBlocksCnt = 0;
+            }
+        }
+        else
+        {
+            /* ASR is holding every frame, drop this block */
+            RGB_LED_SetColor(LED_COLOR_PURPLE);
+        }
+    }
+
+    AUDIO_DEADLINE_Check(kAudioDeadlineAfe, AUDIO_PROFILER_GET_CYCLES() - blockStart);
+}
+
+#if AFE_BLOCK_STAGING
+/*!
+ * @brief Re-cut one capture period into 10ms SLN_AFE blocks. Every completed block is processed.
+ *
+ * @param micStream    Planar int16 mic period, PCM_SINGLE_CH_SMPL_COUNT samples per mic
+ * @param afeMicStream Planar mic period in the SLN_AFE input format
+ * @param ampStream    Amplifier reference period or NULL
+ */
+static void _stage_afe_blocks(int16_t *micStream, void *afeMicStream, int16_t *ampStream)
+{
+    uint32_t offset = 0;
+    uint32_t count  = 0;
+
+    while (offset < PCM_SINGLE_CH_SMPL_COUNT)
+    {
+        count = MIN(AFE_BLOCK_SMPL_COUNT - s_afeBlockFill, PCM_SINGLE_CH_SMPL_COUNT - offset);
+
+        for (uint32_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+        {
+            memcpy(&s_afeMicBlock[micId * AFE_BLOCK_SMPL_COUNT + s_afeBlockFill],
+                   &micStream[micId * PCM_SINGLE_CH_SMPL_COUNT + offset], count * sizeof(int16_t));
+#if SLN_MIC_FLOAT_STREAM
+            memcpy(&s_afeMicFloatBlock[micId * AFE_BLOCK_SMPL_COUNT + s_afeBlockFill],
+                   &((float *)afeMicStream)[micId * PCM_SINGLE_CH_SMPL_COUNT + offset], count * sizeof(float));
+#endif /* SLN_MIC_FLOAT_STREAM */
+        }
+
+        if (ampStream != NULL)
+        {
+            memcpy(&s_afeAmpBlock[s_afeBlockFill], &ampStream[offset], count * sizeof(int16_t));
+        }
+
+        s_afeBlockFill += count;
+        offset += count;
+
+        if (s_afeBlockFill == AFE_BLOCK_SMPL_COUNT)
+        {
+            s_afeBlockFill = 0;
+
+#if SLN_MIC_FLOAT_STREAM
+            _process_afe_block(s_afeMicBlock, s_afeMicFloatBlock, (ampStream != NULL) ? s_afeAmpBlock : NULL);
+#else
+            _process_afe_block(s_afeMicBlock, s_afeMicBlock, (ampStream != NULL) ? s_afeAmpBlock : NULL);
+#endif /* SLN_MIC_FLOAT_STREAM */
+        }
+    }
+}
+#endif /* AFE_BLOCK_STAGING */
+
+static void _queue_frame_for_asr(audio_frame_t *frame)
+{
+    audio_frame_t *oldestFrame = NULL;
+
+#if SLN_TRACE_LATENCY
+    frame->latency.queueTs = AUDIO_LATENCY_GET_TIMESTAMP();
+#endif /* SLN_TRACE_LATENCY */
+
+    /* Only the frame pointer is queued, the ownership moves to ASR */
+    if (xQueueSendToBack(g_xSampleQueue, &frame, 0) == errQUEUE_FULL)
+    {
+#if VAD_BUFFER_DATA
+        /* If ASR queue is full, release the oldest frame, then try again to add at the back */
+        if (xQueueReceive(g_xSampleQueue, &oldestFrame, 0) != pdPASS)
+        {
+            configPRINTF(("Could not receive from the queue\r\n"));
+        }
+        AUDIO_FRAME_POOL_Release(oldestFrame);
+        s_asrFramesDropped++;
+
+        if (xQueueSendToBack(g_xSampleQueue, &frame, 0) != pdPASS)
+        {
+            configPRINTF(("Could not send to the queue\r\n"));
+            AUDIO_FRAME_POOL_Release(frame);
+        }
+#else
+        (void)oldestFrame;
+        AUDIO_FRAME_POOL_Release(frame);
+        s_asrFramesDropped++;
+        RGB_LED_SetColor(LED_COLOR_PURPLE);
+#endif /* VAD_BUFFER_DATA */
+    }
+}
+
+#if ENABLE_AMPLIFIER && ENABLE_AEC
+/*!
+ * @brief Energy gate on the speaker reference of one 10ms block, with hysteresis and a tail.
+ *
+ * @param ampStream Amplifier reference block, AFE_BLOCK_SMPL_COUNT samples
+ *
+ * @return true if AEC should run on this block
+ */
+static bool _aec_ref_gate(const int16_t *ampStream)
+{
+    uint64_t energy = 0;
+
+    for (uint32_t idx = 0; idx < AFE_BLOCK_SMPL_COUNT; idx++)
+    {
+        energy += (int32_t)ampStream[idx] * ampStream[idx];
+    }
+    energy /= AFE_BLOCK_SMPL_COUNT;
+
+    if (energy >= AEC_REF_ACTIVE_ENERGY)
+    {
+        s_aecRefActive    = true;
+        s_aecRefSilentCnt = 0;
+    }
+    else if (s_aecRefActive && (energy < AEC_REF_SILENT_ENERGY))
+    {
+        s_aecRefSilentCnt++;
+        if (s_aecRefSilentCnt >= AEC_REF_TAIL_BLOCKS)
+        {
+            s_aecRefActive = false;
+        }
+    }
+    else
+    {
+        /* Between the two thresholds, keep the current state */
+        s_aecRefSilentCnt = 0;
+    }
+
+    return s_aecRefActive;
+}
+#endif /* ENABLE_AMPLIFIER && ENABLE_AEC */
+
+#if ENABLE_AEC
+/*!
+ * @brief Deadline monitor load shedding: bypass AEC while the audio processing overruns its budget.
+ *        The aecmode setting is kept and applies again once the load is back to normal.
+ */
+static void _afe_shed_load(bool shed)
+{
+    s_shedAec = shed;
+}
+#endif /* ENABLE_AEC */
+
 static sln_afe_status_t _sln_afe_trigger_found()
 {
     sln_afe_status_t afeStatus          = kAfeSuccess;
@@ -426,12 +729,12 @@ static sln_afe_status_t _sln_afe_trigger_found()
     {
         UBaseType_t asrMessagesWaiting = uxQueueMessagesWaiting(g_xSampleQueue);
 
-        /* If ASR is behind AFE with more than 1 30ms frame, skip reporting
+        /* If ASR is behind AFE with more than 1 ASR frame, skip reporting
          * the trigger, as beamformer might be impacted */
         if (asrMessagesWaiting <= 1)
         {
-            wakeWordStartOffsetSamples = g_wakeWordLength + (s_outBlocksCnt * PCM_SINGLE_CH_SMPL_COUNT)
-                                         + asrMessagesWaiting * AFE_BLOCKS_TO_ACCUMULATE * PCM_SINGLE_CH_SMPL_COUNT;
+            wakeWordStartOffsetSamples = g_wakeWordLength + (s_outBlocksCnt * AFE_BLOCK_SMPL_COUNT)
+                                         + asrMessagesWaiting * AUDIO_FRAME_SAMPLE_COUNT;
 
             wakeWordStartOffsetMs      = wakeWordStartOffsetSamples / (PCM_SAMPLE_RATE_HZ / 1000);
 
@@ -440,7 +743,7 @@ static sln_afe_status_t _sln_afe_trigger_found()
                 afeStatus        = SLN_AFE_Trigger_Found(wakeWordStartOffsetSamples);
 
                 configPRINTF(("[AFE] Wake word trigger estimation: starting, length: %ld, %d\r\n",
-                       g_processedFrames * PCM_SINGLE_CH_SMPL_COUNT - wakeWordStartOffsetSamples,
+                       g_processedFrames * AFE_BLOCK_SMPL_COUNT - wakeWordStartOffsetSamples,
                        wakeWordStartOffsetSamples));
             }
             else
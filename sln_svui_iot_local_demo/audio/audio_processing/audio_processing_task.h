@@ -10,6 +10,8 @@
 #include "stdint.h"
 #include "stdbool.h"
 
+#include "sln_mic_config.h"
+
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
@@ -35,6 +37,15 @@ void audio_processing_task(void *pvParameters);
  */
 void audio_processing_set_mic_input_buffer(int16_t *buf);
 
+#if SLN_MIC_FLOAT_STREAM
+/*!
+ * @brief Set the float mic input buffer pointer, used as SLN_AFE input
+ *
+ * @param buf   Pointer to the float mic input buffer
+ */
+void audio_processing_set_mic_float_input_buffer(float *buf);
+#endif /* SLN_MIC_FLOAT_STREAM */
+
 /*!
  * @brief Set the amp input buffer pointer
  *
@@ -42,6 +53,13 @@ void audio_processing_set_mic_input_buffer(int16_t *buf);
  */
 void audio_processing_set_amp_input_buffer(int16_t *buf);
 
+/*!
+ * @brief Set the ring which tells which slot of the mic and amp input buffers must be processed next
+ *
+ * @param ring   Pointer to the ring published by the mic task
+ */
+void audio_processing_set_mic_ring(sln_mic_ring_t *ring);
+
 #if ENABLE_VAD
 /*!
  * @brief Set the local voice task handle
@@ -68,8 +86,33 @@ void audio_processing_set_bypass_aec(bool value);
  * @brief Get the bypass aec mode
  */
 bool audio_processing_get_bypass_aec(void);
+/*!
+ * @brief Set the automatic AEC bypass at runtime. When enabled, AEC is bypassed
+ *        while the speaker reference is silent.
+ *
+ * @param value   true or false
+ */
+void audio_processing_set_auto_bypass_aec(bool value);
+/*!
+ * @brief Get the automatic AEC bypass mode
+ */
+bool audio_processing_get_auto_bypass_aec(void);
+/*!
+ * @brief Get the number of 10ms blocks processed with AEC and the number of blocks
+ *        for which AEC was bypassed by the reference energy gate, since boot.
+ *
+ * @param runBlocks   Pointer where the blocks processed with AEC will be stored
+ * @param gatedBlocks Pointer where the blocks bypassed by the gate will be stored
+ */
+void audio_processing_get_aec_block_counts(uint32_t *runBlocks, uint32_t *gatedBlocks);
 #endif /* ENABLE_AEC */
 
+/*!
+ * @brief Get the number of frames ASR never received because it fell too far behind
+ *        (AFE to ASR queue full or frame pool exhausted), since boot.
+ */
+uint32_t audio_processing_get_dropped_frames(void);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "audio_profiler.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Unlock key of the DWT registers on Cortex-M7 */
+#define DWT_LAR_UNLOCK_KEY 0xC5ACCE55U
+
+typedef struct _audio_profiler_window
+{
+    uint32_t cycles[AUDIO_PROFILER_WINDOW]; /* Most recent runs, oldest overwritten first */
+    uint32_t runs;                          /* Runs recorded since the last reset */
+    uint32_t peak;                          /* Maximum since the last reset */
+} audio_profiler_window_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* Only touched by the CPU, so keep it in cacheable OCRAM. */
+static audio_profiler_window_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) s_windows[kAudioProfilerStageCount];
+
+/* Sorted copy of one window, used to get the percentile */
+static uint32_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) s_sorted[AUDIO_PROFILER_WINDOW];
+
+static const char *const s_stageNames[kAudioProfilerStageCount] = {
+    "PDM decimation", "HPF", "AMP loopback", "AMP TX", "AFE", "VAD", "ASR queue", "ASR process"};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void AUDIO_PROFILER_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR    = DWT_LAR_UNLOCK_KEY;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(s_windows, 0, sizeof(s_windows));
+}
+
+void AUDIO_PROFILER_Reset(void)
+{
+    taskENTER_CRITICAL();
+    memset(s_windows, 0, sizeof(s_windows));
+    taskEXIT_CRITICAL();
+}
+
+void AUDIO_PROFILER_Record(audio_profiler_stage_t stage, uint32_t cycles)
+{
+    audio_profiler_window_t *window = &s_windows[stage];
+
+    window->cycles[window->runs % AUDIO_PROFILER_WINDOW] = cycles;
+    window->runs++;
+
+    if (cycles > window->peak)
+    {
+        window->peak = cycles;
+    }
+}
+
+void AUDIO_PROFILER_GetStats(audio_profiler_stage_t stage, audio_profiler_stats_t *stats)
+{
+    audio_profiler_window_t *window = &s_windows[stage];
+    uint64_t sum                    = 0;
+    uint32_t value                  = 0;
+    uint32_t pos                    = 0;
+
+    memset(stats, 0, sizeof(audio_profiler_stats_t));
+
+    taskENTER_CRITICAL();
+    stats->runs    = window->runs;
+    stats->peak    = window->peak;
+    stats->samples = MIN(window->runs, AUDIO_PROFILER_WINDOW);
+    memcpy(s_sorted, window->cycles, stats->samples * sizeof(uint32_t));
+    taskEXIT_CRITICAL();
+
+    if (stats->samples == 0)
+    {
+        return;
+    }
+
+    /* Insertion sort, the window is small and this only runs on request */
+    for (uint32_t idx = 1; idx < stats->samples; idx++)
+    {
+        value = s_sorted[idx];
+        pos   = idx;
+        while ((pos > 0) && (s_sorted[pos - 1] > value))
+        {
+            s_sorted[pos] = s_sorted[pos - 1];
+            pos--;
+        }
+        s_sorted[pos] = value;
+    }
+
+    for (uint32_t idx = 0; idx < stats->samples; idx++)
+    {
+        sum += s_sorted[idx];
+    }
+
+    stats->min = s_sorted[0];
+    stats->max = s_sorted[stats->samples - 1];
+    stats->avg = (uint32_t)(sum / stats->samples);
+    /* Nearest rank: ceil(0.99 * samples) */
+    stats->p99 = s_sorted[((stats->samples * 99U) + 99U) / 100U - 1U];
+}
+
+const char *AUDIO_PROFILER_GetStageName(audio_profiler_stage_t stage)
+{
+    const char *name = "unknown";
+
+    if (stage < kAudioProfilerStageCount)
+    {
+        name = s_stageNames[stage];
+    }
+
+    return name;
+}
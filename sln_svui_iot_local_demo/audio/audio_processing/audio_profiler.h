@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _AUDIO_PROFILER_H_
+#define _AUDIO_PROFILER_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#include "fsl_common.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Number of most recent runs kept for each stage. The statistics are computed on this window. */
+#ifndef AUDIO_PROFILER_WINDOW
+#define AUDIO_PROFILER_WINDOW 128U
+#endif /* AUDIO_PROFILER_WINDOW */
+
+/*!
+ * @brief Read the DWT cycle counter. Started by AUDIO_PROFILER_Init.
+ */
+#define AUDIO_PROFILER_GET_CYCLES() (DWT->CYCCNT)
+
+/*!
+ * @brief Record the cycles elapsed since start, a value read with AUDIO_PROFILER_GET_CYCLES.
+ */
+#define AUDIO_PROFILER_STOP(stage, start) AUDIO_PROFILER_Record((stage), AUDIO_PROFILER_GET_CYCLES() - (start))
+
+/*!
+ * @brief Profiled stages of the audio pipeline.
+ */
+typedef enum _audio_profiler_stage
+{
+    kAudioProfilerPdmDecimation = 0, /*!< PDM to PCM conversion of one period, all mics */
+    kAudioProfilerHpf,               /*!< I2S mics format conversion and high pass filter of one period */
+    kAudioProfilerAmpLoopback,       /*!< Amplifier loopback read and downsampling of one period */
+    kAudioProfilerAmpTx,             /*!< Amplifier gain and low pass filter of one mixer slot, MQS only */
+    kAudioProfilerAfe,               /*!< SLN_AFE processing of one 10ms block */
+    kAudioProfilerVad,               /*!< SLN_AFE voice activity detection of one 10ms block */
+    kAudioProfilerQueue,             /*!< Hand off of one frame to the ASR queue */
+    kAudioProfilerAsr,               /*!< VIT_Process or SLN_ASR_LOCAL_Process on one frame */
+    kAudioProfilerStageCount
+} audio_profiler_stage_t;
+
+/*!
+ * @brief Statistics of one stage, in cycles.
+ */
+typedef struct _audio_profiler_stats
+{
+    uint32_t runs;    /*!< Runs recorded since the last reset */
+    uint32_t samples; /*!< Runs in the window, at most AUDIO_PROFILER_WINDOW */
+    uint32_t min;     /*!< Window minimum */
+    uint32_t avg;     /*!< Window average */
+    uint32_t p99;     /*!< Window 99th percentile */
+    uint32_t max;     /*!< Window maximum */
+    uint32_t peak;    /*!< Maximum since the last reset */
+} audio_profiler_stats_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Start the DWT cycle counter and clear the statistics. Must be called before the audio tasks start.
+ */
+void AUDIO_PROFILER_Init(void);
+
+/*!
+ * @brief Clear the statistics of all the stages.
+ */
+void AUDIO_PROFILER_Reset(void);
+
+/*!
+ * @brief Store the duration of one run of a stage. Only one task may record a given stage.
+ *
+ * @param stage  Profiled stage
+ * @param cycles Duration in cycles
+ */
+void AUDIO_PROFILER_Record(audio_profiler_stage_t stage, uint32_t cycles);
+
+/*!
+ * @brief Compute the statistics of a stage. Not reentrant, meant for the shell task.
+ *
+ * @param stage Profiled stage
+ * @param stats Pointer where the statistics will be stored
+ */
+void AUDIO_PROFILER_GetStats(audio_profiler_stage_t stage, audio_profiler_stats_t *stats);
+
+/*!
+ * @brief Get the printable name of a stage.
+ *
+ * @param stage Profiled stage
+ */
+const char *AUDIO_PROFILER_GetStageName(audio_profiler_stage_t stage);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _AUDIO_PROFILER_H_ */
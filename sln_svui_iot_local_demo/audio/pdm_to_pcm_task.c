@@ -20,15 +20,17 @@
 #include "pdm_to_pcm_task.h"
 #include "sln_amplifier_processing.h"
 #include "sln_pdm_mic.h"
+#include "audio_profiler.h"
 
 #if ENABLE_AEC
 #if USE_MQS
 #include "semphr.h"
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
 #if USE_NEW_PDM_PCM_LIB
+#include "arm_math.h"
 #include "PdmToPcm_LibHead.h"
 #else
 #include "sln_dsp_toolbox.h"
@@ -55,6 +57,16 @@
 #if USE_NEW_PDM_PCM_LIB
 #define MIC_SCALE_FACTOR            10
 #define PDM_TO_PCM_CONVERT_MEM_SIZE 2900
+
+/* Gain applied on the PDM to PCM library output so that the float stream has the same
+ * scale as the q15 stream (q15 value / 32768) */
+#define MIC_FLOAT_SCALE_FACTOR ((float)MIC_SCALE_FACTOR * UINT16_MAX / 32768.0f)
+
+/* The int16 stream is consumed by AFE only when the float stream is not used.
+ * The audio dumps, the AEC calibration and the self wake up protection always read it. */
+#define PDM_PCM_INT16_STREAM                                                                            \
+    (!SLN_MIC_FLOAT_STREAM || ENABLE_USB_AUDIO_DUMP || ENABLE_WIFI_AUDIO_DUMP || ENABLE_AEC_CALIBRATION || \
+     SELF_WAKE_UP_PROTECTION)
 #else
 #define MIC_SCALE_FACTOR 4
 #endif /* USE_NEW_PDM_PCM_LIB */
@@ -81,7 +93,6 @@ __attribute__((aligned(32))) sln_mic_handle_t g_pdmMicSai2Handle = {0U};
 
 #if USE_NEW_PDM_PCM_LIB
 __attribute__((aligned(8))) static uint8_t s_pdmPcmConvertMemBuff[PDM_TO_PCM_CONVERT_MEM_SIZE];
-__attribute__((aligned(8))) static uint32_t s_OneMicPdmData[PDM_SAMPLE_COUNT];
 /* s_OneMicPcmData buffer will be used for initial PDM to PCM conversion to 32KHz (hence double size). */
 __attribute__((aligned(8))) static float s_OneMicPcmData[PCM_SINGLE_CH_SMPL_COUNT * 2];
 #else
@@ -90,14 +101,19 @@ uint8_t *dspMemPool = NULL;
 
 static mic_task_config_t s_config;
 static EventGroupHandle_t s_PdmDmaEventGroup;
-__attribute__((aligned(2))) static pcmPingPong_t s_pcmStream;
+__attribute__((aligned(2))) static pcmRingBuffer_t s_pcmStream;
+#if SLN_MIC_FLOAT_STREAM
+__attribute__((aligned(8))) static pcmRingBufferFloat_t s_pcmStreamFloat;
+#endif /* SLN_MIC_FLOAT_STREAM */
+/* Tracks which slots of the PCM streams are waiting for the audio processing task */
+static sln_mic_ring_t s_pcmRing;
 
 bool g_micsOn            = false;
 bool g_decimationStarted = false;
 
 #if ENABLE_AEC
 #if USE_MQS
-static int16_t s_ampOutput[PCM_SINGLE_CH_SMPL_COUNT * 2];
+static int16_t s_ampOutput[PCM_SINGLE_CH_SMPL_COUNT * PCM_BUFFER_COUNT];
 volatile static uint32_t s_pingPongTimestamp = 0;
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
@@ -115,6 +131,13 @@ static void pdm_to_pcm_update_timestamp(void);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
+#if USE_NEW_PDM_PCM_LIB
+/*!
+ * @brief Scale one decimated mic frame and store it in the mic streams.
+ */
+static void pdm_to_pcm_store_mic_frame(float *pcmData, uint32_t slotIdx, uint32_t micIdx);
+#endif /* USE_NEW_PDM_PCM_LIB */
+
 /*******************************************************************************
  * Code
  ******************************************************************************/
@@ -133,7 +156,24 @@ void DMA1_DMA17_IRQHandler(void)
 #endif
 
 #if USE_NEW_PDM_PCM_LIB
+static void pdm_to_pcm_store_mic_frame(float *pcmData, uint32_t slotIdx, uint32_t micIdx)
+{
+    uint32_t offset = micIdx * PCM_SINGLE_CH_SMPL_COUNT;
+
+#if SLN_MIC_FLOAT_STREAM
+    /* Keep the headroom of the library output, SLN_AFE consumes the float stream */
+    float *scaledData = &s_pcmStreamFloat[slotIdx][offset];
+#else
+    float *scaledData = pcmData;
+#endif /* SLN_MIC_FLOAT_STREAM */
 
+    arm_scale_f32(pcmData, MIC_FLOAT_SCALE_FACTOR, scaledData, PCM_SINGLE_CH_SMPL_COUNT);
+
+#if PDM_PCM_INT16_STREAM
+    /* arm_float_to_q15 saturates the samples which do not fit in int16 */
+    arm_float_to_q15(scaledData, &s_pcmStream[slotIdx][offset], PCM_SINGLE_CH_SMPL_COUNT);
+#endif /* PDM_PCM_INT16_STREAM */
+}
 #else
 static int32_t pdm_to_pcm_dsp_init(uint8_t **memPool)
 {
@@ -169,21 +209,12 @@ void pdm_to_pcm_stream_formatter(int16_t *pcmBuffer, pdm_pcm_input_event_t micEv
         uint32_t idxStart    = 0;
         uint32_t idxEnd      = 0;
         uint32_t idxIter     = 0;
-        uint32_t pingPongIdx = 0;
+        /* Ping and pong periods are both stored in the current write slot of the ring */
+        uint32_t slotIdx     = SLN_MIC_RING_GetWriteSlot(&s_pcmRing);
 
-        bool isPingEvent = (micEvent & MIC1_PING_EVENT) || (micEvent & MIC2_PING_EVENT) || (micEvent & MIC3_PING_EVENT);
         bool isMicTwoEvent = (micEvent & MIC2_PING_EVENT) || (micEvent & MIC2_PONG_EVENT);
         bool isMicTreEvent = (micEvent & MIC3_PING_EVENT) || (micEvent & MIC3_PONG_EVENT);
 
-        if (isPingEvent)
-        {
-            pingPongIdx = 0;
-        }
-        else
-        {
-            pingPongIdx = 1;
-        }
-
 #if SLN_MIC_COUNT == 3
         if (isMicTreEvent)
         {
@@ -204,7 +235,7 @@ void pdm_to_pcm_stream_formatter(int16_t *pcmBuffer, pdm_pcm_input_event_t micEv
 
         for (uint32_t idx = idxStart; idx < idxEnd; idx += idxIter)
         {
-            s_pcmStream[pingPongIdx][idx] = *pcmBuffer;
+            s_pcmStream[slotIdx][idx] = *pcmBuffer;
             pcmBuffer++;
         }
     }
@@ -231,8 +262,8 @@ status_t pcm_to_pcm_set_config(mic_task_config_t *config)
 
 #if ENABLE_AEC
 #if USE_MQS
-        if ((s_config.loopbackRingBuffer == NULL) || (s_config.loopbackMutex == NULL) ||
-            (s_config.updateTimestamp == NULL) || (s_config.getTimestamp == NULL))
+        if ((s_config.loopbackRingBuffer == NULL) || (s_config.updateTimestamp == NULL) ||
+            (s_config.getTimestamp == NULL))
         {
             status = kStatus_InvalidArgument;
         }
@@ -271,12 +302,7 @@ TaskHandle_t pdm_to_pcm_get_task_handle(void)
 
 #if ENABLE_AEC
 #if USE_MQS
-void pdm_to_pcm_set_loopback_mutex(SemaphoreHandle_t *mutex)
-{
-    s_config.loopbackMutex = *mutex;
-}
-
-void pdm_to_pcm_set_loopback_ring_buffer(ringbuf_t *ring_buf)
+void pdm_to_pcm_set_loopback_ring_buffer(sln_amp_ring_t *ring_buf)
 {
     s_config.loopbackRingBuffer = ring_buf;
 }
@@ -297,10 +323,59 @@ int16_t *pdm_to_pcm_get_pcm_output(void)
     return (int16_t *)s_pcmStream;
 }
 
+sln_mic_ring_t *pdm_to_pcm_get_pcm_ring(void)
+{
+    return &s_pcmRing;
+}
+
+#if SLN_MIC_FLOAT_STREAM
+float *pdm_to_pcm_get_pcm_float_output(void)
+{
+    return (float *)s_pcmStreamFloat;
+}
+#endif /* SLN_MIC_FLOAT_STREAM */
+
 static volatile EventBits_t preProcessEvents  = 0U;
 static volatile EventBits_t postProcessEvents = 0U;
 static uint32_t u32AmpIndex                   = 0;
 
+/* Decimation cycles spent on the ping and pong periods, summed over all the mics */
+static uint32_t s_decimationCycles[EDMA_TCD_COUNT] = {0};
+
+/*!
+ * @brief Publish the current write slot of the PCM ring once every mic of the period was converted.
+ *
+ * @param periodMask EVT_PING_MASK or EVT_PONG_MASK
+ */
+static void pdm_to_pcm_publish_period(EventBits_t periodMask)
+{
+#if !USE_SAI2_MIC
+    /* There is no SAI2 mic to wait for */
+    postProcessEvents |= (periodMask & (MIC3_PING_EVENT | MIC3_PONG_EVENT));
+#endif /* !USE_SAI2_MIC */
+
+    if (periodMask == (postProcessEvents & periodMask))
+    {
+        postProcessEvents &= ~periodMask;
+
+        AUDIO_PROFILER_Record(kAudioProfilerPdmDecimation, s_decimationCycles[(periodMask == EVT_PING_MASK) ? 0 : 1]);
+        s_decimationCycles[(periodMask == EVT_PING_MASK) ? 0 : 1] = 0;
+
+        /* SAI1 and SAI2 run on the same clock, the SAI1 time stamp is used as the capture time of the period */
+        if (SLN_MIC_RING_CommitWrite(&s_pcmRing, g_pdmMicSai1Handle.captureTimestamp[(periodMask == EVT_PING_MASK) ? 0 : 1]))
+        {
+            if (NULL == *(s_config.processingTask))
+            {
+                configPRINTF(("ERROR: Audio Processing Task Handle NULL!\r\n"));
+            }
+            else
+            {
+                xTaskNotify(*(s_config.processingTask), PCM_DATA_EVENT, eSetBits);
+            }
+        }
+    }
+}
+
 #if ENABLE_AEC
 #if USE_MQS
 static void pdm_to_pcm_update_timestamp(void)
@@ -316,6 +391,8 @@ static void pdm_to_pcm_update_timestamp(void)
 void pdm_to_pcm_task(void *pvParameters)
 {
     uint8_t timeout_retries = 0;
+    uint32_t pcmSlot        = 0;
+    uint32_t profStart      = 0;
 
 #if USE_NEW_PDM_PCM_LIB
     PdmConvertingLibStatus pdmPcmStatus  = Status_SUCCESS;
@@ -385,6 +462,10 @@ void pdm_to_pcm_task(void *pvParameters)
     g_pdmMicSai1Handle.errorFlag         = PDM_ERROR_FLAG;
     g_pdmMicSai1Handle.pingPongBuffer[0] = (uint32_t *)(&g_Sai1PdmPingPong[0][0]);
     g_pdmMicSai1Handle.pingPongBuffer[1] = (uint32_t *)(&g_Sai1PdmPingPong[1][0]);
+#if USE_NEW_PDM_PCM_LIB
+    /* Every mic is captured in its own plane, ready for decimation */
+    g_pdmMicSai1Handle.micPlaneBytes     = PDM_SAMPLE_COUNT * PDM_CAPTURE_SIZE_BYTES;
+#endif /* USE_NEW_PDM_PCM_LIB */
 #if ENABLE_AEC
 #if USE_MQS
     g_pdmMicSai1Handle.pdmMicUpdateTimestamp = pdm_to_pcm_update_timestamp;
@@ -449,27 +530,24 @@ void pdm_to_pcm_task(void *pvParameters)
 
         if (preProcessEvents & MIC1_PING_EVENT)
         {
+            pcmSlot = SLN_MIC_RING_GetWriteSlot(&s_pcmRing);
+
 #if SAI1_CH_COUNT == 2
 
 #if ENABLE_AEC
 #if USE_MQS
-            SLN_AMP_GetAmpStream(&s_config, &s_ampOutput[0], &s_pingPongTimestamp);
+            SLN_AMP_GetAmpStream(&s_config, &s_ampOutput[pcmSlot * PCM_SINGLE_CH_SMPL_COUNT], &s_pingPongTimestamp);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
+            profStart = AUDIO_PROFILER_GET_CYCLES();
+
 #if USE_NEW_PDM_PCM_LIB
             /* MIC 1 */
-            for (uint32_t i = 0; i < PDM_SAMPLE_COUNT; i++)
-            {
-                s_OneMicPdmData[i] = g_Sai1PdmPingPong[0][2 * i];
-            }
-            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(s_OneMicPdmData, s_OneMicPcmData, 0);
+            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(&g_Sai1PdmPingPong[0][0], s_OneMicPcmData, 0);
             if (pdmPcmStatus == Status_SUCCESS)
             {
-                for (uint32_t i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
-                {
-                    s_pcmStream[0][i] = (int16_t)(s_OneMicPcmData[i] * MIC_SCALE_FACTOR * UINT16_MAX);
-                }
+                pdm_to_pcm_store_mic_frame(s_OneMicPcmData, pcmSlot, 0);
             }
             else
             {
@@ -477,17 +555,11 @@ void pdm_to_pcm_task(void *pvParameters)
             }
 
             /* MIC 2 */
-            for (uint32_t i = 0; i < PDM_SAMPLE_COUNT; i++)
-            {
-                s_OneMicPdmData[i] = g_Sai1PdmPingPong[0][2 * i + 1];
-            }
-            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(s_OneMicPdmData, s_OneMicPcmData, 1);
+            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(&g_Sai1PdmPingPong[0][PDM_SAMPLE_COUNT],
+                                                                   s_OneMicPcmData, 1);
             if (pdmPcmStatus == Status_SUCCESS)
             {
-                for (uint32_t i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
-                {
-                    s_pcmStream[0][PCM_SINGLE_CH_SMPL_COUNT + i] = (int16_t)(s_OneMicPcmData[i] * MIC_SCALE_FACTOR * UINT16_MAX);
-                }
+                pdm_to_pcm_store_mic_frame(s_OneMicPcmData, pcmSlot, 1);
             }
             else
             {
@@ -495,48 +567,51 @@ void pdm_to_pcm_task(void *pvParameters)
             }
 #else
             if (kDspSuccess != SLN_DSP_pdm_to_pcm_multi_ch(&dspMemPool, 1U, 2U, &(g_Sai1PdmPingPong[0U][0U]),
-                                                           &(s_pcmStream[0][0]), dspScratch))
+                                                           &(s_pcmStream[pcmSlot][0]), dspScratch))
             {
                 configPRINTF(("PDM to PCM Conversion error: %d\r\n", kDspSuccess));
             }
 #endif /* USE_NEW_PDM_PCM_LIB */
 #else
+            profStart = AUDIO_PROFILER_GET_CYCLES();
+
             /* Perform PDM to PCM Conversion */
             SLN_DSP_pdm_to_pcm(&dspMemPool, MIC1_DSP_STREAM, (uint8_t *)(&g_Sai1PdmPingPong[0U][0U]),
-                               &(s_pcmStream[0U][0U]));
+                               &(s_pcmStream[pcmSlot][0U]));
 
 #endif
 
+            s_decimationCycles[0] += AUDIO_PROFILER_GET_CYCLES() - profStart;
+
             postProcessEvents |= MIC1_PING_EVENT;
             postProcessEvents |= MIC2_PING_EVENT;
 
             preProcessEvents &= ~MIC1_PING_EVENT;
             preProcessEvents &= ~MIC2_PING_EVENT;
+
+            pdm_to_pcm_publish_period(EVT_PING_MASK);
         }
 
         if (preProcessEvents & MIC1_PONG_EVENT)
         {
+            pcmSlot = SLN_MIC_RING_GetWriteSlot(&s_pcmRing);
+
 #if SAI1_CH_COUNT == 2
 
 #if ENABLE_AEC
 #if USE_MQS
-            SLN_AMP_GetAmpStream(&s_config, &s_ampOutput[PCM_SINGLE_CH_SMPL_COUNT], &s_pingPongTimestamp);
+            SLN_AMP_GetAmpStream(&s_config, &s_ampOutput[pcmSlot * PCM_SINGLE_CH_SMPL_COUNT], &s_pingPongTimestamp);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
+            profStart = AUDIO_PROFILER_GET_CYCLES();
+
 #if USE_NEW_PDM_PCM_LIB
             /* MIC 1 */
-            for (uint32_t i = 0; i < PDM_SAMPLE_COUNT; i++)
-            {
-                s_OneMicPdmData[i] = g_Sai1PdmPingPong[1][2 * i];
-            }
-            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(s_OneMicPdmData, s_OneMicPcmData, 0);
+            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(&g_Sai1PdmPingPong[1][0], s_OneMicPcmData, 0);
             if (pdmPcmStatus == Status_SUCCESS)
             {
-                for (uint32_t i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
-                {
-                    s_pcmStream[1][i] = (int16_t)(s_OneMicPcmData[i] * MIC_SCALE_FACTOR * UINT16_MAX);
-                }
+                pdm_to_pcm_store_mic_frame(s_OneMicPcmData, pcmSlot, 0);
             }
             else
             {
@@ -544,17 +619,11 @@ void pdm_to_pcm_task(void *pvParameters)
             }
 
             /* MIC 2 */
-            for (uint32_t i = 0; i < PDM_SAMPLE_COUNT; i++)
-            {
-                s_OneMicPdmData[i] = g_Sai1PdmPingPong[1][2 * i + 1];
-            }
-            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(s_OneMicPdmData, s_OneMicPcmData, 1);
+            pdmPcmStatus = PdmToPcm_ConvertOneFrame_Cfg4_WithHpf2(&g_Sai1PdmPingPong[1][PDM_SAMPLE_COUNT],
+                                                                   s_OneMicPcmData, 1);
             if (pdmPcmStatus == Status_SUCCESS)
             {
-                for (uint32_t i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
-                {
-                    s_pcmStream[1][PCM_SINGLE_CH_SMPL_COUNT + i] = (int16_t)(s_OneMicPcmData[i] * MIC_SCALE_FACTOR * UINT16_MAX);
-                }
+                pdm_to_pcm_store_mic_frame(s_OneMicPcmData, pcmSlot, 1);
             }
             else
             {
@@ -562,48 +631,63 @@ void pdm_to_pcm_task(void *pvParameters)
             }
 #else
             if (kDspSuccess != SLN_DSP_pdm_to_pcm_multi_ch(&dspMemPool, MIC1_DSP_STREAM, SAI1_CH_COUNT,
-                                                           &(g_Sai1PdmPingPong[1U][0U]), &(s_pcmStream[1U][0U]),
+                                                           &(g_Sai1PdmPingPong[1U][0U]), &(s_pcmStream[pcmSlot][0U]),
                                                            dspScratch))
             {
                 configPRINTF(("PDM to PCM Conversion error: %d\r\n", kDspSuccess));
             }
 #endif /* USE_NEW_PDM_PCM_LIB */
 #else
+            profStart = AUDIO_PROFILER_GET_CYCLES();
 
             /* Perform PDM to PCM Conversion */
             SLN_DSP_pdm_to_pcm(&dspMemPool, MIC1_DSP_STREAM, (uint8_t *)(&g_Sai1PdmPingPong[1U][0U]),
-                               &(s_pcmStream[1U][0U]));
+                               &(s_pcmStream[pcmSlot][0U]));
 
 #endif
 
+            s_decimationCycles[1] += AUDIO_PROFILER_GET_CYCLES() - profStart;
+
             postProcessEvents |= MIC1_PONG_EVENT;
             postProcessEvents |= MIC2_PONG_EVENT;
 
             preProcessEvents &= ~MIC1_PONG_EVENT;
             preProcessEvents &= ~MIC2_PONG_EVENT;
+
+            pdm_to_pcm_publish_period(EVT_PONG_MASK);
         }
 
 #if (USE_SAI2_MIC)
         if (preProcessEvents & MIC3_PING_EVENT)
         {
+            pcmSlot = SLN_MIC_RING_GetWriteSlot(&s_pcmRing);
 
             /* Perform PDM to PCM Conversion */
+            profStart = AUDIO_PROFILER_GET_CYCLES();
             SLN_DSP_pdm_to_pcm(&dspMemPool, MIC3_DSP_STREAM, (uint8_t *)(&g_Sai2PdmPingPong[0U][0U]),
-                               &(s_pcmStream[0U][MIC3_START_IDX]));
+                               &(s_pcmStream[pcmSlot][MIC3_START_IDX]));
+            s_decimationCycles[0] += AUDIO_PROFILER_GET_CYCLES() - profStart;
 
             postProcessEvents |= MIC3_PING_EVENT;
             preProcessEvents &= ~MIC3_PING_EVENT;
 
+            pdm_to_pcm_publish_period(EVT_PING_MASK);
         }
 
         if (preProcessEvents & MIC3_PONG_EVENT)
         {
+            pcmSlot = SLN_MIC_RING_GetWriteSlot(&s_pcmRing);
+
             /* Perform PDM to PCM Conversion */
+            profStart = AUDIO_PROFILER_GET_CYCLES();
             SLN_DSP_pdm_to_pcm(&dspMemPool, MIC3_DSP_STREAM, (uint8_t *)(&g_Sai2PdmPingPong[1U][0U]),
-                               &(s_pcmStream[1U][MIC3_START_IDX]));
+                               &(s_pcmStream[pcmSlot][MIC3_START_IDX]));
+            s_decimationCycles[1] += AUDIO_PROFILER_GET_CYCLES() - profStart;
 
             postProcessEvents |= MIC3_PONG_EVENT;
             preProcessEvents &= ~MIC3_PONG_EVENT;
+
+            pdm_to_pcm_publish_period(EVT_PONG_MASK);
         }
 
         if (preProcessEvents & PDM_ERROR_FLAG)
@@ -611,37 +695,7 @@ void pdm_to_pcm_task(void *pvParameters)
             configPRINTF(("[PDM-PCM] - Missed Event \r\n"));
             preProcessEvents &= ~PDM_ERROR_FLAG;
         }
-#else
-        postProcessEvents |= MIC3_PING_EVENT;
-        postProcessEvents |= MIC3_PONG_EVENT;
 #endif
-
-        if (EVT_PING_MASK == (postProcessEvents & EVT_PING_MASK))
-        {
-            if (NULL == *(s_config.processingTask))
-            {
-                configPRINTF(("ERROR: Audio Processing Task Handle NULL!\r\n"));
-            }
-            else
-            {
-                xTaskNotify(*(s_config.processingTask), PCM_PING_EVENT, eSetBits);
-            }
-
-            postProcessEvents &= ~(EVT_PING_MASK);
-        }
-        else if (EVT_PONG_MASK == (postProcessEvents & EVT_PONG_MASK))
-        {
-            if (NULL == *(s_config.processingTask))
-            {
-                configPRINTF(("ERROR: Audio Processing Task Handle NULL!\r\n"));
-            }
-            else
-            {
-                xTaskNotify(*(s_config.processingTask), PCM_PONG_EVENT, eSetBits);
-            }
-
-            postProcessEvents &= ~(EVT_PONG_MASK);
-        }
     }
 }
 
@@ -666,7 +720,11 @@ void pdm_to_pcm_mics_off(void)
         g_pdmMicSai2Handle.pingPongTracker = 0;
 #endif
 
-        memset(s_pcmStream, 0, sizeof(pcmPingPong_t));
+        memset(s_pcmStream, 0, sizeof(pcmRingBuffer_t));
+#if SLN_MIC_FLOAT_STREAM
+        memset(s_pcmStreamFloat, 0, sizeof(pcmRingBufferFloat_t));
+#endif /* SLN_MIC_FLOAT_STREAM */
+        SLN_MIC_RING_RequestReset(&s_pcmRing);
 
 #if ENABLE_AEC
         /* amplifier loopback */
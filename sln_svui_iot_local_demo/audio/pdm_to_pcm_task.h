@@ -21,7 +21,7 @@
 #if ENABLE_AEC
 #if USE_MQS
 #include "semphr.h"
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -98,21 +98,13 @@ TaskHandle_t pdm_to_pcm_get_task_handle(void);
 #if ENABLE_AEC
 #if USE_MQS
 
-/*!
- * @brief Set the loopback mutex.
-          Used for exclusive access to the loopback ringbuffer.
- *
- * @param mutex    Pointer to the mutex handler
- */
-void pdm_to_pcm_set_loopback_mutex(SemaphoreHandle_t *mutex);
-
 /*!
  * @brief Set the loopback ringbuffer.
           Used for setting the pointer to the ringbuffer.
  *
  * @param *ring_buf Reference to the ring buffer for amp loopback
  */
-void pdm_to_pcm_set_loopback_ring_buffer(ringbuf_t *ring_buf);
+void pdm_to_pcm_set_loopback_ring_buffer(sln_amp_ring_t *ring_buf);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -130,6 +122,22 @@ int16_t *pdm_to_pcm_get_amp_output(void);
  */
 int16_t *pdm_to_pcm_get_pcm_output(void);
 
+/*!
+ * @brief Get pointer to the ring tracking the slots of the PCM output
+ *
+ * @returns Pointer to the PCM ring
+ */
+sln_mic_ring_t *pdm_to_pcm_get_pcm_ring(void);
+
+#if SLN_MIC_FLOAT_STREAM
+/*!
+ * @brief Get pointer to float PCM output for SLN_AFE
+ *
+ * @returns Pointer to the planar float microphone PCM data
+ */
+float *pdm_to_pcm_get_pcm_float_output(void);
+#endif /* SLN_MIC_FLOAT_STREAM */
+
 #if USE_NEW_PDM_PCM_LIB
 
 #else
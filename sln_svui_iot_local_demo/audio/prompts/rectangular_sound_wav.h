@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
-#if ENABLE_USB_AUDIO_DUMP
+#if ENABLE_USB_AUDIO_DUMP || ENABLE_AEC_CALIBRATION
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
@@ -12,6 +12,10 @@
 /*******************************************************************************
  * Global Vars
  ******************************************************************************/
+#if ENABLE_AEC_CALIBRATION && !defined(RECTANGULAR_SOUND_WAV_DEFINE)
+/* Defined by the AEC calibration (audio_aec_calib.c), which plays the same sound */
+extern const unsigned char rectangular_sound_wav[RECTANGULAR_SOUND_WAV_LEN];
+#else
 __attribute__((aligned(32))) const unsigned char rectangular_sound_wav[RECTANGULAR_SOUND_WAV_LEN] = {
   0x52, 0x49, 0x46, 0x46, 0x28, 0x79, 0x01, 0x00, 0x57, 0x41, 0x56, 0x45,
   0x66, 0x6d, 0x74, 0x20, 0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00,
@@ -8061,4 +8065,5 @@ __attribute__((aligned(32))) const unsigned char rectangular_sound_wav[RECTANGUL
   0x37, 0x90, 0xf3, 0x89, 0x00, 0x80, 0x13, 0x80, 0x9a, 0x8e, 0x3e, 0x91,
   0x5c, 0x86, 0xc4, 0x94, 0x89, 0xdb, 0x1b, 0x3f};
 unsigned int rectangular_sound_wav_len = 96560;
-#endif /* ENABLE_USB_AUDIO_DUMP */
+#endif /* ENABLE_AEC_CALIBRATION && !defined(RECTANGULAR_SOUND_WAV_DEFINE) */
+#endif /* ENABLE_USB_AUDIO_DUMP || ENABLE_AEC_CALIBRATION */
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "string.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "fsl_common.h"
+
+#include "sln_amp_mixer.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Gain of a ducked channel by default, -12dB */
+#define SLN_AMP_MIXER_DEFAULT_DUCK_GAIN (SLN_AMP_MIXER_GAIN_ONE / 4)
+
+typedef struct _sln_amp_mixer_buffer
+{
+    const int16_t *samples;
+    uint32_t count;
+} sln_amp_mixer_buffer_t;
+
+typedef struct _sln_amp_mixer_channel
+{
+    /* Queue, appended by the producer and popped by the mixer, both with the scheduler locked */
+    sln_amp_mixer_buffer_t queue[SLN_AMP_MIXER_QUEUE_LEN];
+    volatile uint32_t head;  /*!< Oldest buffer */
+    volatile uint32_t queued; /*!< Buffers in the queue */
+    uint32_t offset;         /*!< Samples of the oldest buffer already mixed */
+
+    /* Settings */
+    volatile int16_t gain;
+    volatile int16_t duckGain;
+    volatile uint8_t priority;
+
+    /* Gain used at the end of the last block, Q15 in the top half so the ramp steps keep their precision */
+    int32_t appliedGain;
+    bool mixing;
+} sln_amp_mixer_channel_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static sln_amp_mixer_channel_t s_channels[kSlnAmpChannelCount];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void SLN_AMP_MIXER_Init(void)
+{
+    memset(s_channels, 0, sizeof(s_channels));
+
+    for (uint32_t ch = 0; ch < kSlnAmpChannelCount; ch++)
+    {
+        s_channels[ch].gain     = SLN_AMP_MIXER_GAIN_ONE;
+        s_channels[ch].duckGain = SLN_AMP_MIXER_DEFAULT_DUCK_GAIN;
+        s_channels[ch].priority = (uint8_t)ch;
+    }
+}
+
+bool SLN_AMP_MIXER_Queue(sln_amp_channel_t channel, const uint8_t *data, uint32_t length)
+{
+    sln_amp_mixer_channel_t *chn = NULL;
+    bool queued                  = false;
+
+    if ((channel < kSlnAmpChannelCount) && (data != NULL) && (length >= sizeof(int16_t)))
+    {
+        chn = &s_channels[channel];
+
+        taskENTER_CRITICAL();
+        if (chn->queued < SLN_AMP_MIXER_QUEUE_LEN)
+        {
+            chn->queue[(chn->head + chn->queued) % SLN_AMP_MIXER_QUEUE_LEN].samples = (const int16_t *)data;
+            chn->queue[(chn->head + chn->queued) % SLN_AMP_MIXER_QUEUE_LEN].count   = length / sizeof(int16_t);
+            chn->queued++;
+            queued = true;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return queued;
+}
+
+uint32_t SLN_AMP_MIXER_GetQueued(sln_amp_channel_t channel)
+{
+    return (channel < kSlnAmpChannelCount) ? s_channels[channel].queued : 0;
+}
+
+uint32_t SLN_AMP_MIXER_Flush(sln_amp_channel_t channel)
+{
+    uint32_t dropped = 0;
+
+    if (channel < kSlnAmpChannelCount)
+    {
+        taskENTER_CRITICAL();
+        dropped                    = s_channels[channel].queued;
+        s_channels[channel].head   = 0;
+        s_channels[channel].queued = 0;
+        s_channels[channel].offset = 0;
+        taskEXIT_CRITICAL();
+    }
+
+    return dropped;
+}
+
+void SLN_AMP_MIXER_SetGain(sln_amp_channel_t channel, int16_t gainQ15)
+{
+    if (channel < kSlnAmpChannelCount)
+    {
+        s_channels[channel].gain = MAX(gainQ15, 0);
+    }
+}
+
+void SLN_AMP_MIXER_SetDucking(sln_amp_channel_t channel, uint8_t priority, int16_t duckGainQ15)
+{
+    if (channel < kSlnAmpChannelCount)
+    {
+        s_channels[channel].priority = priority;
+        s_channels[channel].duckGain = MAX(duckGainQ15, 0);
+    }
+}
+
+uint8_t SLN_AMP_MIXER_GetPriority(sln_amp_channel_t channel)
+{
+    return (channel < kSlnAmpChannelCount) ? s_channels[channel].priority : 0;
+}
+
+uint32_t SLN_AMP_MIXER_Mix(int16_t *out, uint32_t count, uint8_t released[kSlnAmpChannelCount])
+{
+    sln_amp_mixer_channel_t *chn   = NULL;
+    const sln_amp_mixer_buffer_t *buf = NULL;
+    const int16_t *src             = NULL;
+    uint32_t mixed                 = 0;
+    uint32_t idx                   = 0;
+    uint32_t n                     = 0;
+    int32_t target                 = 0;
+    int32_t step                   = 0;
+    int32_t gain                   = 0;
+    int32_t topPriority            = -1;
+
+    memset(out, 0, count * sizeof(int16_t));
+
+    /* The channels with samples queued below the highest priority one are ducked */
+    for (uint32_t ch = 0; ch < kSlnAmpChannelCount; ch++)
+    {
+        if (s_channels[ch].queued > 0)
+        {
+            topPriority = MAX(topPriority, (int32_t)s_channels[ch].priority);
+        }
+    }
+
+    for (uint32_t ch = 0; ch < kSlnAmpChannelCount; ch++)
+    {
+        chn = &s_channels[ch];
+
+        if (chn->queued == 0)
+        {
+            chn->mixing = false;
+            continue;
+        }
+
+        target = chn->gain;
+        if ((int32_t)chn->priority < topPriority)
+        {
+            target = (target * chn->duckGain) >> 15;
+        }
+        target <<= 16;
+
+        /* A new sound starts at the right gain, a gain change on a playing sound is ramped over the block */
+        if (!chn->mixing)
+        {
+            chn->appliedGain = target;
+            chn->mixing      = true;
+        }
+        gain = chn->appliedGain;
+        step = (target - gain) / (int32_t)count;
+
+        idx = 0;
+        while ((idx < count) && (chn->queued > 0))
+        {
+            buf = &chn->queue[chn->head];
+            src = &buf->samples[chn->offset];
+            n   = MIN(count - idx, buf->count - chn->offset);
+
+            for (uint32_t k = 0; k < n; k++)
+            {
+                gain += step;
+                out[idx + k] = (int16_t)__SSAT(out[idx + k] + ((src[k] * (gain >> 16)) >> 15), 16);
+            }
+
+            idx += n;
+            chn->offset += n;
+
+            if (chn->offset >= buf->count)
+            {
+                taskENTER_CRITICAL();
+                chn->head = (chn->head + 1) % SLN_AMP_MIXER_QUEUE_LEN;
+                chn->queued--;
+                chn->offset = 0;
+                taskEXIT_CRITICAL();
+
+                if (released != NULL)
+                {
+                    released[ch]++;
+                }
+            }
+        }
+
+        chn->appliedGain = target;
+        mixed            = MAX(mixed, idx);
+    }
+
+    return mixed;
+}
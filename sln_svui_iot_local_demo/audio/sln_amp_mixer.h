@@ -0,0 +1,115 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_AMP_MIXER_H_
+#define _SLN_AMP_MIXER_H_
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Buffers a channel can hold before they are mixed. The Streamer keeps up to
+ * SAI_XFER_QUEUE_SIZE buffers in flight, a channel must be able to queue all of them. */
+#define SLN_AMP_MIXER_QUEUE_LEN 4
+
+/* Full scale Q15 gain */
+#define SLN_AMP_MIXER_GAIN_ONE 32767
+
+/*!
+ * @brief Mixer input channels. By default a channel has priority over the ones listed before it.
+ */
+typedef enum _sln_amp_channel
+{
+    kSlnAmpChannelStreamer, /* Decoded prompts fed by the Streamer (SLN_AMP_WriteStreamerNoWait) */
+    kSlnAmpChannelPrompt,   /* Raw PCM prompts (SLN_AMP_WriteAudioBlocking and SLN_AMP_WriteAudioNoWait) */
+    kSlnAmpChannelTone,     /* Short UI tones and earcons (SLN_AMP_WriteChannelNoWait) */
+    kSlnAmpChannelCount,
+} sln_amp_channel_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Empty all the channels and set them to their default gain, priority and ducking.
+ */
+void SLN_AMP_MIXER_Init(void);
+
+/*!
+ * @brief Queue a buffer of 16-bit PCM samples on a channel. The buffer is read in place while it is mixed,
+ *        it must stay valid until SLN_AMP_MIXER_Mix reports it as released.
+ *
+ * @param channel Mixer channel
+ * @param data    Samples, in the amplifier format
+ * @param length  Length of the buffer in bytes
+ * @returns true if the buffer was queued, false if the channel queue is full
+ */
+bool SLN_AMP_MIXER_Queue(sln_amp_channel_t channel, const uint8_t *data, uint32_t length);
+
+/*!
+ * @brief Get the number of buffers queued on a channel and not completely mixed yet.
+ *
+ * @param channel Mixer channel
+ */
+uint32_t SLN_AMP_MIXER_GetQueued(sln_amp_channel_t channel);
+
+/*!
+ * @brief Drop the buffers queued on a channel.
+ *        Must not run at the same time as SLN_AMP_MIXER_Mix.
+ *
+ * @param channel Mixer channel
+ * @returns Number of buffers dropped
+ */
+uint32_t SLN_AMP_MIXER_Flush(sln_amp_channel_t channel);
+
+/*!
+ * @brief Set the gain of a channel. The change is ramped over the next mixed block.
+ *
+ * @param channel Mixer channel
+ * @param gainQ15 Gain, between 0 and SLN_AMP_MIXER_GAIN_ONE
+ */
+void SLN_AMP_MIXER_SetGain(sln_amp_channel_t channel, int16_t gainQ15);
+
+/*!
+ * @brief Set how a channel gives way to the others. While a channel with a higher priority
+ *        has samples queued, the channel gain is multiplied by its duck gain.
+ *
+ * @param channel     Mixer channel
+ * @param priority    Priority of the channel, higher wins
+ * @param duckGainQ15 Gain applied while the channel is ducked, between 0 and SLN_AMP_MIXER_GAIN_ONE
+ */
+void SLN_AMP_MIXER_SetDucking(sln_amp_channel_t channel, uint8_t priority, int16_t duckGainQ15);
+
+/*!
+ * @brief Get the priority of a channel.
+ *
+ * @param channel Mixer channel
+ */
+uint8_t SLN_AMP_MIXER_GetPriority(sln_amp_channel_t channel);
+
+/*!
+ * @brief Mix the queued samples of all the channels, each with its gain, into one block.
+ *        The samples not available on a channel are taken as silence.
+ *
+ * @param out      Output block
+ * @param count    Number of samples of the block
+ * @param released Per channel, incremented by the number of buffers completely mixed, may be NULL
+ * @returns Number of samples of the block which hold audio from at least one channel
+ */
+uint32_t SLN_AMP_MIXER_Mix(int16_t *out, uint32_t count, uint8_t released[kSlnAmpChannelCount]);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _SLN_AMP_MIXER_H_ */
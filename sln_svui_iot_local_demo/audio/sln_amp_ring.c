@@ -0,0 +1,192 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "string.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "fsl_common.h"
+
+#include "sln_amp_ring.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static inline uint32_t _ring_advance(sln_amp_ring_t *ring, uint32_t idx, uint32_t count)
+{
+    idx += count;
+    if (idx >= (2 * ring->size))
+    {
+        idx -= (2 * ring->size);
+    }
+
+    return idx;
+}
+
+static inline uint32_t _ring_distance(sln_amp_ring_t *ring, uint32_t from, uint32_t to)
+{
+    return (to >= from) ? (to - from) : (to + (2 * ring->size) - from);
+}
+
+static inline uint32_t _ring_offset(sln_amp_ring_t *ring, uint32_t idx)
+{
+    return (idx >= ring->size) ? (idx - ring->size) : idx;
+}
+
+/**
+ * @brief Stage bytes after the data already staged. The caller checked that they fit.
+ */
+static void _ring_stage(sln_amp_ring_t *ring, const uint8_t *data, uint32_t size)
+{
+    uint32_t offset = _ring_offset(ring, ring->stageIdx);
+    uint32_t first  = MIN(size, ring->size - offset);
+
+    if (data != NULL)
+    {
+        memcpy(&ring->buffer[offset], data, first);
+        memcpy(ring->buffer, &data[first], size - first);
+    }
+    else
+    {
+        memset(&ring->buffer[offset], 0, first);
+        memset(ring->buffer, 0, size - first);
+    }
+
+    ring->stageIdx = _ring_advance(ring, ring->stageIdx, size);
+}
+
+void SLN_AMP_RING_Init(sln_amp_ring_t *ring, uint8_t *buffer, uint32_t size)
+{
+    if (ring != NULL)
+    {
+        memset((void *)ring, 0, sizeof(sln_amp_ring_t));
+        ring->buffer = buffer;
+        ring->size   = size;
+    }
+}
+
+uint32_t SLN_AMP_RING_GetFill(sln_amp_ring_t *ring)
+{
+    return _ring_distance(ring, ring->readIdx, ring->writeIdx);
+}
+
+uint32_t SLN_AMP_RING_GetFree(sln_amp_ring_t *ring)
+{
+    return ring->size - _ring_distance(ring, ring->readIdx, ring->stageIdx);
+}
+
+bool SLN_AMP_RING_Write(sln_amp_ring_t *ring, const uint8_t *data, uint32_t size)
+{
+    bool staged = false;
+
+    if ((data != NULL) && (size <= SLN_AMP_RING_GetFree(ring)))
+    {
+        _ring_stage(ring, data, size);
+        staged = true;
+    }
+    else
+    {
+        ring->overflows += size;
+    }
+
+    return staged;
+}
+
+bool SLN_AMP_RING_WriteZeros(sln_amp_ring_t *ring, uint32_t size)
+{
+    bool staged = false;
+
+    if (size <= SLN_AMP_RING_GetFree(ring))
+    {
+        _ring_stage(ring, NULL, size);
+        staged = true;
+    }
+    else
+    {
+        ring->overflows += size;
+    }
+
+    return staged;
+}
+
+void SLN_AMP_RING_Commit(sln_amp_ring_t *ring)
+{
+    /* The staged bytes must be visible before the consumer can see the new index */
+    __DMB();
+    ring->writeIdx = ring->stageIdx;
+}
+
+void SLN_AMP_RING_CommitAt(sln_amp_ring_t *ring, uint32_t time)
+{
+    ring->commitTime = time;
+    SLN_AMP_RING_Commit(ring);
+}
+
+uint32_t SLN_AMP_RING_GetCommitTime(sln_amp_ring_t *ring)
+{
+    return ring->commitTime;
+}
+
+void SLN_AMP_RING_Discard(sln_amp_ring_t *ring)
+{
+    ring->stageIdx = ring->writeIdx;
+}
+
+uint32_t SLN_AMP_RING_Peek(sln_amp_ring_t *ring, const uint8_t **data, uint32_t size)
+{
+    uint32_t readIdx = ring->readIdx;
+    uint32_t offset  = _ring_offset(ring, readIdx);
+    uint32_t count   = MIN(size, _ring_distance(ring, readIdx, ring->writeIdx));
+
+    /* Do not read the bytes before their index was seen published */
+    __DMB();
+
+    *data = &ring->buffer[offset];
+
+    return MIN(count, ring->size - offset);
+}
+
+void SLN_AMP_RING_Consume(sln_amp_ring_t *ring, uint32_t size)
+{
+    size = MIN(size, SLN_AMP_RING_GetFill(ring));
+
+    /* The bytes must be read before the producer is allowed to overwrite them */
+    __DMB();
+    ring->readIdx = _ring_advance(ring, ring->readIdx, size);
+}
+
+uint32_t SLN_AMP_RING_Read(sln_amp_ring_t *ring, uint8_t *data, uint32_t size)
+{
+    const uint8_t *src = NULL;
+    uint32_t copied    = 0;
+    uint32_t count     = 0;
+
+    /* The unread bytes are split in at most two parts, at the end and at the start of the storage */
+    for (uint32_t part = 0; (part < 2) && (copied < size); part++)
+    {
+        count = SLN_AMP_RING_Peek(ring, &src, size - copied);
+        if (count == 0)
+        {
+            break;
+        }
+
+        memcpy(&data[copied], src, count);
+        SLN_AMP_RING_Consume(ring, count);
+        copied += count;
+    }
+
+    return copied;
+}
+
+void SLN_AMP_RING_Flush(sln_amp_ring_t *ring)
+{
+    /* The consumer has a higher priority, it must not run between reading writeIdx and moving readIdx */
+    taskENTER_CRITICAL();
+    ring->readIdx = ring->writeIdx;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_AMP_RING_H_
+#define _SLN_AMP_RING_H_
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Cortex-M7 D-cache line size. Each index lives on its own line, so the writer updating
+ * its index never touches the line holding the index of the reader, and the other way around. */
+#define SLN_AMP_RING_CACHE_LINE 32
+
+/*!
+ * @brief Byte ring shared by the amplifier writer (single producer) and the mic task (single consumer)
+ *        without any lock. The writer stages bytes after the published data and makes them visible
+ *        to the reader all at once with SLN_AMP_RING_Commit.
+ *        Indices run from 0 to (2 * size - 1), so a full ring can be told apart from an empty one.
+ */
+typedef struct _sln_amp_ring
+{
+    /* Written only by the producer */
+    volatile uint32_t writeIdx __attribute__((aligned(SLN_AMP_RING_CACHE_LINE))); /*!< End of the published data */
+    uint32_t stageIdx;                                                           /*!< End of the staged data */
+    uint32_t overflows;                                                          /*!< Bytes dropped, ring full */
+    volatile uint32_t commitTime;                                                /*!< Time stamp of the last commit */
+
+    /* Written only by the consumer */
+    volatile uint32_t readIdx __attribute__((aligned(SLN_AMP_RING_CACHE_LINE))); /*!< Start of the unread data */
+
+    /* Constant after SLN_AMP_RING_Init */
+    uint8_t *buffer __attribute__((aligned(SLN_AMP_RING_CACHE_LINE)));
+    uint32_t size;
+} sln_amp_ring_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Attach the storage to the ring and empty it.
+ *
+ * @param ring   Pointer to the ring
+ * @param buffer Storage of the ring
+ * @param size   Size of the storage in bytes
+ */
+void SLN_AMP_RING_Init(sln_amp_ring_t *ring, uint8_t *buffer, uint32_t size);
+
+/*!
+ * @brief Get the number of published bytes which were not read yet.
+ *
+ * @param ring Pointer to the ring
+ */
+uint32_t SLN_AMP_RING_GetFill(sln_amp_ring_t *ring);
+
+/*!
+ * @brief Get the number of bytes which can still be staged. Producer only.
+ *
+ * @param ring Pointer to the ring
+ */
+uint32_t SLN_AMP_RING_GetFree(sln_amp_ring_t *ring);
+
+/*!
+ * @brief Stage data after the data already staged. Producer only.
+ *        Nothing is staged if the whole data does not fit.
+ *
+ * @param ring Pointer to the ring
+ * @param data Data to copy
+ * @param size Number of bytes
+ * @returns true if the data was staged
+ */
+bool SLN_AMP_RING_Write(sln_amp_ring_t *ring, const uint8_t *data, uint32_t size);
+
+/*!
+ * @brief Stage zeroes after the data already staged. Producer only.
+ *        Nothing is staged if the zeroes do not fit.
+ *
+ * @param ring Pointer to the ring
+ * @param size Number of zero bytes
+ * @returns true if the zeroes were staged
+ */
+bool SLN_AMP_RING_WriteZeros(sln_amp_ring_t *ring, uint32_t size);
+
+/*!
+ * @brief Make all the staged bytes visible to the consumer. Producer only.
+ *
+ * @param ring Pointer to the ring
+ */
+void SLN_AMP_RING_Commit(sln_amp_ring_t *ring);
+
+/*!
+ * @brief Same as SLN_AMP_RING_Commit, also record when the bytes were published. Producer only.
+ *        The consumer must not run between the two updates, call it with the scheduler locked.
+ *
+ * @param ring Pointer to the ring
+ * @param time Time stamp of the commit, in the unit of the caller
+ */
+void SLN_AMP_RING_CommitAt(sln_amp_ring_t *ring, uint32_t time);
+
+/*!
+ * @brief Get the time stamp given to the last SLN_AMP_RING_CommitAt.
+ *
+ * @param ring Pointer to the ring
+ */
+uint32_t SLN_AMP_RING_GetCommitTime(sln_amp_ring_t *ring);
+
+/*!
+ * @brief Drop the bytes staged since the last commit. Producer only.
+ *
+ * @param ring Pointer to the ring
+ */
+void SLN_AMP_RING_Discard(sln_amp_ring_t *ring);
+
+/*!
+ * @brief Get the oldest unread bytes which are contiguous in the ring, without consuming them. Consumer only.
+ *
+ * @param ring Pointer to the ring
+ * @param data Pointer where the address of the bytes will be stored
+ * @param size Maximum number of bytes wanted
+ * @returns Number of contiguous bytes available at *data, up to size
+ */
+uint32_t SLN_AMP_RING_Peek(sln_amp_ring_t *ring, const uint8_t **data, uint32_t size);
+
+/*!
+ * @brief Release bytes returned by SLN_AMP_RING_Peek to the producer. Consumer only.
+ *
+ * @param ring Pointer to the ring
+ * @param size Number of bytes
+ */
+void SLN_AMP_RING_Consume(sln_amp_ring_t *ring, uint32_t size);
+
+/*!
+ * @brief Copy and consume the oldest unread bytes. Consumer only.
+ *
+ * @param ring Pointer to the ring
+ * @param data Destination buffer
+ * @param size Maximum number of bytes
+ * @returns Number of bytes copied
+ */
+uint32_t SLN_AMP_RING_Read(sln_amp_ring_t *ring, uint8_t *data, uint32_t size);
+
+/*!
+ * @brief Drop all the unread bytes. Consumer side operation, it may also be called by a task with a
+ *        lower priority than the consumer.
+ *
+ * @param ring Pointer to the ring
+ */
+void SLN_AMP_RING_Flush(sln_amp_ring_t *ring);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _SLN_AMP_RING_H_ */
@@ -16,16 +16,18 @@
 #include "fsl_sai.h"
 #include "fsl_sai_edma.h"
 #include "fsl_codec_common.h"
-#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
 #include "sln_mic_config.h"
 #include "sln_amplifier.h"
 #include "sln_amplifier_processing.h"
+#include "sln_amp_mixer.h"
+#include "audio_profiler.h"
 
 #if ENABLE_AEC
 #if USE_MQS
 #include "fsl_gpt.h"
-#include "semphr.h"
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -33,26 +35,37 @@
  * Definitions
  ******************************************************************************/
 
-/*! @brief PLAY AUDIO ASYNC Task settings */
-#define PLAY_AUDIO_ASYNC_TASK_NAME       "Play_Audio_Async_Task"
-#define PLAY_AUDIO_ASYNC_TASK_STACK_SIZE 256
-#define PLAY_AUDIO_ASYNC_TASK_PRIORITY   configTIMER_TASK_PRIORITY - 1
+/*! @brief Amplifier mixer task settings */
+#define AMP_MIXER_TASK_NAME       "Amp_Mixer_Task"
+#define AMP_MIXER_TASK_STACK_SIZE 512
+#define AMP_MIXER_TASK_PRIORITY   configTIMER_TASK_PRIORITY - 1
 
 #define WAIT_SAI_FEF_FLAG_CLEAR 3
 
-/* Maximum DMA chunk size: 512KB (both for TFA and MQS) */
-#define PCM_AMP_DMA_CHUNK_MAX_SIZE 0x80000
+/* Set in s_AmplifierEvents while a mixer channel has nothing left to play */
+#define AMP_CHANNEL_IDLE_EVT(channel) (1U << (channel))
+#define AMP_CHANNEL_IDLE_EVT_ALL      ((1U << kSlnAmpChannelCount) - 1U)
+
+/* Set in s_AmplifierEvents while no audio is played by SLN_AMP_WriteAudioBlocking or SLN_AMP_WriteAudioNoWait */
+#define AMP_WRITE_DONE_EVT AMP_CHANNEL_IDLE_EVT(kSlnAmpChannelPrompt)
+
+/* Set in s_AmplifierEvents by SLN_AMP_TxCallback when the last slot scheduled was played.
+ * Cleared by SLN_AMP_WaitSlotsIdle, which checks s_AmplifierFreeBuffs again on every wake up. */
+#define AMP_SLOTS_IDLE_EVT (1U << kSlnAmpChannelCount)
+
+/* Longest wait for a slot to be released before the mixer checks again its state.
+ * Slots are normally released every slot duration, the timeout only covers a stalled DMA. */
+#define AMP_SLOT_WAIT_MS 100
+
+/* The mixer output is played in AMP_WRITE_SLOTS slots of DEFAULT_AMP_SLOT_SIZE bytes,
+ * a multiple of 32 bytes as required by the EDMA */
+#define AMP_MIXER_SLOT_SMPL_COUNT (DEFAULT_AMP_SLOT_SIZE / sizeof(int16_t))
 
 #if ENABLE_AEC
 #if USE_MQS
-/* For 24Mhz and PS=200, 1 tick ~= 8.4us.
+/* AMP_LOOPBACK_GPT_FREQ_MHZ and AMP_LOOPBACK_GPT_PS are in sln_mic_config.h.
  * In this configuration, AMP_LOOPBACK_GPT will overflow after around 10 hours */
 #define AMP_LOOPBACK_GPT                    GPT2
-#define AMP_LOOPBACK_GPT_FREQ_MHZ           24
-#define AMP_LOOPBACK_GPT_PS                 200
-
-/* Convert Loopback GPT ticks to microseconds */
-#define AMP_LOOPBACK_GPT_TICKS_TO_US(ticks) ((ticks * AMP_LOOPBACK_GPT_PS) / AMP_LOOPBACK_GPT_FREQ_MHZ)
 
 #define AMP_LOOPBACK_NEW_SYNC_MAX_WAIT_MS 100
 
@@ -69,38 +82,43 @@ typedef enum _loopback_state
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
-/* Structure provided to the async Play_Audio_Async_Task. */
-typedef struct _sln_amp_write_packet
-{
-    uint8_t *data;
-    uint32_t length;
-    uint32_t slotSize;
-    uint8_t slotCnt;
-    bool inFlash;
-} sln_amp_write_packet_t;
-
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 
-static volatile sln_amp_state_t s_SlnAmpState = kSlnAmpIdle;
+/* State reported by SLN_AMP_GetState while a mixer channel plays */
+static volatile sln_amp_state_t s_ChannelState[kSlnAmpChannelCount] = {kSlnAmpStreamer, kSlnAmpPlayBlocking,
+                                                                       kSlnAmpPlayNonBlocking};
 
 /* Used for synchronization with the Streamer */
 static volatile uint8_t *s_StreamerFreeBuffs = NULL;
 static volatile uint8_t s_StreamerMaxBuffs   = 0;
 
-/* Used by SLN_AMP_WriteAudioBlocking and SLN_AMP_WriteAudioNoWait to know
- * how many buffers are free. */
+/* Mixer slots not scheduled to the SAI, incremented by SLN_AMP_TxCallback each time a slot is played. */
 static volatile uint8_t s_AmplifierFreeBuffs = 0;
-static volatile uint8_t s_AmplifierMaxBuffs  = 0;
 
-/* Used by SLN_AMP_WriteAudioNoWait to communicate with the async task.
- * Async task is created only once during the first call of SLN_AMP_WriteAudioNoWait. */
-static TaskHandle_t s_AudioNoWaitTaskHandle = NULL;
-static QueueHandle_t s_AudioNoWaitTaskQueue = NULL;
+/* Mixer output, played by the SAI DMA */
+SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
+          s_MixerSlots[AMP_WRITE_SLOTS][AMP_MIXER_SLOT_SMPL_COUNT], 32);
+
+/* For each scheduled slot, the channels whose last samples it holds and the Streamer buffers
+ * completely mixed in it. Both are released once the slot was played. */
+static uint8_t s_MixerSlotEnds[AMP_WRITE_SLOTS]          = {0};
+static uint8_t s_MixerSlotStreamerBuffs[AMP_WRITE_SLOTS] = {0};
+static uint8_t s_MixerSlotIdx                            = 0; /* Next slot to mix */
+static uint8_t s_MixerInFlight                           = 0; /* Slots scheduled and not played yet */
+
+/* Channels with audio queued, or mixed and not played yet. Bit n is channel n. */
+static uint8_t s_MixerBusyChannels = 0;
+
+/* Held while the mixer state above is used, by the mixer task and by the writers */
+static SemaphoreHandle_t s_MixerMutex = NULL;
 
-/* Used to manage the audio played by SLN_AMP_WriteAudioBlocking and SLN_AMP_WriteAudioNoWait. */
-static volatile bool s_AbortPlaying = false;
+/* Mixer task, woken by the writers when they queue audio and by SLN_AMP_TxCallback when a slot is played */
+static TaskHandle_t s_MixerTaskHandle = NULL;
+
+/* Idle state of the mixer channels */
+static EventGroupHandle_t s_AmplifierEvents = NULL;
 
 static codec_handle_t s_CodecHandle = {0};
 
@@ -111,10 +129,16 @@ static sai_edma_handle_t s_AmpTxHandle = {0};
 #if ENABLE_AEC
 #if USE_MQS
 static volatile loopback_state_t s_LoopbackState = kLoopbackEnabled;
-static ringbuf_t *s_AmpRxDataRingBuffer          = NULL;
 static volatile uint32_t s_PdmPcmTimestamp       = -1;
-static SemaphoreHandle_t s_LoopBackMutex         = NULL;
 static SemaphoreHandle_t s_LoopBackStateMutex    = NULL;
+
+/* Constant part of the loopback delay, AMP_LOOPBACK_CONST_DELAY_US or the calibrated one */
+static volatile uint32_t s_LoopbackConstDelayUs = AMP_LOOPBACK_CONST_DELAY_US;
+
+/* Amplifier data to be used as AEC reference, written by the amplifier and read by the mic task */
+static sln_amp_ring_t s_AmpLoopbackRing;
+SDK_ALIGN(static uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) s_AmpLoopbackRingData[AMP_LOOPBACK_RINGBUF_SIZE],
+          SLN_AMP_RING_CACHE_LINE);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -123,17 +147,23 @@ static SemaphoreHandle_t s_LoopBackStateMutex    = NULL;
  ******************************************************************************/
 
 static status_t SLN_AMP_TransferChunk(uint8_t *data, uint32_t length);
-static status_t SLN_AMP_WriteAudioPipeline(
-    uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash);
-static void SLN_AMP_PlayAudioAsyncTask(void *pvParameters);
+static status_t SLN_AMP_QueueAudio(
+    sln_amp_channel_t channel, uint8_t *data, uint32_t length, bool newSound, sln_amp_state_t state);
+static void SLN_AMP_ReleaseStreamerBuffs(uint8_t count);
+static void SLN_AMP_EndChannels(uint8_t streamerBuffs);
+static void SLN_AMP_CompleteSlots(void);
+static status_t SLN_AMP_WaitSlotsIdle(uint32_t timeoutMs);
+static void SLN_AMP_MixerTask(void *pvParameters);
 static void SLN_AMP_TxCallback(I2S_Type *base, sai_edma_handle_t *handle, status_t status, void *userData);
 #if USE_MQS
-static void SLN_AMP_VolAndDiffInputControl(void *data, uint32_t length);
+static int16_t SLN_AMP_GetVolumeGainQ15(void);
 #endif /* USE_MQS */
 
 #if ENABLE_AEC
 #if USE_MQS
 static void SLN_AMP_StartLoopbackTimer(void);
+static void SLN_AMP_SyncLoopback(void);
+static void SLN_AMP_WriteLoopback(const uint8_t *data, uint32_t length);
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -183,6 +213,22 @@ status_t SLN_AMP_Init(volatile uint8_t *extStreamerBuffsCnt)
         .sai_tx_callback   = SLN_AMP_TxCallback,
     };
 
+    if (ret == kStatus_Success)
+    {
+        s_MixerMutex      = xSemaphoreCreateMutex();
+        s_AmplifierEvents = xEventGroupCreate();
+        if ((s_MixerMutex == NULL) || (s_AmplifierEvents == NULL))
+        {
+            configPRINTF(("Failed to create the amplifier mixer signals\r\n"));
+            ret = kStatus_Fail;
+        }
+        else
+        {
+            SLN_AMP_MIXER_Init();
+            xEventGroupSetBits(s_AmplifierEvents, AMP_CHANNEL_IDLE_EVT_ALL);
+        }
+    }
+
     if (ret == kStatus_Success)
     {
         s_StreamerFreeBuffs = extStreamerBuffsCnt;
@@ -191,48 +237,33 @@ status_t SLN_AMP_Init(volatile uint8_t *extStreamerBuffsCnt)
             s_StreamerMaxBuffs  = *extStreamerBuffsCnt;
         }
 
-        /* BOARD_SAI_Init triggers a Transfer, wait for its end. */
-        s_AmplifierFreeBuffs = 0;
-        s_SlnAmpState        = kSlnAmpPlayBlocking;
+        /* BOARD_SAI_Init triggers a Transfer, wait for its end. The mixer task does not run yet. */
+        s_AmplifierFreeBuffs = AMP_WRITE_SLOTS - 1;
 
         BOARD_SAI_Init(saiInitHandle);
 
-        while (s_AmplifierFreeBuffs == 0)
+        ret = SLN_AMP_WaitSlotsIdle(AMP_SLOT_WAIT_MS);
+        if (ret != kStatus_Success)
         {
-            vTaskDelay(1);
+            configPRINTF(("Failed to start the amplifier SAI %d\r\n", ret));
         }
-        s_AmplifierFreeBuffs = 0;
-        s_SlnAmpState        = kSlnAmpIdle;
+    }
 
+    if (ret == kStatus_Success)
+    {
         ret = CODEC_Init(&s_CodecHandle, (codec_config_t *)BOARD_GetBoardCodecConfig());
     }
 #if ENABLE_AEC
 #if USE_MQS
     if (ret == kStatus_Success)
     {
-        s_AmpRxDataRingBuffer =
-            (ringbuf_t *)(((mqs_config_t *)(s_CodecHandle.codecConfig->codecDevConfig))->s_AmpRxDataRingBuffer);
-        if (s_AmpRxDataRingBuffer == NULL)
-        {
-            configPRINTF(("Failed to create s_AmpRxDataRingBuffer\r\n"));
-            ret = kStatus_Fail;
-        }
-    }
-
-    if (ret == kStatus_Success)
-    {
-        s_LoopBackMutex = xSemaphoreCreateMutex();
-        if (s_LoopBackMutex == NULL)
-        {
-            configPRINTF(("Failed to create s_LoopBackMutex\r\n"));
-            ret = kStatus_Fail;
-        }
+        SLN_AMP_RING_Init(&s_AmpLoopbackRing, s_AmpLoopbackRingData, sizeof(s_AmpLoopbackRingData));
     }
 
     if (ret == kStatus_Success)
     {
         s_LoopBackStateMutex = xSemaphoreCreateMutex();
-        if (s_LoopBackMutex == NULL)
+        if (s_LoopBackStateMutex == NULL)
         {
             configPRINTF(("Failed to create s_LoopBackStateMutex\r\n"));
             ret = kStatus_Fail;
@@ -246,215 +277,189 @@ status_t SLN_AMP_Init(volatile uint8_t *extStreamerBuffsCnt)
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
+    if (ret == kStatus_Success)
+    {
+        if (xTaskCreate(SLN_AMP_MixerTask, AMP_MIXER_TASK_NAME, AMP_MIXER_TASK_STACK_SIZE, NULL,
+                        AMP_MIXER_TASK_PRIORITY, &s_MixerTaskHandle) != pdPASS)
+        {
+            s_MixerTaskHandle = NULL;
+            configPRINTF(("Failed to create s_MixerTaskHandle\r\n"));
+
+            ret = kStatus_Fail;
+        }
+    }
+
     return ret;
 }
 
-status_t SLN_AMP_WriteAudioBlocking(uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash)
+status_t SLN_AMP_WriteAudioBlocking(uint8_t *data, uint32_t length)
 {
     status_t ret = kStatus_Success;
 
-    if ((data == NULL) || (length == 0) || (slotSize == 0) || (slotCnt == 0))
+    if ((data == NULL) || (length == 0))
     {
         ret = kStatus_Fail;
     }
 
-#if USE_MQS
-#if ENABLE_AEC
-    /* In order loopback to work on MQS, it is required that
-     * loopback ringbuffer has enough space to store scheduled to play audio data. */
+    /* If another prompt is playing, do not play this one. Audio on the other channels is mixed with it. */
     if (ret == kStatus_Success)
     {
-        if ((slotSize * slotCnt) > (AMP_WRITE_SLOTS * PCM_AMP_DATA_SIZE_20_MS))
-        {
-            ret = kStatus_Fail;
-        }
+        ret = SLN_AMP_QueueAudio(kSlnAmpChannelPrompt, data, length, true, kSlnAmpPlayBlocking);
     }
-#endif /* ENABLE_AEC */
-#endif /* USE_MQS */
 
     if (ret == kStatus_Success)
     {
-        /* If another audio is playing by SLN_AMP_WriteAudioNoWait or SLN_AMP_WriteStreamerNoWait,
-         * do not play the current chunk. */
-        if (s_SlnAmpState == kSlnAmpIdle)
-        {
-            s_SlnAmpState = kSlnAmpPlayBlocking;
-        }
-        else
-        {
-            ret = kStatus_Fail;
-        }
+        xEventGroupWaitBits(s_AmplifierEvents, AMP_WRITE_DONE_EVT, pdFALSE, pdTRUE, portMAX_DELAY);
     }
 
-    if (ret == kStatus_Success)
+    return ret;
+}
+
+status_t SLN_AMP_WriteAudioNoWait(uint8_t *data, uint32_t length)
+{
+    status_t ret = kStatus_Success;
+
+    if ((data == NULL) || (length == 0))
     {
-        ret = SLN_AMP_WriteAudioPipeline(data, length, slotSize, slotCnt, inFlash);
+        ret = kStatus_Fail;
+    }
 
-        s_SlnAmpState = kSlnAmpIdle;
+    /* If another prompt is playing, do not play this one. Audio on the other channels is mixed with it. */
+    if (ret == kStatus_Success)
+    {
+        ret = SLN_AMP_QueueAudio(kSlnAmpChannelPrompt, data, length, true, kSlnAmpPlayNonBlocking);
     }
 
     return ret;
 }
 
-status_t SLN_AMP_WriteAudioNoWait(uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash)
+status_t SLN_AMP_WriteChannelNoWait(sln_amp_channel_t channel, uint8_t *data, uint32_t length)
 {
-    status_t ret                   = kStatus_Success;
-    sln_amp_write_packet_t *packet = NULL;
+    status_t ret = kStatus_Success;
 
-    if ((data == NULL) || (length == 0) || (slotSize == 0) || (slotCnt == 0))
+    if ((channel >= kSlnAmpChannelCount) || (channel == kSlnAmpChannelStreamer) || (data == NULL) || (length == 0))
     {
         ret = kStatus_Fail;
     }
 
-#if USE_MQS
-#if ENABLE_AEC
-    /* In order loopback to work on MQS, it is required that
-     * loopback ringbuffer has enough space to store scheduled to play audio data. */
     if (ret == kStatus_Success)
     {
-        if ((slotSize * slotCnt) > (AMP_WRITE_SLOTS * PCM_AMP_DATA_SIZE_20_MS))
-        {
-            ret = kStatus_Fail;
-        }
+        ret = SLN_AMP_QueueAudio(channel, data, length, true, kSlnAmpPlayNonBlocking);
     }
-#endif /* ENABLE_AEC */
-#endif /* USE_MQS */
 
-    if (ret == kStatus_Success)
-    {
-        /* Async task queue is created only once during first call of SLN_AMP_WriteAudioNoWait. */
-        if (s_AudioNoWaitTaskQueue == NULL)
-        {
-            s_AudioNoWaitTaskQueue = xQueueCreate(1, sizeof(packet));
-            if (s_AudioNoWaitTaskQueue == NULL)
-            {
-                configPRINTF(("Failed to create s_AudioNoWaitTaskQueue\r\n"));
+    return ret;
+}
 
-                ret = kStatus_Fail;
-            }
-        }
+status_t SLN_AMP_WriteStreamerNoWait(uint8_t *data, uint32_t length)
+{
+    status_t ret = kStatus_Success;
+
+    if ((data == NULL) || (length == 0))
+    {
+        ret = kStatus_Fail;
     }
 
+    /* The buffer is returned to the Streamer once it was played */
     if (ret == kStatus_Success)
     {
-        /* Async task is created only once during the first call of SLN_AMP_WriteAudioNoWait. */
-        if (s_AudioNoWaitTaskHandle == NULL)
-        {
-            if (xTaskCreate(SLN_AMP_PlayAudioAsyncTask, PLAY_AUDIO_ASYNC_TASK_NAME, PLAY_AUDIO_ASYNC_TASK_STACK_SIZE,
-                            NULL, PLAY_AUDIO_ASYNC_TASK_PRIORITY, &s_AudioNoWaitTaskHandle) != pdPASS)
-            {
-                s_AudioNoWaitTaskHandle = NULL;
-                configPRINTF(("Failed to create s_AudioNoWaitTaskHandle\r\n"));
-
-                ret = kStatus_Fail;
-            }
-        }
+        ret = SLN_AMP_QueueAudio(kSlnAmpChannelStreamer, data, length, false, kSlnAmpStreamer);
     }
 
-    if (ret == kStatus_Success)
+    return ret;
+}
+
+void SLN_AMP_AbortWrite(void)
+{
+    if (s_MixerMutex == NULL)
     {
-        /* If another audio is playing by SLN_AMP_WriteAudioBlocking or SLN_AMP_WriteStreamerNoWait,
-         * do not play the current chunk. */
-        if (s_SlnAmpState == kSlnAmpIdle)
-        {
-            s_SlnAmpState = kSlnAmpPlayNonBlocking;
-        }
-        else
-        {
-            ret = kStatus_Fail;
-        }
+        return;
     }
 
-    if (ret == kStatus_Success)
+    xSemaphoreTake(s_MixerMutex, portMAX_DELAY);
+
+    SAI_TransferTerminateSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle);
+
+    for (uint32_t channel = 0; channel < kSlnAmpChannelCount; channel++)
     {
-        /* If PLAY_AUDIO_ASYNC_TASK_NAME will be created successfully, it will be responsible to free
-         * the memory allocated for packet (inside SLN_AMP_PlayAudioAsyncTask function).
-         * Otherwise, packet memory is freed at the end of the current function. */
-        packet = pvPortMalloc(sizeof(sln_amp_write_packet_t));
-        if (packet == NULL)
-        {
-            s_SlnAmpState = kSlnAmpIdle;
-            ret           = kStatus_Fail;
-        }
+        SLN_AMP_MIXER_Flush((sln_amp_channel_t)channel);
     }
 
-    if (ret == kStatus_Success)
+    /* The terminated transfers will not release their slots */
+    taskENTER_CRITICAL();
+    s_AmplifierFreeBuffs = AMP_WRITE_SLOTS;
+    if (s_StreamerFreeBuffs != NULL)
     {
-        packet->data     = data;
-        packet->length   = length;
-        packet->slotSize = slotSize;
-        packet->slotCnt  = slotCnt;
-        packet->inFlash  = inFlash;
+        *s_StreamerFreeBuffs = s_StreamerMaxBuffs;
+    }
+    taskEXIT_CRITICAL();
 
-        if (xQueueSendToBack(s_AudioNoWaitTaskQueue, &packet, 0) != pdTRUE)
-        {
-            vPortFree(packet);
-            s_SlnAmpState = kSlnAmpIdle;
-            ret           = kStatus_Fail;
-        }
+    memset(s_MixerSlotEnds, 0, sizeof(s_MixerSlotEnds));
+    memset(s_MixerSlotStreamerBuffs, 0, sizeof(s_MixerSlotStreamerBuffs));
+    s_MixerInFlight     = 0;
+    s_MixerBusyChannels = 0;
+    xEventGroupSetBits(s_AmplifierEvents, AMP_CHANNEL_IDLE_EVT_ALL | AMP_SLOTS_IDLE_EVT);
+
+    xSemaphoreGive(s_MixerMutex);
+}
+
+void SLN_AMP_AbortChannel(sln_amp_channel_t channel)
+{
+    uint32_t dropped = 0;
+
+    if ((s_MixerMutex == NULL) || (channel >= kSlnAmpChannelCount))
+    {
+        return;
     }
 
-    return ret;
+    /* The slots already scheduled are still played */
+    xSemaphoreTake(s_MixerMutex, portMAX_DELAY);
+    dropped = SLN_AMP_MIXER_Flush(channel);
+    SLN_AMP_EndChannels((channel == kSlnAmpChannelStreamer) ? (uint8_t)dropped : 0);
+    xSemaphoreGive(s_MixerMutex);
 }
 
-status_t SLN_AMP_WriteStreamerNoWait(uint8_t *data, uint32_t length)
+status_t SLN_AMP_WaitWriteDone(uint32_t timeoutMs)
 {
-    status_t ret = kStatus_Success;
+    return SLN_AMP_WaitChannelDone(kSlnAmpChannelPrompt, timeoutMs);
+}
 
-    if ((data == NULL) || (length == 0))
+status_t SLN_AMP_WaitChannelDone(sln_amp_channel_t channel, uint32_t timeoutMs)
+{
+    status_t ret     = kStatus_Success;
+    TickType_t ticks = portMAX_DELAY;
+    EventBits_t bits = 0;
+
+    if ((s_AmplifierEvents == NULL) || (channel >= kSlnAmpChannelCount))
     {
         ret = kStatus_Fail;
     }
 
     if (ret == kStatus_Success)
     {
-        /* If another audio is playing by SLN_AMP_WriteAudioBlocking or SLN_AMP_WriteAudioNoWait,
-         * do not play the current chunk. */
-        if ((s_SlnAmpState == kSlnAmpIdle) || (s_SlnAmpState == kSlnAmpStreamer))
+        if (timeoutMs != UINT32_MAX)
         {
-            s_SlnAmpState = kSlnAmpStreamer;
+            ticks = pdMS_TO_TICKS(timeoutMs);
         }
-        else
+
+        bits = xEventGroupWaitBits(s_AmplifierEvents, AMP_CHANNEL_IDLE_EVT(channel), pdFALSE, pdTRUE, ticks);
+        if ((bits & AMP_CHANNEL_IDLE_EVT(channel)) == 0)
         {
-            ret = kStatus_Fail;
+            ret = kStatus_Timeout;
         }
     }
 
-    /* Play ONLY the first chunk (max PCM_AMP_DMA_CHUNK_MAX_SIZE bytes) of the provided data. */
-    if (ret == kStatus_Success)
-    {
-        ret = SLN_AMP_TransferChunk(data, length);
-    }
-
     return ret;
 }
 
-void SLN_AMP_AbortWrite(void)
+void SLN_AMP_SetChannelGain(sln_amp_channel_t channel, uint8_t gain)
 {
-    SAI_TransferTerminateSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle);
-
-    if (s_AbortPlaying == false)
-    {
-        if ((s_SlnAmpState == kSlnAmpPlayBlocking) || (s_SlnAmpState == kSlnAmpPlayNonBlocking))
-        {
-            s_AbortPlaying = true;
-
-            while (1)
-            {
-                if (s_SlnAmpState == kSlnAmpIdle)
-                {
-                    break;
-                }
-                vTaskDelay(1);
-            }
+    /* Gain between 0 (mute) and 100 (unchanged) */
+    SLN_AMP_MIXER_SetGain(channel, (int16_t)((MIN(gain, 100U) * SLN_AMP_MIXER_GAIN_ONE) / 100U));
+}
 
-            s_AbortPlaying = false;
-        }
-        else
-        {
-            s_SlnAmpState = kSlnAmpIdle;
-        }
-    }
+void SLN_AMP_SetChannelDucking(sln_amp_channel_t channel, uint8_t priority, uint8_t duckGain)
+{
+    SLN_AMP_MIXER_SetDucking(channel, priority, (int16_t)((MIN(duckGain, 100U) * SLN_AMP_MIXER_GAIN_ONE) / 100U));
 }
 
 void SLN_AMP_SetVolume(uint8_t volume)
@@ -470,7 +475,27 @@ void *SLN_AMP_GetAmpTxHandler(void)
 
 sln_amp_state_t SLN_AMP_GetState(void)
 {
-    return s_SlnAmpState;
+    sln_amp_state_t state = kSlnAmpIdle;
+    EventBits_t bits      = AMP_CHANNEL_IDLE_EVT_ALL;
+    int32_t priority      = -1;
+
+    if (s_AmplifierEvents != NULL)
+    {
+        bits = xEventGroupGetBits(s_AmplifierEvents);
+    }
+
+    /* Report the playing channel which has the highest priority */
+    for (uint32_t channel = 0; channel < kSlnAmpChannelCount; channel++)
+    {
+        if (((bits & AMP_CHANNEL_IDLE_EVT(channel)) == 0) &&
+            ((int32_t)SLN_AMP_MIXER_GetPriority((sln_amp_channel_t)channel) > priority))
+        {
+            priority = SLN_AMP_MIXER_GetPriority((sln_amp_channel_t)channel);
+            state    = s_ChannelState[channel];
+        }
+    }
+
+    return state;
 }
 
 /*******************************************************************************
@@ -479,14 +504,9 @@ sln_amp_state_t SLN_AMP_GetState(void)
 
 #if ENABLE_AEC
 #if USE_MQS
-SemaphoreHandle_t SLN_AMP_GetLoopBackMutex(void)
+sln_amp_ring_t *SLN_AMP_GetRingBuffer(void)
 {
-    return s_LoopBackMutex;
-}
-
-ringbuf_t *SLN_AMP_GetRingBuffer(void)
-{
-    return s_AmpRxDataRingBuffer;
+    return &s_AmpLoopbackRing;
 }
 
 uint32_t SLN_AMP_GetTimestamp(void)
@@ -498,6 +518,17 @@ void SLN_AMP_UpdateTimestamp(uint32_t timestamp)
 {
     s_PdmPcmTimestamp = timestamp;
 }
+
+void SLN_AMP_SetLoopbackDelayUs(uint32_t delayUs)
+{
+    /* The loopback ringbuffer is sized for AMP_LOOPBACK_MAX_CONST_DELAY_US */
+    s_LoopbackConstDelayUs = MIN(delayUs, AMP_LOOPBACK_MAX_CONST_DELAY_US);
+}
+
+uint32_t SLN_AMP_GetLoopbackDelayUs(void)
+{
+    return s_LoopbackConstDelayUs;
+}
 #endif /* USE_MQS */
 
 void SLN_AMP_LoopbackEnable(void)
@@ -515,9 +546,7 @@ void SLN_AMP_LoopbackDisable(void)
     xSemaphoreTake(s_LoopBackStateMutex, portMAX_DELAY);
 
     /* Clear the loopback ringbuffer for a future clean start */
-    xSemaphoreTake(s_LoopBackMutex, portMAX_DELAY);
-    ringbuf_clear(s_AmpRxDataRingBuffer);
-    xSemaphoreGive(s_LoopBackMutex);
+    SLN_AMP_RING_Flush(&s_AmpLoopbackRing);
 
     s_LoopbackState = kLoopbackDisabled;
     xSemaphoreGive(s_LoopBackStateMutex);
@@ -530,17 +559,17 @@ void SLN_AMP_LoopbackDisable(void)
  ******************************************************************************/
 
 /**
- * @brief  Extract and start to play the first chunk of the provided audio.
+ * @brief  Start to play a slot of the mixer output.
  *         For MQS, also do:
  *         - Update the audio chunk according to the current volume.
  *         - Sync (if needed) chunk start play with PDM_to_PCM for a better loopback performance.
  *         - Keep loopback synced with PDM_to_PCM for a better loopback performance.
  *         - Write audio chunk into the loopback ringbuffer in order to be used for barge-in.
  *
- * @param  data Pointer to the audio data.
- * @param  length Length of the audio data.
+ * @param  data Pointer to the slot.
+ * @param  length Length of the slot, a multiple of 32 bytes.
  *
- * @return kStatus_Success if the audio was started to play.
+ * @return kStatus_Success if the slot was started to play.
  */
 static status_t SLN_AMP_TransferChunk(uint8_t *data, uint32_t length)
 {
@@ -552,57 +581,25 @@ static status_t SLN_AMP_TransferChunk(uint8_t *data, uint32_t length)
         status = kStatus_Fail;
     }
 
-    /* Prepare the first chunk (max PCM_AMP_DMA_CHUNK_MAX_SIZE bytes) of the provided data. */
     if (status == kStatus_Success)
     {
-        write_xfer.data = data;
+        write_xfer.data     = data;
+        write_xfer.dataSize = length;
 
-        /* Audio data should be less than PCM_AMP_DMA_CHUNK_MAX_SIZE and rounded to 32 */
-        if (length > PCM_AMP_DMA_CHUNK_MAX_SIZE)
-        {
-            write_xfer.dataSize = PCM_AMP_DMA_CHUNK_MAX_SIZE;
-        }
-        else
-        {
-            write_xfer.dataSize = length;
-        }
-        write_xfer.dataSize -= (write_xfer.dataSize % 32);
-
-        /* After write_xfer.dataSize is rounded to 32, it may become 0.
-         * In this case, don't play it, but act as this audio chunk was already played,
-         * call the callback to increase the slots number and return success. */
-        if (write_xfer.dataSize == 0)
-        {
-            SLN_AMP_TxCallback(NULL, NULL, kStatus_Success, NULL);
-        }
-    }
-
-    /* Play prepared audio chunk.
-     * After write_xfer.dataSize is rounded to 32, it may become 0.
-     * In this case, don't play any sound, but still return success. */
-    if ((status == kStatus_Success) && (write_xfer.dataSize > 0))
-    {
 #if USE_MQS
-        SLN_AMP_VolAndDiffInputControl(write_xfer.data, write_xfer.dataSize);
+        uint32_t profStart = AUDIO_PROFILER_GET_CYCLES();
 
-        /* Apply low pass filter for better quality of audio
+        /* Apply the volume and a low pass filter for better quality of audio
          * The output will be in differential format */
-        SLN_AMP_FirLowPassFilterForAMP((int16_t *)write_xfer.data, write_xfer.dataSize / 2);
+        SLN_AMP_GainAndFirLowPassForAMP((int16_t *)write_xfer.data, write_xfer.dataSize / 2,
+                                        SLN_AMP_GetVolumeGainQ15());
+        AUDIO_PROFILER_STOP(kAudioProfilerAmpTx, profStart);
 
 #if !ENABLE_AEC
         status = SAI_TransferSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle, &write_xfer);
 
 #else
-        uint16_t i               = 0;
-        uint8_t dummyZero        = 0;
-        uint32_t ringbufOcc      = 0;
-        uint32_t slnAmpTimestamp = 0;
-        uint32_t delayTicks      = 0;
-        uint32_t delayUs         = 0;
-        uint32_t delayBytes      = 0;
-
-        if ((s_LoopBackStateMutex == NULL) || (s_LoopBackMutex == NULL) || (s_AmpRxDataRingBuffer == NULL) ||
-            (s_PdmPcmTimestamp == -1))
+        if ((s_LoopBackStateMutex == NULL) || (s_AmpLoopbackRing.buffer == NULL) || (s_PdmPcmTimestamp == -1))
         {
             /* Loopback is not ready, just send the sound chunk to dma */
             status = SAI_TransferSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle, &write_xfer);
@@ -610,113 +607,15 @@ static status_t SLN_AMP_TransferChunk(uint8_t *data, uint32_t length)
         }
 
         /*
-         * In case of NOT being already synchronized, calculate the delay between the last Ping/Pong event and the
-         * current call. Add this delay as zeroes to the ringbuffer. After synchronization (if was needed), start the
-         * playback and place the playback data into the ringbuffer.
+         * The first chunk after a loopback enable was delayed by SLN_AMP_SyncLoopback. SLN_AMP_WriteLoopback
+         * calculates the delay between the last Ping/Pong event and the current call and adds it as zeroes
+         * to the ringbuffer, then the playback data is placed into the ringbuffer.
          */
         xSemaphoreTake(s_LoopBackStateMutex, portMAX_DELAY);
-        if (s_LoopbackState == kLoopbackNeedSync)
-        {
-            /* Give time to pdm_to_pcm_task to restart its activities */
-            vTaskDelay(AMP_LOOPBACK_START_DELAY_MS);
-
-            if ((s_SlnAmpState == kSlnAmpPlayBlocking) || (s_SlnAmpState == kSlnAmpPlayNonBlocking))
-            {
-                /* Wait for all the registered AMP packets to be played.
-                 * This is needed for a new synchronization to be performed after a loopback disable-enable. */
-                for (i = 0; i < AMP_LOOPBACK_NEW_SYNC_MAX_WAIT_MS; i++)
-                {
-                    if (s_AmplifierFreeBuffs == s_AmplifierMaxBuffs)
-                    {
-                        break;
-                    }
-                    vTaskDelay(1);
-                }
-            }
-            else
-            {
-                /* Wait for all the registered AMP packets to be played.
-                 * This is needed for a new synchronization to be performed after a loopback disable-enable. */
-                for (i = 0; i < AMP_LOOPBACK_NEW_SYNC_MAX_WAIT_MS; i++)
-                {
-                    if ((s_StreamerFreeBuffs != NULL) && ((*s_StreamerFreeBuffs) == s_StreamerMaxBuffs))
-                    {
-                        break;
-                    }
-                    vTaskDelay(1);
-                }
-            }
-
-            s_LoopbackState = kLoopbackEnabled;
-        }
-
-        if (s_LoopbackState == kLoopbackEnabled)
-        {
-            xSemaphoreTake(s_LoopBackMutex, portMAX_DELAY);
-
-            status = SAI_TransferSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle, &write_xfer);
-            if (status == kStatus_Success)
-            {
-                /* Check if the current packet is the first one of a playback session.
-                 * If it is the first packet, add delay data to the ringbuffer. */
-                ringbufOcc = ringbuf_get_occupancy(s_AmpRxDataRingBuffer);
-                if (ringbufOcc == 0)
-                {
-                    slnAmpTimestamp = GPT_GetCurrentTimerCount(AMP_LOOPBACK_GPT);
-
-                    /* Add the delay data in order to sync the microphones with the amplifier. */
-                    if (slnAmpTimestamp > s_PdmPcmTimestamp)
-                    {
-                        delayTicks = slnAmpTimestamp - s_PdmPcmTimestamp;
-                    }
-                    else
-                    {
-                        delayTicks = (UINT32_MAX - s_PdmPcmTimestamp) + slnAmpTimestamp;
-                    }
-
-                    delayUs = AMP_LOOPBACK_GPT_TICKS_TO_US(delayTicks) + AMP_LOOPBACK_CONST_DELAY_US;
-
-                    /* Delay in bytes should be multiple of 4. Number 4 is selected because it is needed
-                     * to keep samples grouped by 2(positive and negative) and one sample is an int16 (on 2 bytes). */
-                    delayBytes = (delayUs * PCM_AMP_DATA_SIZE_1_MS) / 1000;
-                    delayBytes = delayBytes - (delayBytes % 4);
-
-                    if (delayBytes > AMP_LOOPBACK_MAX_DELAY_BYTES)
-                    {
-                        /* Should not happen, but better safe */
-                        configPRINTF(
-                            ("WARNING: loopback desync of %d packets\r\n",
-                             delayBytes - (AMP_LOOPBACK_MAX_DELAY_BYTES - (AMP_LOOPBACK_MAX_DELAY_BYTES % 4))));
-                        delayBytes = AMP_LOOPBACK_MAX_DELAY_BYTES - (AMP_LOOPBACK_MAX_DELAY_BYTES % 4);
-                    }
-
-                    for (i = 0; i < delayBytes; i++)
-                    {
-                        ringbuf_write(s_AmpRxDataRingBuffer, &dummyZero, 1);
-                    }
-
-                    ringbufOcc = delayBytes;
-                }
-
-                /* Place the data in the ringbuffer. This data will be used for barge-in.
-                 * It should not happen, but skip the packet if the ring buffer is full. */
-                if (ringbufOcc + write_xfer.dataSize <= AMP_LOOPBACK_RINGBUF_SIZE)
-                {
-                    ringbuf_write(s_AmpRxDataRingBuffer, write_xfer.data, write_xfer.dataSize);
-                }
-                else
-                {
-                    configPRINTF(
-                        ("Failed to write data to the loopback ringbuffer. data length = %d, free space = %d\r\n",
-                         write_xfer.dataSize, AMP_LOOPBACK_RINGBUF_SIZE - ringbufOcc));
-                }
-            }
-
-            xSemaphoreGive(s_LoopBackMutex);
-        }
-        else
+        status = SAI_TransferSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle, &write_xfer);
+        if ((status == kStatus_Success) && (s_LoopbackState == kLoopbackEnabled))
         {
-            status = SAI_TransferSendEDMA(BOARD_AMP_SAI, &s_AmpTxHandle, &write_xfer);
+            SLN_AMP_WriteLoopback(write_xfer.data, write_xfer.dataSize);
         }
 
         xSemaphoreGive(s_LoopBackStateMutex);
@@ -728,163 +627,260 @@ static status_t SLN_AMP_TransferChunk(uint8_t *data, uint32_t length)
 }
 
 /**
- * @brief  Play the audio in a blocking manner using an internal simple Streamer which has a pool
- *         of buffers and use them in a pipeline manner.
- *         This function will exit with success only after the whole audio is played
- *         or the play was aborted (by calling SLN_AMP_AbortWrite).
- *         NOTE: For MQS, if the data is in flash, it is mandatory to pass inFlash as true.
- *               For TFA, inFlash parameter has no effect.
- *         NOTE: For MQS, if the data is in flash, this function
- *               will need to allocate (slotSize * slotCnt) memory in RAM.
- *         NOTE: This function assumes that no other audio is already playing.
+ * @brief  Queue audio on a mixer channel and wake up the mixer.
  *
- * @param  data Pointer to the audio data stored in RAM or Flash.
+ * @param  channel Mixer channel.
+ * @param  data Pointer to the audio data, read in place until it was mixed.
  * @param  length Length of the audio data.
- * @param  slotSize Size of a chunk of audio to be scheduled to play. Recommended: OPTIMAL_AMP_SLOT_SIZE.
- * @param  slotCnt Number of slots in the amplifier pool. Recommended: 2 or more. Optimal: OPTIMAL_AMP_SLOT_CNT.
- * @param  inFlash Is the data stored in flash? For TFA has no effect. For MQS, provide TRUE if the data is in Flash.
+ * @param  newSound True to start a new sound, which fails if the channel is still playing.
+ *                  False to append to the sound playing on the channel.
+ * @param  state State reported by SLN_AMP_GetState while the channel plays.
  *
- * @return kStatus_Success if the audio was played or aborted (by calling SLN_AMP_AbortWrite).
+ * @return kStatus_Success if the audio was queued.
  */
-static status_t SLN_AMP_WriteAudioPipeline(
-    uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash)
+static status_t SLN_AMP_QueueAudio(
+    sln_amp_channel_t channel, uint8_t *data, uint32_t length, bool newSound, sln_amp_state_t state)
 {
-    status_t ret             = kStatus_Success;
-    uint32_t soundDataPlayed = 0;
-    uint32_t packetSize      = 0;
-    bool copyBuf             = false;
-
-    uint8_t slotPoolIdx = 0;
-    uint8_t *slotPools  = NULL;
+    status_t ret = kStatus_Success;
 
-    if ((data == NULL) || (length == 0) || (slotSize == 0) || (slotCnt == 0))
+    if ((s_MixerMutex == NULL) || (s_MixerTaskHandle == NULL))
     {
         ret = kStatus_Fail;
     }
 
     if (ret == kStatus_Success)
     {
-#if USE_MQS
-        /* For MQS, we cannot play data directly from flash, because we need to modify
-         * the data according to the set volume. Copy the data into RAM. */
-        if (inFlash)
+        xSemaphoreTake(s_MixerMutex, portMAX_DELAY);
+
+        /* The channel plays until its last slot was played, not only until its audio was mixed */
+        if (newSound && ((xEventGroupGetBits(s_AmplifierEvents) & AMP_CHANNEL_IDLE_EVT(channel)) == 0))
         {
-            copyBuf = true;
+            ret = kStatus_Fail;
         }
-#endif /* USE_MQS */
-
-        if (copyBuf)
+        else if (!SLN_AMP_MIXER_Queue(channel, data, length))
         {
-            slotPools = pvPortMalloc(slotSize * slotCnt);
-            if (slotPools == NULL)
-            {
-                ret = kStatus_Fail;
-            }
+            ret = kStatus_Fail;
+        }
+        else
+        {
+            s_ChannelState[channel] = state;
+            s_MixerBusyChannels |= (uint8_t)(1U << channel);
+            xEventGroupClearBits(s_AmplifierEvents, AMP_CHANNEL_IDLE_EVT(channel));
         }
+
+        xSemaphoreGive(s_MixerMutex);
     }
 
     if (ret == kStatus_Success)
     {
-        s_AmplifierMaxBuffs  = slotCnt;
-        s_AmplifierFreeBuffs = slotCnt;
+        xTaskNotifyGive(s_MixerTaskHandle);
+    }
 
-        /* Block until the entire audio is scheduled to be played. */
-        while ((ret == kStatus_Success) && (soundDataPlayed < length) && (s_AbortPlaying == false))
-        {
-            /* In case there is an empty slot, send a new packet to the Amplifier */
-            if (s_AmplifierFreeBuffs > 0)
-            {
-                if (length - soundDataPlayed >= slotSize)
-                {
-                    packetSize = slotSize;
-                }
-                else
-                {
-                    packetSize = length - soundDataPlayed;
-                }
-
-                if (copyBuf)
-                {
-                    /* MQS requires the data to be in RAM, so copy it in case original data is in flash. */
-                    memcpy(&slotPools[slotPoolIdx * slotSize], &data[soundDataPlayed], packetSize);
-
-                    ret = SLN_AMP_TransferChunk(&slotPools[slotPoolIdx * slotSize], packetSize);
-                }
-                else
-                {
-                    ret = SLN_AMP_TransferChunk(&data[soundDataPlayed], packetSize);
-                }
-
-                if (ret == kStatus_Success)
-                {
-                    s_AmplifierFreeBuffs--;
-
-                    slotPoolIdx = (slotPoolIdx + 1) % slotCnt;
-                    soundDataPlayed += packetSize;
-                }
-            }
+    return ret;
+}
+
+/**
+ * @brief  Give buffers back to the Streamer.
+ *
+ * @param  count Number of buffers.
+ */
+static void SLN_AMP_ReleaseStreamerBuffs(uint8_t count)
+{
+    if ((s_StreamerFreeBuffs != NULL) && (count > 0))
+    {
+        taskENTER_CRITICAL();
+        *s_StreamerFreeBuffs = MIN(*s_StreamerFreeBuffs + count, s_StreamerMaxBuffs);
+        taskEXIT_CRITICAL();
+    }
+}
 
-            vTaskDelay(1);
+/**
+ * @brief  Find the busy channels which have nothing queued anymore. They become idle once the last slot
+ *         scheduled was played, or right away if no slot is playing. Called with s_MixerMutex taken.
+ *
+ * @param  streamerBuffs Streamer buffers mixed or dropped since the last call, released the same way.
+ */
+static void SLN_AMP_EndChannels(uint8_t streamerBuffs)
+{
+    uint8_t ended  = 0;
+    uint8_t newest = 0;
+
+    for (uint32_t channel = 0; channel < kSlnAmpChannelCount; channel++)
+    {
+        if (((s_MixerBusyChannels & (1U << channel)) != 0) &&
+            (SLN_AMP_MIXER_GetQueued((sln_amp_channel_t)channel) == 0))
+        {
+            ended |= (uint8_t)(1U << channel);
         }
+    }
+    s_MixerBusyChannels &= (uint8_t)~ended;
 
-        /* Wait for the last scheduled packets to be played. */
-        while ((s_AmplifierFreeBuffs != s_AmplifierMaxBuffs) && (s_AbortPlaying == false))
+    if (s_MixerInFlight > 0)
+    {
+        newest = (s_MixerSlotIdx + AMP_WRITE_SLOTS - 1) % AMP_WRITE_SLOTS;
+        s_MixerSlotEnds[newest] |= ended;
+        s_MixerSlotStreamerBuffs[newest] += streamerBuffs;
+    }
+    else
+    {
+        SLN_AMP_ReleaseStreamerBuffs(streamerBuffs);
+        if (ended != 0)
         {
-            vTaskDelay(1);
+            xEventGroupSetBits(s_AmplifierEvents, ended);
         }
+    }
+}
 
-        s_AmplifierMaxBuffs  = 0;
-        s_AmplifierFreeBuffs = 0;
+/**
+ * @brief  Release what the slots played since the last call were holding. Slots are played in the order
+ *         they were scheduled. Called with s_MixerMutex taken.
+ */
+static void SLN_AMP_CompleteSlots(void)
+{
+    uint8_t inFlight      = AMP_WRITE_SLOTS - s_AmplifierFreeBuffs;
+    uint8_t oldest        = 0;
+    uint8_t ended         = 0;
+    uint8_t streamerBuffs = 0;
+
+    while (s_MixerInFlight > inFlight)
+    {
+        oldest = (s_MixerSlotIdx + AMP_WRITE_SLOTS - s_MixerInFlight) % AMP_WRITE_SLOTS;
+        ended |= s_MixerSlotEnds[oldest];
+        streamerBuffs += s_MixerSlotStreamerBuffs[oldest];
+
+        s_MixerSlotEnds[oldest]          = 0;
+        s_MixerSlotStreamerBuffs[oldest] = 0;
+        s_MixerInFlight--;
     }
 
-    if (copyBuf)
+    SLN_AMP_ReleaseStreamerBuffs(streamerBuffs);
+
+    /* A channel which got a new sound meanwhile is still playing */
+    ended &= (uint8_t)~s_MixerBusyChannels;
+    if (ended != 0)
+    {
+        xEventGroupSetBits(s_AmplifierEvents, ended);
+    }
+}
+
+/**
+ * @brief  Wait for all the slots scheduled to be played. Called without s_MixerMutex taken,
+ *         by the only task which schedules slots.
+ *
+ * @param  timeoutMs Longest wait.
+ *
+ * @return kStatus_Success if no slot is playing anymore, kStatus_Timeout otherwise.
+ */
+static status_t SLN_AMP_WaitSlotsIdle(uint32_t timeoutMs)
+{
+    status_t ret       = kStatus_Success;
+    TickType_t start   = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeoutMs);
+    TickType_t elapsed = 0;
+
+    while (s_AmplifierFreeBuffs < AMP_WRITE_SLOTS)
     {
-        vPortFree(slotPools);
+        elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout)
+        {
+            ret = kStatus_Timeout;
+            break;
+        }
+
+        /* The event may be left from an earlier wait, the counter tells if the slots are played */
+        xEventGroupWaitBits(s_AmplifierEvents, AMP_SLOTS_IDLE_EVT, pdTRUE, pdTRUE, timeout - elapsed);
     }
 
     return ret;
 }
 
 /**
- * @brief  Play the audio in a blocking manner.
- *         This is the core function for the Play_Audio_Async_Task created
- *         by calling SLN_AMP_WriteAudioNoWait to play audio from a separate task.
+ * @brief  Mixer task, the only writer of the SAI. While a channel has audio queued and a slot is free,
+ *         mix the channels into the slot and schedule it. Sleep when there is nothing to mix.
  *
- * @param  pvParameters Information about the audio to be played.
+ * @param  pvParameters Not used.
  */
-static void SLN_AMP_PlayAudioAsyncTask(void *pvParameters)
+static void SLN_AMP_MixerTask(void *pvParameters)
 {
-    status_t status                = kStatus_Success;
-    sln_amp_write_packet_t *packet = NULL;
+    uint8_t released[kSlnAmpChannelCount] = {0};
+    int16_t *slot                         = NULL;
+    status_t status                       = kStatus_Success;
+    bool queued                           = false;
+    bool mixed                            = false;
 
     while (1)
     {
-        xQueueReceive(s_AudioNoWaitTaskQueue, &packet, portMAX_DELAY);
+#if ENABLE_AEC
+#if USE_MQS
+        /* May sleep until the slots are played, so it runs before s_MixerMutex is taken */
+        SLN_AMP_SyncLoopback();
+#endif /* USE_MQS */
+#endif /* ENABLE_AEC */
+
+        xSemaphoreTake(s_MixerMutex, portMAX_DELAY);
+
+        SLN_AMP_CompleteSlots();
+
+        queued = false;
+        for (uint32_t channel = 0; channel < kSlnAmpChannelCount; channel++)
+        {
+            queued |= (SLN_AMP_MIXER_GetQueued((sln_amp_channel_t)channel) > 0);
+        }
+
+        mixed = (queued && (s_AmplifierFreeBuffs > 0));
 
-        if (packet == NULL)
+#if ENABLE_AEC
+#if USE_MQS
+        /* The loopback was enabled after SLN_AMP_SyncLoopback ran, sync before the next slot */
+        if (mixed && (s_LoopbackState == kLoopbackNeedSync))
         {
-            configPRINTF(("[ERROR] SLN_AMP_PlayAudioAsyncTask received empty packet\r\n"));
+            xSemaphoreGive(s_MixerMutex);
             continue;
         }
+#endif /* USE_MQS */
+#endif /* ENABLE_AEC */
 
-        status = SLN_AMP_WriteAudioPipeline(packet->data, packet->length, packet->slotSize, packet->slotCnt,
-                                         packet->inFlash);
-        if (status != kStatus_Success)
+        if (mixed)
         {
-            configPRINTF(("[ERROR] SLN_AMP_PlayAudioAsyncTask failed %d\r\n", status));
+            memset(released, 0, sizeof(released));
+            slot = s_MixerSlots[s_MixerSlotIdx];
+
+            SLN_AMP_MIXER_Mix(slot, AMP_MIXER_SLOT_SMPL_COUNT, released);
+
+            status = SLN_AMP_TransferChunk((uint8_t *)slot, AMP_MIXER_SLOT_SMPL_COUNT * sizeof(int16_t));
+            if (status == kStatus_Success)
+            {
+                /* SLN_AMP_TxCallback increments the counter from the DMA interrupt */
+                taskENTER_CRITICAL();
+                s_AmplifierFreeBuffs--;
+                taskEXIT_CRITICAL();
+
+                s_MixerSlotIdx = (s_MixerSlotIdx + 1) % AMP_WRITE_SLOTS;
+                s_MixerInFlight++;
+            }
+            else
+            {
+                configPRINTF(("[ERROR] SLN_AMP_MixerTask failed to play a slot %d\r\n", status));
+            }
+
+            SLN_AMP_EndChannels(released[kSlnAmpChannelStreamer]);
         }
 
-        vPortFree(packet);
-        packet = NULL;
+        xSemaphoreGive(s_MixerMutex);
 
-        s_SlnAmpState = kSlnAmpIdle;
+        if (!mixed)
+        {
+            /* Woken by new audio or by a played slot. With nothing queued and nothing playing, only new audio can wake it. */
+            ulTaskNotifyTake(pdTRUE, (queued || (s_MixerInFlight > 0)) ? pdMS_TO_TICKS(AMP_SLOT_WAIT_MS) : portMAX_DELAY);
+        }
     }
 }
 
 /**
  * @brief  Callback triggered when AMP TX (audio chunk played) previously scheduled by:
  *         SLN_AMP_TransferChunk -> SAI_TransferSendEDMA;
- *         Increase the number of available buffers in the pool.
+ *         Increase the number of free slots and wake up the mixer.
+ *         Set AMP_SLOTS_IDLE_EVT once no slot is playing anymore.
  *
  * @param  base
  * @param  handle
@@ -893,64 +889,35 @@ static void SLN_AMP_PlayAudioAsyncTask(void *pvParameters)
  */
 static void SLN_AMP_TxCallback(I2S_Type *base, sai_edma_handle_t *handle, status_t status, void *userData)
 {
-    switch (s_SlnAmpState)
-    {
-        case kSlnAmpIdle:
-            /* Streamer play was aborted. Do nothing. Streamer will handle it. */
-            break;
-
-        case kSlnAmpStreamer:
-            /* Increase external free buffers count.
-             * Audio should have been scheduled to play by SLN_AMP_WriteStreamerNoWait.
-             * Used by the Streamer. */
-            if (s_StreamerFreeBuffs != NULL)
-            {
-                (*s_StreamerFreeBuffs)++;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-                if (*s_StreamerFreeBuffs == s_StreamerMaxBuffs)
-                {
-                    s_SlnAmpState = kSlnAmpIdle;
-                }
-            }
-            else
-            {
-                s_SlnAmpState = kSlnAmpIdle;
-            }
-            break;
+    s_AmplifierFreeBuffs++;
 
-        case kSlnAmpPlayBlocking:
-        case kSlnAmpPlayNonBlocking:
-            /* Increase internal free buffers count.
-             * Audio should have been scheduled to play by SLN_AMP_WriteAudioBlocking or SLN_AMP_WriteAudioNoWait.
-             * Used by the Amplifier's SLN_AMP_WriteAudioBlocking and SLN_AMP_WriteAudioNoWait. */
-            s_AmplifierFreeBuffs++;
-            break;
+    if (s_AmplifierFreeBuffs == AMP_WRITE_SLOTS)
+    {
+        xEventGroupSetBitsFromISR(s_AmplifierEvents, AMP_SLOTS_IDLE_EVT, &xHigherPriorityTaskWoken);
+    }
 
-        default:
-            break;
+    if (s_MixerTaskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(s_MixerTaskHandle, &xHigherPriorityTaskWoken);
     }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 #if USE_MQS
 /**
- * @brief  Adjust the data according to the previously set volume.
+ * @brief  Get the previously set volume as a Q15 gain.
  *
- * @param  data Data to be adjusted.
- * @param  length Length of data to be adjusted.
+ * @return The volume gain, between 0 and 32767.
  */
-static void SLN_AMP_VolAndDiffInputControl(void *data, uint32_t length)
+static int16_t SLN_AMP_GetVolumeGainQ15(void)
 {
-    uint32_t i;
-    int16_t *data16 = (int16_t *)data;
-    float volume    = ((mqs_config_t *)(s_CodecHandle.codecConfig->codecDevConfig))->volume;
-    uint32_t len16  = length / sizeof(int16_t);
+    float volume = ((mqs_config_t *)(s_CodecHandle.codecConfig->codecDevConfig))->volume;
 
-    for (i = 0; i < len16 - 1; i += 2)
-    {
-        /* The volume is decreased by multiplying the samples with values between 0 and 1 */
-        data16[i]     = (int16_t)(data16[i] * volume);
-        data16[i + 1] = -data16[i];
-    }
+    /* The volume is a value between 0 and 1 */
+    return (int16_t)(volume * 32767.0f);
 }
 #endif /* USE_MQS */
 
@@ -984,6 +951,119 @@ static void SLN_AMP_StartLoopbackTimer(void)
     GPT_StartTimer(AMP_LOOPBACK_GPT);
 #endif /* SLN_TRACE_CPU_USAGE */
 }
+
+/**
+ * @brief  After a loopback enable, delay the next slot so that a new synchronization with PDM_to_PCM
+ *         is performed: give time to the pdm_to_pcm_task to restart its activities,
+ *         and wait for the slots already scheduled to be played.
+ *         Called by the mixer task without s_MixerMutex or s_LoopBackStateMutex taken, the writers
+ *         and SLN_AMP_LoopbackDisable are not blocked meanwhile.
+ */
+static void SLN_AMP_SyncLoopback(void)
+{
+    if ((s_LoopBackStateMutex == NULL) || (s_LoopbackState != kLoopbackNeedSync))
+    {
+        return;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(AMP_LOOPBACK_START_DELAY_MS));
+
+    if (SLN_AMP_WaitSlotsIdle(AMP_LOOPBACK_NEW_SYNC_MAX_WAIT_MS) != kStatus_Success)
+    {
+        configPRINTF(("WARNING: loopback sync with slots still playing\r\n"));
+    }
+
+    /* A loopback disable meanwhile wins, a new enable was just served */
+    xSemaphoreTake(s_LoopBackStateMutex, portMAX_DELAY);
+    if (s_LoopbackState == kLoopbackNeedSync)
+    {
+        s_LoopbackState = kLoopbackEnabled;
+    }
+    xSemaphoreGive(s_LoopBackStateMutex);
+}
+
+/**
+ * @brief  Write a chunk which just started to play into the loopback ringbuffer, to be used for barge-in.
+ *         If it is the first chunk of a playback session, add before it the zeroes which sync
+ *         the amplifier with the microphones.
+ *         The ringbuffer is not locked: the data is staged, then published only if the mic task did not
+ *         read the ringbuffer (and move its Ping/Pong time stamp) in the meantime. Otherwise it is staged again.
+ *
+ * @param  data Pointer to the audio chunk.
+ * @param  length Length of the audio chunk.
+ */
+static void SLN_AMP_WriteLoopback(const uint8_t *data, uint32_t length)
+{
+    uint32_t pdmPcmTimestamp = 0;
+    uint32_t slnAmpTimestamp = 0;
+    uint32_t delayTicks      = 0;
+    uint32_t delayUs         = 0;
+    uint32_t delayBytes      = 0;
+    bool published           = false;
+
+    while (!published)
+    {
+        pdmPcmTimestamp = s_PdmPcmTimestamp;
+
+        /* Check if the current packet is the first one of a playback session.
+         * If it is the first packet, add delay data to the ringbuffer. */
+        if (SLN_AMP_RING_GetFill(&s_AmpLoopbackRing) == 0)
+        {
+            slnAmpTimestamp = GPT_GetCurrentTimerCount(AMP_LOOPBACK_GPT);
+
+            /* Add the delay data in order to sync the microphones with the amplifier. */
+            if (slnAmpTimestamp > pdmPcmTimestamp)
+            {
+                delayTicks = slnAmpTimestamp - pdmPcmTimestamp;
+            }
+            else
+            {
+                delayTicks = (UINT32_MAX - pdmPcmTimestamp) + slnAmpTimestamp;
+            }
+
+            delayUs = AMP_LOOPBACK_GPT_TICKS_TO_US(delayTicks) + s_LoopbackConstDelayUs;
+
+            /* Delay in bytes should be multiple of 4. Number 4 is selected because it is needed
+             * to keep samples grouped by 2(positive and negative) and one sample is an int16 (on 2 bytes). */
+            delayBytes = (delayUs * PCM_AMP_DATA_SIZE_1_MS) / 1000;
+            delayBytes = delayBytes - (delayBytes % 4);
+
+            if (delayBytes > AMP_LOOPBACK_MAX_DELAY_BYTES)
+            {
+                /* Should not happen, but better safe */
+                configPRINTF(("WARNING: loopback desync of %d packets\r\n",
+                              delayBytes - (AMP_LOOPBACK_MAX_DELAY_BYTES - (AMP_LOOPBACK_MAX_DELAY_BYTES % 4))));
+                delayBytes = AMP_LOOPBACK_MAX_DELAY_BYTES - (AMP_LOOPBACK_MAX_DELAY_BYTES % 4);
+            }
+
+            SLN_AMP_RING_WriteZeros(&s_AmpLoopbackRing, delayBytes);
+        }
+
+        /* Place the data in the ringbuffer. This data will be used for barge-in.
+         * It should not happen, but skip the packet if the ring buffer is full. */
+        if (!SLN_AMP_RING_Write(&s_AmpLoopbackRing, data, length))
+        {
+            configPRINTF(("Failed to write data to the loopback ringbuffer. data length = %d, free space = %d\r\n",
+                          length, SLN_AMP_RING_GetFree(&s_AmpLoopbackRing)));
+        }
+
+        /* The mic task updates its time stamp right before reading, so an unchanged time stamp means
+         * the fill level and the delay used above are still valid. Only the check and the index update
+         * are done with the scheduler locked, the mic task never waits for the copy. */
+        taskENTER_CRITICAL();
+        if (pdmPcmTimestamp == s_PdmPcmTimestamp)
+        {
+            SLN_AMP_RING_CommitAt(&s_AmpLoopbackRing, GPT_GetCurrentTimerCount(AMP_LOOPBACK_GPT));
+            published = true;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!published)
+        {
+            SLN_AMP_RING_Discard(&s_AmpLoopbackRing);
+        }
+    }
+}
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 #endif /* ENABLE_AMPLIFIER */
@@ -13,13 +13,13 @@
 #include <stdbool.h>
 
 #include "sln_mic_config.h"
+#include "sln_amp_mixer.h"
 
 #if ENABLE_AEC
 #include "FreeRTOS.h"
 #include "event_groups.h"
 #if USE_MQS
-#include "semphr.h"
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #endif /* USE_MQS */
 #endif /* ENABLE_AEC */
 
@@ -27,16 +27,14 @@
  * Definitions
  ******************************************************************************/
 
-/* Default values for a Streamer pipeline approach:
- * A pool of 4 buffers. Each buffer has 1920 Bytes (20 ms). */
+/* The mixer plays its output in a pool of 4 slots. Each slot has 1920 Bytes (20 ms). */
 #define DEFAULT_AMP_SLOT_SIZE PCM_AMP_DATA_SIZE_20_MS
-#define DEFAULT_AMP_SLOT_CNT  AMP_WRITE_SLOTS
 
 typedef enum _sln_amp_state
 {
     kSlnAmpIdle,            /* Not playing */
     kSlnAmpPlayBlocking,    /* Playing in a blocking mode (SLN_AMP_WriteAudioBlocking). */
-    kSlnAmpPlayNonBlocking, /* Playing in a dedicated Amplifier task (SLN_AMP_WriteAudioNoWait). */
+    kSlnAmpPlayNonBlocking, /* Playing without waiting (SLN_AMP_WriteAudioNoWait or SLN_AMP_WriteChannelNoWait). */
     kSlnAmpStreamer,        /* Playing driven by an external Streamer (SLN_AMP_WriteStreamerNoWait). */
 } sln_amp_state_t;
 
@@ -60,76 +58,119 @@ extern "C" {
 status_t SLN_AMP_Init(volatile uint8_t *extStreamerBuffsCnt);
 
 /**
- * @brief  Play the audio in a blocking manner using an internal simple Streamer which has a pool
- *         of buffers and use them in a pipeline manner.
+ * @brief  Play the audio on the kSlnAmpChannelPrompt mixer channel in a blocking manner.
  *         This function will exit with success only after the whole audio is played
  *         or the play was aborted (by calling SLN_AMP_AbortWrite).
- *         If another audio is already playing, this call will return fail.
- *         NOTE: For MQS, if the data is in flash, it is mandatory to pass inFlash as true.
- *               For TFA, inFlash parameter has no effect.
- *         NOTE: For MQS, if the data is in flash, this function
- *               will need to allocate (slotSize * slotCnt) memory in RAM.
- *         NOTE: For MQS with loopback, (slotSize * slotCnt) should not
- *               exceed (AMP_WRITE_SLOTS * PCM_AMP_DATA_SIZE_20_MS).
+ *         If another prompt is already playing, this call will return fail.
+ *         Audio played on the other mixer channels is mixed with this one.
+ *         NOTE: The mixer reads the data in place, it can be stored in RAM or Flash.
  *
  * @param  data Pointer to the audio data stored in RAM or Flash.
  * @param  length Length of the audio data.
- * @param  slotSize Size of a chunk of audio to be scheduled to play. Example: DEFAULT_AMP_SLOT_SIZE.
- * @param  slotCnt Number of slots in the amplifier pool. Recommended: 2 or more. Example: DEFAULT_AMP_SLOT_CNT.
- * @param  inFlash Is the data stored in flash? For TFA has no effect. For MQS, provide TRUE if the data is in Flash.
  *
  * @return kStatus_Success if the audio was played or aborted (by calling SLN_AMP_AbortWrite).
  */
-status_t SLN_AMP_WriteAudioBlocking(uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash);
+status_t SLN_AMP_WriteAudioBlocking(uint8_t *data, uint32_t length);
 
 /**
- * @brief  Create Play_Audio_Async_Task task to play the audio asynchronously.
- *         Play_Audio_Async_Task will play the audio in a blocking manner (exactly as SLN_AMP_WriteAudioBlocking).
- *         After the audio is played or aborted (by calling SLN_AMP_AbortWrite), Play_Audio_Async_Task will auto delete.
- *         Play_Audio_Async_Task can be stopped in advance by calling SLN_AMP_AbortWrite.
- *         If another audio is already playing, this call will return fail.
- *         NOTE: For MQS, if the data is in flash, it is mandatory to pass inFlash as true.
- *               For TFA, inFlash parameter has no effect.
- *         NOTE: For MQS, if the data is in flash, this function
- *               will need to allocate (slotSize * slotCnt) memory in RAM.
- *         NOTE: For MQS with loopback, (slotSize * slotCnt) should not
- *               exceed (AMP_WRITE_SLOTS * PCM_AMP_DATA_SIZE_20_MS).
- *         NOTE: SLN_AMP_WriteAudioNoWait is an asynchronous function,
- *               it will exit immediately after Play_Audio_Async_Task is created
- *               (will not wait the audio to be played).
+ * @brief  Play the audio on the kSlnAmpChannelPrompt mixer channel asynchronously.
+ *         The function exits immediately, the data must stay valid until the audio is played
+ *         (SLN_AMP_WaitWriteDone) or aborted (SLN_AMP_AbortWrite).
+ *         If another prompt is already playing, this call will return fail.
+ *         Audio played on the other mixer channels is mixed with this one.
+ *         NOTE: The mixer reads the data in place, it can be stored in RAM or Flash.
  *
  * @param  data Pointer to the audio data stored in RAM or Flash.
  * @param  length Length of the audio data.
- * @param  slotSize Size of a chunk of audio to be scheduled to play. Example: DEFAULT_AMP_SLOT_SIZE.
- * @param  slotCnt Number of slots in the amplifier pool. Recommended: 2 or more. Example: DEFAULT_AMP_SLOT_CNT.
- * @param  inFlash Is the data stored in flash? For TFA has no effect. For MQS, provide TRUE if the data is in Flash.
  *
- * @return kStatus_Success if the Play_Audio_Async_Task was created successfully.
+ * @return kStatus_Success if the audio was queued to the mixer.
  */
-status_t SLN_AMP_WriteAudioNoWait(uint8_t *data, uint32_t length, uint32_t slotSize, uint8_t slotCnt, bool inFlash);
+status_t SLN_AMP_WriteAudioNoWait(uint8_t *data, uint32_t length);
 
 /**
- * @brief  Start to play the first chunk of the audio provided via parameters.
- *         If the audio data is bigger than a chunk (PCM_AMP_DMA_CHUNK_SIZE),
- *         ignore the rest of the audio.
+ * @brief  Play the audio asynchronously on a mixer channel other than kSlnAmpChannelStreamer,
+ *         for example a UI tone on kSlnAmpChannelTone over a playing prompt.
+ *         The data must stay valid until the audio is played (SLN_AMP_WaitChannelDone) or aborted.
+ *         If the channel is already playing, this call will return fail.
+ *
+ * @param  channel Mixer channel.
+ * @param  data Pointer to the audio data stored in RAM or Flash.
+ * @param  length Length of the audio data.
+ *
+ * @return kStatus_Success if the audio was queued to the mixer.
+ */
+status_t SLN_AMP_WriteChannelNoWait(sln_amp_channel_t channel, uint8_t *data, uint32_t length);
+
+/**
+ * @brief  Queue a buffer of decoded audio on the kSlnAmpChannelStreamer mixer channel.
+ *         The buffer is given back to the Streamer (extStreamerBuffsCnt of SLN_AMP_Init)
+ *         once it was played.
  *         NOTE: This function is supposed to be called by an external STREAMER.
- *         NOTE: For MQS, the data should be mandatory in RAM.
  *
  * @param  data Pointer to the audio data stored in RAM.
  * @param  length Length of the audio data.
  *
- * @return kStatus_Success if the audio chunk was started to play.
+ * @return kStatus_Success if the buffer was queued to the mixer.
  */
 status_t SLN_AMP_WriteStreamerNoWait(uint8_t *data, uint32_t length);
 
 /**
- * @brief  Stop the amplifier (if running).
- *         Stop SLN_AMP_WriteAudioBlocking. SLN_AMP_WriteAudioBlocking will exit with success.
- *         Stop and delete Play_Audio_Async_Task created by SLN_AMP_WriteAudioNoWait.
- *         Stop the audio play started SLN_AMP_WriteStreamerNoWait.
+ * @brief  Stop the amplifier (if running) and drop the audio of all the mixer channels.
+ *         SLN_AMP_WriteAudioBlocking will exit with success.
+ *         The Streamer buffers are all given back.
  */
 void SLN_AMP_AbortWrite(void);
 
+/**
+ * @brief  Drop the audio queued on a mixer channel. The other channels keep playing.
+ *         The few milliseconds of the channel already mixed are still played.
+ *
+ * @param  channel Mixer channel.
+ */
+void SLN_AMP_AbortChannel(sln_amp_channel_t channel);
+
+/**
+ * @brief  Wait for the audio played by SLN_AMP_WriteAudioBlocking or SLN_AMP_WriteAudioNoWait
+ *         to be played or aborted. Returns immediately if no such audio is playing.
+ *         NOTE: Audio played on the other mixer channels is not waited for.
+ *
+ * @param  timeoutMs Maximum time to wait, UINT32_MAX to wait forever.
+ *
+ * @return kStatus_Success if no audio is playing, kStatus_Timeout otherwise.
+ */
+status_t SLN_AMP_WaitWriteDone(uint32_t timeoutMs);
+
+/**
+ * @brief  Wait for the audio of a mixer channel to be played or aborted.
+ *         Returns immediately if the channel is not playing.
+ *
+ * @param  channel Mixer channel.
+ * @param  timeoutMs Maximum time to wait, UINT32_MAX to wait forever.
+ *
+ * @return kStatus_Success if the channel is not playing, kStatus_Timeout otherwise.
+ */
+status_t SLN_AMP_WaitChannelDone(sln_amp_channel_t channel, uint32_t timeoutMs);
+
+/**
+ * @brief  Set the gain of a mixer channel, applied on top of the amplifier volume.
+ *         The change is ramped over 20 ms.
+ *
+ * @param  channel Mixer channel.
+ * @param  gain The channel gain from 0 (mute) to 100 (unchanged).
+ */
+void SLN_AMP_SetChannelGain(sln_amp_channel_t channel, uint8_t gain);
+
+/**
+ * @brief  Set the priority of a mixer channel and how much it is attenuated (ducked)
+ *         while a channel with a higher priority is playing.
+ *         By default the channels are ducked to 25 and kSlnAmpChannelTone has the highest priority.
+ *
+ * @param  channel Mixer channel.
+ * @param  priority Priority of the channel, the highest wins.
+ * @param  duckGain Gain applied while the channel is ducked, from 0 (mute) to 100 (no ducking).
+ */
+void SLN_AMP_SetChannelDucking(sln_amp_channel_t channel, uint8_t priority, uint8_t duckGain);
+
 /**
  * @brief  Set the amplifier volume.
  *
@@ -146,6 +187,7 @@ void *SLN_AMP_GetAmpTxHandler(void);
 
 /**
  * @brief  Get the current state of the Amplifier.
+ *         When several mixer channels play, the state of the one with the highest priority is returned.
  *
  * @return Return one of the states from sln_amp_state_t.
  */
@@ -158,21 +200,14 @@ sln_amp_state_t SLN_AMP_GetState(void);
 #if ENABLE_AEC
 #if USE_MQS
 
-/**
- * @brief  Get loopback mutex.
-           Used for exclusive access to the loopback ringbuffer.
- *
- * @return Loopback mutex handler.
- */
-SemaphoreHandle_t SLN_AMP_GetLoopBackMutex(void);
-
 /**
  * @brief  Get loopback ringbuffer.
            Used for storing and retrieving amplifier data (used for barge-in).
+           The amplifier is the only writer, the mic task the only reader, no lock is needed.
  *
  * @return Pointer to the ringbuffer.
  */
-ringbuf_t *SLN_AMP_GetRingBuffer(void);
+sln_amp_ring_t *SLN_AMP_GetRingBuffer(void);
 
 /**
  * @brief  Get current tick count of the LOOPBACK_GPT.
@@ -189,6 +224,22 @@ uint32_t SLN_AMP_GetTimestamp(void);
  * @param  timestamp number of ticks.
  */
 void SLN_AMP_UpdateTimestamp(uint32_t timestamp);
+
+/**
+ * @brief  Set the constant part of the delay added before the loopback data of a playback session.
+ *         Replaces AMP_LOOPBACK_CONST_DELAY_US, for example with the delay measured by the AEC calibration.
+ *         Takes effect at the next playback session.
+ *
+ * @param  delayUs Delay in microseconds, limited to AMP_LOOPBACK_MAX_CONST_DELAY_US.
+ */
+void SLN_AMP_SetLoopbackDelayUs(uint32_t delayUs);
+
+/**
+ * @brief  Get the constant part of the delay added before the loopback data of a playback session.
+ *
+ * @return Delay in microseconds.
+ */
+uint32_t SLN_AMP_GetLoopbackDelayUs(void);
 #endif /* USE_MQS */
 
 /**
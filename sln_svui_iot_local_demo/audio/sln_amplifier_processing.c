@@ -9,9 +9,11 @@
 #include "stdint.h"
 
 #include "FreeRTOS.h"
-#include "ringbuffer.h"
-#include "semphr.h"
+#include "task.h"
+#include "sln_amp_ring.h"
 #include "sln_mic_config.h"
+#include "sln_amplifier_processing.h"
+#include "audio_profiler.h"
 
 /*******************************************************************************
  * Definitions
@@ -30,155 +32,435 @@ static const int32_t kDefaultF3Coeffs24KHz[F3_NUM_TAPS] =
         -179, -104, 190, -145, 62, -6, -17,
 };
 
+/* Pack two 16-bit coefficients for a dual MAC, the first one in the bottom half */
+#define F3_PACK(lo, hi) (((uint32_t)(uint16_t)(lo)) | ((uint32_t)(uint16_t)(hi) << 16))
+
+/* Taps used by the low pass, as pairs of consecutive coefficients. The pair at index n applies to
+ * the delay line samples kF3PairOffsets[n] and kF3PairOffsets[n] + 1. The center tap 15 is applied alone. */
+#define F3_PAIR_COUNT 10
+
+static const uint32_t kF3CoeffPairs[F3_PAIR_COUNT] =
+{
+        F3_PACK(-6, 62), F3_PACK(190, -104), F3_PACK(613, -991), F3_PACK(-262, -1303), F3_PACK(-5871, 7672),
+        F3_PACK(7672, -5871), F3_PACK(-1303, -262), F3_PACK(-991, 613), F3_PACK(-104, 190), F3_PACK(62, -6),
+};
+
+/* Length of the linear gain ramp applied when the volume changes, in 24KHz samples (10ms) */
+#ifndef SLN_AMP_GAIN_RAMP_SAMPLES
+#define SLN_AMP_GAIN_RAMP_SAMPLES 240
+#endif /* SLN_AMP_GAIN_RAMP_SAMPLES */
+
+#if ENABLE_AEC
+/* Loopback reference resampler, 24KHz to 16KHz (up by 2, low pass, down by 3).
+ * 72 taps Kaiser low pass designed at 48KHz: -6dB at 7.5KHz, less than 0.02dB ripple up to 6KHz,
+ * more than 60dB rejection of the content which would alias below 7KHz. */
+#define AMP_REF_RESAMPLER_PHASE_TAPS 36
+
+/* Real (not differential) 24KHz amplifier samples in one period */
+#define AMP_REF_IN_SMPL_COUNT (PCM_AMP_SAMPLE_COUNT / 2)
+
+/* With the drift compensation a period may use one sample more than nominal, plus the next sample
+ * for the interpolation between two 48KHz phases */
+#define AMP_REF_IN_MAX_SMPL_COUNT (AMP_REF_IN_SMPL_COUNT + 2)
+
+/* Read position of the resampler, in 48KHz steps (one 24KHz sample is 2 steps), Q32 */
+#define AMP_REF_POS_FRAC_BITS 32
+#define AMP_REF_POS_ONE       ((int64_t)1 << AMP_REF_POS_FRAC_BITS)
+
+/* Clock drift compensation between the amplifier (SAI TX) and the mics.
+ * The loopback ringbuffer occupancy is averaged over windows of AMP_REF_DRIFT_WINDOW periods. The amplifier
+ * publishes whole chunks, so the occupancy is corrected with the time elapsed since the last chunk was
+ * published, otherwise it would jump by a chunk whenever the drift moves a write across a mic period.
+ * A PI loop steers the resampler ratio to hold the occupancy at the level the loopback sync was done with,
+ * at the start of the playback session. The integral of the loop is the clock drift, it is kept across
+ * playback sessions. The gains give a critically damped loop with a time constant of ~20 windows. */
+#define AMP_REF_DRIFT_WINDOW  (1000 / SLN_MIC_PERIOD_MS)
+#define AMP_REF_DRIFT_KP      (0.1f / (AMP_REF_IN_SMPL_COUNT * AMP_REF_DRIFT_WINDOW))
+#define AMP_REF_DRIFT_KI      (AMP_REF_DRIFT_KP / 40.0f)
+#define AMP_REF_DRIFT_MAX_PPM 1000.0f
+
+/* Longest time between two loopback commits: a single slot holding all the data the amplifier may queue */
+#define AMP_REF_DRIFT_MAX_CHUNK_US (AMP_WRITE_SLOTS * 20 * 1000)
+
+/* Polyphase components of the low pass, Q15. Each phase has a DC gain of 1. */
+static const int16_t kAmpRefResamplerPhase0[AMP_REF_RESAMPLER_PHASE_TAPS] =
+{
+        -6, 38, -31, -64, 143, -21, -255, 299, 148, -658, 402, 696,
+        -1357, 182, 2212, -2773, -1691, 13777, 19649, 5231, -4274, 291, 1895, -1252,
+        -362, 963, -354, -369, 426, -33, -218, 138, 36, -82, 24, 18,
+};
+
+static const int16_t kAmpRefResamplerPhase1[AMP_REF_RESAMPLER_PHASE_TAPS] =
+{
+        18, 24, -82, 36, 138, -218, -33, 426, -369, -354, 963, -362,
+        -1252, 1895, 291, -4274, 5231, 19649, 13777, -1691, -2773, 2212, 182, -1357,
+        696, 402, -658, 148, 299, -255, -21, 143, -64, -31, 38, -6,
+};
+#endif /* ENABLE_AEC */
+
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 
-/* Buffer used for amp filtering. */
-static int16_t s_dsBuffer[FILTER_ORDER] = {0};
+/* Delay line used for amp filtering. Every sample is stored twice, FILTER_ORDER entries apart,
+ * so the last FILTER_ORDER samples are always contiguous from s_dsHistory[s_dsHistoryPos]:
+ * s_dsHistory[s_dsHistoryPos + k] is the sample k steps in the past. */
+static int16_t s_dsHistory[2 * FILTER_ORDER] = {0};
+static uint32_t s_dsHistoryPos = 0;
+
+/* Playback gain in Q15, kept in the top half so the ramp steps keep their precision */
+static int32_t s_ampGain         = 0;
+static int16_t s_ampGainTarget   = 0;
+static int32_t s_ampGainStep     = 0;
+static uint32_t s_ampGainRampCnt = 0;
 
 #if ENABLE_AEC
 #if USE_MQS
 /* Buffer to store 48KHz PCM data from the speaker. */
-__attribute__((section(".data.$SRAM_DTC"))) __attribute__((aligned(32))) static int16_t s_amp48KhzData[PCM_AMP_SAMPLE_COUNT] = {0};
+__attribute__((section(".data.$SRAM_DTC"))) __attribute__((aligned(32))) static int16_t s_amp48KhzData[2 * AMP_REF_IN_MAX_SMPL_COUNT] = {0};
 #endif /* USE_MQS */
+
+/* Resampler input: the last AMP_REF_RESAMPLER_PHASE_TAPS - 1 samples already used,
+ * followed by the s_ampRefAvail de-duplicated samples not used yet. */
+__attribute__((section(".data.$SRAM_DTC"))) static int16_t s_ampRefHistory[AMP_REF_RESAMPLER_PHASE_TAPS - 1 + AMP_REF_IN_MAX_SMPL_COUNT] = {0};
+static uint32_t s_ampRefAvail = 0;
+
+/* Position of the next output relative to the first sample not used yet, and distance between two outputs.
+ * Nominally 3 steps of 48KHz per 16KHz output, stretched by the drift compensation. */
+static int64_t s_ampRefPos  = 0;
+static int64_t s_ampRefStep = 3 * AMP_REF_POS_ONE;
+
+/* Drift compensation state, written by the mic task */
+static uint32_t s_driftPeriods   = 0;     /* Periods in the current window */
+static float s_driftFillSum      = 0.0f;  /* Sum of the buffered samples over the current window */
+static uint32_t s_driftWindows   = 0;     /* Windows of the current playback session */
+static float s_driftRefFill      = 0.0f;  /* Buffered samples the session is held at */
+static float s_driftIntegral     = 0.0f;  /* Estimated drift, as a ratio */
+static sln_amp_ref_drift_stats_t s_driftStats;
 #endif /* ENABLE_AEC */
 
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
 #if ENABLE_AEC
-static void SLN_AMP_DownsampleDiffData(uint8_t *in, int16_t *out);
+static uint32_t SLN_AMP_GetDownsamplerInputCount(void);
+static void SLN_AMP_DownsampleDiffData(uint8_t *in, uint32_t inCount, int16_t *out);
+static void SLN_AMP_ResetDownsampler(void);
+static float SLN_AMP_GetBufferedSamples(sln_amp_ring_t *ring, uint32_t timestamp);
+static void SLN_AMP_UpdateDrift(float bufferedSmpl);
 #endif /* ENABLE_AEC */
 
 /*******************************************************************************
  * Code
  ******************************************************************************/
 
-void SLN_AMP_FirLowPassFilterForAMP(int16_t *samples, uint32_t samplesCnt)
+void SLN_AMP_GainAndFirLowPassForAMP(int16_t *samples, uint32_t samplesCnt, int16_t gainQ15)
 {
-    int32_t acc = 0;
+    int32_t acc      = 0;
+    int16_t sample   = 0;
+    uint32_t pos     = s_dsHistoryPos;
+    const int16_t *x = NULL;
 
-    for (uint32_t idx = 0; idx < samplesCnt; idx += 2)
+    /* A new volume starts a ramp from the current gain, so there is no step at the chunk boundary */
+    if (gainQ15 != s_ampGainTarget)
     {
-        acc = 0;
-
-        /* Pull new data into buffer */
-        s_dsBuffer[0] = samples[idx];
-
-        acc += kDefaultF3Coeffs24KHz[1] * (s_dsBuffer[1] + s_dsBuffer[29]);
-        acc += kDefaultF3Coeffs24KHz[2] * (s_dsBuffer[2] + s_dsBuffer[28]);
-
-        acc += kDefaultF3Coeffs24KHz[4] * (s_dsBuffer[4] + s_dsBuffer[26]);
-        acc += kDefaultF3Coeffs24KHz[5] * (s_dsBuffer[5] + s_dsBuffer[25]);
-
-        acc += kDefaultF3Coeffs24KHz[7] * (s_dsBuffer[7] + s_dsBuffer[23]);
-        acc += kDefaultF3Coeffs24KHz[8] * (s_dsBuffer[8] + s_dsBuffer[22]);
-
-        acc += kDefaultF3Coeffs24KHz[10] * (s_dsBuffer[10] + s_dsBuffer[20]);
-        acc += kDefaultF3Coeffs24KHz[11] * (s_dsBuffer[11] + s_dsBuffer[19]);
-
-        acc += kDefaultF3Coeffs24KHz[13] * (s_dsBuffer[13] + s_dsBuffer[17]);
-        acc += kDefaultF3Coeffs24KHz[14] * (s_dsBuffer[14] + s_dsBuffer[16]);
-
-        acc += kDefaultF3Coeffs24KHz[15] * (s_dsBuffer[15] + 0);
+        s_ampGainTarget  = gainQ15;
+        s_ampGainStep    = (((int32_t)gainQ15 << 16) - s_ampGain) / SLN_AMP_GAIN_RAMP_SAMPLES;
+        s_ampGainRampCnt = SLN_AMP_GAIN_RAMP_SAMPLES;
+    }
 
-        /* Shift values up in buffer */
-        for (uint32_t idx2 = F3_NUM_TAPS; idx2 > 0; idx2--)
+    for (uint32_t idx = 0; idx < samplesCnt; idx += 2)
+    {
+        if (s_ampGainRampCnt > 0)
         {
-            s_dsBuffer[idx2] = s_dsBuffer[idx2 - 1];
+            s_ampGainRampCnt--;
+            s_ampGain = (s_ampGainRampCnt > 0) ? (s_ampGain + s_ampGainStep) : ((int32_t)s_ampGainTarget << 16);
         }
 
-        samples[idx] = (int16_t)(acc >> 15);
+        /* Apply the gain while pulling new data into the delay line, no shifting needed */
+        sample                          = (int16_t)((samples[idx] * (s_ampGain >> 16)) >> 15);
+        pos                             = (pos - 1U) & (FILTER_ORDER - 1U);
+        s_dsHistory[pos]                = sample;
+        s_dsHistory[pos + FILTER_ORDER] = sample;
+        x                               = &s_dsHistory[pos];
+
+        /* Symmetric taps, two per dual MAC. Same taps as the folded implementation, the output is bit exact. */
+        acc = kDefaultF3Coeffs24KHz[15] * x[15];
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[0], __UNALIGNED_UINT32_READ(&x[1]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[1], __UNALIGNED_UINT32_READ(&x[4]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[2], __UNALIGNED_UINT32_READ(&x[7]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[3], __UNALIGNED_UINT32_READ(&x[10]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[4], __UNALIGNED_UINT32_READ(&x[13]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[5], __UNALIGNED_UINT32_READ(&x[16]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[6], __UNALIGNED_UINT32_READ(&x[19]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[7], __UNALIGNED_UINT32_READ(&x[22]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[8], __UNALIGNED_UINT32_READ(&x[25]), acc);
+        acc = (int32_t)__SMLAD(kF3CoeffPairs[9], __UNALIGNED_UINT32_READ(&x[28]), acc);
+
+        /* Differential output */
+        samples[idx]     = (int16_t)(acc >> 15);
         samples[idx + 1] = -samples[idx];
     }
+
+    /* The delay line and the gain carry over to the next chunk */
+    s_dsHistoryPos = pos;
 }
 
 #if ENABLE_AEC
 
+/**
+ * @brief Number of new 24KHz samples the next period of the resampler needs.
+ */
+static uint32_t SLN_AMP_GetDownsamplerInputCount(void)
+{
+    /* The last output and the step after it, used for the interpolation. Step s ends on input s / 2. */
+    int64_t lastPos = s_ampRefPos + ((PCM_SINGLE_CH_SMPL_COUNT - 1) * s_ampRefStep);
+    uint32_t needed = (uint32_t)(((lastPos >> AMP_REF_POS_FRAC_BITS) + 1) / 2) + 1;
+
+    return (needed > s_ampRefAvail) ? (needed - s_ampRefAvail) : 0;
+}
+
 /**
  * @brief Process amplifier differential samples.
- *        Amplifier's buffer contains 480 sample, but because they are differential samples,
+ *        Amplifier's buffer contains 480 sample (10ms period), but because they are differential samples,
  *        each second sample is its predecessor multiplied with (-1). So, in fact, there are
- *        only 240 actual samples of data. The garbage samples will be ignored.
- *        Apply Low Pass Filter to offer a better quality after down sampling.
- *        Down sample data from PCM_AMP_SAMPLE_RATE_HZ (24KHz) to PCM_SAMPLE_RATE_HZ (16KHz).
+ *        only 240 actual samples of data. The garbage samples are skipped while the actual ones
+ *        are copied after the resampler history.
+ *        Down sample data from PCM_AMP_SAMPLE_RATE_HZ (24KHz) to PCM_SAMPLE_RATE_HZ (16KHz) with a
+ *        polyphase filter: the 24KHz samples are seen as 48KHz samples with every second one at zero,
+ *        and each output is taken every 3 steps of 48KHz, from the phase of the filter which matches its step.
+ *        When the drift compensation moves the outputs between two steps, both are computed and
+ *        interpolated. Without drift, every 3 input samples give 2 output samples, one from each phase.
+ *        The filter state and the read position are kept across periods.
  *
  * @param in Pointer to the buffer containing the samples.
+ * @param inCount Number of real (not differential) samples in the buffer.
  * @param out Pointer where to store processed data.
  */
-static void SLN_AMP_DownsampleDiffData(uint8_t *in, int16_t *out)
+static void SLN_AMP_DownsampleDiffData(uint8_t *in, uint32_t inCount, int16_t *out)
 {
-    uint32_t i = 0;
-    uint32_t j = 0;;
-    int16_t *inBuff = (int16_t *)in;
-
-    for (uint32_t idx = 0; idx < PCM_AMP_SAMPLE_COUNT; idx += 2)
+    int16_t *inBuff     = (int16_t *)in;
+    int16_t *x          = &s_ampRefHistory[AMP_REF_RESAMPLER_PHASE_TAPS - 1];
+    const int16_t *xp   = NULL;
+    const int16_t *taps = NULL;
+    int64_t pos         = 0;
+    uint32_t step       = 0;
+    uint32_t frac       = 0;
+    uint32_t used       = 0;
+    int32_t acc[2]      = {0};
+
+    /* Drop the differential duplicates */
+    for (uint32_t idx = 0; idx < inCount; idx++)
     {
-        inBuff[idx / 2] = inBuff[idx];
+        x[s_ampRefAvail + idx] = inBuff[2 * idx];
     }
+    s_ampRefAvail += inCount;
 
-    /* Down sample from 24KHz to 16KHz */
-    for (i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i += 2)
+    for (uint32_t idx = 0; idx < PCM_SINGLE_CH_SMPL_COUNT; idx++)
     {
-        out[i]     = (inBuff[j] / 2) + (inBuff[j + 1] / 2);
-        out[i + 1] = (inBuff[j + 1] / 2) + (inBuff[j + 2] / 2);
-        j += 3;
+        pos  = s_ampRefPos + (idx * s_ampRefStep);
+        step = (uint32_t)(pos >> AMP_REF_POS_FRAC_BITS);
+        frac = (uint32_t)((uint64_t)pos >> (AMP_REF_POS_FRAC_BITS - 15)) & 0x7FFFU;
+
+        /* Steps 2n (even taps) and 2n + 1 (odd taps) both end on input n */
+        for (uint32_t k = 0; k < ((frac != 0) ? 2U : 1U); k++)
+        {
+            xp     = &x[(step + k) / 2];
+            taps   = (((step + k) & 1U) == 0) ? kAmpRefResamplerPhase0 : kAmpRefResamplerPhase1;
+            acc[k] = 0;
+
+            for (uint32_t tap = 0; tap < AMP_REF_RESAMPLER_PHASE_TAPS; tap++)
+            {
+                acc[k] += taps[tap] * xp[-(int32_t)tap];
+            }
+        }
+
+        if (frac != 0)
+        {
+            acc[0] += (int32_t)((((int64_t)acc[1] - acc[0]) * frac) >> 15);
+        }
+
+        out[idx] = (int16_t)__SSAT((acc[0] + (1 << 14)) >> 15, 16);
     }
+
+    /* Keep the samples not used yet and the filter history for the next period.
+     * The next output ends on input (pos / 2), the inputs before it are only history. */
+    pos  = s_ampRefPos + (PCM_SINGLE_CH_SMPL_COUNT * s_ampRefStep);
+    used = MIN((uint32_t)(pos >> (AMP_REF_POS_FRAC_BITS + 1)), s_ampRefAvail);
+    memmove(s_ampRefHistory, &s_ampRefHistory[used],
+            (AMP_REF_RESAMPLER_PHASE_TAPS - 1 + s_ampRefAvail - used) * sizeof(int16_t));
+    s_ampRefAvail -= used;
+    s_ampRefPos = pos - ((int64_t)(2 * used) << AMP_REF_POS_FRAC_BITS);
 }
 
-void SLN_AMP_GetAmpStream(mic_task_config_t *s_taskConfig, int16_t *buffOut, volatile uint32_t *s_pingPongTimestamp)
+/**
+ * @brief Clear the resampler history, so the next playback does not start with the tail of the previous one.
+ *        The drift estimate is kept, only the tracking of the session is restarted.
+ */
+static void SLN_AMP_ResetDownsampler(void)
 {
-    uint32_t ampProcessDataSize   = 0;
-    uint32_t ampRingBuffOcc       = 0;
-    static uint8_t ampOutputDirty = EDMA_TCD_COUNT;
+    memset(s_ampRefHistory, 0, (AMP_REF_RESAMPLER_PHASE_TAPS - 1) * sizeof(int16_t));
+    s_ampRefAvail = 0;
+    s_ampRefPos   = 0;
+    s_ampRefStep  = (int64_t)((double)(3 * AMP_REF_POS_ONE) * (1.0 + (double)s_driftIntegral));
+
+    s_driftPeriods = 0;
+    s_driftFillSum = 0.0f;
+    s_driftWindows = 0;
+
+    taskENTER_CRITICAL();
+    s_driftStats.tracking     = false;
+    s_driftStats.alignErrorUs = 0;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Count the 24KHz samples buffered between the amplifier and the resampler output at the time stamp of
+ *        the period. The amplifier publishes a chunk when the previous one was played, so the part of the
+ *        next chunk which would have been published by the time stamp, at the playback rate, is counted
+ *        as well. This way the count grows smoothly instead of by whole chunks.
+ *
+ * @param ring Loopback ringbuffer
+ * @param timestamp Time stamp of the period, same time base as the commits of the amplifier
+ */
+static float SLN_AMP_GetBufferedSamples(sln_amp_ring_t *ring, uint32_t timestamp)
+{
+    uint32_t fill       = 0;
+    uint32_t commitTime = 0;
+    int32_t elapsedUs   = 0;
+
+    /* The amplifier writer may preempt the mic task, read both in the same state */
+    taskENTER_CRITICAL();
+    fill       = SLN_AMP_RING_GetFill(ring);
+    commitTime = SLN_AMP_RING_GetCommitTime(ring);
+    taskEXIT_CRITICAL();
+
+    /* Negative if the last chunk was published after the time stamp. Beyond one chunk either way,
+     * the amplifier fell behind and the occupancy says nothing about the clocks. */
+    elapsedUs = AMP_LOOPBACK_GPT_TICKS_TO_US((int32_t)(timestamp - commitTime));
+    elapsedUs = MAX(MIN(elapsedUs, AMP_REF_DRIFT_MAX_CHUNK_US), -AMP_REF_DRIFT_MAX_CHUNK_US);
+
+    return (float)(fill / (2 * PCM_SAMPLE_SIZE_BYTES)) + (float)s_ampRefAvail -
+           ((float)s_ampRefPos / (float)(2 * AMP_REF_POS_ONE)) +
+           ((float)elapsedUs * (AMP_REF_IN_SMPL_COUNT / (SLN_MIC_PERIOD_MS * 1000.0f)));
+}
 
-    if ((s_taskConfig->loopbackMutex == NULL) || (s_taskConfig->loopbackRingBuffer == NULL) ||
-        (s_taskConfig->updateTimestamp == NULL) )
+/**
+ * @brief Average the samples buffered between the amplifier and the resampler over a window,
+ *        then steer the resampler so the average stays where the playback session started.
+ *
+ * @param bufferedSmpl 24KHz samples in the loopback ringbuffer and in the resampler, not used yet,
+ *                     at the time stamp of the period.
+ */
+static void SLN_AMP_UpdateDrift(float bufferedSmpl)
+{
+    float error = 0.0f;
+    float ratio = 0.0f;
+
+    s_driftFillSum += bufferedSmpl;
+    s_driftPeriods++;
+    if (s_driftPeriods < AMP_REF_DRIFT_WINDOW)
     {
         return;
     }
 
-    /* Read the loopback data from the amplifier`s ringbuffer.
-     * Do not read more than 10ms of data. */
-    xSemaphoreTake(s_taskConfig->loopbackMutex, portMAX_DELAY);
+    /* The first window of a session is used as reference, the next ones are compared to it.
+     * The resampler runs at the drift already known during the first two windows, so the slope between
+     * them is the drift left. It moves the reference back to the start of the session, where the loopback
+     * sync was done, instead of the middle of the first window. */
+    if (s_driftWindows == 0)
+    {
+        s_driftRefFill = s_driftFillSum / AMP_REF_DRIFT_WINDOW;
+    }
+    else
+    {
+        error = (s_driftFillSum / AMP_REF_DRIFT_WINDOW) - s_driftRefFill;
 
-    s_taskConfig->updateTimestamp(*s_pingPongTimestamp);
+        if (s_driftWindows == 1)
+        {
+            s_driftIntegral += error / (AMP_REF_IN_SMPL_COUNT * AMP_REF_DRIFT_WINDOW);
+            s_driftRefFill -= error / 2.0f;
+            error = (s_driftFillSum / AMP_REF_DRIFT_WINDOW) - s_driftRefFill;
+        }
+
+        /* More buffered samples mean the amplifier runs faster than the mics, read faster */
+        s_driftIntegral += AMP_REF_DRIFT_KI * error;
+        s_driftIntegral = MAX(MIN(s_driftIntegral, AMP_REF_DRIFT_MAX_PPM / 1e6f), -AMP_REF_DRIFT_MAX_PPM / 1e6f);
+        ratio           = s_driftIntegral + (AMP_REF_DRIFT_KP * error);
+        ratio           = MAX(MIN(ratio, AMP_REF_DRIFT_MAX_PPM / 1e6f), -AMP_REF_DRIFT_MAX_PPM / 1e6f);
+
+        s_ampRefStep = (int64_t)((double)(3 * AMP_REF_POS_ONE) * (1.0 + (double)ratio));
+    }
+
+    s_driftWindows++;
+    s_driftPeriods = 0;
+    s_driftFillSum = 0.0f;
 
-    ampRingBuffOcc = ringbuf_get_occupancy(s_taskConfig->loopbackRingBuffer);
-    if (ampRingBuffOcc > PCM_AMP_DATA_SIZE_10_MS)
+    taskENTER_CRITICAL();
+    s_driftStats.ppm          = s_driftIntegral * 1e6f;
+    s_driftStats.alignErrorUs = error * (1e6f / (AMP_REF_IN_SMPL_COUNT * (1000 / SLN_MIC_PERIOD_MS)));
+    s_driftStats.windows++;
+    s_driftStats.tracking     = (s_driftWindows > 1);
+    taskEXIT_CRITICAL();
+}
+
+void SLN_AMP_GetRefDriftStats(sln_amp_ref_drift_stats_t *stats)
+{
+    if (stats != NULL)
     {
-        ampProcessDataSize = PCM_AMP_DATA_SIZE_10_MS;
+        taskENTER_CRITICAL();
+        *stats = s_driftStats;
+        taskEXIT_CRITICAL();
     }
-    else
+}
+
+void SLN_AMP_GetAmpStream(mic_task_config_t *s_taskConfig, int16_t *buffOut, volatile uint32_t *s_pingPongTimestamp)
+{
+    uint32_t ampProcessDataSize   = 0;
+    uint32_t ampReadSize          = 0;
+    static uint8_t ampOutputDirty = PCM_BUFFER_COUNT;
+    uint32_t profStart            = AUDIO_PROFILER_GET_CYCLES();
+
+    if ((s_taskConfig->loopbackRingBuffer == NULL) || (s_taskConfig->updateTimestamp == NULL))
     {
-        ampProcessDataSize = ampRingBuffOcc;
+        return;
     }
 
-    ringbuf_read(s_taskConfig->loopbackRingBuffer, (uint8_t *)s_amp48KhzData, ampProcessDataSize);
+    /* Publish the time stamp before reading, the amplifier checks it to know whether
+     * this read happened while it was preparing its data. */
+    s_taskConfig->updateTimestamp(*s_pingPongTimestamp);
 
-    xSemaphoreGive(s_taskConfig->loopbackMutex);
+    /* Read the loopback data from the amplifier`s ringbuffer.
+     * Read what the resampler needs for one capture period, about one period of data. */
+    ampReadSize = SLN_AMP_GetDownsamplerInputCount() * 2 * PCM_SAMPLE_SIZE_BYTES;
+    ampProcessDataSize =
+        SLN_AMP_RING_Read(s_taskConfig->loopbackRingBuffer, (uint8_t *)s_amp48KhzData, ampReadSize);
 
-    /* In case of need, add padding zeroes to form a 10ms chunk of data.
+    /* In case of need, add padding zeroes to form a full period of data.
      * Downsample by 3 the data and place it in the downsampled buffer.
      * In case there is no available data, clear the downsampled buffer. */
     if (ampProcessDataSize > 0)
     {
-        /* avoid out of bounds read by dereferencing pointer when ampProcessDataSize is PCM_AMP_DATA_SIZE_10_MS */
-        if (PCM_AMP_DATA_SIZE_10_MS - ampProcessDataSize)
+        /* avoid out of bounds read by dereferencing pointer when ampProcessDataSize is ampReadSize */
+        if (ampReadSize - ampProcessDataSize)
         {
-            memset(&((uint8_t *)s_amp48KhzData)[ampProcessDataSize], 0, (PCM_AMP_DATA_SIZE_10_MS - ampProcessDataSize));
+            memset(&((uint8_t *)s_amp48KhzData)[ampProcessDataSize], 0, (ampReadSize - ampProcessDataSize));
         }
 
-        SLN_AMP_DownsampleDiffData((uint8_t *)s_amp48KhzData, buffOut);
+        SLN_AMP_DownsampleDiffData((uint8_t *)s_amp48KhzData, ampReadSize / (2 * PCM_SAMPLE_SIZE_BYTES), buffOut);
 
-        ampOutputDirty = EDMA_TCD_COUNT;
+        SLN_AMP_UpdateDrift(SLN_AMP_GetBufferedSamples(s_taskConfig->loopbackRingBuffer, *s_pingPongTimestamp));
+
+        ampOutputDirty = PCM_BUFFER_COUNT;
     }
     else if (ampOutputDirty > 0)
     {
         ampOutputDirty--;
         memset(buffOut, 0, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        SLN_AMP_ResetDownsampler();
     }
+
+    AUDIO_PROFILER_STOP(kAudioProfilerAmpLoopback, profStart);
 }
 
 #endif /* ENABLE_AEC */
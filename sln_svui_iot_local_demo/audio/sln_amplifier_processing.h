@@ -8,9 +8,21 @@
 #define SLN_AMPLIFIER_PROCESSING_H_
 
 #include "stdint.h"
+#include "stdbool.h"
 #include "sln_mic_config.h"
 
 #if ENABLE_AEC
+/**
+ * @brief Clock drift between the amplifier and the mics, estimated from the loopback ringbuffer occupancy.
+ */
+typedef struct _sln_amp_ref_drift_stats
+{
+    float ppm;          /* Estimated drift, positive if the amplifier clock is faster than the mics clock */
+    float alignErrorUs; /* Reference delay left to correct in the last window, positive if the reference lags */
+    uint32_t windows;   /* Occupancy windows averaged since boot */
+    bool tracking;      /* A playback session is long enough to be tracked */
+} sln_amp_ref_drift_stats_t;
+
 /**
  * @brief Retrieve amplifier's data from its ring buffer, down sample the data and copy it to the output buffer.
  *        In case amplifier's ring buffer is empty, schedule future clears of the output buffer.
@@ -20,15 +32,27 @@
  * @param s_pingPongTimestamp Pointer to the latest timestamp updated by mic callbacks.
  */
 void SLN_AMP_GetAmpStream(mic_task_config_t *s_taskConfig, int16_t *buffOut, volatile uint32_t *s_pingPongTimestamp);
+
+/**
+ * @brief Get a copy of the clock drift estimation of the loopback reference.
+ *        The reference resampler is steered with this estimation, so the reference stays
+ *        aligned with the mics during long playbacks.
+ *
+ * @param stats Pointer where the statistics will be copied.
+ */
+void SLN_AMP_GetRefDriftStats(sln_amp_ref_drift_stats_t *stats);
 #endif /* ENABLE_AEC */
 
 /**
- * @brief Apply FIR Low Pass Filter on amp differential data.
- *        Differential data means that Filter should skip every second sample.
+ * @brief Apply the volume and the FIR Low Pass Filter on amp differential data, in a single pass.
+ *        Differential data means that only every second sample is read, the output is written in
+ *        differential format. When the gain changes, it ramps linearly to the new value over
+ *        SLN_AMP_GAIN_RAMP_SAMPLES samples.
  *
  * @param samples Pointer to the buffer containing 2B samples of data.
  * @param samplesCnt Number of samples in the buffer.
+ * @param gainQ15 Volume gain in Q15, between 0 and 32767.
  */
-void SLN_AMP_FirLowPassFilterForAMP(int16_t *samples, uint32_t samplesCnt);
+void SLN_AMP_GainAndFirLowPassForAMP(int16_t *samples, uint32_t samplesCnt, int16_t gainQ15);
 
 #endif /* SLN_AMPLIFIER_PROCESSING_H_ */
@@ -14,16 +14,19 @@
 #include "FreeRTOS.h"
 #include "event_groups.h"
 #if USE_MQS
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #include "semphr.h"
 #endif
 
 #include "fsl_dmamux.h"
 #include "fsl_edma.h"
 #include "fsl_sai.h"
+#include "board.h"
 
 #include "sln_amplifier_processing.h"
 #include "sln_i2s_mic_processing.h"
+#include "audio_latency.h"
+#include "audio_profiler.h"
 
 /*******************************************************************************
  * Definitions
@@ -57,17 +60,22 @@
 #define I2S_MIC_DMA_IRQ_PRIO (configMAX_SYSCALL_INTERRUPT_PRIORITY - 1)
 
 /* Skip first chunks of mic data because mics are not reliable right after boot. */
-#define SKIP_DIRTY_FRAMES 4
-
-typedef struct _i2s_mic_edma_config
-{
-    uint32_t startIdx;              /* SAI channel index whose data to be read first. (ex: startIdx = 2 => start reading from channel 2). */
-    uint32_t burstBytes;            /* Number of total bytes to be read in a minor loop. (Minor loop should cover all the channels application is interested in). */
-    edma_transfer_size_t burstSize; /* Number of bytes to be read in a single "read" ("read" compose a minor loop). */
-    uint32_t burstStride;           /* Number of bytes to add to the current read address after a "read". */
-    edma_modulo_t burstMod;         /* Modulo feature. Most significant bits of the read addresses do not change and only the last burstMod bits are dynamic. */
-    uint32_t smloff;                /* Number of bytes to add to the current read address after a minor loop (helps to get the initial read address after a minor loop). */
-} i2s_mic_edma_config_t;
+#define SKIP_DIRTY_FRAMES (40U / SLN_MIC_PERIOD_MS)
+
+/* Size in bytes of one mic plane inside the raw data buffers */
+#define I2S_MIC_RAW_PLANE_BYTES (I2S_MIC_RAW_FRAME_SAMPLES_COUNT * I2S_MIC_RAW_SAMPLE_SIZE)
+
+/* SAI RX requests trigger the DMA channel of the first mic. Each extra mic has its own DMA channel,
+ * started through minor and major loop channel linking, so every mic is written in its own plane.
+ * The channels are defined and checked against the other eDMA users in board.h */
+#if (SLN_MIC_COUNT == 2)
+#define I2S_MIC_LINKED_DMA_CHANNELS {BOARD_I2S_MIC_EDMA_LINK_LAST_CH}
+#elif (SLN_MIC_COUNT == 3)
+#define I2S_MIC_LINKED_DMA_CHANNELS {BOARD_I2S_MIC_EDMA_LINK_CH_1, BOARD_I2S_MIC_EDMA_LINK_LAST_CH}
+#elif (SLN_MIC_COUNT == 4)
+#define I2S_MIC_LINKED_DMA_CHANNELS \
+    {BOARD_I2S_MIC_EDMA_LINK_CH_1, BOARD_I2S_MIC_EDMA_LINK_CH_2, BOARD_I2S_MIC_EDMA_LINK_LAST_CH}
+#endif /* SLN_MIC_COUNT */
 
 /*******************************************************************************
  * Variables
@@ -88,19 +96,28 @@ static mic_task_config_t s_taskConfig = {0};
 /* Structure describing current SAI configuration */
 static sai_mic_config_t g_i2sMicSaiConfig = {I2S_MIC_SAI, I2S_MIC_CHANNEL_MASK, I2S_MIC_RAW_FRAME_SAMPLES_COUNT, I2S_MIC_SAMPLING_EDGE};
 
+#if (SLN_MIC_COUNT > 1)
+/* DMA channels linked after the SAI request channel, one per extra mic */
+static const uint32_t kLinkedDmaChannels[SLN_MIC_COUNT - 1] = I2S_MIC_LINKED_DMA_CHANNELS;
+#endif /* (SLN_MIC_COUNT > 1) */
+
 /* Structure describing current configuration (EDMA, SAI, mics etc.) */
 __attribute__((aligned(32))) static sln_mic_handle_t s_i2sMicSaiHandle = {0U};
 
-/* Buffer to store RAW data from all enabled mics. It has 2 slots for Ping and Pong (write one while processing the other). */
+/* Buffer to store RAW data from all enabled mics. It has 2 slots for Ping and Pong (write one while processing the other).
+ * Inside a slot, every mic has its own plane of I2S_MIC_RAW_PLANE_BYTES. */
 __attribute__((aligned(32))) static uint8_t __attribute__((section(".bss.$SRAM_ITC"))) s_i2sMicRawData[EDMA_TCD_COUNT][I2S_MIC_RAW_FRAME_SAMPLES_COUNT * I2S_MIC_RAW_SAMPLE_SIZE * SLN_MIC_COUNT];
 
-/* Buffer to store PCM data from all enabled mics. It has 2 slots for Ping and Pong (write one while processing the other). */
-__attribute__((aligned(32))) static pcmPingPong_t __attribute__((section(".bss.$SRAM_ITC"))) s_i2sMicPcmData = {0};
+/* Buffer to store PCM data from all enabled mics. It has PCM_BUFFER_COUNT slots managed by s_i2sMicPcmRing. */
+__attribute__((aligned(32))) static pcmRingBuffer_t __attribute__((section(".bss.$SRAM_ITC"))) s_i2sMicPcmData = {0};
+
+/* Tracks which slots of s_i2sMicPcmData are waiting for the audio processing task */
+static sln_mic_ring_t s_i2sMicPcmRing = {0};
 
 #if ENABLE_AEC
 #if USE_MQS
 /* Buffer to store 16KHz PCM data from the speaker after downsampling. */
-static int16_t s_amp16KhzData[PCM_SINGLE_CH_SMPL_COUNT * EDMA_TCD_COUNT] = {0};
+static int16_t s_amp16KhzData[PCM_SINGLE_CH_SMPL_COUNT * PCM_BUFFER_COUNT] = {0};
 
 /* Variable which helps to align Mic with AMP streams based on the timestamps */
 volatile static uint32_t s_pingPongTimestamp = 0;
@@ -111,13 +128,14 @@ volatile static uint32_t s_pingPongTimestamp = 0;
  * Prototypes
  ******************************************************************************/
 
-static void I2S_MIC_GetEdmaConfiguration(uint8_t channelMask, i2s_mic_edma_config_t *dmaConfig);
-static uint32_t I2S_MIC_ConvertSizeToOffset(edma_transfer_size_t transferSize);
+static uint32_t I2S_MIC_GetDmaChannel(sln_mic_handle_t *handle, uint32_t micId);
+static edma_tcd_t *I2S_MIC_GetDmaTcd(sln_mic_handle_t *handle, uint32_t micId);
 static void I2S_MIC_ConfigureEdma(sln_mic_handle_t *handle);
 static void I2S_MIC_Configure(sln_mic_handle_t *handle);
 static void I2S_MIC_StartMic(sln_mic_handle_t *handle);
 static void I2S_MIC_StopMic(sln_mic_handle_t *handle);
 static void PDM_MIC_DmaCallback(sln_mic_handle_t *handle);
+static void I2S_MIC_ProcessPeriod(uint8_t *rawData, uint32_t captureTimestamp);
 
 /*******************************************************************************
  * Code
@@ -139,246 +157,103 @@ static void I2S_MIC_UpdateTimestamp(void)
 #endif /* ENABLE_AEC */
 
 /**
- * @brief Get EDMA configuration for current SAI channel mask.
+ * @brief Get the DMA channel which stores the data of a mic.
  *
- * @param channelMask Current SAI channel mask for enabled mics.
- * @param dmaConfig Pointer where to store the configration.
+ * @param handle Microphone handle.
+ * @param micId Microphone id.
  */
-static void I2S_MIC_GetEdmaConfiguration(uint8_t channelMask, i2s_mic_edma_config_t *dmaConfig)
+static uint32_t I2S_MIC_GetDmaChannel(sln_mic_handle_t *handle, uint32_t micId)
 {
-    memset(dmaConfig, 0, sizeof(i2s_mic_edma_config_t));
-
-    /* Get DMA configuration for each supported combination of channels. */
-
-    if ((channelMask == kSAI_Channel0Mask) ||
-        (channelMask == kSAI_Channel1Mask) ||
-        (channelMask == kSAI_Channel2Mask) ||
-        (channelMask == kSAI_Channel3Mask))
-    {
-        /* Get configuration for 1 microphone configuration.
-         * Determine index of the SAI register for the appropriate microphone
-         * and set the desired number of bytes to be read to 2/4 in chunks of 2/4 bytes
-         * depending on I2S_MIC_RAW_SAMPLE_SIZE.
-         * The read address is not changed, so there is no need to add other configurations to alter
-         * the read address. */
-
-        if (channelMask == kSAI_Channel0Mask)
-        {
-            dmaConfig->startIdx = 0;
-        }
-        else if (channelMask == kSAI_Channel1Mask)
-        {
-            dmaConfig->startIdx = 1;
-        }
-        else if (channelMask == kSAI_Channel2Mask)
-        {
-            dmaConfig->startIdx = 2;
-        }
-        else if (channelMask == kSAI_Channel3Mask)
-        {
-            dmaConfig->startIdx = 3;
-        }
-
-        dmaConfig->burstBytes = I2S_MIC_DMA_READ_BYTES;
-        dmaConfig->burstSize  = I2S_MIC_DMA_CHUNK_BYTES;
-    }
-
-    else if ((channelMask == (kSAI_Channel0Mask | kSAI_Channel1Mask)) ||
-        (channelMask == (kSAI_Channel1Mask | kSAI_Channel2Mask)) ||
-        (channelMask == (kSAI_Channel2Mask | kSAI_Channel3Mask)))
-    {
-        /* Get configuration for 2 adjacent microphones configuration.
-         * Determine index of the SAI register for the first microphone
-         * and set the desired number of bytes to be read to 2/4 * 2 in chunks of 2/4 bytes
-         * depending on I2S_MIC_RAW_SAMPLE_SIZE.
-         * It is also needed to jump 4 bytes after each read and jump back 8 bytes
-         * to get to the initial channel after each minor loop. */
-
-        if (channelMask == (kSAI_Channel0Mask | kSAI_Channel1Mask))
-        {
-            dmaConfig->startIdx = 0;
-        }
-        if (channelMask == (kSAI_Channel1Mask | kSAI_Channel2Mask))
-        {
-            dmaConfig->startIdx = 1;
-        }
-        else if (channelMask == (kSAI_Channel2Mask | kSAI_Channel3Mask))
-        {
-            dmaConfig->startIdx = 2;
-        }
-
-        dmaConfig->burstBytes = I2S_MIC_DMA_READ_BYTES * 2;
-        dmaConfig->burstSize  = I2S_MIC_DMA_CHUNK_BYTES;
-
-        dmaConfig->burstStride = 4;
-        dmaConfig->smloff      = (uint32_t) -8;
-    }
-
-    else if ((channelMask == (kSAI_Channel0Mask | kSAI_Channel2Mask)) ||
-        (channelMask == (kSAI_Channel1Mask | kSAI_Channel3Mask)))
-    {
-        /* Get configuration for 2 non-adjacent microphones configuration.
-         * Determine index of the SAI register for the first microphone
-         * and set the desired number of bytes to be read to 2/4 * 2 in chunks of 2/4 bytes
-         * depending on I2S_MIC_RAW_SAMPLE_SIZE.
-         * It is also needed to jump 8 bytes after each read and modulo the address
-         * to circulate through 16 bytes of the 4 SAI channels. */
-
-        if (channelMask == (kSAI_Channel0Mask | kSAI_Channel2Mask))
-        {
-            dmaConfig->startIdx = 0;
-        }
-        else if (channelMask == (kSAI_Channel1Mask | kSAI_Channel3Mask))
-        {
-            dmaConfig->startIdx = 1;
-        }
-
-        dmaConfig->burstBytes = I2S_MIC_DMA_READ_BYTES * 2;
-        dmaConfig->burstSize  = I2S_MIC_DMA_CHUNK_BYTES;
-
-        dmaConfig->burstStride = 8;
-        dmaConfig->burstMod    = kEDMA_Modulo16bytes;
-    }
-
-    else if ((channelMask == (kSAI_Channel0Mask | kSAI_Channel1Mask | kSAI_Channel2Mask)) ||
-        (channelMask == (kSAI_Channel1Mask | kSAI_Channel2Mask | kSAI_Channel3Mask)))
-    {
-        /* Get configuration for 3 adjacent microphones configuration.
-         * Determine index of the SAI register for the first microphone
-         * and set the desired number of bytes to be read to 2/4 * 3 in chunks of 2/4 bytes.
-         * It is also needed to jump 4 bytes after each read and jump back 12 bytes
-         * to get to the initial channel after each minor loop. */
-
-        if (channelMask == (kSAI_Channel0Mask | kSAI_Channel1Mask | kSAI_Channel2Mask))
-        {
-            dmaConfig->startIdx = 0;
-        }
-        else if (channelMask == (kSAI_Channel1Mask | kSAI_Channel2Mask | kSAI_Channel3Mask))
-        {
-            dmaConfig->startIdx = 1;
-        }
-
-        dmaConfig->burstBytes = I2S_MIC_DMA_READ_BYTES * 3;
-        dmaConfig->burstSize  = I2S_MIC_DMA_CHUNK_BYTES;
-
-        dmaConfig->burstStride = 4;
-        dmaConfig->smloff      = (uint32_t) -12;
-    }
-
-    else if (channelMask == (kSAI_Channel0Mask | kSAI_Channel1Mask | kSAI_Channel2Mask | kSAI_Channel3Mask))
-    {
-        /* Get configuration for 4 adjacent microphones configuration.
-         * Determine index of the SAI register for the first microphone
-         * and set the desired number of bytes to be read to 2/4 * 4 in chunks of 2/4 bytes.
-         * It is also needed to jump 4 bytes after each read and modulo the address
-         * to circulate through 16 bytes of the 4 SAI channels. */
-
-        dmaConfig->startIdx = 0;
-
-        dmaConfig->burstBytes = I2S_MIC_DMA_READ_BYTES * 4;
-        dmaConfig->burstSize  = I2S_MIC_DMA_CHUNK_BYTES;
-
-        dmaConfig->burstStride = 4;
-        dmaConfig->burstMod    = kEDMA_Modulo16bytes;
-    }
-
-    else
-    {
-        /* Other channels configurations are not supported because they are not used and are not trivial to be implemented. */
-        while(1);
-    }
+#if (SLN_MIC_COUNT > 1)
+    return (micId == 0) ? handle->dmaChannel : handle->linkedDmaChannel[micId - 1];
+#else
+    return handle->dmaChannel;
+#endif /* (SLN_MIC_COUNT > 1) */
 }
 
 /**
- * @brief Convert transfer size in an appropriate mask.
+ * @brief Get the ping/pong TCDs of the DMA channel which stores the data of a mic.
  *
- * @param transferSize Transfer Size.
+ * @param handle Microphone handle.
+ * @param micId Microphone id.
  */
-static uint32_t I2S_MIC_ConvertSizeToOffset(edma_transfer_size_t transferSize)
+static edma_tcd_t *I2S_MIC_GetDmaTcd(sln_mic_handle_t *handle, uint32_t micId)
 {
-    uint32_t retVal = 0;
-
-    switch(transferSize)
-    {
-        case kEDMA_TransferSize1Bytes:
-        case kEDMA_TransferSize2Bytes:
-        case kEDMA_TransferSize4Bytes:
-        case kEDMA_TransferSize8Bytes:
-        case kEDMA_TransferSize32Bytes:
-        {
-            retVal = 1 << transferSize;
-            break;
-        }
-
-        default:
-        {
-            while (1);
-            break;
-        }
-    }
-
-    return retVal;
+#if (SLN_MIC_COUNT > 1)
+    return (micId == 0) ? handle->dmaTcd : handle->linkedDmaTcd[micId - 1];
+#else
+    return handle->dmaTcd;
+#endif /* (SLN_MIC_COUNT > 1) */
 }
 
 /**
  * @brief Configure EDMA to work with SAI configuration.
+ *        Every enabled SAI channel is read by its own DMA channel, one sample per minor loop,
+ *        and stored in its own plane of the ping/pong buffers.
  *
  * @param handle Microphone handle.
  */
 static void I2S_MIC_ConfigureEdma(sln_mic_handle_t *handle)
 {
-    i2s_mic_edma_config_t dmaConfig = {0};
+    uint32_t saiChannel  = 0;
+    uint32_t micId       = 0;
+    uint32_t dmaChannel  = 0;
+    uint32_t nextChannel = 0;
+    edma_tcd_t *tcd      = NULL;
+
+    for (saiChannel = 0; (saiChannel < ARRAY_SIZE(handle->config->sai->RDR)) && (micId < SLN_MIC_COUNT); saiChannel++)
+    {
+        if ((handle->config->saiChannelMask & (1U << saiChannel)) == 0)
+        {
+            continue;
+        }
 
-    I2S_MIC_GetEdmaConfiguration(handle->config->saiChannelMask, &dmaConfig);
+        dmaChannel = I2S_MIC_GetDmaChannel(handle, micId);
+        tcd        = I2S_MIC_GetDmaTcd(handle, micId);
 
+        for (uint32_t idx = 0; idx < EDMA_TCD_COUNT; idx++)
+        {
 #if (I2S_MIC_RAW_SAMPLE_SIZE==2)
-    handle->dmaTcd[0].SADDR = (uint32_t)(&handle->config->sai->RDR[dmaConfig.startIdx]) + 2;
-    handle->dmaTcd[1].SADDR = (uint32_t)(&handle->config->sai->RDR[dmaConfig.startIdx]) + 2;
+            tcd[idx].SADDR = (uint32_t)(&handle->config->sai->RDR[saiChannel]) + 2;
 #elif (I2S_MIC_RAW_SAMPLE_SIZE==4)
-    handle->dmaTcd[0].SADDR = (uint32_t)(&handle->config->sai->RDR[dmaConfig.startIdx]);
-    handle->dmaTcd[1].SADDR = (uint32_t)(&handle->config->sai->RDR[dmaConfig.startIdx]);
+            tcd[idx].SADDR = (uint32_t)(&handle->config->sai->RDR[saiChannel]);
 #endif /* I2S_MIC_RAW_SAMPLE_SIZE */
 
-    handle->dmaTcd[0].SOFF = dmaConfig.burstStride;
-    handle->dmaTcd[1].SOFF = dmaConfig.burstStride;
-
-    handle->dmaTcd[0].ATTR = (DMA_ATTR_SMOD(dmaConfig.burstMod) | DMA_ATTR_SSIZE(dmaConfig.burstSize) | DMA_ATTR_DSIZE(dmaConfig.burstSize));
-    handle->dmaTcd[1].ATTR = (DMA_ATTR_SMOD(dmaConfig.burstMod) | DMA_ATTR_SSIZE(dmaConfig.burstSize) | DMA_ATTR_DSIZE(dmaConfig.burstSize));
+            tcd[idx].SOFF      = 0U;
+            tcd[idx].ATTR      = (DMA_ATTR_SSIZE(I2S_MIC_DMA_CHUNK_BYTES) | DMA_ATTR_DSIZE(I2S_MIC_DMA_CHUNK_BYTES));
+            tcd[idx].NBYTES    = I2S_MIC_DMA_READ_BYTES;
+            tcd[idx].SLAST     = 0U;
+            tcd[idx].DADDR     = (uint32_t)handle->pingPongBuffer[idx] + (micId * handle->micPlaneBytes);
+            tcd[idx].DOFF      = I2S_MIC_DMA_READ_BYTES;
+            tcd[idx].DLAST_SGA = (uint32_t)&tcd[(idx + 1) % EDMA_TCD_COUNT];
 
-    handle->dmaTcd[0].NBYTES = dmaConfig.burstBytes;
-    handle->dmaTcd[1].NBYTES = dmaConfig.burstBytes;
+            if (micId < (SLN_MIC_COUNT - 1))
+            {
+                /* Start the next mic channel after every minor loop, including the last one */
+                nextChannel = I2S_MIC_GetDmaChannel(handle, micId + 1);
+
+                tcd[idx].CITER = (DMA_CITER_ELINKYES_ELINK(1U) | DMA_CITER_ELINKYES_LINKCH(nextChannel) |
+                                  DMA_CITER_ELINKYES_CITER(handle->config->saiCaptureCount));
+                tcd[idx].BITER = (DMA_BITER_ELINKYES_ELINK(1U) | DMA_BITER_ELINKYES_LINKCH(nextChannel) |
+                                  DMA_BITER_ELINKYES_BITER(handle->config->saiCaptureCount));
+                tcd[idx].CSR   = (DMA_CSR_ESG_MASK | DMA_CSR_MAJORELINK(1U) | DMA_CSR_MAJORLINKCH(nextChannel));
+            }
+            else
+            {
+                /* The last mic channel completes the ping/pong buffer */
+                tcd[idx].CITER = handle->config->saiCaptureCount;
+                tcd[idx].BITER = handle->config->saiCaptureCount;
+                tcd[idx].CSR   = (DMA_CSR_INTMAJOR_MASK | DMA_CSR_ESG_MASK);
+            }
+        }
 
-    if (dmaConfig.smloff != 0)
-    {
-        handle->dma->CR |= DMA_CR_EMLM(1U);
+        EDMA_InstallTCD(handle->dma, dmaChannel, &tcd[0]);
+        handle->dma->EEI |= (1 << dmaChannel);
 
-        handle->dmaTcd[0].NBYTES |= (DMA_NBYTES_MLOFFYES_SMLOE(1U) | DMA_NBYTES_MLOFFYES_MLOFF(dmaConfig.smloff));
-        handle->dmaTcd[1].NBYTES |= (DMA_NBYTES_MLOFFYES_SMLOE(1U) | DMA_NBYTES_MLOFFYES_MLOFF(dmaConfig.smloff));
+        micId++;
     }
 
-    handle->dmaTcd[0].SLAST = 0U;
-    handle->dmaTcd[1].SLAST = 0U;
-
-    handle->dmaTcd[0].DADDR = (uint32_t)handle->pingPongBuffer[0];
-    handle->dmaTcd[1].DADDR = (uint32_t)handle->pingPongBuffer[1];
-
-    handle->dmaTcd[0].DOFF = I2S_MIC_ConvertSizeToOffset(dmaConfig.burstSize);
-    handle->dmaTcd[1].DOFF = handle->dmaTcd[0].DOFF;
-
-    handle->dmaTcd[0].CITER = handle->config->saiCaptureCount;
-    handle->dmaTcd[1].CITER = handle->config->saiCaptureCount;
-
-    handle->dmaTcd[0].DLAST_SGA = (uint32_t)&handle->dmaTcd[1];
-    handle->dmaTcd[1].DLAST_SGA = (uint32_t)&handle->dmaTcd[0];
-
-    handle->dmaTcd[0].CSR = (DMA_CSR_INTMAJOR_MASK | DMA_CSR_ESG_MASK);
-    handle->dmaTcd[1].CSR = (DMA_CSR_INTMAJOR_MASK | DMA_CSR_ESG_MASK);
-
-    handle->dmaTcd[0].BITER = handle->config->saiCaptureCount;
-    handle->dmaTcd[1].BITER = handle->config->saiCaptureCount;
-
-    EDMA_InstallTCD(handle->dma, handle->dmaChannel, &handle->dmaTcd[0]);
-
+    /* Only the first mic channel is triggered by the SAI, the others are linked */
     DMAMUX_SetSource(DMAMUX, handle->dmaChannel, handle->dmaRequest);
     DMAMUX_EnableChannel(DMAMUX, handle->dmaChannel);
 
@@ -415,7 +290,6 @@ static void I2S_MIC_Configure(sln_mic_handle_t *handle)
 
     SAI_RxSetBitClockRate(I2S_MIC_SAI, I2S_MIC_SAI_CLK_FREQ, I2S_MIC_RAW_FREQUENCY_HZ, kSAI_WordWidth32bits, 2);
 
-    handle->dma->EEI |= (1 << handle->dmaChannel);
     handle->dma->SERQ = DMA_SERQ_SERQ(handle->dmaChannel);
 
     SAI_RxEnableDMA(I2S_MIC_SAI, kSAI_FIFORequestDMAEnable, true);
@@ -430,7 +304,10 @@ static void I2S_MIC_StartMic(sln_mic_handle_t *handle)
 {
     s_skipDirtyFrames = SKIP_DIRTY_FRAMES;
 
-    EDMA_InstallTCD(handle->dma, handle->dmaChannel, &handle->dmaTcd[0]);
+    for (uint32_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        EDMA_InstallTCD(handle->dma, I2S_MIC_GetDmaChannel(handle, micId), I2S_MIC_GetDmaTcd(handle, micId));
+    }
     handle->dma->SERQ = DMA_SERQ_SERQ(handle->dmaChannel);
 
     SAI_RxEnable(I2S_MIC_SAI, true);
@@ -458,7 +335,10 @@ static void I2S_MIC_StopMic(sln_mic_handle_t *handle)
 
     handle->config->sai->RCSR |= (I2S_RCSR_FWF_MASK | I2S_RCSR_FEF_MASK | I2S_TCSR_SEF_MASK | I2S_TCSR_WSF_MASK | I2S_RCSR_FR_MASK);
     handle->dma->CERQ = DMA_CERQ_CERQ(handle->dmaChannel);
-    EDMA_ResetChannel(handle->dma, handle->dmaChannel);
+    for (uint32_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        EDMA_ResetChannel(handle->dma, I2S_MIC_GetDmaChannel(handle, micId));
+    }
 }
 
 /**
@@ -468,11 +348,17 @@ static void I2S_MIC_StopMic(sln_mic_handle_t *handle)
  */
 static void PDM_MIC_DmaCallback(sln_mic_handle_t *handle)
 {
-    handle->dma->INT |= (1 << handle->dmaChannel);
+    /* The interrupt is raised by the DMA channel of the last mic */
+    uint32_t irqChannel = I2S_MIC_GetDmaChannel(handle, SLN_MIC_COUNT - 1);
+
+    handle->dma->INT |= (1 << irqChannel);
 
-    handle->dma->TCD[handle->dmaChannel].CSR &= ~DMA_CSR_DONE_MASK;
+    for (uint32_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        handle->dma->TCD[I2S_MIC_GetDmaChannel(handle, micId)].CSR &= ~DMA_CSR_DONE_MASK;
+    }
 
-    handle->dma->TCD[handle->dmaChannel].CSR |= DMA_CSR_ESG_MASK;
+    handle->dma->TCD[irqChannel].CSR |= DMA_CSR_ESG_MASK;
 
     handle->dma->SERQ = DMA_SERQ_SERQ(handle->dmaChannel);
 
@@ -480,6 +366,9 @@ static void PDM_MIC_DmaCallback(sln_mic_handle_t *handle)
 
     xHigherPriorityTaskWoken = pdFALSE;
 
+    /* Tag the completed buffer, it travels with the audio up to the ASR detection */
+    handle->captureTimestamp[handle->pingPongTracker & 0x01U] = AUDIO_LATENCY_GET_TIMESTAMP();
+
 #if ENABLE_AEC
 #if USE_MQS
     if (handle->pdmMicUpdateTimestamp != NULL)
@@ -516,6 +405,34 @@ static void PDM_MIC_DmaCallback(sln_mic_handle_t *handle)
     handle->pingPongTracker++;
 }
 
+/**
+ * @brief Convert one captured period into the current write slot of the PCM ring
+ *        and notify the audio processing task if it was published.
+ *
+ * @param rawData Pointer to the raw buffer (ping or pong) filled by the DMA.
+ * @param captureTimestamp Time stamp taken when the DMA filled the raw buffer.
+ */
+static void I2S_MIC_ProcessPeriod(uint8_t *rawData, uint32_t captureTimestamp)
+{
+    uint32_t slot      = SLN_MIC_RING_GetWriteSlot(&s_i2sMicPcmRing);
+    uint32_t profStart = 0;
+
+#if ENABLE_AEC
+#if USE_MQS
+    SLN_AMP_GetAmpStream(&s_taskConfig, &s_amp16KhzData[slot * PCM_SINGLE_CH_SMPL_COUNT], &s_pingPongTimestamp);
+#endif /* USE_MQS */
+#endif /* ENABLE_AEC */
+
+    profStart = AUDIO_PROFILER_GET_CYCLES();
+    I2S_MIC_ProcessMicStream(rawData, (int16_t *)s_i2sMicPcmData[slot]);
+    AUDIO_PROFILER_STOP(kAudioProfilerHpf, profStart);
+
+    if (SLN_MIC_RING_CommitWrite(&s_i2sMicPcmRing, captureTimestamp))
+    {
+        xTaskNotify(*(s_taskConfig.processingTask), PCM_DATA_EVENT, eSetBits);
+    }
+}
+
 /**
  * @brief DMA interrupt handler triggered when new mic data is available.
  *        It overrides the default handler which is WEAK.
@@ -534,6 +451,11 @@ int16_t *I2S_MIC_GetPcmBufferPointer(void)
     return (int16_t *)s_i2sMicPcmData;
 }
 
+sln_mic_ring_t *I2S_MIC_GetPcmRingPointer(void)
+{
+    return &s_i2sMicPcmRing;
+}
+
 int16_t *I2S_MIC_GetAmpBufferPointer(void)
 {
 #if ENABLE_AEC
@@ -565,6 +487,7 @@ void I2S_MIC_MicsOn(void)
 
         memset(s_i2sMicRawData, 0, sizeof(s_i2sMicRawData));
         memset(s_i2sMicPcmData, 0, sizeof(s_i2sMicPcmData));
+        SLN_MIC_RING_RequestReset(&s_i2sMicPcmRing);
 #if ENABLE_AEC
 #if USE_MQS
         memset(s_amp16KhzData, 0, sizeof(s_amp16KhzData));
@@ -621,7 +544,7 @@ void I2S_MIC_Task(void *pvParameters)
     s_i2sMicSaiHandle.eventGroup        = s_i2sMicDmaEventGroup;
     s_i2sMicSaiHandle.config            = &g_i2sMicSaiConfig;
     s_i2sMicSaiHandle.dma               = DMA0;
-    s_i2sMicSaiHandle.dmaChannel        = 1U;
+    s_i2sMicSaiHandle.dmaChannel        = BOARD_I2S_MIC_EDMA_CH;
     s_i2sMicSaiHandle.dmaIrqNum         = DMA1_DMA17_IRQn;
     s_i2sMicSaiHandle.dmaRequest        = (uint8_t)kDmaRequestMuxSai1Rx;
     s_i2sMicSaiHandle.pongFlag          = PCM_PONG_EVENT;
@@ -629,6 +552,10 @@ void I2S_MIC_Task(void *pvParameters)
     s_i2sMicSaiHandle.errorFlag         = PCM_ERROR_EVENT;
     s_i2sMicSaiHandle.pingPongBuffer[0] = (uint32_t *)(&s_i2sMicRawData[0][0]);
     s_i2sMicSaiHandle.pingPongBuffer[1] = (uint32_t *)(&s_i2sMicRawData[1][0]);
+    s_i2sMicSaiHandle.micPlaneBytes     = I2S_MIC_RAW_PLANE_BYTES;
+#if (SLN_MIC_COUNT > 1)
+    memcpy(s_i2sMicSaiHandle.linkedDmaChannel, kLinkedDmaChannels, sizeof(kLinkedDmaChannels));
+#endif /* (SLN_MIC_COUNT > 1) */
 #if ENABLE_AEC
 #if USE_MQS
     s_i2sMicSaiHandle.pdmMicUpdateTimestamp = I2S_MIC_UpdateTimestamp;
@@ -662,24 +589,12 @@ void I2S_MIC_Task(void *pvParameters)
 
         if (preProcessEvents & PCM_PING_EVENT)
         {
-#if ENABLE_AEC
-            SLN_AMP_GetAmpStream(&s_taskConfig, &s_amp16KhzData[0], &s_pingPongTimestamp);
-#endif /* ENABLE_AEC */
-
-            I2S_MIC_ProcessMicStream(s_i2sMicRawData[0], (int16_t *)s_i2sMicPcmData[0]);
-
-            xTaskNotify(*(s_taskConfig.processingTask), PCM_PING_EVENT, eSetBits);
+            I2S_MIC_ProcessPeriod(s_i2sMicRawData[0], s_i2sMicSaiHandle.captureTimestamp[0]);
         }
 
         if (preProcessEvents & PCM_PONG_EVENT)
         {
-#if ENABLE_AEC
-            SLN_AMP_GetAmpStream(&s_taskConfig, &s_amp16KhzData[PCM_SINGLE_CH_SMPL_COUNT], &s_pingPongTimestamp);
-#endif /* ENABLE_AEC */
-
-            I2S_MIC_ProcessMicStream(s_i2sMicRawData[1], (int16_t *)s_i2sMicPcmData[1]);
-
-            xTaskNotify(*(s_taskConfig.processingTask), PCM_PONG_EVENT, eSetBits);
+            I2S_MIC_ProcessPeriod(s_i2sMicRawData[1], s_i2sMicSaiHandle.captureTimestamp[1]);
         }
     }
 }
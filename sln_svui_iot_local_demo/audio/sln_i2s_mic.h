@@ -21,6 +21,13 @@
  */
 int16_t *I2S_MIC_GetPcmBufferPointer(void);
 
+/**
+ * @brief Return the pointer to the ring tracking the slots of the PCM mic data buffer.
+ *
+ * @return Pointer to the PCM ring.
+ */
+sln_mic_ring_t *I2S_MIC_GetPcmRingPointer(void);
+
 /**
  * @brief Return the pointer to the buffer containing PCM amp data.
  *
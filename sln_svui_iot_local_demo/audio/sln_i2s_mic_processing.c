@@ -1,5 +1,5 @@
 /*
- * Copyright 2022 NXP.
+ * Copyright 2022, 2024 NXP.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -18,68 +18,35 @@
 #define HPF_CUT_OFF_HZ 60
 #define HPF_SAMPLE_RATE PCM_SAMPLE_RATE_HZ
 
-/* Amplifier factor for mics */
-#define I2S_MIC_AMP_FACTOR 6
-
-/*******************************************************************************
- * Variables
- ******************************************************************************/
-
-/* Buffer used by HPF processing on mic raw data. */
-static float s_micFilteredArray[I2S_MIC_RAW_FRAME_SAMPLES_COUNT] = {0};
-
-/*******************************************************************************
- * Prototypes
- ******************************************************************************/
+/* The one pole HPF coefficient is stored in Q14, so that
+ * alpha * (x[n] + y[n-1] - x[n-1]) always fits in the 32 bits accumulator. */
+#define HPF_COEFF_SHIFT 14
+#define HPF_FRAC_MASK   ((1 << HPF_COEFF_SHIFT) - 1)
 
-static void I2S_MIC_MicHighPassFilter(int16_t *samples, uint32_t samplesCnt, uint8_t micId);
+#define HPF_RC    (1.0 / (HPF_CUT_OFF_HZ * 2 * 3.14))
+#define HPF_DT    (1.0 / HPF_SAMPLE_RATE)
+#define HPF_ALPHA (HPF_RC / (HPF_RC + HPF_DT))
 
-/*******************************************************************************
- * Code
- ******************************************************************************/
+/* Amplifier factor for mics */
+#define I2S_MIC_AMP_FACTOR 6
 
-/**
- * @brief Apply High Pass Filter on mic data.
- *
- * @param samples Pointer to the buffer containing 2B samples of data.
- * @param samplesCnt Number of samples in the buffer.
- * @param micId Microphone id (in order to use the appropriate previously saved fields).
+/*!
+ * @brief Per mic state of the High Pass Filter.
  */
-static void I2S_MIC_MicHighPassFilter(int16_t *samples, uint32_t samplesCnt, uint8_t micId)
+typedef struct _i2s_mic_hpf_state
 {
-    static float last_element_record[SLN_MIC_COUNT] = {0};
-    static float last_element_filter[SLN_MIC_COUNT] = {0};
-    static uint8_t first_time[SLN_MIC_COUNT]        = {0};
-
-    float RC    = 1.0 / (HPF_CUT_OFF_HZ * 2 * 3.14);
-    float dt    = 1.0 / HPF_SAMPLE_RATE;
-    float alpha = RC / (RC + dt);
-
-    memset(s_micFilteredArray, 0, sizeof(s_micFilteredArray));
-
-    if (first_time[micId] == 0)
-    {
-        first_time[micId] = 1;
-        s_micFilteredArray[0]  = samples[0];
-    }
-    else
-    {
-        s_micFilteredArray[0] = alpha * (last_element_filter[micId] + samples[0] - last_element_record[micId]);
-    }
+    int32_t lastRecord; /*!< Last input sample */
+    int32_t lastFilter; /*!< Last output sample */
+    int32_t lastFrac;   /*!< Fractional part of the last output, fed back to avoid the rounding dead band */
+} i2s_mic_hpf_state_t;
 
-    for (uint32_t i = 1; i < samplesCnt; i++)
-    {
-        s_micFilteredArray[i] = alpha * (s_micFilteredArray[i - 1] + samples[i] - samples[i - 1]);
-    }
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
 
-    last_element_record[micId] = samples[samplesCnt - 1];
-    last_element_filter[micId] = s_micFilteredArray[samplesCnt - 1];
+static const int16_t kHpfAlphaQ14 = (int16_t)(HPF_ALPHA * (1 << HPF_COEFF_SHIFT) + 0.5);
 
-    for (uint32_t i = 0; i < samplesCnt; i++)
-    {
-        samples[i] = (int16_t)(s_micFilteredArray[i]);
-    }
-}
+static i2s_mic_hpf_state_t s_hpfState[SLN_MIC_COUNT] = {0};
 
 /*******************************************************************************
  * API
@@ -91,6 +58,19 @@ void I2S_MIC_ProcessMicStream(uint8_t *in, int16_t *out)
     uint32_t i;
 
     int16_t *currentMicOut = NULL;
+#if (I2S_MIC_RAW_SAMPLE_SIZE==2)
+    int16_t *currentMicIn  = NULL;
+#elif (I2S_MIC_RAW_SAMPLE_SIZE==4)
+    int32_t *currentMicIn  = NULL;
+#endif /* I2S_MIC_RAW_SAMPLE_SIZE */
+    int32_t sample         = 0;
+    int32_t acc            = 0;
+    int32_t lastRecord     = 0;
+    int32_t lastFilter     = 0;
+    int32_t lastFrac       = 0;
+
+    /* Both halves hold alpha: one SMLAD computes alpha * x[n] + alpha * y[n-1] */
+    const uint32_t coeffPair = __PKHBT(kHpfAlphaQ14, kHpfAlphaQ14, 16);
 
 #if (I2S_MIC_RAW_SAMPLE_SIZE==2)
     int16_t *inBuff = (int16_t *)in;
@@ -100,19 +80,37 @@ void I2S_MIC_ProcessMicStream(uint8_t *in, int16_t *out)
 
     for (micId = 0; micId < SLN_MIC_COUNT; micId++)
     {
+        currentMicIn  = &inBuff[micId * I2S_MIC_RAW_FRAME_SAMPLES_COUNT];
         currentMicOut = &out[micId * PCM_SINGLE_CH_SMPL_COUNT];
 
+        lastRecord = s_hpfState[micId].lastRecord;
+        lastFilter = s_hpfState[micId].lastFilter;
+        lastFrac   = s_hpfState[micId].lastFrac;
+
+        /* Scale and apply High Pass Filter to center audio amplitudes to zero,
+         * reading every raw sample only once. */
         for (i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
         {
 #if (I2S_MIC_RAW_SAMPLE_SIZE==2)
-            currentMicOut[i] = (inBuff[i * SLN_MIC_COUNT + micId] * I2S_MIC_AMP_FACTOR);
+            sample = __SSAT(currentMicIn[i] * I2S_MIC_AMP_FACTOR, 16);
 #elif (I2S_MIC_RAW_SAMPLE_SIZE==4)
-            currentMicOut[i] = ((inBuff[i * SLN_MIC_COUNT + micId] * I2S_MIC_AMP_FACTOR) >> 16);
+            sample = __SSAT((int32_t)(((int64_t)currentMicIn[i] * I2S_MIC_AMP_FACTOR) >> 16), 16);
 #endif /* I2S_MIC_RAW_SAMPLE_SIZE */
+
+            /* y[n] = alpha * (y[n-1] + x[n] - x[n-1]) */
+            acc = (int32_t)__SMLAD(__PKHBT(sample, lastFilter, 16), coeffPair, (uint32_t)lastFrac);
+            acc -= kHpfAlphaQ14 * lastRecord;
+
+            lastRecord = sample;
+            lastFilter = __SSAT(acc >> HPF_COEFF_SHIFT, 16);
+            lastFrac   = acc & HPF_FRAC_MASK;
+
+            currentMicOut[i] = (int16_t)lastFilter;
         }
 
-        /* Apply High Pass Filter to center audio amplitudes to zero */
-        I2S_MIC_MicHighPassFilter(currentMicOut, PCM_SINGLE_CH_SMPL_COUNT, micId);
+        s_hpfState[micId].lastRecord = lastRecord;
+        s_hpfState[micId].lastFilter = lastFilter;
+        s_hpfState[micId].lastFrac   = lastFrac;
     }
 }
 
@@ -15,9 +15,8 @@
 
 /**
  * @brief Process microphones samples.
- *        Samples should be arranged in the following format: mic1 mic2 .. micN, mic1 mic2 .. micN, etc.
- *        Re-arange the samples in the following format: mic1 mic1 .. mic1, mic2 mic2 .. mic2, micN micN .. micN.
- *        Apply High Pass Filter to center audio amplitudes to zero.
+ *        Samples should be arranged in planes, as stored by the DMA: mic1 mic1 .. mic1, mic2 mic2 .. mic2, micN micN .. micN.
+ *        Scale the samples to 16 bits and apply High Pass Filter to center audio amplitudes to zero.
  *
  * @param in Pointer to the buffer containing the samples.
  * @param out Pointer where to store processed data.
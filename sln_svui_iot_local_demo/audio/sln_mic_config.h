@@ -16,9 +16,11 @@
 #include "fsl_edma.h"
 #include "fsl_sai.h"
 
+#include "sln_mic_ring.h"
+
 #if USE_MQS
 #include "semphr.h"
-#include "ringbuffer.h"
+#include "sln_amp_ring.h"
 #endif /* USE_MQS */
 
 /*******************************************************************************
@@ -36,13 +38,34 @@
  * Microphone configuration
  ******************************************************************************/
 
+/* Capture period in ms, one DMA ping/pong half and one PCM ring slot. Acceptable values: 5, 10 or 20.
+ * 5  --> low latency profile (barge-in): the mics are handed to the AFE 5ms earlier, twice the mic task wake-ups.
+ * 10 --> default profile, one capture period per SLN_AFE block.
+ * 20 --> low power profile: half the DMA interrupts and mic task wake-ups, 10ms more capture latency.
+ * SLN_AFE always processes 10ms blocks (AFE_BLOCK_SMPL_COUNT), audio_processing_task re-cuts the periods. */
+#ifndef SLN_MIC_PERIOD_MS
+#define SLN_MIC_PERIOD_MS 10
+#endif /* SLN_MIC_PERIOD_MS */
+
+#if (SLN_MIC_PERIOD_MS != 5) && (SLN_MIC_PERIOD_MS != 10) && (SLN_MIC_PERIOD_MS != 20)
+#error "SLN_MIC_PERIOD_MS should be set to 5, 10 or 20"
+#endif /* SLN_MIC_PERIOD_MS */
+
 #define EDMA_TCD_COUNT           2
-#define PCM_SINGLE_CH_SMPL_COUNT 160U
+#define PCM_SAMPLES_PER_MS       16U
+#define PCM_SINGLE_CH_SMPL_COUNT (PCM_SAMPLES_PER_MS * SLN_MIC_PERIOD_MS)
+
+/* Number of samples per mic processed by one SLN_AFE_Process_Audio call (10ms) */
+#define AFE_BLOCK_SMPL_COUNT 160U
 
 #if (MICS_TYPE == MICS_PDM)
 
 #define USE_NEW_PDM_PCM_LIB 1
 
+/* Feed SLN_AFE directly with the float output of the PDM to PCM library (kAfeTypeFloat).
+ * When set, the int16 microphone stream is only generated for the audio dump. */
+#define SLN_MIC_FLOAT_STREAM USE_NEW_PDM_PCM_LIB
+
 #define PDM_BUFFER_COUNT       (EDMA_TCD_COUNT)
 #define PDM_SAMPLE_COUNT       (PCM_SINGLE_CH_SMPL_COUNT * 4)
 #define PDM_CAPTURE_SIZE_BYTES (4U)
@@ -70,6 +93,8 @@
 #define SAI_USE_COUNT ((USE_SAI2_MIC) + ((SAI1_CH_COUNT > 0) ? 1 : 0))
 
 #define SLN_MIC_GET_PCM_BUFFER_POINTER() pdm_to_pcm_get_pcm_output()
+#define SLN_MIC_GET_RING_POINTER()       pdm_to_pcm_get_pcm_ring()
+#define SLN_MIC_GET_PCM_FLOAT_BUFFER_POINTER() pdm_to_pcm_get_pcm_float_output()
 #define SLN_MIC_GET_AMP_BUFFER_POINTER() pdm_to_pcm_get_amp_output()
 #define SLN_MIC_SET_TASK_CONFIG(x)       pcm_to_pcm_set_config(x)
 #define SLN_MIC_ON                       pdm_to_pcm_mics_on
@@ -108,7 +133,10 @@
 #define I2S_MIC_RAW_SAMPLE_SIZE 4
 
 /* --- Static configurations --- */
+#define SLN_MIC_FLOAT_STREAM             0
+
 #define SLN_MIC_GET_PCM_BUFFER_POINTER() I2S_MIC_GetPcmBufferPointer()
+#define SLN_MIC_GET_RING_POINTER()       I2S_MIC_GetPcmRingPointer()
 #define SLN_MIC_GET_AMP_BUFFER_POINTER() I2S_MIC_GetAmpBufferPointer()
 #define SLN_MIC_SET_TASK_CONFIG(x)       I2S_MIC_SetTaskConfig(x)
 #define SLN_MIC_ON                       I2S_MIC_MicsOn
@@ -122,7 +150,7 @@
 #define SLN_MIC_TASK_PRIORITY            (configMAX_PRIORITIES - 2)
 
 #define I2S_MIC_RAW_FREQUENCY_HZ        kSAI_SampleRate16KHz
-#define I2S_MIC_RAW_FRAME_SAMPLES_COUNT (I2S_MIC_RAW_FREQUENCY_HZ / 100)
+#define I2S_MIC_RAW_FRAME_SAMPLES_COUNT ((I2S_MIC_RAW_FREQUENCY_HZ / 1000) * SLN_MIC_PERIOD_MS)
 #define I2S_MIC_SAMPLING_EDGE           kSAI_SampleOnFallingEdge
 
 #if (SLN_MIC_COUNT==1)
@@ -155,7 +183,9 @@
 #define PCM_SAMPLE_SIZE_BYTES (2U)
 #define PCM_SAMPLE_RATE_HZ    (16000U)
 #define PCM_SAMPLE_COUNT      (PCM_SINGLE_CH_SMPL_COUNT * SLN_MIC_COUNT)
-#define PCM_BUFFER_COUNT      (EDMA_TCD_COUNT)
+/* The DMA keeps capturing in ping-pong, while the PCM output is a ring of PCM_RING_SLOTS slots,
+ * so the audio processing task can fall behind by up to PCM_RING_DEPTH periods without losing data. */
+#define PCM_BUFFER_COUNT      (PCM_RING_SLOTS)
 
 /*******************************************************************************
  * Amplifier Stream Sample Definitions
@@ -166,27 +196,45 @@
 
 #define AMP_WRITE_SLOTS 4
 
-#define PCM_AMP_DATA_SIZE_1_MS  ((PCM_AMP_SAMPLE_COUNT * PCM_SAMPLE_SIZE_BYTES) / 10)
+#define PCM_AMP_DATA_SIZE_1_MS  ((PCM_AMP_SAMPLE_RATE_HZ / 1000) * PCM_SAMPLE_SIZE_BYTES)
 #define PCM_AMP_DATA_SIZE_10_MS (10 * PCM_AMP_DATA_SIZE_1_MS)
 #define PCM_AMP_DATA_SIZE_20_MS (20 * PCM_AMP_DATA_SIZE_1_MS)
 
+/* Amplifier data consumed by the mic task for one capture period */
+#define PCM_AMP_DATA_SIZE_PERIOD (SLN_MIC_PERIOD_MS * PCM_AMP_DATA_SIZE_1_MS)
+
 #if USE_MQS
-/* Set the loopback constant delay to 2.07ms. Assuming that the amplifier starts to play exactly when
- * a ping/pong event is triggered, AMP_LOOPBACK_CONST_DELAY_US is the only delay required for synchronization.
- * This value was manually calculated using usb_aec_alignment_tool. */
-#define AMP_LOOPBACK_CONST_DELAY_US    2070
-#define AMP_LOOPBACK_CONST_DELAY_BYTES ((AMP_LOOPBACK_CONST_DELAY_US * PCM_AMP_DATA_SIZE_1_MS) / 1000)
-
-/* Set the loopback variable max delay to 12.07ms. This value represents the time delay difference between the
- * current amplifier start and previous ping/pong event.
- * Since ping/pong event is triggered once ~ 10ms, keep the maximum value to 12.07ms. */
-#define AMP_LOOPBACK_MAX_VAR_DELAY_US    12070
+/* Loopback time stamps (SLN_AMP_GetTimestamp) are GPT ticks. For 24Mhz and PS=200, 1 tick ~= 8.4us. */
+#define AMP_LOOPBACK_GPT_FREQ_MHZ 24
+#define AMP_LOOPBACK_GPT_PS       200
+
+/* Convert Loopback GPT ticks to microseconds */
+#define AMP_LOOPBACK_GPT_TICKS_TO_US(ticks) (((ticks) * AMP_LOOPBACK_GPT_PS) / AMP_LOOPBACK_GPT_FREQ_MHZ)
+
+/* Group delay added to the loopback reference by the 24KHz to 16KHz polyphase resampler (72 taps at 48KHz),
+ * on top of the two samples average it replaced. The reference is already late by this much. */
+#define AMP_LOOPBACK_RESAMPLER_DELAY_US 720
+
+/* Set the loopback constant delay to 2.07ms minus the resampler delay. Assuming that the amplifier starts to play
+ * exactly when a ping/pong event is triggered, AMP_LOOPBACK_CONST_DELAY_US is the only delay required for
+ * synchronization. The 2.07ms were manually calculated using usb_aec_alignment_tool. */
+#define AMP_LOOPBACK_CONST_DELAY_US    (2070 - AMP_LOOPBACK_RESAMPLER_DELAY_US)
+
+/* The constant delay can be replaced at runtime by the one measured by the AEC calibration (SLN_AMP_SetLoopbackDelayUs).
+ * The measured delay is limited to AMP_LOOPBACK_MAX_CONST_DELAY_US, which sizes the loopback ringbuffer. */
+#define AMP_LOOPBACK_MAX_CONST_DELAY_US    6000
+#define AMP_LOOPBACK_MAX_CONST_DELAY_BYTES ((AMP_LOOPBACK_MAX_CONST_DELAY_US * PCM_AMP_DATA_SIZE_1_MS) / 1000)
+
+/* Set the loopback variable max delay to the period plus the constant delay (12.07ms for 10ms periods by default).
+ * This value represents the time delay difference between the current amplifier start and previous ping/pong event.
+ * Since ping/pong event is triggered once every SLN_MIC_PERIOD_MS, keep the maximum value to the period + constant delay. */
+#define AMP_LOOPBACK_MAX_VAR_DELAY_US    ((SLN_MIC_PERIOD_MS * 1000) + AMP_LOOPBACK_MAX_CONST_DELAY_US)
 #define AMP_LOOPBACK_MAX_VAR_DELAY_BYTES ((AMP_LOOPBACK_MAX_VAR_DELAY_US * PCM_AMP_DATA_SIZE_1_MS) / 1000)
 
 /* The loopback mechanism requires extra space inside the ringbuffer to store the delay zeroes:
- * Constant  delay: ~12ms equal to AMP_LOOPBACK_CONST_DELAY_US
+ * Constant  delay: AMP_LOOPBACK_CONST_DELAY_US or the calibrated one, at most AMP_LOOPBACK_MAX_CONST_DELAY_US
  * Variable delay: This one is calculated at the beginning of a playback using LOOPBACK_GPT. */
-#define AMP_LOOPBACK_MAX_DELAY_BYTES (AMP_LOOPBACK_CONST_DELAY_BYTES + AMP_LOOPBACK_MAX_VAR_DELAY_BYTES)
+#define AMP_LOOPBACK_MAX_DELAY_BYTES (AMP_LOOPBACK_MAX_CONST_DELAY_BYTES + AMP_LOOPBACK_MAX_VAR_DELAY_BYTES)
 
 /* Set the loopback ringbuf size */
 #define AMP_LOOPBACK_RINGBUF_SIZE ((AMP_WRITE_SLOTS * PCM_AMP_DATA_SIZE_20_MS) + AMP_LOOPBACK_MAX_DELAY_BYTES)
@@ -196,13 +244,18 @@
  * Typedefs, enumerations and structures
  ******************************************************************************/
 
-typedef int16_t pcmPingPong_t[PCM_BUFFER_COUNT][PCM_SAMPLE_COUNT];
+typedef int16_t pcmRingBuffer_t[PCM_BUFFER_COUNT][PCM_SAMPLE_COUNT];
+
+#if SLN_MIC_FLOAT_STREAM
+typedef float pcmRingBufferFloat_t[PCM_BUFFER_COUNT][PCM_SAMPLE_COUNT];
+#endif /* SLN_MIC_FLOAT_STREAM */
 
 typedef enum _pcm_event
 {
     PCM_PING_EVENT  = (1 << 0),
     PCM_PONG_EVENT  = (1 << 1),
     PCM_ERROR_EVENT = (1 << 2),
+    PCM_DATA_EVENT  = (1 << 3), /* A new period was published in the PCM ring */
 } pcm_event_t;
 
 typedef struct _sai_mic_config
@@ -221,8 +274,7 @@ typedef struct _mic_task_config
     void (*feedbackEnable)(void);
     void (*feedbackDisable)(void);
 #if USE_MQS
-    ringbuf_t *loopbackRingBuffer;
-    SemaphoreHandle_t loopbackMutex;
+    sln_amp_ring_t *loopbackRingBuffer;
     void (*updateTimestamp)(uint32_t);
     uint32_t (*getTimestamp)(void);
 #endif /* USE_MQS */
@@ -232,6 +284,10 @@ typedef struct _mic_task_config
 typedef struct _sln_mic_handle
 {
     edma_tcd_t dmaTcd[EDMA_TCD_COUNT]; /* This structure is same as TCD register which is described in reference manual */
+#if (MICS_TYPE == MICS_I2S) && (SLN_MIC_COUNT > 1)
+    edma_tcd_t linkedDmaTcd[SLN_MIC_COUNT - 1][EDMA_TCD_COUNT]; /* TCDs of the channels linked after dmaChannel, one per extra mic */
+    uint32_t linkedDmaChannel[SLN_MIC_COUNT - 1];               /* DMA channels linked after dmaChannel, the last one raises the interrupt */
+#endif /* (MICS_TYPE == MICS_I2S) && (SLN_MIC_COUNT > 1) */
     sai_mic_config_t *config;          /* Microphone configuration */
     DMA_Type *dma;                     /* DMA interface */
     uint32_t dmaChannel;               /* DMA channel */
@@ -243,6 +299,8 @@ typedef struct _sln_mic_handle
     EventBits_t errorFlag;
     uint32_t pingPongTracker;
     uint32_t *pingPongBuffer[EDMA_TCD_COUNT];
+    uint32_t micPlaneBytes;            /* When not 0, DMA stores each mic in its own contiguous plane of this size */
+    volatile uint32_t captureTimestamp[EDMA_TCD_COUNT]; /* Time stamp of the last DMA completion of each ping/pong buffer */
 #if ENABLE_AEC
 #if USE_MQS
     void (*pdmMicUpdateTimestamp)(void);
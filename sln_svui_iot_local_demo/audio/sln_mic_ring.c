@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "fsl_common.h"
+
+#include "sln_mic_ring.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* The indices are slot numbers, so they never wrap in the middle of the ring.
+ * The writer slot is never published, so the fill is at most PCM_RING_DEPTH and stays unambiguous. */
+#define PCM_RING_NEXT(idx) (((idx) + 1U) % PCM_RING_SLOTS)
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void SLN_MIC_RING_RequestReset(sln_mic_ring_t *ring)
+{
+    if (ring != NULL)
+    {
+        ring->captureSeq = 0;
+        ring->overruns   = 0;
+        ring->maxFill    = 0;
+
+        /* The statistics must be cleared before the reader drops the pending periods */
+        __DMB();
+        ring->resetPending = true;
+    }
+}
+
+uint32_t SLN_MIC_RING_GetWriteSlot(sln_mic_ring_t *ring)
+{
+    return ring->writeIdx;
+}
+
+bool SLN_MIC_RING_CommitWrite(sln_mic_ring_t *ring, uint32_t timestamp)
+{
+    bool published = false;
+    uint32_t fill  = SLN_MIC_RING_GetFill(ring);
+
+    if (fill < PCM_RING_DEPTH)
+    {
+        ring->slotSeq[ring->writeIdx]       = ring->captureSeq;
+        ring->slotTimestamp[ring->writeIdx] = timestamp;
+
+        /* The slot content and its sequence number must be visible before the slot is published */
+        __DMB();
+        ring->writeIdx = PCM_RING_NEXT(ring->writeIdx);
+
+        fill++;
+        if (fill > ring->maxFill)
+        {
+            ring->maxFill = fill;
+        }
+
+        published = true;
+    }
+    else
+    {
+        /* The slot is not published, so it will be overwritten by the next period */
+        ring->overruns++;
+    }
+
+    ring->captureSeq++;
+
+    return published;
+}
+
+bool SLN_MIC_RING_GetReadSlot(sln_mic_ring_t *ring, uint32_t *slot, uint32_t *seq)
+{
+    bool available = false;
+
+    if (ring->resetPending)
+    {
+        /* Called between two periods, the reader does not hold any slot.
+         * Clear the request first, so a new one is not lost. */
+        ring->resetPending = false;
+        __DMB();
+        ring->readIdx = ring->writeIdx;
+    }
+
+    if (ring->readIdx != ring->writeIdx)
+    {
+        *slot = ring->readIdx;
+        if (seq != NULL)
+        {
+            *seq = ring->slotSeq[*slot];
+        }
+
+        available = true;
+    }
+
+    return available;
+}
+
+void SLN_MIC_RING_CommitRead(sln_mic_ring_t *ring)
+{
+    if (ring->readIdx != ring->writeIdx)
+    {
+        ring->readIdx = PCM_RING_NEXT(ring->readIdx);
+    }
+}
+
+uint32_t SLN_MIC_RING_GetSlotTimestamp(sln_mic_ring_t *ring, uint32_t slot)
+{
+    return ring->slotTimestamp[slot % PCM_RING_SLOTS];
+}
+
+uint32_t SLN_MIC_RING_GetFill(sln_mic_ring_t *ring)
+{
+    return (ring->writeIdx + PCM_RING_SLOTS - ring->readIdx) % PCM_RING_SLOTS;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_MIC_RING_H_
+#define _SLN_MIC_RING_H_
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Number of captured periods which can wait for the audio processing task.
+ * The ring has one more slot, always owned by the mic task for the period being captured. */
+#ifndef PCM_RING_DEPTH
+#define PCM_RING_DEPTH 4
+#endif /* PCM_RING_DEPTH */
+
+#define PCM_RING_SLOTS (PCM_RING_DEPTH + 1)
+
+/*!
+ * @brief Capture ring shared by the mic task (single writer) and the audio processing task (single reader).
+ *        The ring only manages slot indices, the audio buffers are owned by the mic driver.
+ */
+typedef struct _sln_mic_ring
+{
+    volatile uint32_t writeIdx;              /*!< Slot of the period being captured, owned by the writer */
+    volatile uint32_t readIdx;               /*!< Slot of the oldest period not processed yet, owned by the reader */
+    volatile bool resetPending;              /*!< Set by the writer, the reader drops the pending periods */
+    volatile uint32_t captureSeq;            /*!< Sequence number of the period being captured */
+    volatile uint32_t slotSeq[PCM_RING_SLOTS]; /*!< Sequence number of the period stored in each slot */
+    volatile uint32_t slotTimestamp[PCM_RING_SLOTS]; /*!< Capture time stamp of the period stored in each slot */
+    volatile uint32_t overruns;              /*!< Periods dropped because the ring was full */
+    volatile uint32_t maxFill;               /*!< Highest number of periods waiting to be processed */
+} sln_mic_ring_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Clear the statistics and restart the sequence numbers. Called by the mic task.
+ *        The reader may still hold a slot, so the pending periods are dropped by the reader
+ *        in its next SLN_MIC_RING_GetReadSlot, at a period boundary.
+ *
+ * @param ring Pointer to the ring
+ */
+void SLN_MIC_RING_RequestReset(sln_mic_ring_t *ring);
+
+/*!
+ * @brief Get the slot where the mic task stores the period being captured.
+ *        The slot is never visible to the reader before SLN_MIC_RING_CommitWrite.
+ *
+ * @param ring Pointer to the ring
+ * @returns Slot index
+ */
+uint32_t SLN_MIC_RING_GetWriteSlot(sln_mic_ring_t *ring);
+
+/*!
+ * @brief Publish the captured period. If the reader is PCM_RING_DEPTH periods behind,
+ *        the period is dropped and counted as an overrun.
+ *
+ * @param ring      Pointer to the ring
+ * @param timestamp Time stamp taken when the DMA completed the capture of the period
+ * @returns true if the period was published, false if it was dropped
+ */
+bool SLN_MIC_RING_CommitWrite(sln_mic_ring_t *ring, uint32_t timestamp);
+
+/*!
+ * @brief Get the oldest period which was not processed yet.
+ *        The periods published before a SLN_MIC_RING_RequestReset are dropped first.
+ *
+ * @param ring Pointer to the ring
+ * @param slot Pointer where the slot index will be stored
+ * @param seq  Pointer where the period sequence number will be stored, can be NULL
+ * @returns true if a period is available
+ */
+bool SLN_MIC_RING_GetReadSlot(sln_mic_ring_t *ring, uint32_t *slot, uint32_t *seq);
+
+/*!
+ * @brief Give the slot returned by SLN_MIC_RING_GetReadSlot back to the mic task.
+ *
+ * @param ring Pointer to the ring
+ */
+void SLN_MIC_RING_CommitRead(sln_mic_ring_t *ring);
+
+/*!
+ * @brief Get the capture time stamp of the period stored in a slot returned by SLN_MIC_RING_GetReadSlot.
+ *
+ * @param ring Pointer to the ring
+ * @param slot Slot index
+ */
+uint32_t SLN_MIC_RING_GetSlotTimestamp(sln_mic_ring_t *ring, uint32_t slot);
+
+/*!
+ * @brief Get the number of periods waiting to be processed.
+ *
+ * @param ring Pointer to the ring
+ */
+uint32_t SLN_MIC_RING_GetFill(sln_mic_ring_t *ring);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _SLN_MIC_RING_H_ */
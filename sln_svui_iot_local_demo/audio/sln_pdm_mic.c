@@ -9,6 +9,7 @@
 #if (MICS_TYPE == MICS_PDM)
 
 #include "sln_pdm_mic.h"
+#include "audio_latency.h"
 #include <limits.h>
 #include "fsl_dmamux.h"
 #include "fsl_sai.h"
@@ -32,7 +33,7 @@
     (CLOCK_GetFreq(kCLOCK_AudioPllClk) / (PDM_SAI_CLOCK_SOURCE_DIVIDER + 1U) / (PDM_SAI_CLOCK_SOURCE_PRE_DIVIDER + 1U))
 
 /* Skip first chunks of mic data because mics are not reliable right after boot. */
-#define SKIP_DIRTY_FRAMES 4
+#define SKIP_DIRTY_FRAMES (40U / SLN_MIC_PERIOD_MS)
 
 /*******************************************************************************
  * Prototypes
@@ -63,6 +64,9 @@ void PDM_MIC_DmaCallback(sln_mic_handle_t *handle)
 
     xHigherPriorityTaskWoken = pdFALSE;
 
+    /* Tag the completed buffer, it travels with the audio up to the ASR detection */
+    handle->captureTimestamp[handle->pingPongTracker & 0x01U] = AUDIO_LATENCY_GET_TIMESTAMP();
+
 #if ENABLE_AEC
 #if USE_MQS
     if (handle->pdmMicUpdateTimestamp != NULL)
@@ -228,6 +232,24 @@ pdm_mic_status_t PDM_MIC_ConfigMic(sln_mic_handle_t *handle)
     handle->dmaTcd[0].BITER = handle->config->saiCaptureCount;
     handle->dmaTcd[1].BITER = handle->config->saiCaptureCount;
 
+    if ((handle->micPlaneBytes != 0U) && (burstBytes == 8U) && ((startIndex % 2U) == 0U))
+    {
+        /* Store each of the 2 channels in its own plane: read the 2 RDR registers with 4 bytes
+         * accesses (the source address wraps on 8 bytes), write them one plane apart and go back
+         * to the next sample of the first plane after each minor loop. */
+        for (uint32_t idx = 0; idx < EDMA_TCD_COUNT; idx++)
+        {
+            handle->dmaTcd[idx].SOFF   = 4U;
+            handle->dmaTcd[idx].ATTR   = (DMA_ATTR_SMOD(kEDMA_Modulo8bytes) | DMA_ATTR_SSIZE(kEDMA_TransferSize4Bytes) |
+                                        DMA_ATTR_DSIZE(kEDMA_TransferSize4Bytes));
+            handle->dmaTcd[idx].NBYTES = (DMA_NBYTES_MLOFFYES_NBYTES(8U) | DMA_NBYTES_MLOFFYES_DMLOE(1U) |
+                                          DMA_NBYTES_MLOFFYES_MLOFF(4U - (2U * handle->micPlaneBytes)));
+            handle->dmaTcd[idx].DOFF   = handle->micPlaneBytes;
+        }
+
+        handle->dma->CR |= DMA_CR_EMLM(1U);
+    }
+
     EDMA_InstallTCD(handle->dma, handle->dmaChannel, &handle->dmaTcd[0]);
 
     DMAMUX_SetSource(DMAMUX, handle->dmaChannel, handle->dmaRequest);
@@ -7,6 +7,7 @@
 #if ENABLE_STREAMER
 
 #include "sln_streamer.h"
+#include "local_sounds_task.h"
 #include "FreeRTOSConfig.h"
 #include "fsl_common.h"
 #include "stdint.h"
@@ -72,6 +73,15 @@ status_t LOCAL_SOUNDS_PlayAudioFile(char *audioFileName, int32_t volume)
     {
         if ((audioFileName != NULL) && (!SLN_STREAMER_IsPlaying(&s_streamerHandle)))
         {
+#if ENABLE_STREAMER_CACHE
+            /* Play the prompt from RAM if it was decoded before */
+            status = SLN_STREAMER_PlayCachedSound(&s_streamerHandle, audioFileName, volume);
+            if (kStatus_Success == status)
+            {
+                return status;
+            }
+#endif /* ENABLE_STREAMER_CACHE */
+
             status = SLN_STREAMER_SetLocalSound(&s_streamerHandle, audioFileName);
             if (kStatus_Success == status)
             {
@@ -107,9 +117,50 @@ status_t LOCAL_SOUNDS_PlayAudioFile(char *audioFileName, int32_t volume)
     return status;
 }
 
+status_t LOCAL_SOUNDS_QueueAudioFile(char *audioFileName, int32_t volume)
+{
+    status_t status = kStatus_Success;
+
+    if ((s_streamerHandle.streamer == NULL) || (audioFileName == NULL))
+    {
+        configPRINTF(("[WARNING] Streamer NOT ready\r\n"));
+        return kStatus_Fail;
+    }
+
+    status = SLN_STREAMER_QueueLocalSound(&s_streamerHandle, audioFileName);
+    if (status == kStatus_NoData)
+    {
+        /* No prompt is read by the streamer, start this one once the speaker is free */
+        LOCAL_SOUNDS_WaitForIdle(UINT32_MAX);
+        status = LOCAL_SOUNDS_PlayAudioFile(audioFileName, volume);
+    }
+
+    return status;
+}
+
+void LOCAL_SOUNDS_CancelPlaylist(bool stopCurrent)
+{
+    if (s_streamerHandle.streamer == NULL)
+    {
+        return;
+    }
+
+    SLN_STREAMER_ClearPlaylist(&s_streamerHandle);
+
+    if (stopCurrent && SLN_STREAMER_IsPlaying(&s_streamerHandle))
+    {
+        SLN_STREAMER_Stop(&s_streamerHandle);
+    }
+}
+
 bool LOCAL_SOUNDS_isPlaying(void)
 {
     return SLN_STREAMER_IsPlaying(&s_streamerHandle);
 }
 
+bool LOCAL_SOUNDS_WaitForIdle(uint32_t timeoutMs)
+{
+    return SLN_STREAMER_WaitForIdle(&s_streamerHandle, timeoutMs);
+}
+
 #endif /* ENABLE_STREAMER */
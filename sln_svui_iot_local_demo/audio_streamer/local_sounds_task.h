@@ -37,6 +37,25 @@ status_t LOCAL_SOUNDS_InitStreamer(void);
  *  @return kStatus_Success if success.
  */
 status_t LOCAL_SOUNDS_PlayAudioFile(char *audioFileName, int32_t volume);
+/**
+ * @brief Queue an offline audio to be played right after the one playing, without a gap.
+ *        If no audio is playing, play it as LOCAL_SOUNDS_PlayAudioFile does.
+ *        If an audio which can not be followed is playing (cached or ending), wait for its end first.
+ *
+ * @param audioFileName Path to the audio file in the filesystem, must stay valid until it was played.
+ * @param volume Volume of the audio, only used if the audio is not queued after another one.
+ *
+ *  @return kStatus_Success if success.
+ */
+status_t LOCAL_SOUNDS_QueueAudioFile(char *audioFileName, int32_t volume);
+
+/**
+ * @brief Drop the audio files queued by LOCAL_SOUNDS_QueueAudioFile, for example on barge-in.
+ *
+ * @param stopCurrent true to also stop the audio file playing.
+ */
+void LOCAL_SOUNDS_CancelPlaylist(bool stopCurrent);
+
 /**
  * @brief Check if the audio streamer is playing a file
  *
@@ -44,5 +63,14 @@ status_t LOCAL_SOUNDS_PlayAudioFile(char *audioFileName, int32_t volume);
  */
 bool LOCAL_SOUNDS_isPlaying(void);
 
+/**
+ * @brief Block until the audio streamer is not playing a file
+ *
+ * @param timeoutMs Maximum time to wait, UINT32_MAX to wait forever.
+ *
+ * @return true if it is not playing, false if the timeout expired.
+ */
+bool LOCAL_SOUNDS_WaitForIdle(uint32_t timeoutMs);
+
 #endif /* ENABLE_STREAMER */
 #endif /* LOCAL_SOUNDS_TASK_H_ */
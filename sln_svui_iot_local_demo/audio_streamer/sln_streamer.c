@@ -8,11 +8,17 @@
 
 #include "osa_common.h"
 #include "fsl_common.h"
+#include "event_groups.h"
 
 #include "sln_streamer.h"
 #include "streamer_pcm.h"
 #include "af_error.h"
 #include "sln_flash_fs_ops.h"
+#include "sln_amplifier.h"
+#include "timers.h"
+#if ENABLE_STREAMER_CACHE
+#include "sln_streamer_cache.h"
+#endif /* ENABLE_STREAMER_CACHE */
 
 #define APP_STREAMER_MSG_QUEUE     "app_queue"
 #define STREAMER_TASK_NAME         "Streamer"
@@ -22,6 +28,32 @@
 #define STREAMER_MESSAGE_TASK_STACK_SIZE 512
 #define STREAMER_DEFAULT_VOLUME          60
 
+/* Set in s_playbackEvents while the streamer is not playing */
+#define STREAMER_IDLE_EVT (1U << 0)
+
+/* Longest wait at the end of a prompt for the amplifier to play the last decoded blocks */
+#define STREAMER_TAIL_TIMEOUT_MS 200
+
+/* Start of the next prompt of the playlist read from flash while the current one plays,
+ * so the switch between the prompts does not wait for the file system */
+#define STREAMER_PLAYLIST_PRELOAD_SIZE (16 * STREAMER_PCM_OPUS_FRAME_SIZE)
+
+/* Time the amplifier needs after its power on before it plays */
+#define STREAMER_AMP_POWER_UP_MS 150
+
+/* Time the amplifier stays powered after a playback, so the prompt answering a command
+ * does not wait again for the power up of the amplifier. 0 powers it off at the end of the playback. */
+#ifndef STREAMER_AMP_HOLD_MS
+#define STREAMER_AMP_HOLD_MS 3000
+#endif /* STREAMER_AMP_HOLD_MS */
+
+#if ENABLE_STREAMER_CACHE
+/* Task waiting for the end of the cached prompts played by the amplifier */
+#define STREAMER_CACHE_TASK_NAME       "StreamerCache"
+#define STREAMER_CACHE_TASK_STACK_SIZE 256
+#define STREAMER_CACHE_TASK_PRIORITY   (configMAX_PRIORITIES - 4)
+#endif /* ENABLE_STREAMER_CACHE */
+
 /*! @brief local OPUS file internal structure definition */
 typedef struct _streamer_local_file
 {
@@ -33,11 +65,91 @@ typedef struct _streamer_local_file
 /* Declaration of OPUS file used for playing OPUS audio locally */
 static streamer_local_file_t local_active_file_desc;
 
+/* Prompts played after local_active_file_desc, in the same stream */
+static streamer_local_file_t s_playlist[STREAMER_PLAYLIST_LEN];
+static uint32_t s_playlistHead  = 0;
+static uint32_t s_playlistCount = 0;
+
+/* Start of s_preloadFile, served by _SLN_STREAMER_ReadLocalFile instead of the flash */
+static uint8_t s_preloadData[STREAMER_PLAYLIST_PRELOAD_SIZE];
+static uint32_t s_preloadLen = 0;
+static char *s_preloadFile   = NULL;
+
 static uint32_t _SLN_STREAMER_ReadLocalFile(uint8_t *buffer, uint32_t size);
+static bool _SLN_STREAMER_NextLocalFile(void);
+static void _SLN_STREAMER_PreloadNextFile(void);
+static void _SLN_STREAMER_AmpPowerOn(void);
+static void _SLN_STREAMER_AmpPowerOff(void);
 
 /* internal mutex for accessing the audio buffer */
 static OsaMutex audioBufMutex;
 
+/* Lets the application wait for the end of a playback instead of polling SLN_STREAMER_IsPlaying */
+static EventGroupHandle_t s_playbackEvents = NULL;
+
+/* Amplifier power, kept on for STREAMER_AMP_HOLD_MS after a playback by s_ampHoldTimer */
+static TimerHandle_t s_ampHoldTimer = NULL;
+static bool s_ampPowered            = false;
+static TickType_t s_ampPowerOnTick  = 0;
+
+#if ENABLE_STREAMER_CACHE
+/* Cached prompt played by the amplifier, bypassing the streamer */
+static const uint8_t *s_cachedPcm        = NULL;
+static streamer_handle_t *s_cachedHandle = NULL;
+static TaskHandle_t s_cachedTaskHandle   = NULL;
+
+/* Cleared by SLN_STREAMER_Stop, the end of an aborted cached prompt only releases it */
+static volatile bool s_cachedActive = false;
+
+/*!
+ * @brief Task ending the play of a cached prompt once the amplifier played it.
+ *        Woken by SLN_STREAMER_PlayCachedSound, then blocked on the idle event of the prompt mixer channel.
+ *
+ * @param arg Not used
+ */
+static void SLN_STREAMER_CachedPlaybackTask(void *arg)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        SLN_AMP_WaitChannelDone(kSlnAmpChannelPrompt, UINT32_MAX);
+
+        if (s_cachedActive)
+        {
+            s_cachedActive               = false;
+            s_cachedHandle->audioPlaying = false;
+
+            _SLN_STREAMER_AmpPowerOff();
+
+            xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+        }
+
+        /* The mixer does not read the prompt anymore */
+        SLN_STREAMER_CACHE_Release(s_cachedPcm);
+        s_cachedPcm = NULL;
+    }
+}
+#endif /* ENABLE_STREAMER_CACHE */
+
+#if STREAMER_AMP_HOLD_MS
+/*!
+ * @brief Timer callback powering off the amplifier once it was not used for STREAMER_AMP_HOLD_MS
+ *
+ * @param timer Timer handle
+ */
+static void SLN_STREAMER_AmpHoldCallback(TimerHandle_t timer)
+{
+    /* A playback started meanwhile keeps the amplifier */
+    if ((xEventGroupGetBits(s_playbackEvents) & STREAMER_IDLE_EVT) != 0)
+    {
+        /* power off the amp */
+        GPIO_PinWrite(GPIO2, 2, 0);
+        s_ampPowered = false;
+    }
+}
+#endif /* STREAMER_AMP_HOLD_MS */
+
 /*!
  * @brief Streamer task for communicating messages
  *
@@ -81,6 +193,10 @@ static void SLN_STREAMER_MessageTask(void *arg)
             case STREAM_MSG_ERROR:
                 configPRINTF(("STREAM_MSG_ERROR %d\r\n", msg.errorcode));
 
+#if ENABLE_STREAMER_CACHE
+                SLN_STREAMER_CACHE_RecordEnd(false);
+#endif /* ENABLE_STREAMER_CACHE */
+
                 if (handle->pvExceptionCallback != NULL)
                 {
                     handle->pvExceptionCallback();
@@ -93,15 +209,21 @@ static void SLN_STREAMER_MessageTask(void *arg)
                 if (local_active_file_desc.filename != NULL)
                 {
                     /* Stop the streamer so we don't send speaker closed
-                     * Don't flush the streamer just in case there is pending data */
-                    /* add extra delay to mask prompt tail */
-                    vTaskDelay(100);
+                     * Don't flush the streamer just in case there is pending data.
+                     * Let the amplifier play the prompt tail first. */
+                    SLN_AMP_WaitChannelDone(kSlnAmpChannelStreamer, STREAMER_TAIL_TIMEOUT_MS);
                     handle->audioPlaying = false;
                     streamer_set_state(handle->streamer, 0, STATE_NULL, true);
                     local_active_file_desc.filename = NULL;
 
-                    /* power off the amp */
-                    GPIO_PinWrite(GPIO2, 2, 0);
+#if ENABLE_STREAMER_CACHE
+                    /* The whole prompt was decoded, keep it for the next plays */
+                    SLN_STREAMER_CACHE_RecordEnd(true);
+#endif /* ENABLE_STREAMER_CACHE */
+
+                    xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+
+                    _SLN_STREAMER_AmpPowerOff();
                 }
                 else
                 {
@@ -131,6 +253,7 @@ static void SLN_STREAMER_MessageTask(void *arg)
 int SLN_STREAMER_Read(uint8_t *data, uint32_t size)
 {
     volatile uint32_t bytes_read = 0;
+    uint32_t chunk               = 0;
 
     /* The streamer reads blocks of data but the decoder only decodes frames
        This means there could be incomplete frames the decoder has got but the
@@ -149,13 +272,33 @@ int SLN_STREAMER_Read(uint8_t *data, uint32_t size)
         {
             local_active_file_desc.filename = NULL;
         }
-        else if (local_active_file_desc.len == 0)
-        {
-            local_active_file_desc.len = -1;
-        }
-        else if (local_active_file_desc.len != 0)
+        else
         {
-            bytes_read = _SLN_STREAMER_ReadLocalFile(data, size);
+            /* Fill the block across the end of a prompt with the start of the next one of the playlist,
+             * the decoder sees one continuous stream and the switch has no gap */
+            while (bytes_read < size)
+            {
+                if ((local_active_file_desc.len == 0) && !_SLN_STREAMER_NextLocalFile())
+                {
+                    break;
+                }
+
+                chunk = _SLN_STREAMER_ReadLocalFile(&data[bytes_read], size - bytes_read);
+                if (chunk == 0)
+                {
+                    break;
+                }
+                bytes_read += chunk;
+            }
+
+            if ((bytes_read == 0) && (local_active_file_desc.len == 0))
+            {
+                local_active_file_desc.len = -1;
+            }
+            else
+            {
+                _SLN_STREAMER_PreloadNextFile();
+            }
         }
     }
 
@@ -197,6 +340,14 @@ uint32_t SLN_STREAMER_SetLocalSound(streamer_handle_t *handle, char *filename)
             local_active_file_desc.len  = len;
             local_active_file_desc.offset = 0;
             status = kStatus_Success;
+
+            /* The preloaded data may belong to another file by the same name pointer */
+            s_preloadFile = NULL;
+            s_preloadLen  = 0;
+
+#if ENABLE_STREAMER_CACHE
+            SLN_STREAMER_CACHE_RecordStart((const char *)filename, len);
+#endif /* ENABLE_STREAMER_CACHE */
         }
     }
 
@@ -205,12 +356,138 @@ uint32_t SLN_STREAMER_SetLocalSound(streamer_handle_t *handle, char *filename)
     return status;
 }
 
+uint32_t SLN_STREAMER_QueueLocalSound(streamer_handle_t *handle, char *fileName)
+{
+    uint32_t status      = kStatus_Success;
+    uint32_t statusFlash = 0;
+    uint32_t len         = 0;
+
+    xSemaphoreTake(audioBufMutex, portMAX_DELAY);
+
+    /* Only a prompt still read by the streamer can be followed without a gap */
+    if ((local_active_file_desc.filename == NULL) || (local_active_file_desc.len == -1))
+    {
+        status = kStatus_NoData;
+    }
+    else if (s_playlistCount >= STREAMER_PLAYLIST_LEN)
+    {
+        configPRINTF(("Playlist full, %s not queued.\r\n", fileName));
+        status = kStatus_Fail;
+    }
+    else
+    {
+        /* Open the file now, the switch to it will only read it */
+        statusFlash = sln_flash_fs_ops_read((const char *)fileName, NULL, 0, &len);
+        if ((statusFlash != SLN_FLASH_FS_OK) || (len == 0))
+        {
+            configPRINTF(("Failed reading audio file info from flash memory.\r\n"));
+            status = kStatus_Fail;
+        }
+        else
+        {
+            s_playlist[(s_playlistHead + s_playlistCount) % STREAMER_PLAYLIST_LEN].filename = fileName;
+            s_playlist[(s_playlistHead + s_playlistCount) % STREAMER_PLAYLIST_LEN].len      = len;
+            s_playlist[(s_playlistHead + s_playlistCount) % STREAMER_PLAYLIST_LEN].offset   = 0;
+            s_playlistCount++;
+        }
+    }
+
+    xSemaphoreGive(audioBufMutex);
+
+    return status;
+}
+
+uint32_t SLN_STREAMER_ClearPlaylist(streamer_handle_t *handle)
+{
+    uint32_t dropped = 0;
+
+    xSemaphoreTake(audioBufMutex, portMAX_DELAY);
+
+    dropped         = s_playlistCount;
+    s_playlistHead  = 0;
+    s_playlistCount = 0;
+
+    xSemaphoreGive(audioBufMutex);
+
+    return dropped;
+}
+
+#if ENABLE_STREAMER_CACHE
+status_t SLN_STREAMER_PlayCachedSound(streamer_handle_t *handle, char *fileName, uint32_t volume)
+{
+    status_t status    = kStatus_Success;
+    const uint8_t *pcm = NULL;
+    uint32_t length    = 0;
+
+    if ((s_cachedTaskHandle == NULL) || handle->audioPlaying || (s_cachedPcm != NULL))
+    {
+        return kStatus_Fail;
+    }
+
+    if (!SLN_STREAMER_CACHE_Acquire((const char *)fileName, &pcm, &length))
+    {
+        return kStatus_NoData;
+    }
+
+    xEventGroupClearBits(s_playbackEvents, STREAMER_IDLE_EVT);
+    handle->audioPlaying = true;
+
+    /* Only waits if the amplifier is not powered since STREAMER_AMP_POWER_UP_MS */
+    _SLN_STREAMER_AmpPowerOn();
+
+    SLN_STREAMER_SetVolume(volume);
+
+    s_cachedHandle = handle;
+    s_cachedPcm    = pcm;
+    s_cachedActive = true;
+
+    /* The mixer starts the prompt on its next slot */
+    status = SLN_AMP_WriteAudioNoWait((uint8_t *)pcm, length);
+    if (status == kStatus_Success)
+    {
+        xTaskNotifyGive(s_cachedTaskHandle);
+    }
+    else
+    {
+        handle->audioPlaying = false;
+        s_cachedActive       = false;
+        s_cachedPcm          = NULL;
+        SLN_STREAMER_CACHE_Release(pcm);
+
+        xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+
+        _SLN_STREAMER_AmpPowerOff();
+    }
+
+    return status;
+}
+#endif /* ENABLE_STREAMER_CACHE */
 
 bool SLN_STREAMER_IsPlaying(streamer_handle_t *handle)
 {
     return handle->audioPlaying;
 }
 
+bool SLN_STREAMER_WaitForIdle(streamer_handle_t *handle, uint32_t timeoutMs)
+{
+    TickType_t ticks = portMAX_DELAY;
+    EventBits_t bits = 0;
+
+    if (s_playbackEvents == NULL)
+    {
+        return !handle->audioPlaying;
+    }
+
+    if (timeoutMs != UINT32_MAX)
+    {
+        ticks = pdMS_TO_TICKS(timeoutMs);
+    }
+
+    bits = xEventGroupWaitBits(s_playbackEvents, STREAMER_IDLE_EVT, pdFALSE, pdTRUE, ticks);
+
+    return ((bits & STREAMER_IDLE_EVT) != 0);
+}
+
 void SLN_STREAMER_SetVolume(uint32_t volume)
 {
     /* Protect against an uninitialized volume */
@@ -225,11 +502,11 @@ void SLN_STREAMER_SetVolume(uint32_t volume)
 void SLN_STREAMER_Start(streamer_handle_t *handle)
 {
 //    configPRINTF(("[STREAMER] start playback\r\n"));
-    /* power on the amp */
-    GPIO_PinWrite(GPIO2, 2, 1);
-    vTaskDelay(150);
-
+    xEventGroupClearBits(s_playbackEvents, STREAMER_IDLE_EVT);
     handle->audioPlaying = true;
+
+    /* Only waits if the amplifier is not powered since STREAMER_AMP_POWER_UP_MS */
+    _SLN_STREAMER_AmpPowerOn();
     streamer_set_state(handle->streamer, 0, STATE_PLAYING, true);
 }
 
@@ -245,8 +522,20 @@ uint32_t SLN_STREAMER_Stop(streamer_handle_t *handle)
     handle->audioPlaying = false;
     streamer_set_state(handle->streamer, 0, STATE_NULL, true);
 
-    /* power off the amp */
-    GPIO_PinWrite(GPIO2, 2, 0);
+#if ENABLE_STREAMER_CACHE
+    SLN_STREAMER_CACHE_RecordEnd(false);
+
+    /* The cached playback task releases the cached prompt */
+    if (s_cachedPcm != NULL)
+    {
+        s_cachedActive = false;
+        SLN_AMP_AbortChannel(kSlnAmpChannelPrompt);
+    }
+#endif /* ENABLE_STREAMER_CACHE */
+
+    xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+
+    _SLN_STREAMER_AmpPowerOff();
 
     /* Flush input ringbuffer. */
     xSemaphoreTake(audioBufMutex, portMAX_DELAY);
@@ -254,6 +543,9 @@ uint32_t SLN_STREAMER_Stop(streamer_handle_t *handle)
     local_active_file_desc.filename = NULL;
     local_active_file_desc.len  = -1;
 
+    s_playlistHead  = 0;
+    s_playlistCount = 0;
+
     xSemaphoreGive(audioBufMutex);
 
     return flushedSize;
@@ -268,8 +560,14 @@ void SLN_STREAMER_Pause(streamer_handle_t *handle)
     handle->audioPlaying = false;
     streamer_set_state(handle->streamer, 0, STATE_PAUSED, true);
 
-    /* power off the amp */
-    GPIO_PinWrite(GPIO2, 2, 0);
+#if ENABLE_STREAMER_CACHE
+    /* A paused prompt is not complete */
+    SLN_STREAMER_CACHE_RecordEnd(false);
+#endif /* ENABLE_STREAMER_CACHE */
+
+    xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+
+    _SLN_STREAMER_AmpPowerOff();
 }
 
 status_t SLN_STREAMER_Create(streamer_handle_t *handle, streamer_decoder_t decoder)
@@ -286,6 +584,36 @@ status_t SLN_STREAMER_Create(streamer_handle_t *handle, streamer_decoder_t decod
         return kStatus_Fail;
     }
 
+    s_playbackEvents = xEventGroupCreate();
+    if (!s_playbackEvents)
+    {
+        return kStatus_Fail;
+    }
+    xEventGroupSetBits(s_playbackEvents, STREAMER_IDLE_EVT);
+
+#if STREAMER_AMP_HOLD_MS
+    s_ampHoldTimer = xTimerCreate("StreamerAmpHold", pdMS_TO_TICKS(STREAMER_AMP_HOLD_MS), pdFALSE, NULL,
+                                  SLN_STREAMER_AmpHoldCallback);
+    if (!s_ampHoldTimer)
+    {
+        return kStatus_Fail;
+    }
+#endif /* STREAMER_AMP_HOLD_MS */
+
+#if ENABLE_STREAMER_CACHE
+    if (SLN_STREAMER_CACHE_Init() != kStatus_Success)
+    {
+        return kStatus_Fail;
+    }
+
+    if (xTaskCreate(SLN_STREAMER_CachedPlaybackTask, STREAMER_CACHE_TASK_NAME, STREAMER_CACHE_TASK_STACK_SIZE, NULL,
+                    STREAMER_CACHE_TASK_PRIORITY, &s_cachedTaskHandle) != pdPASS)
+    {
+        s_cachedTaskHandle = NULL;
+        return kStatus_Fail;
+    }
+#endif /* ENABLE_STREAMER_CACHE */
+
     /* Create message process thread */
     osa_thread_attr_init(&thread_attr);
     osa_thread_attr_set_name(&thread_attr, STREAMER_MESSAGE_TASK_NAME);
@@ -343,6 +671,16 @@ void SLN_STREAMER_Destroy(streamer_handle_t *handle)
     streamer_destroy(handle->streamer);
 
     vSemaphoreDelete(audioBufMutex);
+
+    if (s_ampHoldTimer != NULL)
+    {
+        xTimerDelete(s_ampHoldTimer, portMAX_DELAY);
+        s_ampHoldTimer = NULL;
+    }
+    _SLN_STREAMER_AmpPowerOff();
+
+    vEventGroupDelete(s_playbackEvents);
+    s_playbackEvents = NULL;
 }
 
 void SLN_STREAMER_Init(void)
@@ -374,7 +712,18 @@ static uint32_t _SLN_STREAMER_ReadLocalFile(uint8_t *buffer, uint32_t size)
         read_size = local_active_file_desc.len;
     }
 
-    statusFlash = sln_flash_fs_ops_read((const char *)local_active_file_desc.filename, buffer, local_active_file_desc.offset, &read_size);
+    if ((local_active_file_desc.filename == s_preloadFile) && (local_active_file_desc.offset < s_preloadLen))
+    {
+        /* Start of the prompt already read while the previous one played */
+        read_size = MIN(read_size, s_preloadLen - local_active_file_desc.offset);
+        memcpy(buffer, &s_preloadData[local_active_file_desc.offset], read_size);
+        statusFlash = SLN_FLASH_FS_OK;
+    }
+    else
+    {
+        statusFlash = sln_flash_fs_ops_read((const char *)local_active_file_desc.filename, buffer,
+                                            local_active_file_desc.offset, &read_size);
+    }
     if (statusFlash != SLN_FLASH_FS_OK)
     {
         configPRINTF(("Failed reading audio file from flash memory.\r\n"));
@@ -394,4 +743,106 @@ static uint32_t _SLN_STREAMER_ReadLocalFile(uint8_t *buffer, uint32_t size)
     return read_size;
 }
 
+/*!
+ * @brief Make the next prompt of the playlist the active one. Called with audioBufMutex taken.
+ *
+ * @return true if there was a next prompt
+ */
+static bool _SLN_STREAMER_NextLocalFile(void)
+{
+    if (s_playlistCount == 0)
+    {
+        return false;
+    }
+
+    local_active_file_desc = s_playlist[s_playlistHead];
+    s_playlistHead         = (s_playlistHead + 1) % STREAMER_PLAYLIST_LEN;
+    s_playlistCount--;
+
+#if ENABLE_STREAMER_CACHE
+    /* The decoded blocks will hold the end of a prompt and the start of the next one */
+    SLN_STREAMER_CACHE_RecordEnd(false);
+#endif /* ENABLE_STREAMER_CACHE */
+
+    return true;
+}
+
+/*!
+ * @brief Read the start of the next prompt of the playlist, once the active one does not use
+ *        the preload buffer anymore. Called with audioBufMutex taken.
+ */
+static void _SLN_STREAMER_PreloadNextFile(void)
+{
+    streamer_local_file_t *next = &s_playlist[s_playlistHead];
+    uint32_t statusFlash        = 0;
+    uint32_t read_size          = 0;
+
+    if ((s_playlistCount == 0) || (next->filename == s_preloadFile) ||
+        ((local_active_file_desc.filename == s_preloadFile) && (local_active_file_desc.offset < s_preloadLen)))
+    {
+        return;
+    }
+
+    read_size   = MIN(next->len, STREAMER_PLAYLIST_PRELOAD_SIZE);
+    statusFlash = sln_flash_fs_ops_read((const char *)next->filename, s_preloadData, 0, &read_size);
+    if (statusFlash == SLN_FLASH_FS_OK)
+    {
+        s_preloadFile = next->filename;
+        s_preloadLen  = read_size;
+    }
+    else
+    {
+        /* The prompt will be read from flash */
+        s_preloadFile = NULL;
+        s_preloadLen  = 0;
+    }
+}
+
+/*!
+ * @brief Power on the amplifier for a playback, or keep it powered if it is held after the last one.
+ *        Wait for the end of its power up, only the part not elapsed yet.
+ */
+static void _SLN_STREAMER_AmpPowerOn(void)
+{
+    TickType_t elapsed = 0;
+
+    /* The timer task has a higher priority, the hold callback can not run after this */
+    if (s_ampHoldTimer != NULL)
+    {
+        xTimerStop(s_ampHoldTimer, portMAX_DELAY);
+    }
+
+    if (!s_ampPowered)
+    {
+        /* power on the amp */
+        GPIO_PinWrite(GPIO2, 2, 1);
+        s_ampPowerOnTick = xTaskGetTickCount();
+        s_ampPowered     = true;
+    }
+
+    elapsed = xTaskGetTickCount() - s_ampPowerOnTick;
+    if (elapsed < pdMS_TO_TICKS(STREAMER_AMP_POWER_UP_MS))
+    {
+        vTaskDelay(pdMS_TO_TICKS(STREAMER_AMP_POWER_UP_MS) - elapsed);
+    }
+}
+
+/*!
+ * @brief End of a playback: power off the amplifier once it was not used for STREAMER_AMP_HOLD_MS.
+ *        Called after STREAMER_IDLE_EVT was set.
+ */
+static void _SLN_STREAMER_AmpPowerOff(void)
+{
+    if (s_ampHoldTimer != NULL)
+    {
+        xTimerReset(s_ampHoldTimer, 0);
+    }
+    else
+    {
+        /* power off the amp */
+        GPIO_PinWrite(GPIO2, 2, 0);
+        s_ampPowered = false;
+    }
+}
+
 #endif /* ENABLE_STREAMER */
@@ -21,6 +21,9 @@
 /* Maximum streamer volume */
 #define MAX_STREAMER_VOLUME 100
 
+/* Number of prompts which can be queued after the playing one */
+#define STREAMER_PLAYLIST_LEN 4
+
 typedef void (*tvStreamerErrorCallback)();
 
 /*! @brief Streamer decoder algorithm values */
@@ -119,6 +122,17 @@ void SLN_STREAMER_Pause(streamer_handle_t *handle);
  */
 bool SLN_STREAMER_IsPlaying(streamer_handle_t *handle);
 
+/*!
+ * @brief Wait for the streamer interface to stop playing
+ *
+ * This function blocks until the current playback ends, is stopped or paused.
+ *
+ * @param handle Pointer to input handle
+ * @param timeoutMs Maximum time to wait, UINT32_MAX to wait forever
+ * @return true if not playing, false if the timeout expired
+ */
+bool SLN_STREAMER_WaitForIdle(streamer_handle_t *handle, uint32_t timeoutMs);
+
 /*!
  * @brief Set volume for streamer playback interface
  *
@@ -150,6 +164,46 @@ int SLN_STREAMER_Read(uint8_t *data, uint32_t size);
  */
 uint32_t SLN_STREAMER_SetLocalSound(streamer_handle_t *handle, char *fileName);
 
+/*!
+ * @brief Queue a local file to be played right after the current one
+ *
+ * The file is decoded in the same stream as the playing one, the switch between them
+ * has no gap. The start of the file is read from flash while the previous one plays.
+ *
+ * @param handle Streamer Handle
+ * @param fileName name of the file to be played, must stay valid until it was played
+ * @return kStatus_Success if queued, kStatus_NoData if no file is being played
+ *         (start it with SLN_STREAMER_SetLocalSound), kStatus_Fail otherwise
+ */
+uint32_t SLN_STREAMER_QueueLocalSound(streamer_handle_t *handle, char *fileName);
+
+/*!
+ * @brief Drop the files queued by SLN_STREAMER_QueueLocalSound
+ *
+ * The playing file is not stopped, use SLN_STREAMER_Stop for that.
+ *
+ * @param handle Streamer Handle
+ * @return Number of files dropped
+ */
+uint32_t SLN_STREAMER_ClearPlaylist(streamer_handle_t *handle);
+
+#if ENABLE_STREAMER_CACHE
+/*!
+ * @brief Play a prompt from the decoded PCM cache
+ *
+ * This function plays the prompt straight from RAM if it was decoded before,
+ * without starting the streamer. The end of the play is reported by
+ * SLN_STREAMER_IsPlaying and SLN_STREAMER_WaitForIdle, as for a streamed prompt.
+ *
+ * @param handle Streamer Handle
+ * @param fileName name of the file to be played
+ * @param volume Volume with range from 0-100
+ * @return kStatus_Success if the prompt is playing, kStatus_NoData if it is not cached
+ *         (play it with SLN_STREAMER_SetLocalSound, it will then be cached), kStatus_Fail otherwise
+ */
+status_t SLN_STREAMER_PlayCachedSound(streamer_handle_t *handle, char *fileName, uint32_t volume);
+#endif /* ENABLE_STREAMER_CACHE */
+
 /*!
  * @brief Locks the internal streamer recursive mutex
  * @return Void
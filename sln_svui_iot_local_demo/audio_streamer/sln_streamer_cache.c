@@ -0,0 +1,365 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if ENABLE_STREAMER_CACHE
+
+#include "string.h"
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#include "fsl_common.h"
+#include "sln_heap.h"
+#include "sln_mic_config.h"
+#include "streamer_pcm.h"
+#include "sln_streamer_cache.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* The prompts are encoded with 20 ms Opus frames, each one decodes to 20 ms of amplifier PCM */
+#define STREAMER_CACHE_PCM_PER_OPUS_FRAME PCM_AMP_DATA_SIZE_20_MS
+
+/*! @brief Cached prompt. An entry is free while pcm is NULL. */
+typedef struct _streamer_cache_entry
+{
+    char name[STREAMER_CACHE_NAME_LEN];
+    uint8_t *pcm;
+    uint32_t length;  /*!< Decoded bytes */
+    uint32_t size;    /*!< Allocated bytes, counted in the budget */
+    uint32_t lastUse; /*!< Value of s_useClock at the last play, the smallest one is evicted first */
+    bool pinned;      /*!< Playing, must not be evicted */
+} streamer_cache_entry_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static streamer_cache_entry_t s_entries[STREAMER_CACHE_MAX_ENTRIES];
+
+/* Entry filled by the Streamer, not visible to SLN_STREAMER_CACHE_Acquire until its record ends */
+static streamer_cache_entry_t *s_recording = NULL;
+
+static uint32_t s_usedBytes = 0;
+static uint32_t s_useClock  = 0;
+
+static sln_streamer_cache_stats_t s_stats = {0};
+
+static SemaphoreHandle_t s_cacheMutex = NULL;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+static void SLN_STREAMER_CACHE_Drop(streamer_cache_entry_t *entry);
+static streamer_cache_entry_t *SLN_STREAMER_CACHE_GetLru(void);
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+status_t SLN_STREAMER_CACHE_Init(void)
+{
+    status_t status = kStatus_Success;
+
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_recording = NULL;
+    s_usedBytes = 0;
+    s_useClock  = 0;
+
+    s_cacheMutex = xSemaphoreCreateMutex();
+    if (s_cacheMutex == NULL)
+    {
+        configPRINTF(("Failed to create s_cacheMutex\r\n"));
+        status = kStatus_Fail;
+    }
+
+    return status;
+}
+
+bool SLN_STREAMER_CACHE_Acquire(const char *fileName, const uint8_t **pcm, uint32_t *length)
+{
+    bool hit = false;
+
+    if ((s_cacheMutex == NULL) || (fileName == NULL) || (pcm == NULL) || (length == NULL))
+    {
+        return false;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+    {
+        if ((s_entries[idx].pcm != NULL) && (&s_entries[idx] != s_recording) &&
+            (strncmp(s_entries[idx].name, fileName, STREAMER_CACHE_NAME_LEN) == 0))
+        {
+            s_entries[idx].pinned  = true;
+            s_entries[idx].lastUse = ++s_useClock;
+
+            *pcm    = s_entries[idx].pcm;
+            *length = s_entries[idx].length;
+            hit     = true;
+            break;
+        }
+    }
+
+    if (hit)
+    {
+        s_stats.hits++;
+    }
+    else
+    {
+        s_stats.misses++;
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+
+    return hit;
+}
+
+void SLN_STREAMER_CACHE_Release(const uint8_t *pcm)
+{
+    if ((s_cacheMutex == NULL) || (pcm == NULL))
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+    {
+        if (s_entries[idx].pcm == pcm)
+        {
+            s_entries[idx].pinned = false;
+            break;
+        }
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+void SLN_STREAMER_CACHE_RecordStart(const char *fileName, uint32_t encodedLen)
+{
+    streamer_cache_entry_t *entry = NULL;
+    uint32_t size                 = 0;
+
+    if ((s_cacheMutex == NULL) || (fileName == NULL))
+    {
+        return;
+    }
+
+    /* Upper bound of the decoded size, the file header is counted as frames */
+    size = ((encodedLen / STREAMER_PCM_OPUS_FRAME_SIZE) + 1) * STREAMER_CACHE_PCM_PER_OPUS_FRAME;
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    /* A record which was not ended is dropped */
+    if (s_recording != NULL)
+    {
+        SLN_STREAMER_CACHE_Drop(s_recording);
+        s_recording = NULL;
+    }
+
+    if ((strlen(fileName) >= STREAMER_CACHE_NAME_LEN) || (size > STREAMER_CACHE_BUDGET_BYTES))
+    {
+        s_stats.skipped++;
+    }
+    else
+    {
+        for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+        {
+            if (s_entries[idx].pcm == NULL)
+            {
+                entry = &s_entries[idx];
+                break;
+            }
+        }
+
+        /* Evict the least recently played prompts until both an entry and the memory are available */
+        while ((entry == NULL) || ((s_usedBytes + size) > STREAMER_CACHE_BUDGET_BYTES))
+        {
+            streamer_cache_entry_t *lru = SLN_STREAMER_CACHE_GetLru();
+            if (lru == NULL)
+            {
+                break;
+            }
+
+            SLN_STREAMER_CACHE_Drop(lru);
+            s_stats.evictions++;
+
+            if (entry == NULL)
+            {
+                entry = lru;
+            }
+        }
+
+        if ((entry != NULL) && ((s_usedBytes + size) <= STREAMER_CACHE_BUDGET_BYTES))
+        {
+            entry->pcm = SLN_HEAP_TryAlloc(size);
+        }
+
+        if ((entry != NULL) && (entry->pcm != NULL))
+        {
+            strcpy(entry->name, fileName);
+            entry->length  = 0;
+            entry->size    = size;
+            entry->lastUse = 0;
+            entry->pinned  = false;
+
+            s_usedBytes += size;
+            s_recording = entry;
+        }
+        else
+        {
+            s_stats.skipped++;
+        }
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+void SLN_STREAMER_CACHE_RecordWrite(const uint8_t *pcm, uint32_t length)
+{
+    /* Called for every block played by the Streamer, skip the lock when nothing is recorded */
+    if ((s_recording == NULL) || (pcm == NULL))
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    if (s_recording != NULL)
+    {
+        if ((s_recording->length + length) <= s_recording->size)
+        {
+            memcpy(&s_recording->pcm[s_recording->length], pcm, length);
+            s_recording->length += length;
+        }
+        else
+        {
+            /* Longer than expected from the file size, the prompt is not cached */
+            SLN_STREAMER_CACHE_Drop(s_recording);
+            s_recording = NULL;
+            s_stats.skipped++;
+        }
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+void SLN_STREAMER_CACHE_RecordEnd(bool complete)
+{
+    if ((s_cacheMutex == NULL) || (s_recording == NULL))
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    if (s_recording != NULL)
+    {
+        if (complete && (s_recording->length > 0))
+        {
+            s_recording->lastUse = ++s_useClock;
+        }
+        else
+        {
+            SLN_STREAMER_CACHE_Drop(s_recording);
+        }
+        s_recording = NULL;
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+void SLN_STREAMER_CACHE_Flush(void)
+{
+    if (s_cacheMutex == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+    {
+        if ((s_entries[idx].pcm != NULL) && !s_entries[idx].pinned && (&s_entries[idx] != s_recording))
+        {
+            SLN_STREAMER_CACHE_Drop(&s_entries[idx]);
+        }
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+void SLN_STREAMER_CACHE_GetStats(sln_streamer_cache_stats_t *stats)
+{
+    if ((s_cacheMutex == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_cacheMutex, portMAX_DELAY);
+
+    *stats             = s_stats;
+    stats->usedBytes   = s_usedBytes;
+    stats->budgetBytes = STREAMER_CACHE_BUDGET_BYTES;
+    stats->entries     = 0;
+    for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+    {
+        if ((s_entries[idx].pcm != NULL) && (&s_entries[idx] != s_recording))
+        {
+            stats->entries++;
+        }
+    }
+
+    xSemaphoreGive(s_cacheMutex);
+}
+
+/*******************************************************************************
+ * Static Functions
+ ******************************************************************************/
+
+/**
+ * @brief  Free a cache entry. Called with s_cacheMutex taken.
+ *
+ * @param  entry Entry to free.
+ */
+static void SLN_STREAMER_CACHE_Drop(streamer_cache_entry_t *entry)
+{
+    if (entry->pcm != NULL)
+    {
+        vPortFree(entry->pcm);
+        s_usedBytes -= entry->size;
+    }
+
+    memset(entry, 0, sizeof(streamer_cache_entry_t));
+}
+
+/**
+ * @brief  Find the least recently played prompt which can be evicted. Called with s_cacheMutex taken.
+ *
+ * @return The entry to evict or NULL if all the prompts are playing or being recorded.
+ */
+static streamer_cache_entry_t *SLN_STREAMER_CACHE_GetLru(void)
+{
+    streamer_cache_entry_t *lru = NULL;
+
+    for (uint32_t idx = 0; idx < STREAMER_CACHE_MAX_ENTRIES; idx++)
+    {
+        if ((s_entries[idx].pcm != NULL) && !s_entries[idx].pinned && (&s_entries[idx] != s_recording) &&
+            ((lru == NULL) || (s_entries[idx].lastUse < lru->lastUse)))
+        {
+            lru = &s_entries[idx];
+        }
+    }
+
+    return lru;
+}
+
+#endif /* ENABLE_STREAMER_CACHE */
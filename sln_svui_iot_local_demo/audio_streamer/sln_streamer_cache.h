@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_STREAMER_CACHE_H_
+#define _SLN_STREAMER_CACHE_H_
+
+#if ENABLE_STREAMER_CACHE
+
+#include "stdbool.h"
+#include "stdint.h"
+
+#include "fsl_common.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Memory the decoded prompts may use, in FreeRTOS heap bytes */
+#ifndef STREAMER_CACHE_BUDGET_BYTES
+#define STREAMER_CACHE_BUDGET_BYTES (64 * 1024)
+#endif /* STREAMER_CACHE_BUDGET_BYTES */
+
+/* Number of prompts the cache can hold, whatever their size */
+#ifndef STREAMER_CACHE_MAX_ENTRIES
+#define STREAMER_CACHE_MAX_ENTRIES 8
+#endif /* STREAMER_CACHE_MAX_ENTRIES */
+
+/* Longest prompt path which can be cached, string terminator included */
+#define STREAMER_CACHE_NAME_LEN 64
+
+/*! @brief Prompt cache counters */
+typedef struct _sln_streamer_cache_stats
+{
+    uint32_t hits;        /*!< Prompts played from the cache */
+    uint32_t misses;      /*!< Prompts decoded from the file system */
+    uint32_t evictions;   /*!< Prompts dropped to make room for a new one */
+    uint32_t skipped;     /*!< Prompts which could not be cached (too big, name too long, out of memory) */
+    uint32_t usedBytes;   /*!< Heap used by the cached prompts */
+    uint32_t budgetBytes; /*!< STREAMER_CACHE_BUDGET_BYTES */
+    uint32_t entries;     /*!< Prompts cached */
+} sln_streamer_cache_stats_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Initialize the prompt cache. The cache starts empty.
+ *
+ * @return kStatus_Success on success, otherwise an error.
+ */
+status_t SLN_STREAMER_CACHE_Init(void);
+
+/*!
+ * @brief Look for the decoded PCM of a prompt and count a hit or a miss.
+ *        On a hit the prompt is pinned, it is not evicted until SLN_STREAMER_CACHE_Release is called.
+ *
+ * @param fileName Path of the prompt in the file system
+ * @param pcm Pointer where the address of the decoded PCM will be stored
+ * @param length Pointer where the length of the decoded PCM in bytes will be stored
+ * @return true on a hit
+ */
+bool SLN_STREAMER_CACHE_Acquire(const char *fileName, const uint8_t **pcm, uint32_t *length);
+
+/*!
+ * @brief Unpin a prompt returned by SLN_STREAMER_CACHE_Acquire.
+ *
+ * @param pcm Address of the decoded PCM
+ */
+void SLN_STREAMER_CACHE_Release(const uint8_t *pcm);
+
+/*!
+ * @brief Start to record the decoded PCM of a prompt about to be played by the Streamer.
+ *        The least recently used prompts are evicted to make room for it.
+ *
+ * @param fileName Path of the prompt in the file system
+ * @param encodedLen Length of the Opus file, used to size the record
+ */
+void SLN_STREAMER_CACHE_RecordStart(const char *fileName, uint32_t encodedLen);
+
+/*!
+ * @brief Append decoded PCM to the prompt being recorded. Returns immediately if nothing is recorded.
+ *
+ * @param pcm Decoded PCM written to the amplifier
+ * @param length Length of the decoded PCM in bytes
+ */
+void SLN_STREAMER_CACHE_RecordWrite(const uint8_t *pcm, uint32_t length);
+
+/*!
+ * @brief End the record of a prompt.
+ *
+ * @param complete true if the prompt was played up to its end and can be cached,
+ *                 false if it was stopped and the record must be dropped
+ */
+void SLN_STREAMER_CACHE_RecordEnd(bool complete);
+
+/*!
+ * @brief Drop all the cached prompts which are not playing.
+ */
+void SLN_STREAMER_CACHE_Flush(void);
+
+/*!
+ * @brief Get the cache counters.
+ *
+ * @param stats Pointer where the counters will be stored
+ */
+void SLN_STREAMER_CACHE_GetStats(sln_streamer_cache_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ENABLE_STREAMER_CACHE */
+#endif /* _SLN_STREAMER_CACHE_H_ */
@@ -12,6 +12,9 @@
 #include "sln_mic_config.h"
 #include "sln_amplifier.h"
 #include "streamer_pcm.h"
+#if ENABLE_STREAMER_CACHE
+#include "sln_streamer_cache.h"
+#endif /* ENABLE_STREAMER_CACHE */
 
 static pcm_rtos_t pcmHandle = {0};
 
@@ -108,6 +111,10 @@ int streamer_pcm_write(pcm_rtos_t *pcm, uint8_t *data, uint32_t size)
     if (ret == kStatus_Success)
     {
         pcm->emptyBlock--;
+
+#if ENABLE_STREAMER_CACHE
+        SLN_STREAMER_CACHE_RecordWrite(pcm->saiTx.data, pcm->saiTx.dataSize);
+#endif /* ENABLE_STREAMER_CACHE */
     }
     else
     {
@@ -67,8 +67,7 @@ lpi2c_master_handle_t g_i2cHandle = {0};
 #if defined(SDK_SAI_BASED_COMPONENT_USED) && SDK_SAI_BASED_COMPONENT_USED
 AT_NONCACHEABLE_SECTION_ALIGN(static uint8_t dummy_txbuffer[32], 32);
 
-mqs_config_t mqsConfig = {
-    .s_AmpRxDataRingBuffer = NULL, .ringbuf_delay = 0, .ringbuf_size = AMP_LOOPBACK_RINGBUF_SIZE, .volume = 0};
+mqs_config_t mqsConfig = {.volume = 0};
 
 codec_config_t boardCodecConfig = {.codecDevType = kCODEC_MQS, .codecDevConfig = &mqsConfig};
 #endif /* SDK_SAI_BASED_COMPONENT_USED */
@@ -104,6 +104,37 @@
 #define BOARD_AMP_SAI_EDMA_RX_IRQ DMA3_DMA19_IRQn
 #endif /* ENABLE_AMPLIFIER */
 
+#if (MICS_TYPE == MICS_I2S)
+/* eDMA channels of the I2S mics. SAI1 RX requests trigger BOARD_I2S_MIC_EDMA_CH, which writes the first mic.
+ * Each extra mic is written by a linked channel, the last linked channel raises the major loop interrupt
+ * so it must share DMA1_DMA17_IRQn with BOARD_I2S_MIC_EDMA_CH. */
+#define BOARD_I2S_MIC_EDMA_CH          1U
+#define BOARD_I2S_MIC_EDMA_LINK_CH_1   4U
+#define BOARD_I2S_MIC_EDMA_LINK_CH_2   5U
+#define BOARD_I2S_MIC_EDMA_LINK_LAST_CH 17U
+
+#if (BOARD_I2S_MIC_EDMA_LINK_LAST_CH != (BOARD_I2S_MIC_EDMA_CH + 16U))
+#error "The last linked mic eDMA channel must share the interrupt of BOARD_I2S_MIC_EDMA_CH"
+#endif /* BOARD_I2S_MIC_EDMA_LINK_LAST_CH */
+
+#if (BOARD_I2S_MIC_EDMA_LINK_CH_1 == BOARD_I2S_MIC_EDMA_CH) || (BOARD_I2S_MIC_EDMA_LINK_CH_2 == BOARD_I2S_MIC_EDMA_CH) || \
+    (BOARD_I2S_MIC_EDMA_LINK_CH_1 == BOARD_I2S_MIC_EDMA_LINK_CH_2) ||                                                  \
+    (BOARD_I2S_MIC_EDMA_LINK_CH_1 == BOARD_I2S_MIC_EDMA_LINK_LAST_CH) ||                                               \
+    (BOARD_I2S_MIC_EDMA_LINK_CH_2 == BOARD_I2S_MIC_EDMA_LINK_LAST_CH)
+#error "The I2S mics eDMA channels must be distinct"
+#endif /* BOARD_I2S_MIC_EDMA_CH */
+
+#if ENABLE_AMPLIFIER
+#if (BOARD_AMP_SAI_EDMA_TX_CH == BOARD_I2S_MIC_EDMA_CH) || (BOARD_AMP_SAI_EDMA_RX_CH == BOARD_I2S_MIC_EDMA_CH) ||             \
+    (BOARD_AMP_SAI_EDMA_TX_CH == BOARD_I2S_MIC_EDMA_LINK_CH_1) || (BOARD_AMP_SAI_EDMA_RX_CH == BOARD_I2S_MIC_EDMA_LINK_CH_1) || \
+    (BOARD_AMP_SAI_EDMA_TX_CH == BOARD_I2S_MIC_EDMA_LINK_CH_2) || (BOARD_AMP_SAI_EDMA_RX_CH == BOARD_I2S_MIC_EDMA_LINK_CH_2) || \
+    (BOARD_AMP_SAI_EDMA_TX_CH == BOARD_I2S_MIC_EDMA_LINK_LAST_CH) ||                                                         \
+    (BOARD_AMP_SAI_EDMA_RX_CH == BOARD_I2S_MIC_EDMA_LINK_LAST_CH)
+#error "The I2S mics and the amplifier must use distinct eDMA channels"
+#endif /* BOARD_AMP_SAI_EDMA_TX_CH */
+#endif /* ENABLE_AMPLIFIER */
+#endif /* (MICS_TYPE == MICS_I2S) */
+
 #define SAMPLE_RATE (kSAI_SampleRate48KHz)
 
 /* The UART to use for debug messages. */
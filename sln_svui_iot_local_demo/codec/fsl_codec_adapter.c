@@ -42,15 +42,6 @@ status_t HAL_CODEC_Init(void *handle, void *config)
 {
     assert((config != NULL) && (handle != NULL));
 
-    ((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->s_AmpRxDataRingBuffer =
-        ringbuf_create(((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->ringbuf_size);
-
-    ((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->s_AmpRxDataRingBuffer->tail =
-        ((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->ringbuf_delay;
-
-    ((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->s_AmpRxDataRingBuffer->occ =
-        ((mqs_config_t *)((codec_config_t *)config)->codecDevConfig)->ringbuf_delay;
-
     ((codec_handle_t *)handle)->codecCapability = &s_mqs_capability;
 
     return kStatus_Success;
@@ -66,8 +57,6 @@ status_t HAL_CODEC_Deinit(void *handle)
 {
     assert(handle != NULL);
 
-    ringbuf_destroy(((mqs_config_t *)((codec_handle_t *)handle)->codecConfig->codecDevConfig)->s_AmpRxDataRingBuffer);
-
     return kStatus_Success;
 }
 
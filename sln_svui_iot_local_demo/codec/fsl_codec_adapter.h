@@ -11,7 +11,6 @@
 
 #include "fsl_common.h"
 #include "board.h"
-#include "ringbuffer.h"
 
 /*!
  * @addtogroup mqs_adapter
@@ -23,9 +22,6 @@
 /*! @brief Initialize structure of MQS */
 typedef struct mqs_config
 {
-    ringbuf_t *s_AmpRxDataRingBuffer;
-    uint32_t ringbuf_size;
-    uint32_t ringbuf_delay;
     float volume;
 } mqs_config_t;
 
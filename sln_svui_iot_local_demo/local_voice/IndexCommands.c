@@ -23,6 +23,15 @@ extern sln_voice_demo_t *all_voice_demos_vit;
 sln_voice_demo_t **all_voice_demos = &all_voice_demos_vit;
 #endif /* ENABLE_DSMT_ASR */
 
+#if ENABLE_MODEL_STORE
+#include "sln_model_store.h"
+#if ENABLE_DSMT_ASR
+#define MODEL_STORE_ENGINE kModelStoreEngine_Dsmt
+#elif ENABLE_VIT_ASR
+#define MODEL_STORE_ENGINE kModelStoreEngine_Vit
+#endif /* ENABLE_DSMT_ASR */
+#endif /* ENABLE_MODEL_STORE */
+
 static sln_voice_demo_t *get_voice_demo(asr_language_t asrLang, asr_inference_t infCMDType)
 {
     sln_voice_demo_t **demo_iterator = all_voice_demos;
@@ -152,7 +161,14 @@ void *get_demo_model(asr_language_t asrLang, asr_inference_t infCMDType)
     sln_voice_demo_t *demo = get_voice_demo(asrLang, infCMDType);
     if (demo)
     {
-        model = (char *)demo->model;
+#if ENABLE_MODEL_STORE
+        /* A model flashed in the model store replaces the one linked in the application */
+        model = (void *)SLN_MODEL_STORE_Find(MODEL_STORE_ENGINE, asrLang, infCMDType);
+        if (model == NULL)
+#endif /* ENABLE_MODEL_STORE */
+        {
+            model = (char *)demo->model;
+        }
     }
 
     return model;
@@ -28,8 +28,39 @@
 /* Pool allocation method. When set to 1, static allocation will be used.
  * When set to 0, dynamic allocation from FreeRTOS heap will be used.  */
 #define USE_DSMT_STATIC_POOLS          1
+
+/* Wake word scheduler, used when MULTILINGUAL is set. When set to 1, only the wake word engine of the
+ * last detected language runs on every frame while the audio stays at the noise floor. The other
+ * languages take turns within WW_SCHED_BUDGET_US per frame, and all of them run as soon as a louder
+ * sound opens the energy gate. Use "pipestat" in sln_shell to print the detection latency and the
+ * detections the gate missed. */
+#define ENABLE_WW_SCHEDULER            1
+#define WW_SCHED_BUDGET_US             (12000U)
 #endif /* ENABLE_DSMT_ASR */
 
+#if ENABLE_VIT_ASR
+/* When the language or the demo changes, create the new VIT instance in a background task while
+ * the current one keeps processing audio, then swap them at a frame boundary. The new instance
+ * takes its memory from the FreeRTOS heap when the current one uses the static pools.
+ * When set to 0, or when the heap is too small, VIT is reinitialized in place. */
+#define ENABLE_VIT_HOT_SWAP            1
+#endif /* ENABLE_VIT_ASR */
+
+#if ENABLE_VIT_ASR || ENABLE_DSMT_ASR
+/* If set to 1, the ASR models are first looked up in the model container flashed at MODEL_STORE_ADDR,
+ * the flash left free after the file system, and are read from there through XIP. A model is used
+ * only if its CRC matches, otherwise the model linked in the application is used. This allows to
+ * update or add the model of a language or a demo without re-flashing the application.
+ * The container format is described in sln_model_store.h */
+#define ENABLE_MODEL_STORE             1
+
+/* If set to 1, at boot the ASR engine processes a clip with its memory pools in each RAM region
+ * and prints the cycles per frame of each placement, before starting normally.
+ * Use the results to update the placement table in sln_asr_mem_placement.h
+ * ENABLE_VAD must be set to 0, VAD would suspend the ASR task and lower the core clock */
+#define ASR_MEM_BENCH                  0
+#endif /* ENABLE_VIT_ASR || ENABLE_DSMT_ASR */
+
 /* Enable Voice Activity Detection */
 #define ENABLE_VAD                     1
 
@@ -43,7 +74,7 @@
  * After waking up from VAD low power, the ASR will first process the buffered
  * audio, before catching up with real time audio
  *
- * This setting will use 10KB more FreeRTOS heap */
+ * This setting will use 10KB more static RAM in cacheable OCRAM (AFE to ASR frame pool) */
 #define VAD_BUFFER_DATA                1
 #endif /* ENABLE_VAD */
 
@@ -51,6 +82,11 @@
  * switch the definition to MICS_PDM */
 #define MICS_TYPE                      MICS_I2S
 
+/* Microphones capture period in ms: 5 (low latency), 10 (default) or 20 (low power).
+ * Duration of the audio frames handed to ASR in ms: 30 (default), or 10 for VIT only. */
+#define SLN_MIC_PERIOD_MS              10
+#define ASR_FRAME_MS                   30
+
 /* Speaker volume, between 0 and 100 */
 #define DEFAULT_SPEAKER_VOLUME         55
 
@@ -66,6 +102,13 @@
  * Disabling saves RAM memory. */
 #define ENABLE_AEC                     0
 
+#if ENABLE_AEC
+/* If set to 1, AEC only runs while the speaker reference carries sound. The reference energy is
+ * checked on every 10ms block and AEC is bypassed while the speaker is silent, which saves most of
+ * the AEC CPU load during playback pauses. The mode can be changed at runtime with "aecmode auto". */
+#define AEC_AUTO_BYPASS                1
+#endif /* ENABLE_AEC */
+
 /* Enable NXP out of the box experience. If set to 0,
  * no demo change or language change available through voice commands,
  * but these actions will still be possible through shell commands. */
@@ -82,12 +125,45 @@
  * If set to 0, streamer task will not feed raw PCM audio data to the amplifier.
  * Disabling the streamer saves RAM memory. */
 #define ENABLE_STREAMER                1
+
+#if ENABLE_STREAMER
+/* If set to 1, the decoded PCM of the last played prompts is kept in RAM and the next plays
+ * of these prompts skip the flash read and the OPUS decoder. The least recently played prompts
+ * are evicted when STREAMER_CACHE_BUDGET_BYTES is reached. Use "promptcache" in sln_shell
+ * to print the hit and miss counters.
+ *
+ * This setting will use up to STREAMER_CACHE_BUDGET_BYTES of FreeRTOS heap (96KB per second of prompt) */
+#define ENABLE_STREAMER_CACHE          0
+#define STREAMER_CACHE_BUDGET_BYTES    (64 * 1024)
+#endif /* ENABLE_STREAMER */
+
+#if ENABLE_VIT_ASR
+/* If set to 1, while the speaker plays, a second VIT instance looks for the wake word in the speaker
+ * reference (in the first mic before AFE when ENABLE_AEC is 0). A wake word found at the same time by
+ * the main instance is the device waking itself up and is ignored.
+ * The second instance is created in the FreeRTOS heap when the playback starts and freed 2 seconds
+ * after it stopped. When the heap is too small, the wake words are not filtered. */
+#define SELF_WAKE_UP_PROTECTION        1
+#endif /* ENABLE_VIT_ASR */
 #endif /* ENABLE_AMPLIFIER */
 
+#if ENABLE_AEC && ENABLE_AMPLIFIER && USE_MQS
+/* If set to 1, "aecmode calibrate" plays the AEC alignment sound, measures the delay between the
+ * microphones and the loopback reference and stores the loopback delay in the file system.
+ * The stored delay replaces AMP_LOOPBACK_CONST_DELAY_US at boot.
+ * The calibration allocates about 20KB of FreeRTOS heap while it runs. */
+#define ENABLE_AEC_CALIBRATION         1
+#endif /* ENABLE_AEC && ENABLE_AMPLIFIER && USE_MQS */
+
 /* Enable CPU usage tracing. When set to 1, a new command will be available in
  * sln_shell: cpuview. This will print CPU usage per task */
 #define SLN_TRACE_CPU_USAGE            0
 
+/* Enable wake word and command latency tracing. When set to 1, the captured audio is time stamped
+ * from the mics DMA up to the appTask action and a new command will be available in sln_shell: latency.
+ * This will print the latency histograms per pipeline stage or export them in binary form */
+#define SLN_TRACE_LATENCY              0
+
 /* Enable logging task based on dynamic buffer allocation.
  * Using this is helpful as the other tasks do not need to waste time printing
  * on the console. The log is instead inserted in a queue and printed by the
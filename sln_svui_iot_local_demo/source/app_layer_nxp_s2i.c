@@ -98,13 +98,8 @@ static status_t APP_LAYER_PlayAudioFromFileSystem(char *filename)
 {
     status_t status = kStatus_Success;
 
-    /* Make sure that speaker is not currently playing another audio. */
-    while (LOCAL_SOUNDS_isPlaying())
-    {
-        vTaskDelay(10);
-    }
-
-    LOCAL_SOUNDS_PlayAudioFile(filename, appAsrShellCommands.volume);
+    /* Play the prompt right after the one currently playing, without a gap. */
+    LOCAL_SOUNDS_QueueAudioFile(filename, appAsrShellCommands.volume);
 
     return status;
 }
@@ -3142,6 +3137,8 @@ status_t APP_LAYER_ProcessWakeWord(oob_demo_control_t *commandConfig)
     status_t status = kStatus_Success;
 
 #if ENABLE_STREAMER
+    /* The prompts still queued answer the previous utterance */
+    LOCAL_SOUNDS_CancelPlaylist(false);
     APP_LAYER_PlayAudioFromFileSystem(AUDIO_WW_DETECTED);
 #endif /* ENABLE_STREAMER */
 
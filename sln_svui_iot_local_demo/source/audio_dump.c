@@ -28,14 +28,14 @@
  * Definitions
  ******************************************************************************/
 #define USB_BUFFER_OUTPUT_VCOM_SIZE \
-    ((PCM_SAMPLE_COUNT * PCM_SAMPLE_SIZE_BYTES) + (PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES * 2))
+    ((AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT * PCM_SAMPLE_SIZE_BYTES) + (AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES * 2))
 
 #define DUMP_QUEUE_SLOTS 3
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
-          s_dumpStream[PCM_SINGLE_CH_SMPL_COUNT * (SLN_MIC_COUNT + 2)],
+          s_dumpStream[AFE_BLOCK_SMPL_COUNT * (SLN_MIC_COUNT + 2)],
           8);
 QueueHandle_t g_xDumpQueue        = NULL;
 TaskHandle_t  audioDumpTaskHandle = NULL;
@@ -406,7 +406,7 @@ void AUDIO_DUMP_ForwardDataOverUsb(int16_t *micStream, int16_t *ampStream, void
     {
         if (g_xDumpQueue == NULL)
         {
-            g_xDumpQueue = xQueueCreate(DUMP_QUEUE_SLOTS, PCM_SINGLE_CH_SMPL_COUNT * (SLN_MIC_COUNT + 2) * sizeof(short));
+            g_xDumpQueue = xQueueCreate(DUMP_QUEUE_SLOTS, AFE_BLOCK_SMPL_COUNT * (SLN_MIC_COUNT + 2) * sizeof(short));
             if (g_xDumpQueue == NULL)
             {
                 configPRINTF(("Failed to create DumpQueue!\r\n"));
@@ -426,19 +426,19 @@ void AUDIO_DUMP_ForwardDataOverUsb(int16_t *micStream, int16_t *ampStream, void
         }
 
         /* Prepare and send clean data to Audio Dump task */
-        memcpy(&s_dumpStream[u32Element], (uint8_t *)micStream, PCM_SAMPLE_COUNT * PCM_SAMPLE_SIZE_BYTES);
-        u32Element += PCM_SAMPLE_COUNT;
+        memcpy(&s_dumpStream[u32Element], (uint8_t *)micStream, AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        u32Element += AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT;
         if (ampStream != NULL)
         {
-            memcpy(&s_dumpStream[u32Element], (uint8_t *)ampStream, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+            memcpy(&s_dumpStream[u32Element], (uint8_t *)ampStream, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
         }
         else
         {
-            memset(&s_dumpStream[u32Element], 0, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+            memset(&s_dumpStream[u32Element], 0, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
         }
-        u32Element += PCM_SINGLE_CH_SMPL_COUNT;
-        memcpy(&s_dumpStream[u32Element], (uint8_t *)cleanStream, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
-        u32Element += PCM_SINGLE_CH_SMPL_COUNT;
+        u32Element += AFE_BLOCK_SMPL_COUNT;
+        memcpy(&s_dumpStream[u32Element], (uint8_t *)cleanStream, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        u32Element += AFE_BLOCK_SMPL_COUNT;
 
         if (xQueueSendToBack(g_xDumpQueue, s_dumpStream, 0) != pdPASS)
         {
@@ -465,7 +465,7 @@ void AUDIO_DUMP_AecAlignSoundTask(void *arg)
             vTaskDelay(150);
 
             SLN_AMP_SetVolume(AEC_ALIGN_SOUND_VOLUME);
-            status = SLN_AMP_WriteAudioBlocking(sound, soundSize, DEFAULT_AMP_SLOT_SIZE, DEFAULT_AMP_SLOT_CNT, true);
+            status = SLN_AMP_WriteAudioBlocking(sound, soundSize);
             if (status != kStatus_Success)
             {
                 configPRINTF(("[Error] SLN_AMP_WriteAudioBlocking failed %d\r\n", status));
@@ -46,11 +46,22 @@
 #include "sln_flash_fs.h"
 #include "sln_flash_fs_ops.h"
 #include "sln_flash_files.h"
+#if ENABLE_MODEL_STORE
+#include "sln_model_store.h"
+#endif /* ENABLE_MODEL_STORE */
 
 /* Audio processing includes */
 #include "audio_processing_task.h"
+#include "audio_profiler.h"
+#include "audio_deadline.h"
 #include "pdm_to_pcm_task.h"
+#if SLN_TRACE_LATENCY
+#include "audio_latency.h"
+#endif /* SLN_TRACE_LATENCY */
 #include "sln_amplifier.h"
+#if ENABLE_AEC_CALIBRATION
+#include "audio_aec_calib.h"
+#endif /* ENABLE_AEC_CALIBRATION */
 #if ENABLE_USB_AUDIO_DUMP
 #include "audio_dump.h"
 #endif /* ENABLE_USB_AUDIO_DUMP */
@@ -148,10 +159,7 @@ static status_t audio_play_clip(char *fileName, uint32_t volume)
     status_t status = kStatus_Success;
 
     /* Make sure that speaker is not currently playing another audio. */
-    while (LOCAL_SOUNDS_isPlaying())
-    {
-        vTaskDelay(10);
-    }
+    LOCAL_SOUNDS_WaitForIdle(UINT32_MAX);
 
     status = LOCAL_SOUNDS_PlayAudioFile(fileName, volume);
 
@@ -218,12 +226,27 @@ void appTask(void *arg)
 #endif /* ENABLE_STREAMER */
 #endif /* ENABLE_AMPLIFIER */
 
+#if ENABLE_AEC_CALIBRATION
+    /* Use the loopback delay measured by the last AEC calibration, if any */
+    AUDIO_AEC_CALIB_Init();
+#endif /* ENABLE_AEC_CALIBRATION */
+
     int16_t *micBuf = SLN_MIC_GET_PCM_BUFFER_POINTER();
     audio_processing_set_mic_input_buffer(micBuf);
 
+#if SLN_MIC_FLOAT_STREAM
+    float *micFloatBuf = SLN_MIC_GET_PCM_FLOAT_BUFFER_POINTER();
+    audio_processing_set_mic_float_input_buffer(micFloatBuf);
+#endif /* SLN_MIC_FLOAT_STREAM */
+
     int16_t *ampBuf = SLN_MIC_GET_AMP_BUFFER_POINTER();
     audio_processing_set_amp_input_buffer(ampBuf);
 
+    audio_processing_set_mic_ring(SLN_MIC_GET_RING_POINTER());
+
+#if SLN_TRACE_LATENCY
+    AUDIO_LATENCY_Init();
+#endif /* SLN_TRACE_LATENCY */
 
     /* Create audio processing task */
     if (xTaskCreate(audio_processing_task, "Audio_Proc_Task", 768, NULL, audio_processing_task_PRIORITY,
@@ -242,7 +265,6 @@ void appTask(void *arg)
     config.feedbackDisable = SLN_AMP_LoopbackDisable;
 #if USE_MQS
     config.loopbackRingBuffer = SLN_AMP_GetRingBuffer();
-    config.loopbackMutex      = SLN_AMP_GetLoopBackMutex();
     config.updateTimestamp    = SLN_AMP_UpdateTimestamp;
     config.getTimestamp       = SLN_AMP_GetTimestamp;
 #endif /* USE_MQS */
@@ -364,6 +386,9 @@ void appTask(void *arg)
         if (taskNotification & kWakeWordDetected)
         {
             APP_LAYER_ProcessWakeWord(&oob_demo_control);
+#if SLN_TRACE_LATENCY
+            AUDIO_LATENCY_DetectionHandled(kAudioLatencyWakeWord);
+#endif /* SLN_TRACE_LATENCY */
         }
 
         if (taskNotification & kVoiceCommandDetected)
@@ -373,6 +398,9 @@ void appTask(void *arg)
 #else
             APP_LAYER_ProcessVoiceCommand(&oob_demo_control);
 #endif /* ENABLE_S2I_ASR */
+#if SLN_TRACE_LATENCY
+            AUDIO_LATENCY_DetectionHandled(kAudioLatencyCommand);
+#endif /* SLN_TRACE_LATENCY */
         }
 
        if (taskNotification & kTimeOut)
@@ -519,6 +547,10 @@ int main(void)
 
     DMAMUX_Init(DMAMUX);
 
+    /* Start the cycle counter used to profile the audio pipeline */
+    AUDIO_PROFILER_Init();
+    AUDIO_DEADLINE_Init();
+
     RGB_LED_Init();
     RGB_LED_SetColor(LED_COLOR_GREEN);
 
@@ -553,6 +585,11 @@ int main(void)
     xLoggingTaskInitialize(384, configMAX_PRIORITIES - 5, 32);
 #endif /* ENABLE_LOGGING_TASK */
 
+#if ENABLE_MODEL_STORE
+    /* Read the model index before the ASR task looks up its first model */
+    SLN_MODEL_STORE_Init();
+#endif /* ENABLE_MODEL_STORE */
+
     /* Run RTOS */
     vTaskStartScheduler();
 
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if ASR_MEM_BENCH
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "sln_flash_config.h"
+#include "sln_flash_fs_ops.h"
+#include "audio_frame_pool.h"
+#include "audio_profiler.h"
+#include "sln_asr_mem_bench.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define ASR_MEM_BENCH_ALIGN 8U
+
+/* Heap left to the other tasks and to the heap block headers while the benchmark runs */
+#define ASR_MEM_BENCH_HEAP_MARGIN (8U * 1024U)
+
+/* Synthetic clip: 160 ms voiced bursts every 250 ms, 125 Hz pulse train over noise */
+#define ASR_MEM_BENCH_SYNTH_PERIOD  4000U
+#define ASR_MEM_BENCH_SYNTH_VOICED  2560U
+#define ASR_MEM_BENCH_SYNTH_PITCH   128U
+
+typedef struct _asr_mem_bench_arena
+{
+    uint8_t *base;
+    uint32_t size;
+    uint32_t used;
+    sln_asr_mem_region_t region;
+} asr_mem_bench_arena_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+extern void __base_SRAM_DTC(void);
+extern void __top_SRAM_DTC(void);
+extern void __base_SRAM_OC_NON_CACHEABLE(void);
+extern void __top_SRAM_OC_NON_CACHEABLE(void);
+extern void __base_SRAM_OC_CACHEABLE(void);
+extern void __top_SRAM_OC_CACHEABLE(void);
+
+static asr_mem_bench_arena_t s_arenas[ASR_MEM_BENCH_MAX_ARENAS];
+static uint32_t s_arenaCount = 0;
+
+/* Blocks taken from the FreeRTOS heap, freed by SLN_ASR_MEM_BENCH_FreeAll */
+static void *s_heapBlocks[ASR_MEM_BENCH_MAX_ARENAS];
+static uint32_t s_heapBlockCount = 0;
+
+static int16_t s_clipFrame[AUDIO_FRAME_SAMPLE_COUNT];
+static uint32_t s_clipLength = 0; /* Bytes of ASR_MEM_BENCH_CLIP_FILE, 0 when the synthetic clip is used */
+static uint32_t s_synthNoise = 0;
+static int32_t s_synthFilter = 0;
+
+static const char *const s_regionNames[] = {"DTC", "OC_CACHEABLE", "OC_NON_CACHEABLE", "XIP", "UNKNOWN"};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+/*!
+ * @brief Fill s_clipFrame with the next frame of the clip. The same clip is produced after each reset.
+ */
+static void _clip_next_frame(uint32_t frame)
+{
+    uint32_t len    = sizeof(s_clipFrame);
+    uint32_t offset = 0;
+    uint32_t n      = 0;
+    int32_t sample  = 0;
+
+    if (s_clipLength >= sizeof(s_clipFrame))
+    {
+        offset = (frame * sizeof(s_clipFrame)) % (s_clipLength - (s_clipLength % sizeof(s_clipFrame)));
+        if (sln_flash_fs_ops_read(ASR_MEM_BENCH_CLIP_FILE, (uint8_t *)s_clipFrame, offset, &len) == SLN_FLASH_FS_OK)
+        {
+            return;
+        }
+    }
+
+    for (uint32_t idx = 0; idx < AUDIO_FRAME_SAMPLE_COUNT; idx++)
+    {
+        n            = frame * AUDIO_FRAME_SAMPLE_COUNT + idx;
+        s_synthNoise = s_synthNoise * 1664525U + 1013904223U;
+        sample       = (int32_t)(s_synthNoise >> 16U) - 32768;
+        sample >>= 6;
+
+        if ((n % ASR_MEM_BENCH_SYNTH_PERIOD) < ASR_MEM_BENCH_SYNTH_VOICED)
+        {
+            if ((n % ASR_MEM_BENCH_SYNTH_PITCH) == 0)
+            {
+                sample += 12000;
+            }
+            /* One pole low pass, gives the pulses a vowel like decay */
+            s_synthFilter += (sample - s_synthFilter) >> 2;
+            sample = s_synthFilter;
+        }
+
+        s_clipFrame[idx] = (int16_t)__SSAT(sample, 16);
+    }
+}
+
+static void _clip_reset(void)
+{
+    uint32_t len = 0;
+
+    s_synthNoise  = 0x5EED;
+    s_synthFilter = 0;
+
+    if (sln_flash_fs_ops_read(ASR_MEM_BENCH_CLIP_FILE, NULL, 0, &len) == SLN_FLASH_FS_OK)
+    {
+        s_clipLength = len;
+    }
+    else
+    {
+        s_clipLength = 0;
+    }
+}
+
+void SLN_ASR_MEM_BENCH_Init(void)
+{
+    SLN_ASR_MEM_BENCH_FreeAll();
+
+    memset(s_arenas, 0, sizeof(s_arenas));
+    s_arenaCount = 0;
+}
+
+void SLN_ASR_MEM_BENCH_AddArena(void *base, uint32_t size)
+{
+    if ((base != NULL) && (size > 0) && (s_arenaCount < ASR_MEM_BENCH_MAX_ARENAS))
+    {
+        s_arenas[s_arenaCount].base   = (uint8_t *)base;
+        s_arenas[s_arenaCount].size   = size;
+        s_arenas[s_arenaCount].used   = 0;
+        s_arenas[s_arenaCount].region = SLN_ASR_MEM_BENCH_GetRegion(base);
+        s_arenaCount++;
+    }
+}
+
+void *SLN_ASR_MEM_BENCH_Alloc(sln_asr_mem_region_t region, uint32_t size)
+{
+    void *block          = NULL;
+    uint32_t alignedSize = (size + ASR_MEM_BENCH_ALIGN - 1U) & ~(ASR_MEM_BENCH_ALIGN - 1U);
+
+    for (uint32_t idx = 0; (idx < s_arenaCount) && (block == NULL); idx++)
+    {
+        if ((s_arenas[idx].region == region) && ((s_arenas[idx].size - s_arenas[idx].used) >= alignedSize))
+        {
+            block = &s_arenas[idx].base[s_arenas[idx].used];
+            s_arenas[idx].used += alignedSize;
+        }
+    }
+
+    /* The heap region is not assumed, the block is kept only if it landed in the right one.
+     * A request larger than the largest free block is not tried, it would break in the malloc failed hook. */
+    if ((block == NULL) && (s_heapBlockCount < ASR_MEM_BENCH_MAX_ARENAS))
+    {
+        HeapStats_t heapStats;
+
+        vPortGetHeapStats(&heapStats);
+        if (heapStats.xSizeOfLargestFreeBlockInBytes >= (alignedSize + ASR_MEM_BENCH_HEAP_MARGIN))
+        {
+            block = pvPortMalloc(alignedSize);
+        }
+        if ((block != NULL) && (SLN_ASR_MEM_BENCH_GetRegion(block) != region))
+        {
+            vPortFree(block);
+            block = NULL;
+        }
+
+        if (block != NULL)
+        {
+            s_heapBlocks[s_heapBlockCount++] = block;
+        }
+    }
+
+    return block;
+}
+
+void SLN_ASR_MEM_BENCH_FreeAll(void)
+{
+    for (uint32_t idx = 0; idx < s_arenaCount; idx++)
+    {
+        s_arenas[idx].used = 0;
+    }
+
+    for (uint32_t idx = 0; idx < s_heapBlockCount; idx++)
+    {
+        vPortFree(s_heapBlocks[idx]);
+        s_heapBlocks[idx] = NULL;
+    }
+    s_heapBlockCount = 0;
+}
+
+sln_asr_mem_region_t SLN_ASR_MEM_BENCH_GetRegion(const void *address)
+{
+    uint32_t addr               = (uint32_t)address;
+    sln_asr_mem_region_t region = kAsrMemRegion_Unknown;
+
+    if ((addr >= (uint32_t)__base_SRAM_DTC) && (addr < (uint32_t)__top_SRAM_DTC))
+    {
+        region = kAsrMemRegion_Dtc;
+    }
+    else if ((addr >= (uint32_t)__base_SRAM_OC_CACHEABLE) && (addr < (uint32_t)__top_SRAM_OC_CACHEABLE))
+    {
+        region = kAsrMemRegion_OcCacheable;
+    }
+    else if ((addr >= (uint32_t)__base_SRAM_OC_NON_CACHEABLE) && (addr < (uint32_t)__top_SRAM_OC_NON_CACHEABLE))
+    {
+        region = kAsrMemRegion_OcNonCacheable;
+    }
+    else if ((addr >= FLEXSPI_AMBA_BASE) && (addr < (FLEXSPI_AMBA_BASE + FLASH_SIZE)))
+    {
+        region = kAsrMemRegion_Xip;
+    }
+
+    return region;
+}
+
+const char *SLN_ASR_MEM_BENCH_GetRegionName(sln_asr_mem_region_t region)
+{
+    return s_regionNames[MIN((uint32_t)region, (uint32_t)kAsrMemRegion_Unknown)];
+}
+
+void SLN_ASR_MEM_BENCH_Run(const char *label,
+                           sln_asr_mem_bench_process_t process,
+                           void *arg,
+                           sln_asr_mem_bench_result_t *result)
+{
+    sln_asr_mem_bench_result_t res = {.minCycles = UINT32_MAX};
+    uint64_t sumCycles             = 0;
+    uint32_t start                 = 0;
+    uint32_t cycles                = 0;
+    uint32_t frameCycles           = (uint32_t)(((uint64_t)SystemCoreClock * ASR_FRAME_MS) / 1000U);
+
+    _clip_reset();
+
+    for (uint32_t frame = 0; frame < ASR_MEM_BENCH_FRAMES; frame++)
+    {
+        /* The clip is read or generated outside of the measure */
+        _clip_next_frame(frame);
+
+        start = AUDIO_PROFILER_GET_CYCLES();
+        if (process(arg, s_clipFrame) != 0)
+        {
+            res.errors++;
+        }
+        cycles = AUDIO_PROFILER_GET_CYCLES() - start;
+
+        if (frame >= ASR_MEM_BENCH_WARMUP_FRAMES)
+        {
+            sumCycles += cycles;
+            res.frames++;
+            res.minCycles = MIN(res.minCycles, cycles);
+            res.maxCycles = MAX(res.maxCycles, cycles);
+        }
+
+        /* Let the lower priority tasks run between two frames, the logging task among them */
+        vTaskDelay(1);
+    }
+
+    if (res.frames > 0)
+    {
+        res.avgCycles = (uint32_t)(sumCycles / res.frames);
+    }
+    else
+    {
+        res.minCycles = 0;
+    }
+
+    configPRINTF(("[MEMBENCH] %s: avg %d, min %d, max %d cycles/frame, %d%% of a frame, %d errors (%s clip)\r\n",
+                  label, res.avgCycles, res.minCycles, res.maxCycles,
+                  (frameCycles > 0) ? (uint32_t)(((uint64_t)res.avgCycles * 100U) / frameCycles) : 0, res.errors,
+                  (s_clipLength > 0) ? ASR_MEM_BENCH_CLIP_FILE : "synthetic"));
+
+    if (result != NULL)
+    {
+        *result = res;
+    }
+}
+
+#endif /* ASR_MEM_BENCH */
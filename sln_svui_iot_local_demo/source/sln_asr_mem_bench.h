@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_ASR_MEM_BENCH_H_
+#define _SLN_ASR_MEM_BENCH_H_
+
+#if ASR_MEM_BENCH
+
+#include "stdint.h"
+
+#if ENABLE_VAD
+#error "ASR_MEM_BENCH needs ENABLE_VAD set to 0, VAD would suspend the benchmark and lower the core clock"
+#endif /* ENABLE_VAD */
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Frames of the clip run for each placement, the first ASR_MEM_BENCH_WARMUP_FRAMES are not measured */
+#ifndef ASR_MEM_BENCH_FRAMES
+#define ASR_MEM_BENCH_FRAMES 100U
+#endif /* ASR_MEM_BENCH_FRAMES */
+
+#ifndef ASR_MEM_BENCH_WARMUP_FRAMES
+#define ASR_MEM_BENCH_WARMUP_FRAMES 5U
+#endif /* ASR_MEM_BENCH_WARMUP_FRAMES */
+
+/* Raw 16 kHz, 16 bit, mono PCM clip in the file system. When the file is missing, a synthetic
+ * clip alternating voiced bursts and silence is generated, the same one on every run. */
+#define ASR_MEM_BENCH_CLIP_FILE "bench_clip.pcm"
+
+/* Scratch buffers the benchmark may use besides the FreeRTOS heap */
+#define ASR_MEM_BENCH_MAX_ARENAS 6U
+
+/*! @brief Memory regions. The RAM regions come first, the pools can only be placed in them. */
+typedef enum _sln_asr_mem_region
+{
+    kAsrMemRegion_Dtc = 0,
+    kAsrMemRegion_OcCacheable,
+    kAsrMemRegion_OcNonCacheable,
+    kAsrMemRegion_RamCount,
+    kAsrMemRegion_Xip = kAsrMemRegion_RamCount,
+    kAsrMemRegion_Unknown,
+} sln_asr_mem_region_t;
+
+/*! @brief Processing time of one placement */
+typedef struct _sln_asr_mem_bench_result
+{
+    uint32_t frames;    /*!< Frames measured */
+    uint32_t avgCycles; /*!< Average cycles per frame */
+    uint32_t minCycles; /*!< Fastest frame, the least disturbed by the interrupts */
+    uint32_t maxCycles; /*!< Slowest frame */
+    uint32_t errors;    /*!< Frames the engine failed to process */
+} sln_asr_mem_bench_result_t;
+
+/*!
+ * @brief Process one frame of the clip with the engine under test.
+ *
+ * @param arg     Argument given to SLN_ASR_MEM_BENCH_Run
+ * @param samples Frame of AUDIO_FRAME_SAMPLE_COUNT samples
+ * @returns 0 on success, an engine error code otherwise
+ */
+typedef int32_t (*sln_asr_mem_bench_process_t)(void *arg, int16_t *samples);
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Forget the scratch buffers and free the memory allocated by a previous benchmark.
+ */
+void SLN_ASR_MEM_BENCH_Init(void);
+
+/*!
+ * @brief Give a scratch buffer to the benchmark. Its content is lost, the engine using it must be
+ *        initialized again once the benchmark is over.
+ *
+ * @param base Buffer address, its region is found from the address
+ * @param size Buffer size in bytes
+ */
+void SLN_ASR_MEM_BENCH_AddArena(void *base, uint32_t size);
+
+/*!
+ * @brief Allocate 8 bytes aligned memory in a region, from the scratch buffers or from the FreeRTOS
+ *        heap when it lives in that region.
+ *
+ * @param region Region the memory must be in
+ * @param size   Size in bytes
+ * @returns The memory, or NULL if the region has no room left
+ */
+void *SLN_ASR_MEM_BENCH_Alloc(sln_asr_mem_region_t region, uint32_t size);
+
+/*!
+ * @brief Release all the memory allocated by SLN_ASR_MEM_BENCH_Alloc.
+ */
+void SLN_ASR_MEM_BENCH_FreeAll(void);
+
+/*!
+ * @brief Find the region of an address.
+ */
+sln_asr_mem_region_t SLN_ASR_MEM_BENCH_GetRegion(const void *address);
+
+/*!
+ * @brief Get the name of a region, as used in the placement table.
+ */
+const char *SLN_ASR_MEM_BENCH_GetRegionName(sln_asr_mem_region_t region);
+
+/*!
+ * @brief Run the clip through the engine and print the cycles per frame.
+ *
+ * @param label   Placement under test, printed with the result
+ * @param process Engine processing function
+ * @param arg     Argument given to process
+ * @param result  Pointer where the result will be stored, can be NULL
+ */
+void SLN_ASR_MEM_BENCH_Run(const char *label,
+                           sln_asr_mem_bench_process_t process,
+                           void *arg,
+                           sln_asr_mem_bench_result_t *result);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ASR_MEM_BENCH */
+#endif /* _SLN_ASR_MEM_BENCH_H_ */
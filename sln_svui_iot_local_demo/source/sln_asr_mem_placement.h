@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_ASR_MEM_PLACEMENT_H_
+#define _SLN_ASR_MEM_PLACEMENT_H_
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Regions an ASR memory pool can be linked in, named after the regions of the linker script:
+ *   DTC              DTCM, single cycle, never cached, shared with the FreeRTOS heap and the stacks
+ *   OC_CACHEABLE     OCRAM behind the D-cache
+ *   OC_NON_CACHEABLE OCRAM without cache
+ * The models are not part of the table, they are read in place from the flash (XIP). */
+#define _ASR_MEM_SECTION(region) __attribute__((section(".bss.$SRAM_" #region)))
+#define ASR_MEM_SECTION(region)  _ASR_MEM_SECTION(region)
+
+#define _ASR_MEM_REGION_NAME(region) #region
+#define ASR_MEM_REGION_NAME(region)  _ASR_MEM_REGION_NAME(region)
+
+/* Placement table
+ *
+ * Build with ASR_MEM_BENCH set to 1 to get the cycles per frame of the engine for each placement
+ * which fits, then set the fastest one here. A placement which does not fit fails at link time. */
+
+#if ENABLE_VIT_ASR
+/* VIT persistent fast data and scratch */
+#ifndef VIT_FAST_MEMORY_REGION
+#define VIT_FAST_MEMORY_REGION OC_CACHEABLE
+#endif /* VIT_FAST_MEMORY_REGION */
+
+/* VIT persistent slow data */
+#ifndef VIT_SLOW_MEMORY_REGION
+#define VIT_SLOW_MEMORY_REGION OC_NON_CACHEABLE
+#endif /* VIT_SLOW_MEMORY_REGION */
+
+/* Speed of the model memory as told to VIT: VIT_MODEL_IN_SLOW_MEM or VIT_MODEL_IN_FAST_MEM.
+ * The memory table of the instance depends on it. */
+#ifndef VIT_MODEL_LOCATION
+#define VIT_MODEL_LOCATION VIT_MODEL_IN_SLOW_MEM
+#endif /* VIT_MODEL_LOCATION */
+#endif /* ENABLE_VIT_ASR */
+
+#if ENABLE_DSMT_ASR
+/* Wake word engines pools, one per concurrent language */
+#ifndef DSMT_WW_POOL_REGION
+#define DSMT_WW_POOL_REGION OC_CACHEABLE
+#endif /* DSMT_WW_POOL_REGION */
+
+/* Commands engine pool. Cacheable OCRAM has no room left next to the four wake word pools
+ * when MULTILINGUAL is set. */
+#ifndef DSMT_CMD_POOL_REGION
+#if MULTILINGUAL
+#define DSMT_CMD_POOL_REGION OC_NON_CACHEABLE
+#else
+#define DSMT_CMD_POOL_REGION OC_CACHEABLE
+#endif /* MULTILINGUAL */
+#endif /* DSMT_CMD_POOL_REGION */
+#endif /* ENABLE_DSMT_ASR */
+
+#endif /* _SLN_ASR_MEM_PLACEMENT_H_ */
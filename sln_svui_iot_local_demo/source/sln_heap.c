@@ -0,0 +1,36 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "sln_heap.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void *SLN_HEAP_TryAlloc(size_t size)
+{
+    HeapStats_t heapStats;
+    void *block = NULL;
+
+    /* No other task may take the free block between the check and the allocation */
+    vTaskSuspendAll();
+
+    vPortGetHeapStats(&heapStats);
+
+    /* Room for the heap block header and the alignment */
+    if (heapStats.xSizeOfLargestFreeBlockInBytes >= (size + 2U * portBYTE_ALIGNMENT))
+    {
+        block = pvPortMalloc(size);
+    }
+
+    (void)xTaskResumeAll();
+
+    return block;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_HEAP_H_
+#define _SLN_HEAP_H_
+
+#include "stddef.h"
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate from the FreeRTOS heap only if the largest free block can hold the request.
+ *        Unlike pvPortMalloc, a heap too small or too fragmented does not call the malloc failed hook
+ *        (which halts the board), the caller gets NULL and can fall back.
+ *
+ * @param size Bytes to allocate.
+ *
+ * @return The allocated block, portBYTE_ALIGNMENT aligned, or NULL. Free it with vPortFree.
+ */
+void *SLN_HEAP_TryAlloc(size_t size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _SLN_HEAP_H_ */
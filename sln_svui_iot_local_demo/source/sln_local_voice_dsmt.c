@@ -6,6 +6,8 @@
 
 #if ENABLE_DSMT_ASR
 
+#include <stdio.h>
+
 /* FreeRTOS includes */
 #include "FreeRTOS.h"
 #include "task.h"
@@ -26,11 +28,21 @@
 #include "sln_local_voice_dsmt.h"
 #include "IndexCommands.h"
 #include "audio_processing_task.h"
+#include "audio_frame_pool.h"
+#include "audio_profiler.h"
+#include "audio_deadline.h"
+#include "sln_asr_mem_placement.h"
+#if ASR_MEM_BENCH
+#include "sln_asr_mem_bench.h"
+#endif /* ASR_MEM_BENCH */
+#if MULTILINGUAL && ENABLE_WW_SCHEDULER
+#include "sln_ww_scheduler.h"
+#endif /* MULTILINGUAL && ENABLE_WW_SCHEDULER */
 
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
-#define NUM_SAMPLES_AFE_OUTPUT            (480)
+#define NUM_SAMPLES_AFE_OUTPUT            AUDIO_FRAME_SAMPLE_COUNT
 #if USE_DSMT_EVALUATION_MODE
 #define DSMT_EVALUATION_DETECTIONS_LIMIT  (100)
 #endif /* USE_DSMT_EVALUATION_MODE */
@@ -59,23 +71,17 @@ typedef struct pool_entry_t_
 /*******************************************************************************
  * Variables
  ******************************************************************************/
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) g_memPoolWLang0[WAKE_WORD_MEMPOOL_SIZE], 8);
-
-#if MULTILINGUAL
-/* Put commands static pool in non cacheable ocram as we don't have any more space in cacheable
- * when MULTILINGUAL is on */
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE"))) g_memPoolCmd[COMMAND_MEMPOOL_SIZE], 8);
-#else
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) g_memPoolCmd[COMMAND_MEMPOOL_SIZE], 8);
-#endif /* MULTILINGUAL */
+/* The regions of the pools come from the placement table, see sln_asr_mem_placement.h */
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(DSMT_WW_POOL_REGION) g_memPoolWLang0[WAKE_WORD_MEMPOOL_SIZE], 8);
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(DSMT_CMD_POOL_REGION) g_memPoolCmd[COMMAND_MEMPOOL_SIZE], 8);
 
 #if MULTILINGUAL
 /* NOTE: Chinese with Tone Recognition model takes larger memory pool than the other languages.
  * Make sure Chinese model is placed in g_memPoolWLang3 with CN_WAKE_WORD_MEMPOOL_SIZE.
  * Also, make sure Chinese model is installed in the same order for install_language() and install_inference_engine(). */
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) g_memPoolWLang1[WAKE_WORD_MEMPOOL_SIZE], 8);
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) g_memPoolWLang2[WAKE_WORD_MEMPOOL_SIZE], 8);
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) g_memPoolWLang3[CN_WAKE_WORD_MEMPOOL_SIZE], 8);
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(DSMT_WW_POOL_REGION) g_memPoolWLang1[WAKE_WORD_MEMPOOL_SIZE], 8);
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(DSMT_WW_POOL_REGION) g_memPoolWLang2[WAKE_WORD_MEMPOOL_SIZE], 8);
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(DSMT_WW_POOL_REGION) g_memPoolWLang3[CN_WAKE_WORD_MEMPOOL_SIZE], 8);
 
 /* NOTE: must be in pool size order, from lower to higher pool size! */
 pool_entry_t g_memPoolWw[MAX_CONCURRENT_LANGUAGES] =      {{g_memPoolWLang0, sizeof(g_memPoolWLang0), false},
@@ -101,6 +107,11 @@ struct asr_inference_engine g_asrInfCMD                            = {};
 asr_control_t g_asrControl                                         = {};
 app_asr_shell_commands_t appAsrShellCommands                       = {};
 
+#if MULTILINGUAL
+/* Set by the deadline monitor while ASR keeps overrunning its budget */
+static volatile bool s_shedSecondaryWW = false;
+#endif /* MULTILINGUAL */
+
 /*******************************************************************************
  * Code
  ******************************************************************************/
@@ -472,7 +483,57 @@ void reset_WW_engine(asr_control_t *pAsrCtrl)
     {
         reset_inference_handler(pInf);
     }
+
+#if MULTILINGUAL && ENABLE_WW_SCHEDULER
+    SLN_WW_SCHED_EnginesReset();
+#endif /* MULTILINGUAL && ENABLE_WW_SCHEDULER */
+}
+
+#if MULTILINGUAL
+/*!
+ * @brief Get the WW recognition engine of the last detected language, or the first one if none matches.
+ */
+static struct asr_inference_engine *get_primary_WW_engine(asr_control_t *pAsrCtrl)
+{
+    struct asr_inference_engine *pInf = pAsrCtrl->infEngineWW;
+
+    for (pInf = pAsrCtrl->infEngineWW; pInf != NULL; pInf = pInf->next)
+    {
+        if (pInf->iWhoAmI_lang == oob_demo_control.language)
+        {
+            break;
+        }
+    }
+
+    return (pInf != NULL) ? pInf : pAsrCtrl->infEngineWW;
+}
+
+#if ENABLE_WW_SCHEDULER
+/*!
+ * @brief Get the position of a WW recognition engine in the list, or the number of engines if pEngine is NULL.
+ */
+static uint32_t get_WW_engine_index(asr_control_t *pAsrCtrl, struct asr_inference_engine *pEngine)
+{
+    struct asr_inference_engine *pInf = pAsrCtrl->infEngineWW;
+    uint32_t idx                      = 0;
+
+    for (pInf = pAsrCtrl->infEngineWW; (pInf != NULL) && (pInf != pEngine); pInf = pInf->next)
+    {
+        idx++;
+    }
+
+    return idx;
+}
+#endif /* ENABLE_WW_SCHEDULER */
+
+/*!
+ * @brief Deadline monitor load shedding: skip the secondary language WW engines while ASR overruns.
+ */
+static void asr_shed_load(bool shed)
+{
+    s_shedSecondaryWW = shed;
 }
+#endif /* MULTILINGUAL */
 
 /*!
  * @brief Set specific language CMD recognition engine, post WW detection.
@@ -518,13 +579,16 @@ void reset_CMD_engine(asr_control_t *pAsrCtrl)
  */
 int asr_process_audio_buffer(void *handler, int16_t *audBuff, uint16_t bufSize, asr_inference_t infType)
 {
-    int status = 0;
+    int status         = 0;
+    uint32_t profStart = 0;
     // reset values
     g_asrControl.result.keywordID[0] = 0xFFFF;
     g_asrControl.result.keywordID[1] = 0xFFFF;
     g_asrControl.result.cmdMapID     = 0xFF;
 
-    status = SLN_ASR_LOCAL_Process(handler, audBuff, bufSize, &g_asrControl.result);
+    profStart = AUDIO_PROFILER_GET_CYCLES();
+    status    = SLN_ASR_LOCAL_Process(handler, audBuff, bufSize, &g_asrControl.result);
+    AUDIO_PROFILER_STOP(kAudioProfilerAsr, profStart);
 
     return status;
 }
@@ -619,7 +683,98 @@ void initialize_asr(void)
     // init
     init_WW_engine(&g_asrControl, demoType);
     init_CMD_engine(&g_asrControl, demoType);
+
+#if MULTILINGUAL && ENABLE_WW_SCHEDULER
+    /* The engines are indexed by their position in the list, which changes with the active languages */
+    SLN_WW_SCHED_Init(get_WW_engine_index(&g_asrControl, NULL));
+#endif /* MULTILINGUAL && ENABLE_WW_SCHEDULER */
+}
+
+#if ASR_MEM_BENCH
+static int32_t asr_bench_process(void *arg, int16_t *samples)
+{
+    int32_t status = SLN_ASR_LOCAL_Process((HANDLE)arg, samples, NUM_SAMPLES_AFE_OUTPUT, &g_asrControl.result);
+
+    /* A detection is not an error, the engine is reset as after a real one */
+    if (status == kAsrLocalDetected)
+    {
+        SLN_ASR_LOCAL_Reset((HANDLE)arg);
+        status = kAsrLocalSuccess;
+    }
+
+    return status;
+}
+
+/*!
+ * @brief Measure an engine with its pool in each RAM region. The model is read from the flash (XIP).
+ */
+static void asr_bench_engine(const char *name, struct asr_inference_engine *p)
+{
+    int32_t memUsage = 0;
+    int32_t status   = kAsrLocalSuccess;
+    HANDLE handler   = NULL;
+    uint8_t *pool    = NULL;
+    char label[64];
+
+    memUsage = SLN_ASR_LOCAL_Verify(p->addrGroup[0], (unsigned char **)&p->addrGroup[1], 1, MAX_COMMAND_FRAMES);
+
+    for (uint32_t region = 0; region < kAsrMemRegion_RamCount; region++)
+    {
+        snprintf(label, sizeof(label), "DSMT %s model (%s), pool %s (%d B)", name,
+                 SLN_ASR_MEM_BENCH_GetRegionName(SLN_ASR_MEM_BENCH_GetRegion(p->addrGroup[0])),
+                 SLN_ASR_MEM_BENCH_GetRegionName((sln_asr_mem_region_t)region), memUsage);
+
+        pool = SLN_ASR_MEM_BENCH_Alloc((sln_asr_mem_region_t)region, memUsage);
+        if (pool == NULL)
+        {
+            configPRINTF(("[MEMBENCH] %s: does not fit\r\n", label));
+            continue;
+        }
+
+        handler = SLN_ASR_LOCAL_Init(p->addrGroup[0], (unsigned char **)&p->addrGroup[1], 1, MAX_COMMAND_FRAMES, pool,
+                                     memUsage, &status);
+        if ((status == kAsrLocalSuccess) && (handler != NULL))
+        {
+            SLN_ASR_LOCAL_Set_CmdMapID(handler, &p->addrGroupMapID, 1);
+            SLN_ASR_MEM_BENCH_Run(label, asr_bench_process, handler, NULL);
+        }
+        else
+        {
+            configPRINTF(("[MEMBENCH] %s: init failed %d\r\n", label, status));
+        }
+
+        SLN_ASR_MEM_BENCH_FreeAll();
+    }
+}
+
+/*!
+ * @brief Measure the primary wake word engine and the commands engine with their pool in each RAM region.
+ *        The engines pools are used as scratch memory, the engines are initialized again after.
+ */
+static void asr_mem_bench(void)
+{
+    SLN_ASR_MEM_BENCH_Init();
+
+#if USE_DSMT_STATIC_POOLS
+    for (int i = 0; i < MAX_CONCURRENT_LANGUAGES; i++)
+    {
+        SLN_ASR_MEM_BENCH_AddArena(g_memPoolWw[i].pool_ptr, g_memPoolWw[i].pool_size);
+    }
+    SLN_ASR_MEM_BENCH_AddArena(g_memPoolCmd, sizeof(g_memPoolCmd));
+#endif /* USE_DSMT_STATIC_POOLS */
+
+    configPRINTF(("[MEMBENCH] DSMT built with wake word pools in %s, commands pool in %s\r\n",
+                  ASR_MEM_REGION_NAME(DSMT_WW_POOL_REGION), ASR_MEM_REGION_NAME(DSMT_CMD_POOL_REGION)));
+
+    asr_bench_engine("wake word", g_asrControl.infEngineWW);
+    asr_bench_engine("commands", g_asrControl.infEngineCMD);
+
+    SLN_ASR_MEM_BENCH_Init();
+
+    set_WW_engine(&g_asrControl);
+    set_inference_handler(g_asrControl.infEngineCMD);
 }
+#endif /* ASR_MEM_BENCH */
 
 void print_asr_session(int status)
 {
@@ -642,11 +797,24 @@ void print_asr_session(int status)
  */
 void local_voice_task(void *arg)
 {
-    int16_t pi16Sample[NUM_SAMPLES_AFE_OUTPUT];
+    audio_frame_t *asrFrame = NULL;
+    int16_t *pi16Sample     = NULL;
     uint32_t len            = 0;
     uint32_t statusFlash    = 0;
+    uint32_t frameStart     = 0;
     asr_events_t asrEvent   = ASR_SESSION_ENDED;
     struct asr_inference_engine *pInfWW;
+#if MULTILINGUAL
+    struct asr_inference_engine *pInfPrimaryWW;
+    bool shedWW = false;
+#if ENABLE_WW_SCHEDULER
+    uint32_t wwRunMask   = 0;
+    uint32_t wwResetMask = 0;
+    uint32_t wwEngine    = 0;
+    uint32_t wwStart     = 0;
+#endif /* ENABLE_WW_SCHEDULER */
+#endif /* MULTILINGUAL */
+    int wwStatus = kAsrLocalSuccess;
     struct asr_inference_engine *pInfCMD;
     char **cmdString;
 #if USE_DSMT_EVALUATION_MODE
@@ -711,6 +879,15 @@ void local_voice_task(void *arg)
 
     initialize_asr();
 
+#if ASR_MEM_BENCH
+    asr_mem_bench();
+#endif /* ASR_MEM_BENCH */
+
+#if MULTILINGUAL
+    /* Secondary language wake word engines are the first load dropped when ASR overruns */
+    AUDIO_DEADLINE_SetShedCallback(kAudioDeadlineAsr, asr_shed_load);
+#endif /* MULTILINGUAL */
+
     if (appAsrShellCommands.asrMode == ASR_MODE_CMD_ONLY)
     {
         asrEvent = ASR_SESSION_STARTED;
@@ -728,10 +905,21 @@ void local_voice_task(void *arg)
 
     while (1)
     {
-        if (xQueueReceive(g_xSampleQueue, pi16Sample, portMAX_DELAY) != pdPASS)
+        /* Hand the previous frame back to the pool before waiting for the next one */
+        AUDIO_FRAME_POOL_Release(asrFrame);
+        asrFrame = NULL;
+
+        if (xQueueReceive(g_xSampleQueue, &asrFrame, portMAX_DELAY) != pdPASS)
         {
             configPRINTF(("Could not receive from the queue\r\n"));
+            continue;
         }
+        pi16Sample = asrFrame->samples;
+        frameStart = AUDIO_PROFILER_GET_CYCLES();
+
+#if SLN_TRACE_LATENCY
+        asrFrame->latency.dequeueTs = AUDIO_LATENCY_GET_TIMESTAMP();
+#endif /* SLN_TRACE_LATENCY */
 
         // push-to-talk
         if ((g_SW1Pressed == true) && (asrEvent == ASR_SESSION_ENDED) && (appAsrShellCommands.asrMode == ASR_MODE_PTT))
@@ -770,10 +958,61 @@ void local_voice_task(void *arg)
         // continue listening to wake words in the selected languages. pInfWW is language specific.
         if ((asrEvent == ASR_SESSION_ENDED) && (appAsrShellCommands.asrMode != ASR_MODE_PTT))
         {
+#if MULTILINGUAL
+            pInfPrimaryWW = get_primary_WW_engine(&g_asrControl);
+
+            /* The skipped engines missed audio, restart them all from a clean state */
+            if (shedWW && !s_shedSecondaryWW)
+            {
+                reset_WW_engine(&g_asrControl);
+            }
+            shedWW = s_shedSecondaryWW;
+#if ENABLE_WW_SCHEDULER
+            /* The primary language always listens, the other ones only when the energy gate is open
+             * or when they fit in the budget. While ASR overruns its budget, only the primary one runs. */
+            wwRunMask = SLN_WW_SCHED_Plan(pi16Sample, NUM_SAMPLES_AFE_OUTPUT,
+                                          get_WW_engine_index(&g_asrControl, pInfPrimaryWW), shedWW, &wwResetMask);
+            wwEngine  = 0;
+#endif /* ENABLE_WW_SCHEDULER */
+#endif /* MULTILINGUAL */
             for (pInfWW = g_asrControl.infEngineWW; pInfWW != NULL; pInfWW = pInfWW->next)
             {
-                if (asr_process_audio_buffer(pInfWW->handler, pi16Sample, NUM_SAMPLES_AFE_OUTPUT,
-                                             pInfWW->iWhoAmI_inf) == kAsrLocalDetected)
+#if MULTILINGUAL
+#if ENABLE_WW_SCHEDULER
+                if ((wwRunMask & (1U << wwEngine)) == 0)
+                {
+                    wwEngine++;
+                    continue;
+                }
+
+                /* The engine skipped frames before the utterance, restart it from a clean state */
+                if (wwResetMask & (1U << wwEngine))
+                {
+                    reset_inference_handler(pInfWW);
+                }
+                wwStart = AUDIO_PROFILER_GET_CYCLES();
+#else
+                /* While ASR overruns its budget, only the primary language listens for the wake word */
+                if (shedWW && (pInfWW != pInfPrimaryWW))
+                {
+                    continue;
+                }
+#endif /* ENABLE_WW_SCHEDULER */
+#endif /* MULTILINGUAL */
+
+                wwStatus = asr_process_audio_buffer(pInfWW->handler, pi16Sample, NUM_SAMPLES_AFE_OUTPUT,
+                                                    pInfWW->iWhoAmI_inf);
+
+#if MULTILINGUAL && ENABLE_WW_SCHEDULER
+                SLN_WW_SCHED_Record(wwEngine, AUDIO_PROFILER_GET_CYCLES() - wwStart);
+                if (wwStatus == kAsrLocalDetected)
+                {
+                    SLN_WW_SCHED_Detected(wwEngine, g_asrControl.result.trustScore);
+                }
+                wwEngine++;
+#endif /* MULTILINGUAL && ENABLE_WW_SCHEDULER */
+
+                if (wwStatus == kAsrLocalDetected)
                 {
                     if (asr_get_string_by_id(pInfWW, g_asrControl.result.keywordID[0]) != NULL)
                     {
@@ -804,12 +1043,14 @@ void local_voice_task(void *arg)
 
                         reset_WW_engine(&g_asrControl);
 
+#if SLN_TRACE_LATENCY
+                        AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyWakeWord);
+#endif /* SLN_TRACE_LATENCY */
                         // Notify App Task Wake Word Detected
                         xTaskNotify(appTaskHandle, kWakeWordDetected, eSetBits);
                         break; // exit for loop
                     }          // end of if (asr_get_string_by_id(pInfWW, g_asrControl.keywordID[0]) != NULL)
-                } // end of if (asr_process_audio_buffer(pInfWW->handler, pi16Sample, NUM_SAMPLES_AFE_OUTPUT,
-                  // pInfWW->iWhoAmI_inf))
+                } // end of if (wwStatus == kAsrLocalDetected)
             }     // end of for (pInfWW = g_asrControl.infEngineWW; pInfWW != NULL; pInfWW = pInfWW->next)
         }         // end of if (asrEvent == ASR_SESSION_ENDED)
         // now we are getting into command detection. It must detect a command within the waiting time.
@@ -849,6 +1090,9 @@ void local_voice_task(void *arg)
                     oob_demo_control.language   = pInfCMD->iWhoAmI_lang;
                     oob_demo_control.commandSet = pInfCMD->iWhoAmI_inf;
                     oob_demo_control.commandId  = g_asrControl.result.keywordID[1];
+#if SLN_TRACE_LATENCY
+                    AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyCommand);
+#endif /* SLN_TRACE_LATENCY */
                     xTaskNotify(appTaskHandle, kVoiceCommandDetected, eSetBits);
 
                     if (asrEvent == ASR_SESSION_ENDED)
@@ -919,6 +1163,8 @@ void local_voice_task(void *arg)
             }
         }
 
+        AUDIO_DEADLINE_Check(kAudioDeadlineAsr, AUDIO_PROFILER_GET_CYCLES() - frameStart);
+
 #if USE_DSMT_EVALUATION_MODE
         /* DSMT lib is limited to 100 detections. When this limit is reached the board will not detect
          * any commands. Power reset the board to reset the counter.
@@ -26,6 +26,9 @@
 #include "sln_local_voice_s2i.h"
 #include "IndexCommands.h"
 #include "audio_processing_task.h"
+#include "audio_frame_pool.h"
+#include "audio_profiler.h"
+#include "audio_deadline.h"
 
 /* Used models */
 #include "VIT_Model_en_Hvac.h"
@@ -36,8 +39,10 @@
 #include "app_layer.h"
 
 #define NUMBER_OF_CHANNELS     1
-#define ASR_INPUT_FRAMES       3
-#define NUM_SAMPLES_AFE_OUTPUT (PCM_SINGLE_CH_SMPL_COUNT * ASR_INPUT_FRAMES)
+#define NUM_SAMPLES_AFE_OUTPUT AUDIO_FRAME_SAMPLE_COUNT
+#if (NUM_SAMPLES_AFE_OUTPUT != VIT_SAMPLES_PER_30MS_FRAME)
+#error "S2I supports only 30ms frames, check ASR_FRAME_MS"
+#endif /* NUM_SAMPLES_AFE_OUTPUT */
 #define DEVICE_ID VIT_IMXRT1060
 #define MEMORY_ALIGNMENT 8 // in bytes
 
@@ -249,7 +254,7 @@ static VIT_ReturnStatus_en VIT_Init(void)
     {
         /* Configure VIT Instance Parameters */
         VITInstParams.SampleRate_Hz   = VIT_SAMPLE_RATE;
-        VITInstParams.SamplesPerFrame = VIT_SAMPLES_PER_30MS_FRAME;
+        VITInstParams.SamplesPerFrame = NUM_SAMPLES_AFE_OUTPUT;
         VITInstParams.NumberOfChannel = NUMBER_OF_CHANNELS;
         VITInstParams.DeviceId        = DEVICE_ID;
         VITInstParams.APIVersion      = VIT_API_VERSION;
@@ -359,8 +364,11 @@ static VIT_ReturnStatus_en VIT_Init(void)
  */
 void local_voice_task(void *arg)
 {
-    int16_t pi16Sample[NUM_SAMPLES_AFE_OUTPUT];
+    audio_frame_t *asrFrame = NULL;
+    int16_t *pi16Sample     = NULL;
     uint32_t len            = 0;
+    uint32_t profStart      = 0;
+    uint32_t frameStart     = 0;
     uint32_t statusFlash    = 0;
     VIT_ReturnStatus_en VIT_Status;
     static VIT_WakeWord_st s_WakeWord;
@@ -428,10 +436,21 @@ void local_voice_task(void *arg)
 
     while (1)
     {
-        if (xQueueReceive(g_xSampleQueue, pi16Sample, portMAX_DELAY) != pdPASS)
+        /* Hand the previous frame back to the pool before waiting for the next one */
+        AUDIO_FRAME_POOL_Release(asrFrame);
+        asrFrame = NULL;
+
+        if (xQueueReceive(g_xSampleQueue, &asrFrame, portMAX_DELAY) != pdPASS)
         {
             configPRINTF(("Could not receive from the queue\r\n"));
+            continue;
         }
+        pi16Sample = asrFrame->samples;
+        frameStart = AUDIO_PROFILER_GET_CYCLES();
+
+#if SLN_TRACE_LATENCY
+        asrFrame->latency.dequeueTs = AUDIO_LATENCY_GET_TIMESTAMP();
+#endif /* SLN_TRACE_LATENCY */
 
         /* Push to talk */
         if ((g_SW1Pressed == true) && (s_asrSession == ASR_SESSION_WAKE_WORD) && (appAsrShellCommands.asrMode == ASR_MODE_PTT))
@@ -453,7 +472,9 @@ void local_voice_task(void *arg)
             oob_demo_control.skipWW = 0;
         }
 
+        profStart  = AUDIO_PROFILER_GET_CYCLES();
         VIT_Status = VIT_Process(VITHandle, pi16Sample, &VIT_DetectionResults);
+        AUDIO_PROFILER_STOP(kAudioProfilerAsr, profStart);
 
         if (VIT_Status != VIT_SUCCESS)
         {
@@ -486,6 +507,9 @@ void local_voice_task(void *arg)
                         asr_set_state(ASR_SESSION_INTENT);
                     }
 
+#if SLN_TRACE_LATENCY
+                    AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyWakeWord);
+#endif /* SLN_TRACE_LATENCY */
                     // Notify App Task Wake Word Detected
                     xTaskNotify(appTaskHandle, kWakeWordDetected, eSetBits);
                 }
@@ -528,6 +552,9 @@ void local_voice_task(void *arg)
                                 asr_set_state(ASR_SESSION_WAKE_WORD);
                             }
 
+#if SLN_TRACE_LATENCY
+                            AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyCommand);
+#endif /* SLN_TRACE_LATENCY */
                             xTaskNotify(appTaskHandle, kVoiceCommandDetected, eSetBits);
                         }
                         else
@@ -580,6 +607,8 @@ void local_voice_task(void *arg)
                 asr_set_state(ASR_SESSION_WAKE_WORD);
             }
         }
+
+        AUDIO_DEADLINE_Check(kAudioDeadlineAsr, AUDIO_PROFILER_GET_CYCLES() - frameStart);
     } // end of while
 }
 
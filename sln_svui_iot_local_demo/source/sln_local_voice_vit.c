@@ -6,10 +6,13 @@
 
 #if ENABLE_VIT_ASR
 
+#include <stdio.h>
+
 /* FreeRTOS includes */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
 
 /* Include file system */
 #include "sln_flash.h"
@@ -26,6 +29,14 @@
 #include "sln_local_voice_vit.h"
 #include "IndexCommands.h"
 #include "audio_processing_task.h"
+#include "audio_frame_pool.h"
+#include "audio_profiler.h"
+#include "audio_deadline.h"
+#include "sln_asr_mem_placement.h"
+#include "sln_heap.h"
+#if ASR_MEM_BENCH
+#include "sln_asr_mem_bench.h"
+#endif /* ASR_MEM_BENCH */
 
 /* VIT includes */
 #include "PL_platformTypes_CortexM.h"
@@ -35,8 +46,10 @@
 #include "app_layer.h"
 
 #define NUMBER_OF_CHANNELS     1
-#define ASR_INPUT_FRAMES       3
-#define NUM_SAMPLES_AFE_OUTPUT (PCM_SINGLE_CH_SMPL_COUNT * ASR_INPUT_FRAMES)
+#define NUM_SAMPLES_AFE_OUTPUT AUDIO_FRAME_SAMPLE_COUNT
+#if (NUM_SAMPLES_AFE_OUTPUT != VIT_SAMPLES_PER_10MS_FRAME) && (NUM_SAMPLES_AFE_OUTPUT != VIT_SAMPLES_PER_30MS_FRAME)
+#error "VIT supports only 10ms or 30ms frames, check ASR_FRAME_MS"
+#endif /* NUM_SAMPLES_AFE_OUTPUT */
 #define DEVICE_ID VIT_IMXRT1060
 #define MEMORY_ALIGNMENT 8 // in bytes
 
@@ -52,6 +65,13 @@
 #define SLOW_MEMORY_SIZE_BYTES  (151000)
 #define MODEL_MEMORY_SIZE_BYTES (450000)
 
+#if ENABLE_VIT_HOT_SWAP
+/* Task creating the VIT instance of a new model, below the ASR task so the active instance keeps up */
+#define VIT_PREPARE_TASK_NAME     "VIT_Prepare"
+#define VIT_PREPARE_TASK_STACK    1024
+#define VIT_PREPARE_TASK_PRIORITY (configMAX_PRIORITIES - 5)
+#endif /* ENABLE_VIT_HOT_SWAP */
+
 /*******************************************************************************
  * Variables
  ******************************************************************************/
@@ -72,6 +92,15 @@ app_asr_shell_commands_t appAsrShellCommands                      = {};
  */
 #define VIT_COMMAND_TIME_SPAN 8
 
+#if SELF_WAKE_UP_PROTECTION
+/* A wake word found in the microphones up to this long after the self wake up engine found it in
+ * the playback is the device waking itself up */
+#define SELF_WAKE_UP_WINDOW_MS  500
+/* The self wake up engine is released this long after the playback stopped, which covers the echo
+ * tail and the gaps between queued prompts */
+#define SELF_WAKE_UP_RELEASE_MS 2000
+#endif /* SELF_WAKE_UP_PROTECTION */
+
 typedef enum _asr_session
 {
     ASR_SESSION_STOPPED,
@@ -80,36 +109,96 @@ typedef enum _asr_session
 } asr_session_t;
 static asr_session_t s_asrSession = ASR_SESSION_STOPPED;
 
-static VIT_Handle_t VITHandle = PL_NULL;      // VIT handle pointer
+/* One VIT instance and the memory it was created in */
+typedef struct _vit_instance
+{
+    VIT_Handle_t handle;
+    PL_MemoryTable_st memoryTable; // VIT memory table descriptor, with the base addresses
+    int8_t *fastMemory;            // Fast regions
+    int8_t *slowMemory;            // Slow regions
+    uint32_t fastSize;             // Size of the fast regions buffer, when it is not taken from the heap
+    uint32_t slowSize;             // Size of the slow regions buffer, when it is not taken from the heap
+    bool heap;                     // Memory taken from the FreeRTOS heap when the instance is created
+} vit_instance_t;
+
+static VIT_Handle_t VITHandle = PL_NULL;      // VIT handle pointer, of the active instance
 static VIT_InstanceParams_st VITInstParams;   // VIT instance parameters structure
 static VIT_ControlParams_st VITControlParams; // VIT control parameters structure
-static PL_MemoryTable_st VITMemoryTable;      // VIT memory table descriptor
 static PL_BOOL InitPhase_Error = PL_FALSE;
-static PL_INT8 *pMemory[PL_NR_MEMORY_REGIONS];
-
-#if SELF_WAKE_UP_PROTECTION
-static VIT_Handle_t VITHandleSelfWake = PL_NULL; // VIT handle pointer for self wake up engine
-static PL_MemoryTable_st VITMemoryTableSelfWake;
-static PL_INT8 *pMemorySelfWake[PL_NR_MEMORY_REGIONS];
-#endif /* SELF_WAKE_UP_PROTECTION */
+static VIT_Model_Location_en s_vitModelLocation = VIT_MODEL_LOCATION; // Changed only by the memory benchmark
 
 VIT_StatusParams_st VIT_StatusParams_Buffer;
 
-static uint32_t s_vitFastMemoryUsed = 0;
-//AT_NONCACHEABLE_SECTION_ALIGN_DTC(static int8_t s_vitFastMemory[FAST_MEMORY_SIZE_BYTES], 8);
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_CACHEABLE"))) s_vitFastMemory[FAST_MEMORY_SIZE_BYTES], 8);
-static uint32_t s_vitSlowMemoryUsed = 0;
-//AT_CACHEABLE_SECTION_ALIGN_OCRAM(static int8_t s_vitSlowMemory[SLOW_MEMORY_SIZE_BYTES], 8);
-SDK_ALIGN(uint8_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE"))) s_vitSlowMemory[SLOW_MEMORY_SIZE_BYTES], 8);
+/* The regions of the pools come from the placement table, see sln_asr_mem_placement.h */
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(VIT_FAST_MEMORY_REGION) s_vitFastMemory[FAST_MEMORY_SIZE_BYTES], 8);
+SDK_ALIGN(uint8_t ASR_MEM_SECTION(VIT_SLOW_MEMORY_REGION) s_vitSlowMemory[SLOW_MEMORY_SIZE_BYTES], 8);
 //AT_CACHEABLE_SECTION_ALIGN_OCRAM(static int8_t s_vitModelMemory[MODEL_MEMORY_SIZE_BYTES], 64);
 
+/* Instance 0 lives in the static pools. Instance 1 only exists while a hot swap put the active
+ * model in the FreeRTOS heap, the next swap brings the model back to the static pools. */
+static vit_instance_t s_vitInstances[2] = {
+    {.fastMemory = (int8_t *)s_vitFastMemory,
+     .slowMemory = (int8_t *)s_vitSlowMemory,
+     .fastSize   = FAST_MEMORY_SIZE_BYTES,
+     .slowSize   = SLOW_MEMORY_SIZE_BYTES,
+     .heap       = false},
+    {.fastMemory = NULL, .slowMemory = NULL, .heap = true},
+};
+static uint32_t s_vitActive = 0;
+
 #if SELF_WAKE_UP_PROTECTION
-static uint32_t s_vitFastMemoryUsedSelfWake = 0;
-AT_NONCACHEABLE_SECTION_ALIGN_DTC(static int8_t s_vitFastMemorySelfWake[FAST_MEMORY_SIZE_BYTES], 8);
-static uint32_t s_vitSlowMemoryUsedSelfWake = 0;
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static int8_t s_vitSlowMemorySelfWake[SLOW_MEMORY_SIZE_BYTES], 8);
+/* The self wake up engine looks for the wake word in what the speaker plays. It only exists while
+ * the speaker plays, in the FreeRTOS heap, which it shares with the other transient users such as
+ * the hot swap instance. A model switch releases it first. */
+static vit_instance_t s_vitSelfWake = {.fastMemory = NULL, .slowMemory = NULL, .heap = true};
+static int16_t *s_selfWakeRef       = NULL;  // Reference of the frames, attached to the frame pool
+static uint32_t s_selfWakeIdleFrames = 0;    // Frames since the playback stopped
+static uint32_t s_selfWakeTick       = 0;    // Tick count of the last wake word found in the playback
+static bool s_selfWakeDetected       = false;
+static bool s_selfWakeFailed         = false; // Not created again before the next playback
 #endif /* SELF_WAKE_UP_PROTECTION */
 
+#if ENABLE_VIT_HOT_SWAP
+typedef enum _vit_prepare_state
+{
+    kVitPrepareIdle,
+    kVitPrepareRunning, // The new instance is created by the VIT_Prepare task
+    kVitPrepareReady,   // The new instance can replace the active one
+    kVitPrepareFailed,  // The new instance could not be created, VIT is reinitialized in place
+} vit_prepare_state_t;
+
+/* Serializes the VIT library calls of the ASR task and of the VIT_Prepare task */
+static SemaphoreHandle_t s_vitMutex = NULL;
+
+static volatile vit_prepare_state_t s_vitPrepareState = kVitPrepareIdle;
+static uint32_t s_vitPrepareIdx                       = 0;
+static uint8_t *s_vitPrepareModel                     = NULL;
+
+#define VIT_LOCK()                                          \
+    if (s_vitMutex != NULL)                                 \
+    {                                                       \
+        xSemaphoreTakeRecursive(s_vitMutex, portMAX_DELAY); \
+    }
+#define VIT_UNLOCK()                           \
+    if (s_vitMutex != NULL)                    \
+    {                                          \
+        xSemaphoreGiveRecursive(s_vitMutex);   \
+    }
+#else
+#define VIT_LOCK()
+#define VIT_UNLOCK()
+#endif /* ENABLE_VIT_HOT_SWAP */
+
+/* Cost of the last model switch, printed once the new model runs */
+typedef struct _vit_switch_stats
+{
+    uint32_t requestTick;      // Tick count when the switch was requested
+    uint32_t droppedAtRequest; // Frames dropped on the way to ASR since boot, when the switch was requested
+    uint32_t oldModelFrames;   // Frames processed by the old model while the new one was prepared
+} vit_switch_stats_t;
+
+static vit_switch_stats_t s_vitSwitch;
+
 typedef enum _cmd_state
 {
     kWwConfirmed,
@@ -170,9 +259,6 @@ static void asr_set_state(asr_session_t state)
         VITControlParams.Command_Time_Span = VIT_COMMAND_TIME_SPAN;
 
         VIT_Status = VIT_SetControlParameters(VITHandle, &VITControlParams);
-#if SELF_WAKE_UP_PROTECTION
-        VIT_Status = VIT_SetControlParameters(VITHandleSelfWake, &VITControlParams);
-#endif /* SELF_WAKE_UP_PROTECTION */
 
         if (VIT_Status != VIT_SUCCESS)
         {
@@ -181,45 +267,52 @@ static void asr_set_state(asr_session_t state)
     }
 }
 
+#if SELF_WAKE_UP_PROTECTION
+static void VIT_SelfWakeDestroy(void);
+#endif /* SELF_WAKE_UP_PROTECTION */
+
 static VIT_ReturnStatus_en VIT_Deinit()
 {
-    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
+    vit_instance_t *pInstance = &s_vitInstances[s_vitActive];
 
-    VIT_Status = VIT_GetMemoryTable(VITHandle, &VITMemoryTable, &VITInstParams);
+    VIT_LOCK();
 
-    if (VIT_Status != VIT_SUCCESS)
+    // Free the MEM tables
+    for (int i = 0; i < PL_NR_MEMORY_REGIONS; i++)
     {
-        configPRINTF(("VIT_GetMemoryTable error: %d\r\n", VIT_Status));
+        if ((pInstance->memoryTable.Region[i].Size != 0) && (pInstance->memoryTable.Region[i].pBaseAddress != NULL))
+        {
+            memset(pInstance->memoryTable.Region[i].pBaseAddress, 0, pInstance->memoryTable.Region[i].Size);
+            pInstance->memoryTable.Region[i].pBaseAddress = NULL;
+        }
     }
 
-    if (VIT_Status == VIT_SUCCESS)
-    {
-        // Free the MEM tables
-        for (int i = 0; i < PL_NR_MEMORY_REGIONS; i++)
-        {
-            if (VITMemoryTable.Region[i].Size != 0)
-            {
-                memset(pMemory[i], 0, VITMemoryTable.Region[i].Size);
-                pMemory[i] = NULL;
-            }
+    pInstance->handle = PL_NULL;
+    VITHandle         = PL_NULL;
 
-    #if SELF_WAKE_UP_PROTECTION
-            if (VITMemoryTableSelfWake.Region[i].Size != 0)
-            {
-                memset(pMemorySelfWake[i], 0, VITMemoryTableSelfWake.Region[i].Size);
-                pMemorySelfWake[i] = NULL;
-            }
-    #endif /* SELF_WAKE_UP_PROTECTION */
-        }
+#if SELF_WAKE_UP_PROTECTION
+    /* It runs the model of the instance */
+    VIT_SelfWakeDestroy();
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+    if (pInstance->heap)
+    {
+        vPortFree(pInstance->fastMemory);
+        vPortFree(pInstance->slowMemory);
+        pInstance->fastMemory = NULL;
+        pInstance->slowMemory = NULL;
     }
 
-    return VIT_Status;
+    VIT_UNLOCK();
+
+    return VIT_SUCCESS;
 }
 
-static VIT_ReturnStatus_en VIT_Init(void)
+/*!
+ * @brief Get the model of the active language and demo, or of the default demo if the demo has no model.
+ */
+static uint8_t *VIT_GetModel(void)
 {
-    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
-
     uint8_t *asrModelAddr = NULL;
 
     asrModelAddr = get_demo_model(appAsrShellCommands.activeLanguage, appAsrShellCommands.demo);
@@ -232,111 +325,217 @@ static VIT_ReturnStatus_en VIT_Init(void)
 
     if (asrModelAddr == NULL)
     {
-        configPRINTF(("VIT get model for %d failed. Pointer %p size %d for demo %d.\r\n", appAsrShellCommands.demo, asrModelAddr));
-        VIT_Status = VIT_DUMMY_ERROR;
+        configPRINTF(("VIT get model failed for language %d, demo %d.\r\n", appAsrShellCommands.activeLanguage,
+                      appAsrShellCommands.demo));
     }
 
-    if (VIT_SUCCESS == VIT_Status)
+    return asrModelAddr;
+}
+
+/*!
+ * @brief Register a model and get the memory table of an instance of it, with the offset of each
+ *        region in the fast or slow memory buffer and the size of both buffers.
+ */
+static VIT_ReturnStatus_en VIT_GetMemoryLayout(const uint8_t *asrModelAddr,
+                                               PL_MemoryTable_st *pTable,
+                                               uint32_t regionOffset[PL_NR_MEMORY_REGIONS],
+                                               uint32_t *fastMemoryUsed,
+                                               uint32_t *slowMemoryUsed)
+{
+    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
+
+    *fastMemoryUsed = 0;
+    *slowMemoryUsed = 0;
+
+    VIT_LOCK();
+
+    VIT_Status = VIT_SetModel((const PL_UINT8 *)asrModelAddr, s_vitModelLocation);
+    if (VIT_Status != VIT_SUCCESS)
     {
-        VIT_Status = VIT_SetModel((const PL_UINT8 *)asrModelAddr, VIT_MODEL_IN_SLOW_MEM);
-        if (VIT_Status != VIT_SUCCESS)
-        {
-            configPRINTF(("VIT_SetModel error: %d\r\n", VIT_Status));
-        }
+        configPRINTF(("VIT_SetModel error: %d\r\n", VIT_Status));
     }
 
     if (VIT_SUCCESS == VIT_Status)
     {
         /* Configure VIT Instance Parameters */
         VITInstParams.SampleRate_Hz   = VIT_SAMPLE_RATE;
-        VITInstParams.SamplesPerFrame = VIT_SAMPLES_PER_30MS_FRAME;
+        VITInstParams.SamplesPerFrame = NUM_SAMPLES_AFE_OUTPUT;
         VITInstParams.NumberOfChannel = NUMBER_OF_CHANNELS;
         VITInstParams.DeviceId        = DEVICE_ID;
         VITInstParams.APIVersion      = VIT_API_VERSION;
 
         /* VIT get memory table: Get size info per memory type */
         VIT_Status = VIT_GetMemoryTable(PL_NULL, // VITHandle param should be NULL
-                                        &VITMemoryTable, &VITInstParams);
+                                        pTable, &VITInstParams);
         if (VIT_Status != VIT_SUCCESS)
         {
             configPRINTF(("VIT_GetMemoryTable error: %d\r\n", VIT_Status));
         }
     }
 
+    VIT_UNLOCK();
+
     if (VIT_SUCCESS == VIT_Status)
     {
-        /* Reserve memory space: Malloc for each memory type */
-        s_vitSlowMemoryUsed = 0;
-        s_vitFastMemoryUsed = 0;
+        /* Split the memory per type */
         for (int i = 0; i < PL_NR_MEMORY_REGIONS; i++)
         {
-            /* Log the memory size */
-            if (VITMemoryTable.Region[i].Size != 0)
+            regionOffset[i] = 0;
+
+            if (pTable->Region[i].Size != 0)
             {
-                /* reserve memory space
-                   NB: VITMemoryTable.Region[PL_MEMREGION_PERSISTENT_FAST_DATA] should be allocated
-                   in the fastest memory of the platform (when possible) - this is not the case in this example.
-                 */
-                if (VITMemoryTable.Region[i].Type == PL_PERSISTENT_SLOW_DATA)
+                /* The fast and slow buffers regions are chosen in sln_asr_mem_placement.h */
+                if (pTable->Region[i].Type == PL_PERSISTENT_SLOW_DATA)
                 {
-                    pMemory[i] = (signed char *)&s_vitSlowMemory[s_vitSlowMemoryUsed];
-                    s_vitSlowMemoryUsed += VITMemoryTable.Region[i].Size;
-                    s_vitSlowMemoryUsed += MEMORY_ALIGNMENT - (s_vitSlowMemoryUsed % MEMORY_ALIGNMENT);
+                    regionOffset[i] = *slowMemoryUsed;
+                    *slowMemoryUsed += pTable->Region[i].Size;
+                    *slowMemoryUsed += MEMORY_ALIGNMENT - (*slowMemoryUsed % MEMORY_ALIGNMENT);
                 }
                 else
                 {
-                    pMemory[i] = (signed char *)&s_vitFastMemory[s_vitFastMemoryUsed];
-                    s_vitFastMemoryUsed += VITMemoryTable.Region[i].Size;
-                    s_vitFastMemoryUsed += MEMORY_ALIGNMENT - (s_vitFastMemoryUsed % MEMORY_ALIGNMENT);
+                    regionOffset[i] = *fastMemoryUsed;
+                    *fastMemoryUsed += pTable->Region[i].Size;
+                    *fastMemoryUsed += MEMORY_ALIGNMENT - (*fastMemoryUsed % MEMORY_ALIGNMENT);
                 }
-                VITMemoryTable.Region[i].pBaseAddress = (void *)pMemory[i];
             }
         }
+    }
+
+    return VIT_Status;
+}
+
+/*!
+ * @brief Create a VIT instance for a model, in the memory of pInstance. The VIT library calls are
+ *        made with the VIT lock taken, so the instance can be created while another one processes audio.
+ */
+static VIT_ReturnStatus_en VIT_CreateInstance(vit_instance_t *pInstance, const uint8_t *asrModelAddr)
+{
+    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
+    PL_MemoryTable_st *pTable      = &pInstance->memoryTable;
+    uint32_t fastMemoryUsed        = 0;
+    uint32_t slowMemoryUsed        = 0;
+    uint32_t regionOffset[PL_NR_MEMORY_REGIONS];
+
+    VIT_Status = VIT_GetMemoryLayout(asrModelAddr, pTable, regionOffset, &fastMemoryUsed, &slowMemoryUsed);
 
-        if (s_vitSlowMemoryUsed > SLOW_MEMORY_SIZE_BYTES)
+    if (VIT_SUCCESS == VIT_Status)
+    {
+        if (pInstance->heap)
         {
-            configPRINTF(("VIT slow memory buffer is too small %d < %d.\r\n", SLOW_MEMORY_SIZE_BYTES, s_vitSlowMemoryUsed));
-            vTaskDelay(100);
-            while (1)
-                ;
+            /* pvPortMalloc returns portBYTE_ALIGNMENT aligned blocks, enough for MEMORY_ALIGNMENT */
+            pInstance->fastMemory = SLN_HEAP_TryAlloc(fastMemoryUsed);
+            pInstance->slowMemory = (pInstance->fastMemory != NULL) ? SLN_HEAP_TryAlloc(slowMemoryUsed) : NULL;
+
+            if ((pInstance->fastMemory == NULL) || (pInstance->slowMemory == NULL))
+            {
+                configPRINTF(("No heap for a VIT instance, %d + %d bytes.\r\n", fastMemoryUsed, slowMemoryUsed));
+                vPortFree(pInstance->fastMemory);
+                vPortFree(pInstance->slowMemory);
+                pInstance->fastMemory = NULL;
+                pInstance->slowMemory = NULL;
+                VIT_Status            = VIT_INVALID_NULLADDRESS;
+            }
         }
-        if (s_vitFastMemoryUsed > FAST_MEMORY_SIZE_BYTES)
+        else
         {
-            configPRINTF(("VIT fast memory buffer is too small %d < %d.\r\n", FAST_MEMORY_SIZE_BYTES, s_vitFastMemoryUsed));
-            vTaskDelay(100);
-            while (1)
-                ;
+            if (slowMemoryUsed > pInstance->slowSize)
+            {
+                configPRINTF(("VIT slow memory buffer is too small %d < %d.\r\n", pInstance->slowSize, slowMemoryUsed));
+                vTaskDelay(100);
+                while (1)
+                    ;
+            }
+            if (fastMemoryUsed > pInstance->fastSize)
+            {
+                configPRINTF(("VIT fast memory buffer is too small %d < %d.\r\n", pInstance->fastSize, fastMemoryUsed));
+                vTaskDelay(100);
+                while (1)
+                    ;
+            }
         }
     }
 
     if (VIT_SUCCESS == VIT_Status)
     {
-        /* Create VIT Instance */
-        VITHandle  = PL_NULL; // force to null address for correct memory initialization
-        VIT_Status = VIT_GetInstanceHandle(&VITHandle, &VITMemoryTable, &VITInstParams);
+        /* Reserve memory space for each memory type */
+        for (int i = 0; i < PL_NR_MEMORY_REGIONS; i++)
+        {
+            if (pTable->Region[i].Size != 0)
+            {
+                if (pTable->Region[i].Type == PL_PERSISTENT_SLOW_DATA)
+                {
+                    pTable->Region[i].pBaseAddress = (void *)&pInstance->slowMemory[regionOffset[i]];
+                }
+                else
+                {
+                    pTable->Region[i].pBaseAddress = (void *)&pInstance->fastMemory[regionOffset[i]];
+                }
+
+                memset(pTable->Region[i].pBaseAddress, 0, pTable->Region[i].Size);
+            }
+        }
+
+        VIT_LOCK();
+
+        /* Create VIT Instance, with the model registered by VIT_SetModel. The instance keeps
+         * its model, the active instance is not affected by the registration of a new one. */
+        pInstance->handle = PL_NULL; // force to null address for correct memory initialization
+        VIT_Status        = VIT_GetInstanceHandle(&pInstance->handle, pTable, &VITInstParams);
         if (VIT_Status != VIT_SUCCESS)
         {
             InitPhase_Error = PL_TRUE;
             configPRINTF(("VIT_GetInstanceHandle error: %d\r\n", VIT_Status));
         }
+
+        /* Test the reset (OPTIONAL) */
+        if (VIT_SUCCESS == VIT_Status)
+        {
+            VIT_Status = VIT_ResetInstance(pInstance->handle);
+            if (VIT_Status != VIT_SUCCESS)
+            {
+                InitPhase_Error = PL_TRUE;
+                configPRINTF(("VIT_ResetInstance error: %d\r\n", VIT_Status));
+            }
+        }
+
+        VIT_UNLOCK();
+
+        if ((VIT_Status != VIT_SUCCESS) && pInstance->heap)
+        {
+            vPortFree(pInstance->fastMemory);
+            vPortFree(pInstance->slowMemory);
+            pInstance->fastMemory = NULL;
+            pInstance->slowMemory = NULL;
+        }
+    }
+
+    return VIT_Status;
+}
+
+/*!
+ * @brief Create the VIT instance of the active language and demo in the static pools and start it.
+ */
+static VIT_ReturnStatus_en VIT_Init(void)
+{
+    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
+    uint8_t *asrModelAddr          = NULL;
+
+    asrModelAddr = VIT_GetModel();
+    if (asrModelAddr == NULL)
+    {
+        VIT_Status = VIT_DUMMY_ERROR;
     }
 
-    /* Test the reset (OPTIONAL) */
     if (VIT_SUCCESS == VIT_Status)
     {
-        VIT_Status = VIT_ResetInstance(VITHandle);
-        if (VIT_Status != VIT_SUCCESS)
-        {
-            InitPhase_Error = PL_TRUE;
-            configPRINTF(("VIT_ResetInstance error: %d\r\n", VIT_Status));
-        }
+        VIT_Status = VIT_CreateInstance(&s_vitInstances[0], asrModelAddr);
     }
-#if SELF_WAKE_UP_PROTECTION
+
     if (VIT_SUCCESS == VIT_Status)
     {
-        VIT_Status = initialize_asr_self_wake_up();
+        s_vitActive = 0;
+        VITHandle   = s_vitInstances[0].handle;
     }
-#endif /* SELF_WAKE_UP_PROTECTION */
 
     if (VIT_SUCCESS == VIT_Status)
     {
@@ -354,13 +553,359 @@ static VIT_ReturnStatus_en VIT_Init(void)
     return VIT_Status;
 }
 
+#if ASR_MEM_BENCH
+static int32_t VIT_BenchProcess(void *arg, int16_t *samples)
+{
+    VIT_DetectionStatus_en detection = VIT_NO_DETECTION;
+
+    return (int32_t)VIT_Process((VIT_Handle_t)arg, samples, &detection);
+}
+
+/*!
+ * @brief Measure the wake word processing of the active model with its fast and slow memory in each
+ *        RAM region, for both model locations. Must run before VIT_Init, the static pools are used as
+ *        scratch memory. The model itself is always read from the flash (XIP).
+ */
+static void VIT_MemBench(void)
+{
+    static const VIT_Model_Location_en locations[] = {VIT_MODEL_IN_SLOW_MEM, VIT_MODEL_IN_FAST_MEM};
+    vit_instance_t bench;
+    VIT_ControlParams_st benchParams;
+    PL_MemoryTable_st table;
+    uint32_t regionOffset[PL_NR_MEMORY_REGIONS];
+    uint32_t fastMemoryUsed = 0;
+    uint32_t slowMemoryUsed = 0;
+    PL_BOOL initPhaseError  = InitPhase_Error;
+    uint8_t *asrModelAddr   = VIT_GetModel();
+    char label[80];
+
+    if (asrModelAddr == NULL)
+    {
+        return;
+    }
+
+    SLN_ASR_MEM_BENCH_Init();
+    SLN_ASR_MEM_BENCH_AddArena(s_vitFastMemory, sizeof(s_vitFastMemory));
+    SLN_ASR_MEM_BENCH_AddArena(s_vitSlowMemory, sizeof(s_vitSlowMemory));
+
+    configPRINTF(("[MEMBENCH] VIT built with fast memory in %s, slow memory in %s, model as %s\r\n",
+                  ASR_MEM_REGION_NAME(VIT_FAST_MEMORY_REGION), ASR_MEM_REGION_NAME(VIT_SLOW_MEMORY_REGION),
+                  (VIT_MODEL_LOCATION == VIT_MODEL_IN_FAST_MEM) ? "fast memory" : "slow memory"));
+
+    for (uint32_t loc = 0; loc < ARRAY_SIZE(locations); loc++)
+    {
+        s_vitModelLocation = locations[loc];
+        if (VIT_GetMemoryLayout(asrModelAddr, &table, regionOffset, &fastMemoryUsed, &slowMemoryUsed) != VIT_SUCCESS)
+        {
+            continue;
+        }
+
+        for (uint32_t fastRegion = 0; fastRegion < kAsrMemRegion_RamCount; fastRegion++)
+        {
+            for (uint32_t slowRegion = 0; slowRegion < kAsrMemRegion_RamCount; slowRegion++)
+            {
+                snprintf(label, sizeof(label), "VIT model as %s memory (%s), fast %s (%d B), slow %s (%d B)",
+                         (locations[loc] == VIT_MODEL_IN_FAST_MEM) ? "fast" : "slow",
+                         SLN_ASR_MEM_BENCH_GetRegionName(SLN_ASR_MEM_BENCH_GetRegion(asrModelAddr)),
+                         SLN_ASR_MEM_BENCH_GetRegionName((sln_asr_mem_region_t)fastRegion), fastMemoryUsed,
+                         SLN_ASR_MEM_BENCH_GetRegionName((sln_asr_mem_region_t)slowRegion), slowMemoryUsed);
+
+                memset(&bench, 0, sizeof(bench));
+                bench.fastMemory = SLN_ASR_MEM_BENCH_Alloc((sln_asr_mem_region_t)fastRegion, fastMemoryUsed);
+                bench.slowMemory = SLN_ASR_MEM_BENCH_Alloc((sln_asr_mem_region_t)slowRegion, slowMemoryUsed);
+                bench.fastSize   = fastMemoryUsed;
+                bench.slowSize   = slowMemoryUsed;
+
+                if ((bench.fastMemory == NULL) || (bench.slowMemory == NULL))
+                {
+                    configPRINTF(("[MEMBENCH] %s: does not fit\r\n", label));
+                }
+                else if (VIT_CreateInstance(&bench, asrModelAddr) == VIT_SUCCESS)
+                {
+                    /* The wake word phase is the one running most of the time */
+                    benchParams.OperatingMode     = VIT_OPERATING_MODE_WW;
+                    benchParams.Feature_LowRes    = PL_FALSE;
+                    benchParams.Command_Time_Span = VIT_COMMAND_TIME_SPAN;
+
+                    if (VIT_SetControlParameters(bench.handle, &benchParams) == VIT_SUCCESS)
+                    {
+                        SLN_ASR_MEM_BENCH_Run(label, VIT_BenchProcess, bench.handle, NULL);
+                    }
+                }
+
+                SLN_ASR_MEM_BENCH_FreeAll();
+            }
+        }
+    }
+
+    /* The errors of the placements under test do not concern the instance created next */
+    s_vitModelLocation = VIT_MODEL_LOCATION;
+    InitPhase_Error    = initPhaseError;
+
+    SLN_ASR_MEM_BENCH_Init();
+}
+#endif /* ASR_MEM_BENCH */
+
+/*!
+ * @brief Print the cost of the model switch which just completed.
+ */
+static void VIT_PrintSwitchStats(bool hotSwap, uint32_t stallCycles)
+{
+    configPRINTF(("[ASR] VIT model switched %s in %d ms: ASR stalled %d us, %d frames dropped, "
+                  "%d frames processed by the old model meanwhile\r\n",
+                  hotSwap ? "by hot swap" : "in place",
+                  (xTaskGetTickCount() - s_vitSwitch.requestTick) * portTICK_PERIOD_MS,
+                  (uint32_t)(((uint64_t)stallCycles * 1000000U) / SystemCoreClock),
+                  audio_processing_get_dropped_frames() - s_vitSwitch.droppedAtRequest,
+                  s_vitSwitch.oldModelFrames));
+}
+
+/*!
+ * @brief Reinitialize VIT in place with the active language and demo. No audio is processed meanwhile.
+ */
+static void VIT_Reinit(void)
+{
+    uint32_t stallStart = AUDIO_PROFILER_GET_CYCLES();
+
+    VIT_Deinit();
+    VIT_Init();
+
+    oob_demo_control.language = appAsrShellCommands.activeLanguage;
+    xTaskNotify(appTaskHandle, kAsrModelChanged, eSetBits);
+
+    VIT_PrintSwitchStats(false, AUDIO_PROFILER_GET_CYCLES() - stallStart);
+}
+
+#if ENABLE_VIT_HOT_SWAP
+/*!
+ * @brief Create the new VIT instance while the active one keeps processing audio.
+ */
+static void VIT_PrepareTask(void *arg)
+{
+    VIT_ReturnStatus_en VIT_Status = VIT_SUCCESS;
+
+    VIT_Status = VIT_CreateInstance(&s_vitInstances[s_vitPrepareIdx], s_vitPrepareModel);
+
+    s_vitPrepareState = (VIT_Status == VIT_SUCCESS) ? kVitPrepareReady : kVitPrepareFailed;
+
+    vTaskDelete(NULL);
+}
+
+/*!
+ * @brief Start to prepare the instance of the new language or demo in the memory the active instance does not use.
+ */
+static void VIT_PrepareInstance(void)
+{
+    s_vitPrepareIdx   = (s_vitActive == 0) ? 1 : 0;
+    s_vitPrepareModel = VIT_GetModel();
+    s_vitPrepareState = kVitPrepareRunning;
+
+    if ((s_vitPrepareModel == NULL) || (xTaskCreate(VIT_PrepareTask, VIT_PREPARE_TASK_NAME, VIT_PREPARE_TASK_STACK,
+                                                    NULL, VIT_PREPARE_TASK_PRIORITY, NULL) != pdPASS))
+    {
+        s_vitPrepareState = kVitPrepareFailed;
+    }
+}
+
+/*!
+ * @brief Replace the active instance by the prepared one, at a frame boundary. If the new instance could
+ *        not be prepared, VIT is reinitialized in place as without hot swap.
+ */
+static void VIT_SwapInstance(void)
+{
+    uint32_t stallStart   = AUDIO_PROFILER_GET_CYCLES();
+    vit_instance_t *pOld  = &s_vitInstances[s_vitActive];
+
+    if (s_vitPrepareState == kVitPrepareReady)
+    {
+        s_vitActive = s_vitPrepareIdx;
+        VITHandle   = s_vitInstances[s_vitActive].handle;
+
+        /* The old instance is dropped, its memory is cleared when it is reused */
+        pOld->handle = PL_NULL;
+        if (pOld->heap)
+        {
+            vPortFree(pOld->fastMemory);
+            vPortFree(pOld->slowMemory);
+            pOld->fastMemory = NULL;
+            pOld->slowMemory = NULL;
+        }
+
+        /* Set and Apply VIT control parameters */
+        if (appAsrShellCommands.asrMode == ASR_MODE_CMD_ONLY)
+        {
+            asr_set_state(ASR_SESSION_VOICE_COMMAND);
+        }
+        else
+        {
+            asr_set_state(ASR_SESSION_WAKE_WORD);
+        }
+
+        oob_demo_control.language = appAsrShellCommands.activeLanguage;
+        xTaskNotify(appTaskHandle, kAsrModelChanged, eSetBits);
+
+        VIT_PrintSwitchStats(true, AUDIO_PROFILER_GET_CYCLES() - stallStart);
+    }
+    else
+    {
+        VIT_Reinit();
+    }
+
+    s_vitPrepareState = kVitPrepareIdle;
+}
+#endif /* ENABLE_VIT_HOT_SWAP */
+
+#if SELF_WAKE_UP_PROTECTION
+/*!
+ * @brief Release the self wake up engine and the frames reference, the heap gets back to the single engine usage.
+ */
+static void VIT_SelfWakeDestroy(void)
+{
+    if (s_selfWakeRef != NULL)
+    {
+        AUDIO_FRAME_POOL_AttachRef(NULL);
+        vPortFree(s_selfWakeRef);
+        s_selfWakeRef = NULL;
+    }
+
+    if (s_vitSelfWake.handle != PL_NULL)
+    {
+        configPRINTF(("[ASR] Self wake up engine released\r\n"));
+    }
+
+    s_vitSelfWake.handle = PL_NULL;
+    vPortFree(s_vitSelfWake.fastMemory);
+    vPortFree(s_vitSelfWake.slowMemory);
+    s_vitSelfWake.fastMemory = NULL;
+    s_vitSelfWake.slowMemory = NULL;
+
+    s_selfWakeDetected = false;
+}
+
+/*!
+ * @brief Create the self wake up engine with the active model, in wake word mode only.
+ */
+static void VIT_SelfWakeCreate(void)
+{
+    VIT_ReturnStatus_en VIT_Status = VIT_DUMMY_ERROR;
+    VIT_ControlParams_st selfWakeParams;
+    uint8_t *asrModelAddr = VIT_GetModel();
+    uint32_t createStart  = AUDIO_PROFILER_GET_CYCLES();
+
+    if (asrModelAddr != NULL)
+    {
+        VIT_Status = VIT_CreateInstance(&s_vitSelfWake, asrModelAddr);
+    }
+
+    if (VIT_SUCCESS == VIT_Status)
+    {
+        selfWakeParams.OperatingMode     = VIT_OPERATING_MODE_WW;
+        selfWakeParams.Feature_LowRes    = PL_FALSE;
+        selfWakeParams.Command_Time_Span = VIT_COMMAND_TIME_SPAN;
+
+        VIT_Status = VIT_SetControlParameters(s_vitSelfWake.handle, &selfWakeParams);
+    }
+
+    if (VIT_SUCCESS == VIT_Status)
+    {
+        s_selfWakeRef = SLN_HEAP_TryAlloc(AUDIO_FRAME_POOL_REF_SIZE);
+        if (s_selfWakeRef != NULL)
+        {
+            AUDIO_FRAME_POOL_AttachRef(s_selfWakeRef);
+        }
+        else
+        {
+            VIT_Status = VIT_INVALID_NULLADDRESS;
+        }
+    }
+
+    if (VIT_SUCCESS == VIT_Status)
+    {
+        configPRINTF(("[ASR] Self wake up engine created in %d us\r\n",
+                      (uint32_t)(((uint64_t)(AUDIO_PROFILER_GET_CYCLES() - createStart) * 1000000U) / SystemCoreClock)));
+    }
+    else
+    {
+        VIT_SelfWakeDestroy();
+        s_selfWakeFailed = true;
+        configPRINTF(("[ASR] Self wake up engine not created (%d), the wake words are not filtered during this playback\r\n",
+                      VIT_Status));
+    }
+}
+
+/*!
+ * @brief Create the self wake up engine when the speaker starts to play and release it once it stopped,
+ *        then run it on the reference of the frame while waiting for the wake word.
+ */
+static void VIT_SelfWakeProcess(audio_frame_t *frame)
+{
+    VIT_DetectionStatus_en detection = VIT_NO_DETECTION;
+    int16_t *ref                     = NULL;
+
+    if (SLN_AMP_GetState() != kSlnAmpIdle)
+    {
+        s_selfWakeIdleFrames = 0;
+
+        /* Not during a hot swap, the model registration of the new instance must not be disturbed */
+        if ((s_vitSelfWake.handle == PL_NULL) && !s_selfWakeFailed
+#if ENABLE_VIT_HOT_SWAP
+            && (s_vitPrepareState == kVitPrepareIdle)
+#endif /* ENABLE_VIT_HOT_SWAP */
+        )
+        {
+            VIT_SelfWakeCreate();
+        }
+    }
+    else
+    {
+        s_selfWakeFailed = false;
+
+        if ((s_vitSelfWake.handle != PL_NULL) &&
+            (++s_selfWakeIdleFrames >= (SELF_WAKE_UP_RELEASE_MS / ASR_FRAME_MS)))
+        {
+            VIT_SelfWakeDestroy();
+        }
+    }
+
+    if ((s_vitSelfWake.handle != PL_NULL) && (s_asrSession == ASR_SESSION_WAKE_WORD))
+    {
+        ref = AUDIO_FRAME_POOL_GetRef(frame);
+    }
+
+    if (ref != NULL)
+    {
+        if ((VIT_Process(s_vitSelfWake.handle, ref, &detection) == VIT_SUCCESS) && (detection == VIT_WW_DETECTED))
+        {
+            s_selfWakeDetected = true;
+            s_selfWakeTick     = xTaskGetTickCount();
+        }
+    }
+}
+
+/*!
+ * @brief Check whether the wake word just found by the main engine was played by the speaker.
+ */
+static bool VIT_IsSelfWakeUp(void)
+{
+    bool selfWake = s_selfWakeDetected &&
+                    ((xTaskGetTickCount() - s_selfWakeTick) <= pdMS_TO_TICKS(SELF_WAKE_UP_WINDOW_MS));
+
+    s_selfWakeDetected = false;
+
+    return selfWake;
+}
+#endif /* SELF_WAKE_UP_PROTECTION */
+
 /*!
  * @brief ASR main task
  */
 void local_voice_task(void *arg)
 {
-    int16_t pi16Sample[NUM_SAMPLES_AFE_OUTPUT];
+    audio_frame_t *asrFrame = NULL;
+    int16_t *pi16Sample     = NULL;
     uint32_t len            = 0;
+    uint32_t profStart      = 0;
+    uint32_t frameStart     = 0;
     uint32_t statusFlash    = 0;
     VIT_ReturnStatus_en VIT_Status;
     static VIT_WakeWord_st s_WakeWord;
@@ -418,6 +963,18 @@ void local_voice_task(void *arg)
         }
     }
 
+#if ENABLE_VIT_HOT_SWAP
+    s_vitMutex = xSemaphoreCreateRecursiveMutex();
+    if (s_vitMutex == NULL)
+    {
+        configPRINTF(("Failed to create s_vitMutex\r\n"));
+    }
+#endif /* ENABLE_VIT_HOT_SWAP */
+
+#if ASR_MEM_BENCH
+    VIT_MemBench();
+#endif /* ASR_MEM_BENCH */
+
     VIT_Init();
 
     // We need to reset asrCfg state so we won't remember an unprocessed demo change that was saved in flash
@@ -428,10 +985,35 @@ void local_voice_task(void *arg)
 
     while (1)
     {
-        if (xQueueReceive(g_xSampleQueue, pi16Sample, portMAX_DELAY) != pdPASS)
+        /* Hand the previous frame back to the pool before waiting for the next one */
+        AUDIO_FRAME_POOL_Release(asrFrame);
+        asrFrame = NULL;
+
+        if (xQueueReceive(g_xSampleQueue, &asrFrame, portMAX_DELAY) != pdPASS)
         {
             configPRINTF(("Could not receive from the queue\r\n"));
+            continue;
         }
+        pi16Sample = asrFrame->samples;
+        frameStart = AUDIO_PROFILER_GET_CYCLES();
+
+#if SLN_TRACE_LATENCY
+        asrFrame->latency.dequeueTs = AUDIO_LATENCY_GET_TIMESTAMP();
+#endif /* SLN_TRACE_LATENCY */
+
+        VIT_LOCK();
+
+#if ENABLE_VIT_HOT_SWAP
+        /* The new model takes over at a frame boundary, the old one processed all the frames before */
+        if ((s_vitPrepareState == kVitPrepareReady) || (s_vitPrepareState == kVitPrepareFailed))
+        {
+            VIT_SwapInstance();
+        }
+        else if (s_vitPrepareState == kVitPrepareRunning)
+        {
+            s_vitSwitch.oldModelFrames++;
+        }
+#endif /* ENABLE_VIT_HOT_SWAP */
 
         /* Push to talk */
         if ((g_SW1Pressed == true) && (s_asrSession == ASR_SESSION_WAKE_WORD) && (appAsrShellCommands.asrMode == ASR_MODE_PTT))
@@ -453,7 +1035,14 @@ void local_voice_task(void *arg)
             oob_demo_control.skipWW = 0;
         }
 
+#if SELF_WAKE_UP_PROTECTION
+        /* First, so a wake word played in this frame is known when the main engine finds it */
+        VIT_SelfWakeProcess(asrFrame);
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+        profStart  = AUDIO_PROFILER_GET_CYCLES();
         VIT_Status = VIT_Process(VITHandle, pi16Sample, &VIT_DetectionResults);
+        AUDIO_PROFILER_STOP(kAudioProfilerAsr, profStart);
 
         if (VIT_Status != VIT_SUCCESS)
         {
@@ -469,6 +1058,13 @@ void local_voice_task(void *arg)
                 {
                     configPRINTF(("VIT_GetWakeWordFound error: %d\r\n", VIT_Status));
                 }
+#if SELF_WAKE_UP_PROTECTION
+                else if ((s_WakeWord.Id > 0) && VIT_IsSelfWakeUp())
+                {
+                    configPRINTF(("[ASR] Wake Word played by the speaker ignored: %s(%d)\r\n",
+                                  (s_WakeWord.pName == PL_NULL) ? "UNDEF" : s_WakeWord.pName, s_WakeWord.Id));
+                }
+#endif /* SELF_WAKE_UP_PROTECTION */
                 else if (s_WakeWord.Id > 0)
                 {
                     g_wakeWordLength = s_WakeWord.StartOffset;
@@ -485,6 +1081,9 @@ void local_voice_task(void *arg)
                         asr_set_state(ASR_SESSION_VOICE_COMMAND);
                     }
 
+#if SLN_TRACE_LATENCY
+                    AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyWakeWord);
+#endif /* SLN_TRACE_LATENCY */
                     // Notify App Task Wake Word Detected
                     xTaskNotify(appTaskHandle, kWakeWordDetected, eSetBits);
                 }
@@ -525,6 +1124,9 @@ void local_voice_task(void *arg)
                             asr_set_state(ASR_SESSION_WAKE_WORD);
                         }
 
+#if SLN_TRACE_LATENCY
+                        AUDIO_LATENCY_DetectionNotified(&asrFrame->latency, kAudioLatencyCommand);
+#endif /* SLN_TRACE_LATENCY */
                         xTaskNotify(appTaskHandle, kVoiceCommandDetected, eSetBits);
                     }
                     else
@@ -554,12 +1156,27 @@ void local_voice_task(void *arg)
         // reinitialize the ASR engine if language set was changed
         if (appAsrShellCommands.asrCfg & (ASR_CFG_DEMO_LANGUAGE_CHANGED | ASR_CFG_CMD_INFERENCE_ENGINE_CHANGED))
         {
-            VIT_Deinit();
-            VIT_Init();
-            appAsrShellCommands.asrCfg &= ~(ASR_CFG_DEMO_LANGUAGE_CHANGED | ASR_CFG_CMD_INFERENCE_ENGINE_CHANGED);
-            oob_demo_control.language   = appAsrShellCommands.activeLanguage;
+#if ENABLE_VIT_HOT_SWAP
+            /* A change requested while a model is prepared is handled once that model was swapped in */
+            if (s_vitPrepareState == kVitPrepareIdle)
+#endif /* ENABLE_VIT_HOT_SWAP */
+            {
+                appAsrShellCommands.asrCfg &= ~(ASR_CFG_DEMO_LANGUAGE_CHANGED | ASR_CFG_CMD_INFERENCE_ENGINE_CHANGED);
 
-            xTaskNotify(appTaskHandle, kAsrModelChanged, eSetBits);
+                s_vitSwitch.requestTick      = xTaskGetTickCount();
+                s_vitSwitch.droppedAtRequest = audio_processing_get_dropped_frames();
+                s_vitSwitch.oldModelFrames   = 0;
+
+#if ENABLE_VIT_HOT_SWAP
+#if SELF_WAKE_UP_PROTECTION
+                /* The new instance gets the heap, the self wake up engine is created again once it runs */
+                VIT_SelfWakeDestroy();
+#endif /* SELF_WAKE_UP_PROTECTION */
+                VIT_PrepareInstance();
+#else
+                VIT_Reinit();
+#endif /* ENABLE_VIT_HOT_SWAP */
+            }
         }
 
         if (appAsrShellCommands.asrCfg & ASR_CFG_MODE_CHANGED)
@@ -575,6 +1192,10 @@ void local_voice_task(void *arg)
                 asr_set_state(ASR_SESSION_WAKE_WORD);
             }
         }
+
+        VIT_UNLOCK();
+
+        AUDIO_DEADLINE_Check(kAudioDeadlineAsr, AUDIO_PROFILER_GET_CYCLES() - frameStart);
     } // end of while
 }
 
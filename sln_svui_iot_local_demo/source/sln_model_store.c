@@ -0,0 +1,178 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if ENABLE_MODEL_STORE
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "sln_flash.h"
+#include "sln_model_store.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+typedef enum _model_store_state
+{
+    kModelStoreState_Unchecked = 0, /* CRC not computed yet */
+    kModelStoreState_Valid,
+    kModelStoreState_Corrupted,
+} model_store_state_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* Copy of the index, the container itself stays in flash */
+static sln_model_store_entry_t s_index[MODEL_STORE_MAX_ENTRIES];
+static model_store_state_t s_state[MODEL_STORE_MAX_ENTRIES];
+static uint32_t s_entryCount = 0;
+
+static const uint8_t *s_container = NULL;
+
+/* Taken while a model CRC is checked, the ASR task and the VIT prepare task may look up models */
+static SemaphoreHandle_t s_storeMutex = NULL;
+
+/* CRC-32 of a nibble, polynomial 0xEDB88320 */
+static const uint32_t s_crcNibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _crc32(const uint8_t *data, uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t idx = 0; idx < length; idx++)
+    {
+        crc ^= data[idx];
+        crc = (crc >> 4U) ^ s_crcNibble[crc & 0xFU];
+        crc = (crc >> 4U) ^ s_crcNibble[crc & 0xFU];
+    }
+
+    return crc ^ 0xFFFFFFFFU;
+}
+
+status_t SLN_MODEL_STORE_Init(void)
+{
+    sln_model_store_header_t header;
+    const sln_model_store_entry_t *entry = NULL;
+    uint32_t indexSize                   = 0;
+
+    s_entryCount = 0;
+    memset(s_index, 0, sizeof(s_index));
+    memset(s_state, 0, sizeof(s_state));
+
+    if (s_storeMutex == NULL)
+    {
+        s_storeMutex = xSemaphoreCreateMutex();
+        if (s_storeMutex == NULL)
+        {
+            configPRINTF(("Failed to create s_storeMutex\r\n"));
+            return kStatus_Fail;
+        }
+    }
+
+    s_container = (const uint8_t *)SLN_Flash_Get_Read_Address(MODEL_STORE_ADDR);
+    memcpy(&header, s_container, sizeof(header));
+
+    if (header.magic != MODEL_STORE_MAGIC)
+    {
+        configPRINTF(("Model store empty, using the built-in models\r\n"));
+        return kStatus_NoData;
+    }
+
+    indexSize = header.entryCount * sizeof(sln_model_store_entry_t);
+
+    if ((header.version != MODEL_STORE_VERSION) || (header.entryCount > MODEL_STORE_MAX_ENTRIES) ||
+        (header.totalSize > MODEL_STORE_SIZE) || ((sizeof(header) + indexSize) > header.totalSize) ||
+        (_crc32(&s_container[sizeof(header)], indexSize) != header.indexCrc))
+    {
+        configPRINTF(("Model store index invalid, using the built-in models\r\n"));
+        return kStatus_Fail;
+    }
+
+    memcpy(s_index, &s_container[sizeof(header)], indexSize);
+
+    for (uint32_t idx = 0; idx < header.entryCount; idx++)
+    {
+        entry = &s_index[idx];
+
+        /* Out of the container or misaligned for VIT, the entry is never used */
+        if ((entry->offset < (sizeof(header) + indexSize)) || (entry->offset > header.totalSize) ||
+            (entry->size > (header.totalSize - entry->offset)) || ((entry->offset % MODEL_STORE_ALIGN_BYTES) != 0))
+        {
+            s_state[idx] = kModelStoreState_Corrupted;
+        }
+
+        configPRINTF(("Model store %d: engine %d, languages 0x%x, demos 0x%x, %d bytes, version 0x%x%s\r\n", idx,
+                      entry->engine, entry->languageMask, entry->demoMask, entry->size, entry->modelVersion,
+                      (s_state[idx] == kModelStoreState_Corrupted) ? ", out of bounds" : ""));
+    }
+
+    s_entryCount = header.entryCount;
+
+    return kStatus_Success;
+}
+
+const void *SLN_MODEL_STORE_Find(sln_model_store_engine_t engine, uint32_t language, uint32_t demo)
+{
+    const void *model                    = NULL;
+    const sln_model_store_entry_t *entry = NULL;
+
+    if ((s_entryCount == 0) || (language == 0) || (demo == 0))
+    {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_storeMutex, portMAX_DELAY);
+
+    /* The first valid entry wins, a container may list a demo model before the language pack */
+    for (uint32_t idx = 0; (idx < s_entryCount) && (model == NULL); idx++)
+    {
+        entry = &s_index[idx];
+
+        if ((entry->engine != engine) || ((entry->languageMask & language) != language) ||
+            ((entry->demoMask & demo) != demo))
+        {
+            continue;
+        }
+
+        if (s_state[idx] == kModelStoreState_Unchecked)
+        {
+            if (_crc32(&s_container[entry->offset], entry->size) == entry->crc)
+            {
+                s_state[idx] = kModelStoreState_Valid;
+            }
+            else
+            {
+                s_state[idx] = kModelStoreState_Corrupted;
+                configPRINTF(("Model store %d: CRC mismatch, entry skipped\r\n", idx));
+            }
+        }
+
+        if (s_state[idx] == kModelStoreState_Valid)
+        {
+            model = &s_container[entry->offset];
+        }
+    }
+
+    xSemaphoreGive(s_storeMutex);
+
+    return model;
+}
+
+#endif /* ENABLE_MODEL_STORE */
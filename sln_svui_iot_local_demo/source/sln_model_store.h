@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_MODEL_STORE_H_
+#define _SLN_MODEL_STORE_H_
+
+#if ENABLE_MODEL_STORE
+
+#include "stdint.h"
+
+#include "fsl_common.h"
+#include "fica_definition.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Flash region of the model container, by default the flash left free after the file system.
+ * The models are read in place through the FlexSPI AMBA (XIP) window. */
+#ifndef MODEL_STORE_ADDR
+#define MODEL_STORE_ADDR (FICA_FREE_MEM_START_ADDR)
+#endif /* MODEL_STORE_ADDR */
+
+#ifndef MODEL_STORE_SIZE
+#define MODEL_STORE_SIZE (FICA_FREE_MEM_END_ADDR - MODEL_STORE_ADDR)
+#endif /* MODEL_STORE_SIZE */
+
+#if (MODEL_STORE_ADDR < FICA_FREE_MEM_START_ADDR) || ((MODEL_STORE_ADDR + MODEL_STORE_SIZE) > FICA_FREE_MEM_END_ADDR)
+#error "The model store must be placed between FICA_FREE_MEM_START_ADDR and FICA_FREE_MEM_END_ADDR"
+#endif
+
+/* Models the index can hold */
+#ifndef MODEL_STORE_MAX_ENTRIES
+#define MODEL_STORE_MAX_ENTRIES 16U
+#endif /* MODEL_STORE_MAX_ENTRIES */
+
+/* Container format
+ *
+ * The container starts at MODEL_STORE_ADDR, all the fields are little endian:
+ *   sln_model_store_header_t
+ *   sln_model_store_entry_t[entryCount]   the index
+ *   model data                            each model at an offset multiple of MODEL_STORE_ALIGN_BYTES
+ *
+ * indexCrc covers the index, an entry crc covers its model data. Both are the standard CRC-32
+ * (polynomial 0xEDB88320 reflected, initial value and final xor 0xFFFFFFFF), the one of zlib crc32().
+ * An erased or invalid container is ignored and the models linked in the application are used. */
+#define MODEL_STORE_MAGIC         (0x4C444F4DU) /* "MODL" */
+#define MODEL_STORE_VERSION       (1U)
+#define MODEL_STORE_ALIGN_BYTES   (64U)         /* VIT_MODEL_ALIGN_BYTES */
+#define MODEL_STORE_ALL_DEMOS     (0xFFFFFFFFU) /* demoMask of a model serving all the demos of a language */
+
+/*! @brief Engine a model is built for */
+typedef enum _sln_model_store_engine
+{
+    kModelStoreEngine_None = 0,
+    kModelStoreEngine_Vit  = 1,
+    kModelStoreEngine_Dsmt = 2,
+    kModelStoreEngine_S2i  = 3,
+} sln_model_store_engine_t;
+
+/*! @brief Container header */
+typedef struct __attribute__((packed)) _sln_model_store_header
+{
+    uint32_t magic;      /*!< MODEL_STORE_MAGIC */
+    uint16_t version;    /*!< MODEL_STORE_VERSION */
+    uint16_t entryCount; /*!< Entries of the index, up to MODEL_STORE_MAX_ENTRIES */
+    uint32_t totalSize;  /*!< Bytes of the container, header included */
+    uint32_t indexCrc;   /*!< CRC-32 of the index */
+} sln_model_store_header_t;
+
+/*! @brief Index entry, one per model */
+typedef struct __attribute__((packed)) _sln_model_store_entry
+{
+    uint8_t engine;         /*!< sln_model_store_engine_t */
+    uint8_t reserved[3];    /*!< 0 */
+    uint32_t languageMask;  /*!< asr_language_t bits the model serves */
+    uint32_t demoMask;      /*!< asr_inference_t bits the model serves, MODEL_STORE_ALL_DEMOS for a language pack */
+    uint32_t offset;        /*!< Offset of the model from the container start */
+    uint32_t size;          /*!< Bytes of the model */
+    uint32_t crc;           /*!< CRC-32 of the model */
+    uint32_t modelVersion;  /*!< Free for the model tools, printed at boot */
+} sln_model_store_entry_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Read and check the index of the model container. The models themselves are checked
+ *        the first time they are looked up.
+ *
+ * @return kStatus_Success if a valid container was found, kStatus_NoData if the region holds no
+ *         container, kStatus_Fail if the container is corrupted.
+ */
+status_t SLN_MODEL_STORE_Init(void);
+
+/*!
+ * @brief Look up the model of a language and a demo in the container.
+ *        The CRC of the model is checked on the first lookup, a corrupted model is never returned.
+ *
+ * @param engine   Engine the model must be built for
+ * @param language One asr_language_t bit
+ * @param demo     One asr_inference_t bit
+ * @return XIP address of the model, or NULL if the container has no valid model for them
+ */
+const void *SLN_MODEL_STORE_Find(sln_model_store_engine_t engine, uint32_t language, uint32_t demo);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ENABLE_MODEL_STORE */
+#endif /* _SLN_MODEL_STORE_H_ */
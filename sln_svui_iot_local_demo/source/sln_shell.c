@@ -26,6 +26,25 @@
 #include "audio_processing_task.h"
 #endif /* ENABLE_VAD */
 
+#include "audio_profiler.h"
+#include "audio_deadline.h"
+#if ENABLE_AEC_CALIBRATION
+#include "audio_aec_calib.h"
+#include "sln_amplifier.h"
+#endif /* ENABLE_AEC_CALIBRATION */
+#if ENABLE_AEC && USE_MQS
+#include "sln_amplifier_processing.h"
+#endif /* ENABLE_AEC && USE_MQS */
+#if ENABLE_STREAMER_CACHE
+#include "sln_streamer_cache.h"
+#endif /* ENABLE_STREAMER_CACHE */
+#if ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER
+#include "sln_ww_scheduler.h"
+#endif /* ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER */
+#if SLN_TRACE_LATENCY
+#include "audio_latency.h"
+#endif /* SLN_TRACE_LATENCY */
+
 #if ENABLE_WIFI
 #include "wifi_connection.h"
 #include "wifi_credentials.h"
@@ -50,6 +69,11 @@
 /* A longer argv string size, string terminator included */
 #define MAX_ARGV_LONG_STR_SIZE 100
 
+#if SLN_TRACE_LATENCY
+/* Bytes printed on each line of the latency export */
+#define LATENCY_EXPORT_BYTES_PER_LINE 32
+#endif /* SLN_TRACE_LATENCY */
+
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
@@ -94,6 +118,13 @@ static shell_status_t sln_wifi_handler(shell_handle_t shellHandle, int32_t argc,
 #if ENABLE_AEC
 static shell_status_t sln_aecmode_handler(shell_handle_t shellHandle, int32_t argc, char **argv);
 #endif /* ENABLE_AEC */
+#if SLN_TRACE_LATENCY
+static shell_status_t sln_latency_handler(shell_handle_t shellHandle, int32_t argc, char **argv);
+#endif /* SLN_TRACE_LATENCY */
+static shell_status_t sln_pipestat_handler(shell_handle_t shellHandle, int32_t argc, char **argv);
+#if ENABLE_STREAMER_CACHE
+static shell_status_t sln_promptcache_handler(shell_handle_t shellHandle, int32_t argc, char **argv);
+#endif /* ENABLE_STREAMER_CACHE */
 
 /*******************************************************************************
  * Variables
@@ -262,19 +293,74 @@ SHELL_COMMAND_DEFINE(wifi,
 #endif /* ENABLE_WIFI */
 
 #if ENABLE_AEC
+#if ENABLE_AEC_CALIBRATION
+#define AECMODE_CALIBRATION_HELP                                                           \
+    "            calibrate to play the AEC alignment sound, measure the loopback delay\r\n" \
+    "                      and save it in flash memory. Keep the room quiet.\r\n"          \
+    "            calreset to erase the measured loopback delay and use the default one\r\n"
+#else
+#define AECMODE_CALIBRATION_HELP ""
+#endif /* ENABLE_AEC_CALIBRATION */
+
 SHELL_COMMAND_DEFINE(aecmode,
-                     "\r\n\"aecmode\": Set the aecmode to true or false. \r\n"
+                     "\r\n\"aecmode\": Set the aecmode to on, off or auto. \r\n"
                      "                 This setting can only be changed at runtime and it is not persistent,\r\n"
-                     "                 after reboot aecmode will be true again.\r\n"
+                     "                 after reboot aecmode will be auto (AEC_AUTO_BYPASS) or on again.\r\n"
                      "         Usage:\r\n"
-                     "            aecmode on (or off) \r\n"
+                     "            aecmode on (or off or auto) \r\n"
                      "            when called without parameters, it will display the status of aecmode\r\n"
                      "         Parameters\r\n"
-                     "            on or off\r\n",
+                     "            on, off, or auto to run AEC only while the speaker is not silent\r\n"
+                     AECMODE_CALIBRATION_HELP,
                      sln_aecmode_handler,
                      SHELL_IGNORE_PARAMETER_COUNT);
 #endif /* ENABLE_AEC */
 
+#if SLN_TRACE_LATENCY
+SHELL_COMMAND_DEFINE(latency,
+                     "\r\n\"latency\": Print the wake word and command latency measured from the mics to the application.\r\n"
+                     "         Usage:\r\n"
+                     "            latency [reset / export]\r\n"
+                     "            when called without parameters, it will print the latency of each stage\r\n"
+                     "         Parameters\r\n"
+                     "            reset: clear the statistics\r\n"
+                     "            export: dump the statistics in binary form, as hex lines\r\n",
+                     sln_latency_handler,
+                     SHELL_IGNORE_PARAMETER_COUNT);
+
+static const char *const s_latencyStageNames[kAudioLatencyStageCount] = {
+    "capture->AFE", "AFE->ASR", "ASR process", "detection->action", "capture->action"};
+#endif /* SLN_TRACE_LATENCY */
+
+SHELL_COMMAND_DEFINE(pipestat,
+                     "\r\n\"pipestat\": Print the processing time of each audio pipeline stage.\r\n"
+                     "         Usage:\r\n"
+                     "            pipestat [reset]\r\n"
+                     "            when called without parameters, it will print min, avg, p99 and max over the\r\n"
+                     "            last runs of each stage, the peak since the last reset, the real-time\r\n"
+                     "            deadlines missed and the context of the last misses\r\n"
+#if ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER
+                     "            followed by the wake word scheduler counters: gate, detection latency,\r\n"
+                     "            gate misses and the frames run or skipped by each language\r\n"
+#endif /* ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER */
+                     "         Parameters\r\n"
+                     "            reset: clear the statistics\r\n",
+                     sln_pipestat_handler,
+                     SHELL_IGNORE_PARAMETER_COUNT);
+
+#if ENABLE_STREAMER_CACHE
+SHELL_COMMAND_DEFINE(promptcache,
+                     "\r\n\"promptcache\": Print the usage of the decoded prompts cache.\r\n"
+                     "         Usage:\r\n"
+                     "            promptcache [flush]\r\n"
+                     "            when called without parameters, it will print the hits, misses, evictions\r\n"
+                     "            and the memory used by the cached prompts\r\n"
+                     "         Parameters\r\n"
+                     "            flush: drop the cached prompts\r\n",
+                     sln_promptcache_handler,
+                     SHELL_IGNORE_PARAMETER_COUNT);
+#endif /* ENABLE_STREAMER_CACHE */
+
 extern app_asr_shell_commands_t appAsrShellCommands;
 extern TaskHandle_t appTaskHandle;
 
@@ -952,10 +1038,7 @@ static void sln_playprompt_cmd_action(void)
     else if (statusFlash == SLN_FLASH_FS_OK)
     {
         /* Make sure that speaker is not currently playing another audio. */
-        while (LOCAL_SOUNDS_isPlaying())
-        {
-            vTaskDelay(10);
-        }
+        LOCAL_SOUNDS_WaitForIdle(UINT32_MAX);
 
 #if ENABLE_VAD
         audio_processing_force_vad_event();
@@ -1670,6 +1753,15 @@ static shell_status_t sln_stacksview_handler(shell_handle_t shellHandle, int32_t
 static void sln_aecmode_cmd_action(void)
 {
     char *str;
+    uint32_t runBlocks   = 0;
+    uint32_t gatedBlocks = 0;
+#if ENABLE_AEC_CALIBRATION
+    status_t status      = kStatus_Success;
+    uint32_t delayUs     = 0;
+#endif /* ENABLE_AEC_CALIBRATION */
+#if USE_MQS
+    sln_amp_ref_drift_stats_t driftStats;
+#endif /* USE_MQS */
 
     if (s_argc > 2)
     {
@@ -1681,14 +1773,31 @@ static void sln_aecmode_cmd_action(void)
     {
         if (s_argc == 1)
         {
-            if (audio_processing_get_bypass_aec() == false)
+            if (audio_processing_get_bypass_aec() == true)
             {
-                SHELL_Printf(s_shellHandle, "AEC mode set to on.\r\n");
+                SHELL_Printf(s_shellHandle, "AEC mode set to off.\r\n");
+            }
+            else if (audio_processing_get_auto_bypass_aec() == true)
+            {
+                SHELL_Printf(s_shellHandle, "AEC mode set to auto.\r\n");
             }
             else
             {
-                SHELL_Printf(s_shellHandle, "AEC mode set to off.\r\n");
+                SHELL_Printf(s_shellHandle, "AEC mode set to on.\r\n");
             }
+
+            audio_processing_get_aec_block_counts(&runBlocks, &gatedBlocks);
+            SHELL_Printf(s_shellHandle, "During playback AEC ran on %d blocks and was bypassed on %d silent blocks.\r\n",
+                         runBlocks, gatedBlocks);
+#if ENABLE_AEC_CALIBRATION
+            SHELL_Printf(s_shellHandle, "Loopback delay is %d us.\r\n", SLN_AMP_GetLoopbackDelayUs());
+#endif /* ENABLE_AEC_CALIBRATION */
+#if USE_MQS
+            SLN_AMP_GetRefDriftStats(&driftStats);
+            SHELL_Printf(s_shellHandle, "Speaker to mics clock drift is %d ppm, measured over %d s%s.\r\n",
+                         (int)driftStats.ppm, driftStats.windows, driftStats.tracking ? ", tracking" : "");
+            SHELL_Printf(s_shellHandle, "Reference alignment error is %d us.\r\n", (int)driftStats.alignErrorUs);
+#endif /* USE_MQS */
         }
         else
         {
@@ -1696,6 +1805,7 @@ static void sln_aecmode_cmd_action(void)
 
             if (strcmp(str, "on") == 0)
             {
+                audio_processing_set_auto_bypass_aec(false);
                 audio_processing_set_bypass_aec(false);
                 SHELL_Printf(s_shellHandle, "Setting AEC mode to on.\r\n");
             }
@@ -1704,6 +1814,48 @@ static void sln_aecmode_cmd_action(void)
                 audio_processing_set_bypass_aec(true);
                 SHELL_Printf(s_shellHandle, "Setting AEC mode to off.\r\n");
             }
+            else if (strcmp(str, "auto") == 0)
+            {
+                audio_processing_set_auto_bypass_aec(true);
+                audio_processing_set_bypass_aec(false);
+                SHELL_Printf(s_shellHandle, "Setting AEC mode to auto.\r\n");
+            }
+#if ENABLE_AEC_CALIBRATION
+            else if (strcmp(str, "calibrate") == 0)
+            {
+                /* Make sure that speaker is not currently playing another audio. */
+                LOCAL_SOUNDS_WaitForIdle(UINT32_MAX);
+
+#if ENABLE_VAD
+                audio_processing_force_vad_event();
+#endif /* ENABLE_VAD */
+
+                SHELL_Printf(s_shellHandle, "Calibrating the AEC loopback delay, keep the room quiet.\r\n");
+                status = AUDIO_AEC_CALIB_Run(&delayUs);
+                SLN_AMP_SetVolume(appAsrShellCommands.volume);
+
+                if (status == kStatus_Success)
+                {
+                    SHELL_Printf(s_shellHandle, "Loopback delay set to %d us and saved in flash memory.\r\n", delayUs);
+                }
+                else
+                {
+                    SHELL_Printf(s_shellHandle, "AEC calibration failed %d, loopback delay is %d us.\r\n", status,
+                                 SLN_AMP_GetLoopbackDelayUs());
+                }
+            }
+            else if (strcmp(str, "calreset") == 0)
+            {
+                if (AUDIO_AEC_CALIB_Reset() == kStatus_Success)
+                {
+                    SHELL_Printf(s_shellHandle, "Loopback delay set back to %d us.\r\n", SLN_AMP_GetLoopbackDelayUs());
+                }
+                else
+                {
+                    SHELL_Printf(s_shellHandle, "Failed to erase the AEC calibration.\r\n");
+                }
+            }
+#endif /* ENABLE_AEC_CALIBRATION */
             else
             {
                 SHELL_Printf(s_shellHandle, "Invalid input.\r\n");
@@ -1728,6 +1880,334 @@ static shell_status_t sln_aecmode_handler(shell_handle_t shellHandle, int32_t ar
 }
 #endif /* ENABLE_AEC */
 
+#if SLN_TRACE_LATENCY
+
+/* latency command */
+/*******************/
+static void sln_latency_print(audio_latency_stats_t *stats)
+{
+    audio_latency_hist_t *hist = NULL;
+
+    SHELL_Printf(s_shellHandle, "\r\nLatency of %d wake words and %d commands (%d not measured)\r\n",
+                 stats->detections[kAudioLatencyWakeWord], stats->detections[kAudioLatencyCommand], stats->missed);
+    SHELL_Printf(s_shellHandle, "%-18s %8s %8s %8s %8s [us]\r\n", "stage", "last", "min", "avg", "max");
+
+    for (uint32_t stage = 0; stage < kAudioLatencyStageCount; stage++)
+    {
+        hist = &stats->hist[stage];
+        SHELL_Printf(s_shellHandle, "%-18s %8d %8d %8d %8d\r\n", s_latencyStageNames[stage], stats->lastUs[stage],
+                     hist->minUs, (hist->count > 0) ? (hist->sumUs / hist->count) : 0, hist->maxUs);
+    }
+
+    for (uint32_t stage = 0; stage < kAudioLatencyStageCount; stage++)
+    {
+        hist = &stats->hist[stage];
+        SHELL_Printf(s_shellHandle, "\r\n%s histogram:\r\n", s_latencyStageNames[stage]);
+
+        for (uint32_t bin = 0; bin < AUDIO_LATENCY_BIN_COUNT; bin++)
+        {
+            if (hist->bins[bin] > 0)
+            {
+                SHELL_Printf(s_shellHandle, "  >= %8d us: %d\r\n", (bin == 0) ? 0 : (1U << bin), hist->bins[bin]);
+            }
+        }
+    }
+}
+
+static void sln_latency_export(audio_latency_stats_t *stats)
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char line[(2 * LATENCY_EXPORT_BYTES_PER_LINE) + 1];
+    uint8_t *data = (uint8_t *)stats;
+    uint32_t pos  = 0;
+
+    SHELL_Printf(s_shellHandle, "\r\nLATENCY BEGIN %d\r\n", (int)sizeof(audio_latency_stats_t));
+
+    for (uint32_t idx = 0; idx < sizeof(audio_latency_stats_t); idx++)
+    {
+        line[pos++] = hexDigits[data[idx] >> 4];
+        line[pos++] = hexDigits[data[idx] & 0x0F];
+
+        if ((pos == (2 * LATENCY_EXPORT_BYTES_PER_LINE)) || ((idx + 1) == sizeof(audio_latency_stats_t)))
+        {
+            line[pos] = '\0';
+            SHELL_Printf(s_shellHandle, "%s\r\n", line);
+            pos = 0;
+        }
+    }
+
+    SHELL_Printf(s_shellHandle, "LATENCY END\r\n");
+}
+
+static void sln_latency_cmd_action(void)
+{
+    audio_latency_stats_t *stats = NULL;
+
+    if (s_argc > 2)
+    {
+        SHELL_Printf(
+            s_shellHandle,
+            "\r\nIncorrect command parameter(s). Enter \"help\" to view a list of available commands.\r\n\r\n");
+    }
+    else if ((s_argc == 2) && (strcmp(s_argv[1], "reset") == 0))
+    {
+        AUDIO_LATENCY_Reset();
+        SHELL_Printf(s_shellHandle, "Latency statistics cleared.\r\n");
+    }
+    else if ((s_argc == 1) || (strcmp(s_argv[1], "export") == 0))
+    {
+        stats = pvPortMalloc(sizeof(audio_latency_stats_t));
+        if (stats != NULL)
+        {
+            AUDIO_LATENCY_GetStats(stats);
+
+            if (s_argc == 1)
+            {
+                sln_latency_print(stats);
+            }
+            else
+            {
+                sln_latency_export(stats);
+            }
+
+            vPortFree(stats);
+        }
+        else
+        {
+            SHELL_Printf(s_shellHandle, "%s: No memory for latency statistics\r\n", __func__);
+        }
+    }
+    else
+    {
+        SHELL_Printf(s_shellHandle, "Invalid input.\r\n");
+    }
+}
+
+static shell_status_t sln_latency_handler(shell_handle_t shellHandle, int32_t argc, char **argv)
+{
+    s_argc = argc;
+    if (argc > 1)
+    {
+        strncpy(s_argv[1], argv[1], MAX_ARGV_STR_SIZE);
+    }
+
+#if ENABLE_USB_SHELL
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xEventGroupSetBitsFromISR(s_ShellEventGroup, LATENCY_EVT, &xHigherPriorityTaskWoken);
+#elif ENABLE_UART_SHELL
+    sln_latency_cmd_action();
+#endif /* ENABLE_USB_SHELL */
+
+    return kStatus_SHELL_Success;
+}
+#endif /* SLN_TRACE_LATENCY */
+
+/* pipestat command */
+/********************/
+static uint32_t sln_pipestat_cycles_to_us(uint32_t cycles)
+{
+    /* SystemCoreClock follows the VAD clock reduction */
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+}
+
+static void sln_pipestat_print_deadlines(void)
+{
+    audio_deadline_stats_t stats;
+    audio_deadline_miss_t *log = NULL;
+    uint32_t count             = 0;
+
+    SHELL_Printf(s_shellHandle, "\r\n%-16s %10s %8s %8s %8s %s\r\n", "deadline", "runs", "missed", "budget", "worst",
+                 "load shedding");
+
+    for (uint32_t stage = 0; stage < kAudioDeadlineStageCount; stage++)
+    {
+        AUDIO_DEADLINE_GetStats((audio_deadline_stage_t)stage, &stats);
+        SHELL_Printf(s_shellHandle, "%-16s %10d %8d %8d %8d %s (%d times)\r\n",
+                     AUDIO_DEADLINE_GetStageName((audio_deadline_stage_t)stage), stats.runs, stats.misses,
+                     stats.budgetUs, stats.worstUs, stats.shedding ? "on" : "off", stats.sheds);
+    }
+
+    log = pvPortMalloc(AUDIO_DEADLINE_MISS_LOG_SIZE * sizeof(audio_deadline_miss_t));
+    if (log == NULL)
+    {
+        SHELL_Printf(s_shellHandle, "%s: No memory for the missed deadlines\r\n", __func__);
+        return;
+    }
+
+    count = AUDIO_DEADLINE_GetMissLog(log, AUDIO_DEADLINE_MISS_LOG_SIZE);
+    if (count > 0)
+    {
+        SHELL_Printf(s_shellHandle, "\r\nLast missed deadlines, newest first [us]:\r\n");
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            SHELL_Printf(s_shellHandle,
+                         "  tick %d %s run %d: %d/%d, task %s prio %d stack %d, %d MHz, %d free frames%s\r\n",
+                         log[idx].tick, AUDIO_DEADLINE_GetStageName((audio_deadline_stage_t)log[idx].stage),
+                         log[idx].run, log[idx].elapsedUs, log[idx].budgetUs, log[idx].taskName, log[idx].priority,
+                         log[idx].stackFree, log[idx].coreMhz, log[idx].freeFrames,
+                         log[idx].shedding ? ", shedding" : "");
+        }
+    }
+
+    vPortFree(log);
+}
+
+#if ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER
+static void sln_pipestat_print_ww_scheduler(void)
+{
+    sln_ww_sched_stats_t *stats = NULL;
+
+    stats = pvPortMalloc(sizeof(sln_ww_sched_stats_t));
+    if (stats == NULL)
+    {
+        SHELL_Printf(s_shellHandle, "%s: No memory for the wake word scheduler statistics\r\n", __func__);
+        return;
+    }
+
+    SLN_WW_SCHED_GetStats(stats);
+
+    SHELL_Printf(s_shellHandle, "\r\nWake word scheduler%s, budget %d us, noise floor %d, gate %s\r\n",
+                 stats->shadow ? " (shadow mode)" : "", WW_SCHED_BUDGET_US, stats->noiseFloor,
+                 stats->gateOpen ? "open" : "closed");
+    SHELL_Printf(s_shellHandle, "  frames %d, gate open %d (%d times), shed %d\r\n", stats->frames,
+                 stats->gateFrames, stats->gateOpens, stats->shedFrames);
+    SHELL_Printf(s_shellHandle, "  detections %d, gate missed %d, latency from gate avg %d ms max %d ms\r\n",
+                 stats->detections, stats->ungated, stats->latencyAvgMs, stats->latencyMaxMs);
+    SHELL_Printf(s_shellHandle, "%-8s %10s %10s %8s %6s %8s %6s\r\n", "engine", "runs", "skips", "cost us", "dets",
+                 "missed", "trust");
+
+    for (uint32_t idx = 0; idx < stats->engineCount; idx++)
+    {
+        SHELL_Printf(s_shellHandle, "%d%-7s %10d %10d %8d %6d %8d %6d\r\n", idx,
+                     (idx == stats->primary) ? " (p)" : "", stats->engines[idx].runs, stats->engines[idx].skips,
+                     stats->engines[idx].costUs, stats->engines[idx].detections, stats->engines[idx].misses,
+                     stats->engines[idx].lastTrust);
+    }
+
+    vPortFree(stats);
+}
+#endif /* ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER */
+
+static void sln_pipestat_cmd_action(void)
+{
+    audio_profiler_stats_t stats;
+
+    if (s_argc > 2)
+    {
+        SHELL_Printf(
+            s_shellHandle,
+            "\r\nIncorrect command parameter(s). Enter \"help\" to view a list of available commands.\r\n\r\n");
+    }
+    else if ((s_argc == 2) && (strcmp(s_argv[1], "reset") == 0))
+    {
+        AUDIO_PROFILER_Reset();
+        AUDIO_DEADLINE_Reset();
+#if ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER
+        SLN_WW_SCHED_ResetStats();
+#endif /* ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER */
+        SHELL_Printf(s_shellHandle, "Pipeline statistics cleared.\r\n");
+    }
+    else if (s_argc == 1)
+    {
+        SHELL_Printf(s_shellHandle, "\r\nCore clock %d MHz, window of %d runs\r\n", SystemCoreClock / 1000000U,
+                     AUDIO_PROFILER_WINDOW);
+        SHELL_Printf(s_shellHandle, "%-16s %10s %8s %8s %8s %8s %8s [us]\r\n", "stage", "runs", "min", "avg", "p99",
+                     "max", "peak");
+
+        for (uint32_t stage = 0; stage < kAudioProfilerStageCount; stage++)
+        {
+            AUDIO_PROFILER_GetStats((audio_profiler_stage_t)stage, &stats);
+            SHELL_Printf(s_shellHandle, "%-16s %10d %8d %8d %8d %8d %8d\r\n",
+                         AUDIO_PROFILER_GetStageName((audio_profiler_stage_t)stage), stats.runs,
+                         sln_pipestat_cycles_to_us(stats.min), sln_pipestat_cycles_to_us(stats.avg),
+                         sln_pipestat_cycles_to_us(stats.p99), sln_pipestat_cycles_to_us(stats.max),
+                         sln_pipestat_cycles_to_us(stats.peak));
+        }
+
+        sln_pipestat_print_deadlines();
+#if ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER
+        sln_pipestat_print_ww_scheduler();
+#endif /* ENABLE_DSMT_ASR && MULTILINGUAL && ENABLE_WW_SCHEDULER */
+    }
+    else
+    {
+        SHELL_Printf(s_shellHandle, "Invalid input.\r\n");
+    }
+}
+
+static shell_status_t sln_pipestat_handler(shell_handle_t shellHandle, int32_t argc, char **argv)
+{
+    s_argc = argc;
+    if (argc > 1)
+    {
+        strncpy(s_argv[1], argv[1], MAX_ARGV_STR_SIZE);
+    }
+
+#if ENABLE_USB_SHELL
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xEventGroupSetBitsFromISR(s_ShellEventGroup, PIPESTAT_EVT, &xHigherPriorityTaskWoken);
+#elif ENABLE_UART_SHELL
+    sln_pipestat_cmd_action();
+#endif /* ENABLE_USB_SHELL */
+
+    return kStatus_SHELL_Success;
+}
+
+#if ENABLE_STREAMER_CACHE
+/* promptcache command */
+/***********************/
+static void sln_promptcache_cmd_action(void)
+{
+    sln_streamer_cache_stats_t stats = {0};
+    uint32_t lookups                 = 0;
+
+    if (s_argc > 2)
+    {
+        SHELL_Printf(
+            s_shellHandle,
+            "\r\nIncorrect command parameter(s). Enter \"help\" to view a list of available commands.\r\n\r\n");
+    }
+    else if ((s_argc == 2) && (strcmp(s_argv[1], "flush") == 0))
+    {
+        SLN_STREAMER_CACHE_Flush();
+        SHELL_Printf(s_shellHandle, "Prompt cache flushed.\r\n");
+    }
+    else if (s_argc == 1)
+    {
+        SLN_STREAMER_CACHE_GetStats(&stats);
+        lookups = stats.hits + stats.misses;
+
+        SHELL_Printf(s_shellHandle, "\r\nPrompts cached: %d, %d / %d bytes\r\n", stats.entries, stats.usedBytes,
+                     stats.budgetBytes);
+        SHELL_Printf(s_shellHandle, "Hits: %d, misses: %d, hit rate: %d%%\r\n", stats.hits, stats.misses,
+                     (lookups > 0) ? ((stats.hits * 100) / lookups) : 0);
+        SHELL_Printf(s_shellHandle, "Evictions: %d, not cached: %d\r\n", stats.evictions, stats.skipped);
+    }
+    else
+    {
+        SHELL_Printf(s_shellHandle, "Invalid input.\r\n");
+    }
+}
+
+static shell_status_t sln_promptcache_handler(shell_handle_t shellHandle, int32_t argc, char **argv)
+{
+    s_argc = argc;
+    if (argc > 1)
+    {
+        strncpy(s_argv[1], argv[1], MAX_ARGV_STR_SIZE);
+    }
+
+#if ENABLE_USB_SHELL
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xEventGroupSetBitsFromISR(s_ShellEventGroup, PROMPT_CACHE_EVT, &xHigherPriorityTaskWoken);
+#elif ENABLE_UART_SHELL
+    sln_promptcache_cmd_action();
+#endif /* ENABLE_USB_SHELL */
+
+    return kStatus_SHELL_Success;
+}
+#endif /* ENABLE_STREAMER_CACHE */
+
 int log_shell_printf(const char *formatString, ...)
 {
     va_list ap;
@@ -1837,6 +2317,13 @@ int sln_shell_init(void)
 #if ENABLE_AEC
     SHELL_RegisterCommand(s_shellHandle, SHELL_COMMAND(aecmode));
 #endif /* ENABLE_AEC */
+#if SLN_TRACE_LATENCY
+    SHELL_RegisterCommand(s_shellHandle, SHELL_COMMAND(latency));
+#endif /* SLN_TRACE_LATENCY */
+    SHELL_RegisterCommand(s_shellHandle, SHELL_COMMAND(pipestat));
+#if ENABLE_STREAMER_CACHE
+    SHELL_RegisterCommand(s_shellHandle, SHELL_COMMAND(promptcache));
+#endif /* ENABLE_STREAMER_CACHE */
 
     return status;
 }
@@ -1977,6 +2464,25 @@ void sln_shell_task(void *arg)
         }
 #endif /* ENABLE_AEC */
 
+#if SLN_TRACE_LATENCY
+        if (shellEvents & LATENCY_EVT)
+        {
+            sln_latency_cmd_action();
+        }
+#endif /* SLN_TRACE_LATENCY */
+
+        if (shellEvents & PIPESTAT_EVT)
+        {
+            sln_pipestat_cmd_action();
+        }
+
+#if ENABLE_STREAMER_CACHE
+        if (shellEvents & PROMPT_CACHE_EVT)
+        {
+            sln_promptcache_cmd_action();
+        }
+#endif /* ENABLE_STREAMER_CACHE */
+
 #endif /* ENABLE_UART_SHELL */
     }
 }
@@ -101,6 +101,13 @@ typedef enum _shell_event
 #if ENABLE_AEC
     AEC_MODE_EVT         = (1 << 20U),
 #endif /* ENABLE_AEC */
+#if SLN_TRACE_LATENCY
+    LATENCY_EVT          = (1 << 21U),
+#endif /* SLN_TRACE_LATENCY */
+    PIPESTAT_EVT         = (1 << 22U),
+#if ENABLE_STREAMER_CACHE
+    PROMPT_CACHE_EVT     = (1 << 23U),
+#endif /* ENABLE_STREAMER_CACHE */
 } shell_event_t;
 
 typedef struct __shell_heap_trace
@@ -0,0 +1,365 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if ENABLE_WW_SCHEDULER
+
+#include <string.h>
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* NXP includes. */
+#include "fsl_common.h"
+#include "audio_frame_pool.h"
+#include "sln_ww_scheduler.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* The noise floor follows a quieter frame within a few frames, and a louder one over a few seconds */
+#define WW_SCHED_FLOOR_FALL_SHIFT 2U
+#define WW_SCHED_FLOOR_RISE_SHIFT 7U
+
+/* Weight of the new run in the average processing time of an engine, 1 / 2^shift */
+#define WW_SCHED_COST_SHIFT 3U
+
+#define WW_SCHED_ENGINE_MASK(idx) (1U << (idx))
+
+typedef struct _ww_sched_engine
+{
+    uint32_t costCycles; /* Average processing time, 0 until the first run */
+    uint32_t skipRun;    /* Frames skipped in a row */
+} ww_sched_engine_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static ww_sched_engine_t s_engines[WW_SCHED_MAX_ENGINES];
+static sln_ww_sched_stats_t s_stats;
+
+static uint32_t s_allMask   = 0; /* All the engines */
+static uint32_t s_staleMask = 0; /* Engines which skipped frames since their last reset */
+static uint32_t s_planMask  = 0; /* Engines chosen for the current frame */
+static uint32_t s_next      = 0; /* First secondary engine considered on the next frame */
+
+static uint32_t s_floorQ4     = WW_SCHED_GATE_MIN_FLOOR << 4U;
+static uint32_t s_hangoverMs  = 0;
+static uint32_t s_openedFrame = 0; /* Value of s_stats.frames when the gate opened */
+static uint32_t s_latencySum  = 0; /* Sum of the gated detections latency, in ms */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+/*!
+ * @brief Update the noise floor and the gate with the mean absolute value of a frame.
+ */
+static void _update_gate(const int16_t *samples, uint32_t count)
+{
+    uint32_t sum      = 0;
+    uint32_t energyQ4 = 0;
+    bool loud         = false;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        sum += (uint32_t)((samples[idx] < 0) ? -samples[idx] : samples[idx]);
+    }
+    energyQ4 = (count > 0) ? ((sum / count) << 4U) : 0;
+
+    /* Compare with the floor before the frame is accounted in it */
+    loud = (energyQ4 >= ((s_floorQ4 >> 4U) * WW_SCHED_GATE_RATIO_Q4));
+
+    if (energyQ4 < s_floorQ4)
+    {
+        s_floorQ4 -= (s_floorQ4 - energyQ4) >> WW_SCHED_FLOOR_FALL_SHIFT;
+    }
+    else
+    {
+        s_floorQ4 += (energyQ4 - s_floorQ4) >> WW_SCHED_FLOOR_RISE_SHIFT;
+    }
+    s_floorQ4 = MAX(s_floorQ4, WW_SCHED_GATE_MIN_FLOOR << 4U);
+
+    if (loud)
+    {
+        s_hangoverMs = WW_SCHED_GATE_HANGOVER_MS;
+        if (!s_stats.gateOpen)
+        {
+            s_stats.gateOpen = true;
+            s_stats.gateOpens++;
+            s_openedFrame = s_stats.frames;
+        }
+    }
+    else if (s_stats.gateOpen)
+    {
+        s_hangoverMs = (s_hangoverMs > ASR_FRAME_MS) ? (s_hangoverMs - ASR_FRAME_MS) : 0;
+        if (s_hangoverMs == 0)
+        {
+            s_stats.gateOpen = false;
+        }
+    }
+
+    s_stats.noiseFloor = s_floorQ4 >> 4U;
+}
+
+/*!
+ * @brief Choose the secondary engines which fit in the budget next to the primary one, in turns.
+ */
+static uint32_t _plan_budget(uint32_t primary, uint32_t count)
+{
+    uint32_t budget = WW_SCHED_BUDGET_US * (SystemCoreClock / 1000000U);
+    uint32_t used   = s_engines[primary].costCycles;
+    uint32_t mask   = WW_SCHED_ENGINE_MASK(primary);
+    uint32_t idx    = 0;
+    uint32_t last   = count;
+
+    for (uint32_t turn = 0; turn < count; turn++)
+    {
+        idx = (s_next + turn) % count;
+        if (idx == primary)
+        {
+            continue;
+        }
+
+        /* An engine never measured runs once to learn its cost, a starving one runs whatever the budget */
+        if ((s_engines[idx].costCycles == 0) || ((used + s_engines[idx].costCycles) <= budget) ||
+            (s_engines[idx].skipRun >= WW_SCHED_MAX_SKIP))
+        {
+            used += s_engines[idx].costCycles;
+            mask |= WW_SCHED_ENGINE_MASK(idx);
+            last = idx;
+        }
+    }
+
+    /* The next frame starts with the first engine left out of this one */
+    if (last < count)
+    {
+        s_next = (last + 1U) % count;
+    }
+
+    return mask;
+}
+
+void SLN_WW_SCHED_Init(uint32_t engineCount)
+{
+    taskENTER_CRITICAL();
+
+    memset(s_engines, 0, sizeof(s_engines));
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    s_allMask   = (engineCount >= 32U) ? 0xFFFFFFFFU : (WW_SCHED_ENGINE_MASK(engineCount) - 1U);
+    s_staleMask = 0;
+    s_planMask  = s_allMask;
+    s_next      = 0;
+
+    s_floorQ4     = WW_SCHED_GATE_MIN_FLOOR << 4U;
+    s_hangoverMs  = 0;
+    s_openedFrame = 0;
+    s_latencySum  = 0;
+
+    s_stats.engineCount = MIN(engineCount, WW_SCHED_MAX_ENGINES);
+    s_stats.shadow      = (WW_SCHED_SHADOW_MODE != 0);
+
+    taskEXIT_CRITICAL();
+}
+
+void SLN_WW_SCHED_ResetStats(void)
+{
+    taskENTER_CRITICAL();
+
+    s_stats.frames       = 0;
+    s_stats.gateFrames   = 0;
+    s_stats.gateOpens    = 0;
+    s_stats.shedFrames   = 0;
+    s_stats.detections   = 0;
+    s_stats.ungated      = 0;
+    s_stats.latencyAvgMs = 0;
+    s_stats.latencyMaxMs = 0;
+    s_openedFrame        = 0;
+    s_latencySum         = 0;
+
+    for (uint32_t idx = 0; idx < WW_SCHED_MAX_ENGINES; idx++)
+    {
+        s_stats.engines[idx].runs       = 0;
+        s_stats.engines[idx].skips      = 0;
+        s_stats.engines[idx].detections = 0;
+        s_stats.engines[idx].misses     = 0;
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+uint32_t SLN_WW_SCHED_Plan(const int16_t *samples, uint32_t count, uint32_t primary, bool shed, uint32_t *resetMask)
+{
+    uint32_t engineCount = s_stats.engineCount;
+    uint32_t mask        = 0;
+    uint32_t reset       = 0;
+
+    s_stats.frames++;
+
+    if ((samples != NULL) && (count > 0))
+    {
+        _update_gate(samples, count);
+    }
+
+    if (engineCount == 0)
+    {
+        mask = s_allMask;
+    }
+    else
+    {
+        primary         = (primary < engineCount) ? primary : 0;
+        s_stats.primary = primary;
+
+        /* The engines above WW_SCHED_MAX_ENGINES are not scheduled, they always run */
+        mask = s_allMask & ~(WW_SCHED_ENGINE_MASK(engineCount) - 1U);
+
+        if (s_stats.gateOpen)
+        {
+            s_stats.gateFrames++;
+        }
+
+        if (shed)
+        {
+            s_stats.shedFrames++;
+            mask |= WW_SCHED_ENGINE_MASK(primary);
+        }
+        else if (s_stats.gateOpen)
+        {
+            mask = s_allMask;
+        }
+        else
+        {
+            mask |= _plan_budget(primary, engineCount);
+        }
+
+        for (uint32_t idx = 0; idx < engineCount; idx++)
+        {
+            if (mask & WW_SCHED_ENGINE_MASK(idx))
+            {
+                s_stats.engines[idx].runs++;
+                s_engines[idx].skipRun = 0;
+            }
+            else
+            {
+                s_stats.engines[idx].skips++;
+                s_engines[idx].skipRun++;
+                s_staleMask |= WW_SCHED_ENGINE_MASK(idx);
+            }
+        }
+
+#if WW_SCHED_SHADOW_MODE
+        /* Everything runs, the plan is only kept to count the detections it would have missed */
+        s_planMask  = mask;
+        s_staleMask = 0;
+        mask        = s_allMask;
+#else
+        s_planMask = mask;
+
+        /* The engines which skipped frames restart from a clean state on the utterance */
+        if (s_stats.gateOpen && !shed)
+        {
+            reset = s_staleMask & mask;
+            s_staleMask &= ~reset;
+        }
+#endif /* WW_SCHED_SHADOW_MODE */
+    }
+
+    if (resetMask != NULL)
+    {
+        *resetMask = reset;
+    }
+
+    return mask;
+}
+
+void SLN_WW_SCHED_Record(uint32_t engine, uint32_t cycles)
+{
+    ww_sched_engine_t *state = NULL;
+
+    if (engine < s_stats.engineCount)
+    {
+        state = &s_engines[engine];
+
+        if (state->costCycles == 0)
+        {
+            state->costCycles = cycles;
+        }
+        else if (cycles > state->costCycles)
+        {
+            state->costCycles += (cycles - state->costCycles) >> WW_SCHED_COST_SHIFT;
+        }
+        else
+        {
+            state->costCycles -= (state->costCycles - cycles) >> WW_SCHED_COST_SHIFT;
+        }
+
+        /* 0 stands for an engine never measured */
+        state->costCycles = MAX(state->costCycles, 1U);
+    }
+}
+
+void SLN_WW_SCHED_Detected(uint32_t engine, int32_t trustScore)
+{
+    uint32_t latencyMs = 0;
+
+    taskENTER_CRITICAL();
+
+    s_stats.detections++;
+
+    if (s_stats.gateOpen)
+    {
+        latencyMs = (s_stats.frames - s_openedFrame + 1U) * ASR_FRAME_MS;
+        s_latencySum += latencyMs;
+        s_stats.latencyMaxMs = MAX(s_stats.latencyMaxMs, latencyMs);
+        s_stats.latencyAvgMs = s_latencySum / (s_stats.detections - s_stats.ungated);
+    }
+    else
+    {
+        s_stats.ungated++;
+    }
+
+    if (engine < s_stats.engineCount)
+    {
+        s_stats.engines[engine].detections++;
+        s_stats.engines[engine].lastTrust = trustScore;
+
+        if ((s_planMask & WW_SCHED_ENGINE_MASK(engine)) == 0)
+        {
+            s_stats.engines[engine].misses++;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+void SLN_WW_SCHED_EnginesReset(void)
+{
+    s_staleMask = 0;
+}
+
+void SLN_WW_SCHED_GetStats(sln_ww_sched_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+
+    *stats = s_stats;
+    for (uint32_t idx = 0; idx < WW_SCHED_MAX_ENGINES; idx++)
+    {
+        /* SystemCoreClock follows the VAD clock reduction */
+        stats->engines[idx].costUs = (uint32_t)(((uint64_t)s_engines[idx].costCycles * 1000000U) / SystemCoreClock);
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+#endif /* ENABLE_WW_SCHEDULER */
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SLN_WW_SCHEDULER_H_
+#define _SLN_WW_SCHEDULER_H_
+
+#if ENABLE_WW_SCHEDULER
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Wake word engines the scheduler can handle, one per active language */
+#ifndef WW_SCHED_MAX_ENGINES
+#define WW_SCHED_MAX_ENGINES 4U
+#endif /* WW_SCHED_MAX_ENGINES */
+
+/* Processing time all the wake word engines may use on one frame while the gate is closed,
+ * the primary engine included */
+#ifndef WW_SCHED_BUDGET_US
+#define WW_SCHED_BUDGET_US 12000U
+#endif /* WW_SCHED_BUDGET_US */
+
+/* A secondary engine runs at least once every WW_SCHED_MAX_SKIP + 1 frames, whatever the budget */
+#ifndef WW_SCHED_MAX_SKIP
+#define WW_SCHED_MAX_SKIP 7U
+#endif /* WW_SCHED_MAX_SKIP */
+
+/* The gate opens when the frame energy exceeds the noise floor by WW_SCHED_GATE_RATIO_Q4 / 16 */
+#ifndef WW_SCHED_GATE_RATIO_Q4
+#define WW_SCHED_GATE_RATIO_Q4 48U
+#endif /* WW_SCHED_GATE_RATIO_Q4 */
+
+/* Lowest noise floor, in mean absolute sample value, so digital silence does not open the gate on dither */
+#ifndef WW_SCHED_GATE_MIN_FLOOR
+#define WW_SCHED_GATE_MIN_FLOOR 16U
+#endif /* WW_SCHED_GATE_MIN_FLOOR */
+
+/* Time the gate stays open after the last loud frame, covers the pauses inside a wake word */
+#ifndef WW_SCHED_GATE_HANGOVER_MS
+#define WW_SCHED_GATE_HANGOVER_MS 900U
+#endif /* WW_SCHED_GATE_HANGOVER_MS */
+
+/* When set to 1, all the engines run on every frame and the scheduler only counts the detections
+ * it would have missed. Used to measure the miss rate of a budget before enabling it. */
+#ifndef WW_SCHED_SHADOW_MODE
+#define WW_SCHED_SHADOW_MODE 0
+#endif /* WW_SCHED_SHADOW_MODE */
+
+/*! @brief Counters of one wake word engine */
+typedef struct _sln_ww_sched_engine_stats
+{
+    uint32_t runs;       /*!< Frames processed by the engine */
+    uint32_t skips;      /*!< Frames skipped to save processing time */
+    uint32_t costUs;     /*!< Average processing time of one frame */
+    uint32_t detections; /*!< Wake words detected by the engine */
+    uint32_t misses;     /*!< Shadow mode: detections made on a frame the scheduler would have skipped */
+    int32_t lastTrust;   /*!< Trust score of the last detection */
+} sln_ww_sched_engine_stats_t;
+
+/*! @brief Scheduler counters */
+typedef struct _sln_ww_sched_stats
+{
+    uint32_t frames;         /*!< Frames scheduled */
+    uint32_t gateFrames;     /*!< Frames scheduled with the gate open */
+    uint32_t gateOpens;      /*!< Times the gate opened */
+    uint32_t shedFrames;     /*!< Frames where only the primary engine ran because ASR was shedding load */
+    uint32_t detections;     /*!< Wake words detected */
+    uint32_t ungated;        /*!< Wake words detected while the gate was closed, the gate missed the utterance */
+    uint32_t latencyAvgMs;   /*!< Average time from the gate opening to the detection */
+    uint32_t latencyMaxMs;   /*!< Longest time from the gate opening to the detection */
+    uint32_t noiseFloor;     /*!< Current noise floor, in mean absolute sample value */
+    uint32_t engineCount;    /*!< Engines scheduled */
+    uint32_t primary;        /*!< Index of the primary engine */
+    bool gateOpen;           /*!< Gate state */
+    bool shadow;             /*!< WW_SCHED_SHADOW_MODE */
+    sln_ww_sched_engine_stats_t engines[WW_SCHED_MAX_ENGINES];
+} sln_ww_sched_stats_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * @brief Clear the scheduler state and counters. Must be called each time the set of engines changes.
+ *
+ * @param engineCount Number of wake word engines, the ones above WW_SCHED_MAX_ENGINES always run
+ */
+void SLN_WW_SCHED_Init(uint32_t engineCount);
+
+/*!
+ * @brief Clear the counters, the gate and the cost estimates are kept.
+ */
+void SLN_WW_SCHED_ResetStats(void);
+
+/*!
+ * @brief Update the energy gate with a new frame and choose the engines which process it.
+ *        While the gate is open all the engines run. Otherwise the primary engine runs and the
+ *        secondary ones take turns within WW_SCHED_BUDGET_US.
+ *
+ * @param samples    Frame handed to the wake word engines
+ * @param count      Number of samples of the frame
+ * @param primary    Index of the engine of the last detected language
+ * @param shed       true while ASR is shedding load, only the primary engine runs
+ * @param resetMask  Engines which skipped frames and must be reset before they process this one
+ * @returns Mask of the engines which process the frame, bit n for engine n
+ */
+uint32_t SLN_WW_SCHED_Plan(const int16_t *samples, uint32_t count, uint32_t primary, bool shed, uint32_t *resetMask);
+
+/*!
+ * @brief Record the processing time of an engine on the current frame.
+ *
+ * @param engine Engine index
+ * @param cycles Duration of asr_process_audio_buffer, in DWT cycles
+ */
+void SLN_WW_SCHED_Record(uint32_t engine, uint32_t cycles);
+
+/*!
+ * @brief Count a wake word detection and its latency from the gate opening.
+ *
+ * @param engine     Engine index
+ * @param trustScore Trust score reported by the engine
+ */
+void SLN_WW_SCHED_Detected(uint32_t engine, int32_t trustScore);
+
+/*!
+ * @brief Tell the scheduler all the engines were reset, none of them is stale anymore.
+ */
+void SLN_WW_SCHED_EnginesReset(void);
+
+/*!
+ * @brief Get a copy of the scheduler counters.
+ *
+ * @param stats Pointer where the counters will be copied
+ */
+void SLN_WW_SCHED_GetStats(sln_ww_sched_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ENABLE_WW_SCHEDULER */
+#endif /* _SLN_WW_SCHEDULER_H_ */
@@ -16,16 +16,16 @@
 
 #if DUMP_ALL_STREAMS
 #define AUDIO_BUFFER_OUTPUT_SIZE \
-    ((PCM_SAMPLE_COUNT * PCM_SAMPLE_SIZE_BYTES) + (PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES * 2))
+    ((AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT * PCM_SAMPLE_SIZE_BYTES) + (AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES * 2))
 #define DUMP_QUEUE_SLOTS 5
 SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
-          s_audioStream[PCM_SINGLE_CH_SMPL_COUNT * (SLN_MIC_COUNT + 2)],
+          s_audioStream[AFE_BLOCK_SMPL_COUNT * (SLN_MIC_COUNT + 2)],
           8);
 #else
-#define AUDIO_BUFFER_OUTPUT_SIZE (PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES)
+#define AUDIO_BUFFER_OUTPUT_SIZE (AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES)
 #define DUMP_QUEUE_SLOTS 25
 SDK_ALIGN(static int16_t __attribute__((section(".bss.$SRAM_OC_NON_CACHEABLE")))
-          s_audioStream[PCM_SINGLE_CH_SMPL_COUNT],
+          s_audioStream[AFE_BLOCK_SMPL_COUNT],
           8);
 #endif /* DUMP_ALL_STREAMS */
 
@@ -542,22 +542,22 @@ void AUDIO_DUMP_ForwardDataOverWiFi(int16_t *micStream, int16_t *ampStream, void
 
 #if DUMP_ALL_STREAMS
         /* Prepare and send clean data to Audio Dump task */
-        memcpy(&s_audioStream[u32Element], (uint8_t *)micStream, PCM_SAMPLE_COUNT * PCM_SAMPLE_SIZE_BYTES);
-        u32Element += PCM_SAMPLE_COUNT;
+        memcpy(&s_audioStream[u32Element], (uint8_t *)micStream, AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        u32Element += AFE_BLOCK_SMPL_COUNT * SLN_MIC_COUNT;
         if (ampStream != NULL)
         {
-            memcpy(&s_audioStream[u32Element], (uint8_t *)ampStream, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+            memcpy(&s_audioStream[u32Element], (uint8_t *)ampStream, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
         }
         else
         {
-            memset(&s_audioStream[u32Element], 0, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+            memset(&s_audioStream[u32Element], 0, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
         }
-        u32Element += PCM_SINGLE_CH_SMPL_COUNT;
-        memcpy(&s_audioStream[u32Element], (uint8_t *)cleanStream, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
-        u32Element += PCM_SINGLE_CH_SMPL_COUNT;
+        u32Element += AFE_BLOCK_SMPL_COUNT;
+        memcpy(&s_audioStream[u32Element], (uint8_t *)cleanStream, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        u32Element += AFE_BLOCK_SMPL_COUNT;
 #else
-        memcpy(&s_audioStream[u32Element], (uint8_t *)cleanStream, PCM_SINGLE_CH_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
-        u32Element += PCM_SINGLE_CH_SMPL_COUNT;
+        memcpy(&s_audioStream[u32Element], (uint8_t *)cleanStream, AFE_BLOCK_SMPL_COUNT * PCM_SAMPLE_SIZE_BYTES);
+        u32Element += AFE_BLOCK_SMPL_COUNT;
 #endif /* DUMP_ALL_STREAMS */
 
         if (xQueueSendToBack(g_xAudioDumpQueue, s_audioStream, 0) != pdPASS)
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Helpers shared by the host tests: checks, a reproducible random generator, timing and tone analysis. */
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif /* PI */
+
+static int s_hostTestFailures = 0;
+
+/* Report a failed check and keep going, so one run shows all the failures */
+#define HOST_TEST_CHECK(cond, ...)                                  \
+    do                                                              \
+    {                                                               \
+        if (!(cond))                                                \
+        {                                                           \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+            s_hostTestFailures++;                                   \
+        }                                                           \
+    } while (0)
+
+static inline int HOST_TEST_Result(const char *name)
+{
+    printf("%s: %s\n", name, (s_hostTestFailures == 0) ? "PASS" : "FAIL");
+
+    return (s_hostTestFailures == 0) ? 0 : 1;
+}
+
+/* xorshift32, the same sequence on every host */
+static uint32_t s_hostTestSeed = 0x12345678U;
+
+static inline uint32_t HOST_TEST_Rand(void)
+{
+    s_hostTestSeed ^= s_hostTestSeed << 13;
+    s_hostTestSeed ^= s_hostTestSeed >> 17;
+    s_hostTestSeed ^= s_hostTestSeed << 5;
+
+    return s_hostTestSeed;
+}
+
+/* Uniform in [min, max] */
+static inline int32_t HOST_TEST_RandRange(int32_t min, int32_t max)
+{
+    return min + (int32_t)(HOST_TEST_Rand() % (uint32_t)(max - min + 1));
+}
+
+/* Host time stamp in ns, plus the time stamp counter when the host has one.
+ * Host numbers only compare two versions of the code, the device cost is read with pipestat. */
+typedef struct _host_test_time
+{
+    uint64_t ns;
+    uint64_t ticks;
+} host_test_time_t;
+
+static inline host_test_time_t HOST_TEST_Now(void)
+{
+    host_test_time_t now;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now.ns = (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#if defined(__x86_64__) || defined(__i386__)
+    now.ticks = __rdtsc();
+#else
+    now.ticks = now.ns;
+#endif
+
+    return now;
+}
+
+/* Least squares fit of a * cos + b * sin at freq (cycles per sample) over samples[0..count),
+ * returns the amplitude, and the power of what the tone does not explain in residualPower. */
+static inline double HOST_TEST_FitTone(const int16_t *samples, uint32_t count, double freq, double *residualPower)
+{
+    double cc = 0.0, ss = 0.0, cs = 0.0, xc = 0.0, xs = 0.0;
+    double a = 0.0, b = 0.0, det = 0.0, res = 0.0;
+
+    for (uint32_t n = 0; n < count; n++)
+    {
+        double c = cos(2.0 * PI * freq * n);
+        double s = sin(2.0 * PI * freq * n);
+
+        cc += c * c;
+        ss += s * s;
+        cs += c * s;
+        xc += samples[n] * c;
+        xs += samples[n] * s;
+    }
+
+    det = (cc * ss) - (cs * cs);
+    a   = ((xc * ss) - (xs * cs)) / det;
+    b   = ((xs * cc) - (xc * cs)) / det;
+
+    if (residualPower != NULL)
+    {
+        for (uint32_t n = 0; n < count; n++)
+        {
+            double e = samples[n] - (a * cos(2.0 * PI * freq * n)) - (b * sin(2.0 * PI * freq * n));
+            res += e * e;
+        }
+        *residualPower = res / count;
+    }
+
+    return sqrt((a * a) + (b * b));
+}
+
+#endif /* HOST_TEST_H_ */
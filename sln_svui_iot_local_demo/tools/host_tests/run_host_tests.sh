@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Copyright 2024 NXP.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Build and run the host tests of the audio processing code.
+# Each test includes the source file it checks and builds it against the stand-ins in stubs/,
+# which model the FreeRTOS, SDK and CMSIS intrinsics used by the audio code.
+#
+# Usage: tools/host_tests/run_host_tests.sh [test name...]
+#        CC and OUT_DIR may be set to change the compiler and the build directory.
+
+set -e
+
+HOST_TESTS_DIR=$(cd "$(dirname "$0")" && pwd)
+APP_DIR="$HOST_TESTS_DIR/../.."
+CC=${CC:-cc}
+OUT_DIR=${OUT_DIR:-"${TMPDIR:-/tmp}/sln_host_tests"}
+# The DSP code relies on the wrapping of the Cortex-M7 integer arithmetic
+CFLAGS="-O2 -Wall -Wextra -fwrapv -I$HOST_TESTS_DIR -I$HOST_TESTS_DIR/stubs -I$APP_DIR/audio -I$APP_DIR/audio/audio_processing"
+
+# Test name and the builds it runs in, one set of defines per build
+TESTS="test_amp_fir:-DSLN_AMP_GAIN_RAMP_SAMPLES=240,-DSLN_AMP_GAIN_RAMP_SAMPLES=1
+test_amp_resampler:-DSLN_MIC_PERIOD_MS=5,-DSLN_MIC_PERIOD_MS=10,-DSLN_MIC_PERIOD_MS=20
+test_i2s_mic_hpf:-DSLN_MIC_COUNT=3,-DSLN_MIC_COUNT=1"
+
+if [ $# -gt 0 ]; then
+    SELECTED="$*"
+else
+    SELECTED=""
+    for entry in $TESTS; do
+        SELECTED="$SELECTED ${entry%%:*}"
+    done
+fi
+
+mkdir -p "$OUT_DIR"
+failed=0
+
+for name in $SELECTED; do
+    builds=""
+    for entry in $TESTS; do
+        if [ "${entry%%:*}" = "$name" ]; then
+            builds="${entry#*:}"
+        fi
+    done
+
+    for defines in $(echo "$builds" | tr ',' ' '); do
+        echo "=== $name $defines"
+        if $CC $CFLAGS $defines "$HOST_TESTS_DIR/$name.c" -lm -o "$OUT_DIR/$name" && "$OUT_DIR/$name"; then
+            :
+        else
+            failed=1
+        fi
+    done
+done
+
+exit $failed
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host stand-in for the FreeRTOS kernel header, only what the audio processing code needs to build. */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef void *TaskHandle_t;
+typedef void *EventGroupHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef uint32_t EventBits_t;
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+
+#define configMAX_PRIORITIES 10
+#define portMAX_DELAY        0xFFFFFFFFU
+
+/* The host tests run in a single thread */
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#define configPRINTF(x) printf x
+
+#endif /* HOST_FREERTOS_H_ */
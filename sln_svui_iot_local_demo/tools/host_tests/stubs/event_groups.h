@@ -0,0 +1,8 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host stand-in, everything used by the audio processing code is in FreeRTOS.h */
+#include "FreeRTOS.h"
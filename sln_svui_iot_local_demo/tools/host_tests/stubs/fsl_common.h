@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host stand-in for the SDK common header: status codes, helpers and the CMSIS intrinsics of the
+ * Cortex-M7 DSP extension, implemented in plain C with the semantics of the instructions. */
+
+#ifndef HOST_FSL_COMMON_H_
+#define HOST_FSL_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef int32_t status_t;
+
+enum
+{
+    kStatus_Success = 0,
+    kStatus_Fail    = 1,
+};
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif /* MIN */
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif /* MAX */
+
+/* Signed saturation to bits, as SSAT */
+static inline int32_t __SSAT(int32_t val, uint32_t bits)
+{
+    const int32_t max = (int32_t)((1U << (bits - 1U)) - 1U);
+    const int32_t min = -max - 1;
+
+    return (val > max) ? max : ((val < min) ? min : val);
+}
+
+/* Dual 16-bit multiply with 32-bit accumulate, as SMLAD (the Q flag is not modelled) */
+static inline uint32_t __SMLAD(uint32_t x, uint32_t y, uint32_t sum)
+{
+    int32_t acc = (int32_t)sum;
+
+    acc += (int32_t)(int16_t)(x & 0xFFFFU) * (int32_t)(int16_t)(y & 0xFFFFU);
+    acc += (int32_t)(int16_t)(x >> 16) * (int32_t)(int16_t)(y >> 16);
+
+    return (uint32_t)acc;
+}
+
+/* Pack the bottom half of x with the top half of y shifted left, as PKHBT */
+static inline uint32_t __PKHBT(int32_t x, int32_t y, uint32_t shift)
+{
+    return ((uint32_t)x & 0xFFFFU) | (((uint32_t)y << shift) & 0xFFFF0000U);
+}
+
+static inline uint32_t __UNALIGNED_UINT32_READ(const void *addr)
+{
+    uint32_t value;
+
+    memcpy(&value, addr, sizeof(value));
+
+    return value;
+}
+
+#define __DMB()
+
+/* The DWT cycle counter does not exist on the host, the tests time the code with host_test.h */
+typedef struct _host_dwt
+{
+    uint32_t CYCCNT;
+} host_dwt_t;
+
+static host_dwt_t s_hostDwt __attribute__((unused));
+#define DWT (&s_hostDwt)
+
+#endif /* HOST_FSL_COMMON_H_ */
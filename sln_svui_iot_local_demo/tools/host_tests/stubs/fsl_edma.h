@@ -0,0 +1,24 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host stand-in for the eDMA driver header, the types only appear in the mic handle */
+
+#ifndef HOST_FSL_EDMA_H_
+#define HOST_FSL_EDMA_H_
+
+#include <stdint.h>
+
+typedef struct _edma_tcd
+{
+    uint32_t reg[8];
+} edma_tcd_t;
+
+typedef struct _host_dma
+{
+    uint32_t reg;
+} DMA_Type;
+
+#endif /* HOST_FSL_EDMA_H_ */
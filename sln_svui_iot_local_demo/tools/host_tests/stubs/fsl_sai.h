@@ -0,0 +1,37 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host stand-in for the SAI driver header, the mic configuration only uses its constants */
+
+#ifndef HOST_FSL_SAI_H_
+#define HOST_FSL_SAI_H_
+
+#include <stdint.h>
+
+typedef struct _host_i2s
+{
+    uint32_t reg;
+} I2S_Type;
+
+typedef enum _sai_clock_polarity
+{
+    kSAI_PolarityActiveHigh   = 0x0U,
+    kSAI_PolarityActiveLow    = 0x1U,
+    kSAI_SampleOnFallingEdge  = 0x0U,
+    kSAI_SampleOnRisingEdge   = 0x1U,
+} sai_clock_polarity_t;
+
+enum
+{
+    kSAI_Channel0Mask = 1 << 0U,
+    kSAI_Channel1Mask = 1 << 1U,
+    kSAI_Channel2Mask = 1 << 2U,
+    kSAI_Channel3Mask = 1 << 3U,
+};
+
+#define kSAI_SampleRate16KHz 16000U
+
+#endif /* HOST_FSL_SAI_H_ */
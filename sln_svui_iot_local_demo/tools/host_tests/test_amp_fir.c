@@ -0,0 +1,180 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host test of the MQS playback path, SLN_AMP_GainAndFirLowPassForAMP.
+ * The output is compared with a reference made of the shift register low pass the circular one replaced,
+ * fed with the same ramped Q15 gain:
+ * - random chunks of random sizes, with volume changes in between, must give bit exact output;
+ * - the host cost of both versions is printed for the chunk sizes the mixer plays.
+ * Build and run with run_host_tests.sh */
+
+#define USE_MQS 1
+
+#include "host_test.h"
+
+#include "sln_amplifier_processing.c"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define FIR_TEST_CHUNKS         20000
+#define FIR_TEST_MAX_SMPL_COUNT (PCM_AMP_DATA_SIZE_20_MS / sizeof(int16_t))
+#define FIR_TEST_GAIN_CHANGE    50 /* One volume change every FIR_TEST_GAIN_CHANGE chunks on average */
+#define FIR_BENCH_RUNS          2000
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* Reference state: the shift register delay line and the gain ramp */
+static int16_t s_refDsBuffer[FILTER_ORDER];
+static int32_t s_refGain         = 0;
+static int16_t s_refGainTarget   = 0;
+static int32_t s_refGainStep     = 0;
+static uint32_t s_refGainRampCnt = 0;
+
+static int16_t s_chunk[FIR_TEST_MAX_SMPL_COUNT];
+static int16_t s_refChunk[FIR_TEST_MAX_SMPL_COUNT];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+/* Gain ramp of SLN_AMP_GainAndFirLowPassForAMP, followed by the shift register low pass it replaced */
+static void ref_gain_and_fir(int16_t *samples, uint32_t samplesCnt, int16_t gainQ15)
+{
+    int32_t acc = 0;
+
+    if (gainQ15 != s_refGainTarget)
+    {
+        s_refGainTarget  = gainQ15;
+        s_refGainStep    = (((int32_t)gainQ15 << 16) - s_refGain) / SLN_AMP_GAIN_RAMP_SAMPLES;
+        s_refGainRampCnt = SLN_AMP_GAIN_RAMP_SAMPLES;
+    }
+
+    for (uint32_t idx = 0; idx < samplesCnt; idx += 2)
+    {
+        if (s_refGainRampCnt > 0)
+        {
+            s_refGainRampCnt--;
+            s_refGain = (s_refGainRampCnt > 0) ? (s_refGain + s_refGainStep) : ((int32_t)s_refGainTarget << 16);
+        }
+
+        acc = 0;
+
+        /* Pull new data into buffer */
+        s_refDsBuffer[0] = (int16_t)((samples[idx] * (s_refGain >> 16)) >> 15);
+
+        acc += kDefaultF3Coeffs24KHz[1] * (s_refDsBuffer[1] + s_refDsBuffer[29]);
+        acc += kDefaultF3Coeffs24KHz[2] * (s_refDsBuffer[2] + s_refDsBuffer[28]);
+
+        acc += kDefaultF3Coeffs24KHz[4] * (s_refDsBuffer[4] + s_refDsBuffer[26]);
+        acc += kDefaultF3Coeffs24KHz[5] * (s_refDsBuffer[5] + s_refDsBuffer[25]);
+
+        acc += kDefaultF3Coeffs24KHz[7] * (s_refDsBuffer[7] + s_refDsBuffer[23]);
+        acc += kDefaultF3Coeffs24KHz[8] * (s_refDsBuffer[8] + s_refDsBuffer[22]);
+
+        acc += kDefaultF3Coeffs24KHz[10] * (s_refDsBuffer[10] + s_refDsBuffer[20]);
+        acc += kDefaultF3Coeffs24KHz[11] * (s_refDsBuffer[11] + s_refDsBuffer[19]);
+
+        acc += kDefaultF3Coeffs24KHz[13] * (s_refDsBuffer[13] + s_refDsBuffer[17]);
+        acc += kDefaultF3Coeffs24KHz[14] * (s_refDsBuffer[14] + s_refDsBuffer[16]);
+
+        acc += kDefaultF3Coeffs24KHz[15] * (s_refDsBuffer[15] + 0);
+
+        /* Shift values up in buffer */
+        for (uint32_t idx2 = F3_NUM_TAPS; idx2 > 0; idx2--)
+        {
+            s_refDsBuffer[idx2] = s_refDsBuffer[idx2 - 1];
+        }
+
+        samples[idx]     = (int16_t)(acc >> 15);
+        samples[idx + 1] = -samples[idx];
+    }
+}
+
+static void test_bit_exact(void)
+{
+    int16_t gainQ15     = 0;
+    uint32_t count      = 0;
+    uint32_t mismatches = 0;
+
+    for (uint32_t chunk = 0; chunk < FIR_TEST_CHUNKS; chunk++)
+    {
+        if ((chunk == 0) || ((HOST_TEST_Rand() % FIR_TEST_GAIN_CHANGE) == 0))
+        {
+            gainQ15 = (int16_t)HOST_TEST_RandRange(0, INT16_MAX);
+        }
+
+        /* The differential layout always holds pairs */
+        count = 2U * (uint32_t)HOST_TEST_RandRange(1, FIR_TEST_MAX_SMPL_COUNT / 2);
+        for (uint32_t idx = 0; idx < count; idx += 2)
+        {
+            s_chunk[idx]     = (int16_t)HOST_TEST_RandRange(INT16_MIN, INT16_MAX);
+            s_chunk[idx + 1] = (int16_t)-s_chunk[idx];
+        }
+        memcpy(s_refChunk, s_chunk, count * sizeof(int16_t));
+
+        SLN_AMP_GainAndFirLowPassForAMP(s_chunk, count, gainQ15);
+        ref_gain_and_fir(s_refChunk, count, gainQ15);
+
+        if (memcmp(s_chunk, s_refChunk, count * sizeof(int16_t)) != 0)
+        {
+            mismatches++;
+        }
+    }
+
+    printf("  %u random chunks of 2 to %u samples, %u differ from the reference\n", FIR_TEST_CHUNKS,
+           (uint32_t)FIR_TEST_MAX_SMPL_COUNT, mismatches);
+    HOST_TEST_CHECK(mismatches == 0, "%u chunks are not bit exact", mismatches);
+}
+
+static void bench(void)
+{
+    /* 1ms, 10ms and one mixer slot (DEFAULT_AMP_SLOT_SIZE, 20ms) */
+    static const uint32_t kSizes[] = {PCM_AMP_DATA_SIZE_1_MS / sizeof(int16_t),
+                                      PCM_AMP_DATA_SIZE_10_MS / sizeof(int16_t), FIR_TEST_MAX_SMPL_COUNT};
+    host_test_time_t start = {0};
+    uint64_t refNs         = 0;
+    uint64_t newNs         = 0;
+
+    for (uint32_t idx = 0; idx < sizeof(kSizes) / sizeof(kSizes[0]); idx++)
+    {
+        for (uint32_t smpl = 0; smpl < kSizes[idx]; smpl++)
+        {
+            s_chunk[smpl] = (int16_t)HOST_TEST_RandRange(INT16_MIN, INT16_MAX);
+        }
+
+        start = HOST_TEST_Now();
+        for (uint32_t run = 0; run < FIR_BENCH_RUNS; run++)
+        {
+            ref_gain_and_fir(s_chunk, kSizes[idx], INT16_MAX / 2);
+        }
+        refNs = HOST_TEST_Now().ns - start.ns;
+
+        start = HOST_TEST_Now();
+        for (uint32_t run = 0; run < FIR_BENCH_RUNS; run++)
+        {
+            SLN_AMP_GainAndFirLowPassForAMP(s_chunk, kSizes[idx], INT16_MAX / 2);
+        }
+        newNs = HOST_TEST_Now().ns - start.ns;
+
+        printf("  %4u samples per chunk: shift register %llu ns, circular %llu ns (x%.1f)\n", kSizes[idx],
+               (unsigned long long)(refNs / FIR_BENCH_RUNS), (unsigned long long)(newNs / FIR_BENCH_RUNS),
+               (double)refNs / (double)MAX(newNs, 1U));
+    }
+}
+
+int main(void)
+{
+    printf("Bit exactness:\n");
+    test_bit_exact();
+    printf("Cost:\n");
+    bench();
+
+    return HOST_TEST_Result("test_amp_fir");
+}
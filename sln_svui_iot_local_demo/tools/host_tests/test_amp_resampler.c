@@ -0,0 +1,198 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host test of the AEC reference resampler, SLN_AMP_DownsampleDiffData (24KHz differential to 16KHz).
+ * Tones are played through the resampler period by period, the way SLN_AMP_GetAmpStream feeds it:
+ * - pass band tones must come out with their gain and at least RESAMPLER_MIN_SNR_DB of SNR;
+ * - tones above 8KHz must be rejected by at least RESAMPLER_MIN_REJECTION_DB where they would alias;
+ * - with the drift compensation stretching the step, the interpolation between phases must hold
+ *   RESAMPLER_MIN_DRIFT_SNR_DB;
+ * - the host cost of one period is printed.
+ * Build and run with run_host_tests.sh */
+
+#define ENABLE_AEC 1
+#define USE_MQS    1
+
+#include "host_test.h"
+
+#include "sln_amp_ring.c"
+#include "sln_amplifier_processing.c"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define RESAMPLER_TONE_AMPLITUDE   16000.0
+#define RESAMPLER_PERIODS          (1000 / SLN_MIC_PERIOD_MS)
+#define RESAMPLER_WARMUP_PERIODS   4
+#define RESAMPLER_OUT_SMPL_COUNT   (RESAMPLER_PERIODS * PCM_SINGLE_CH_SMPL_COUNT)
+#define RESAMPLER_FIT_SMPL_COUNT   ((RESAMPLER_PERIODS - RESAMPLER_WARMUP_PERIODS) * PCM_SINGLE_CH_SMPL_COUNT)
+
+#define RESAMPLER_MIN_SNR_DB       65.0
+#define RESAMPLER_MAX_GAIN_DB      0.05
+#define RESAMPLER_MIN_REJECTION_DB 60.0
+#define RESAMPLER_MIN_DRIFT_SNR_DB 50.0
+#define RESAMPLER_DRIFT_PPM        500.0
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int16_t s_out[RESAMPLER_OUT_SMPL_COUNT];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void AUDIO_PROFILER_Record(audio_profiler_stage_t stage, uint32_t cycles)
+{
+    (void)stage;
+    (void)cycles;
+}
+
+/* Resample RESAMPLER_PERIODS periods of a tone, returns the host time spent in the resampler */
+static host_test_time_t run_tone(double freqHz, double drift)
+{
+    host_test_time_t start = {0};
+    host_test_time_t stop  = {0};
+    host_test_time_t spent = {0};
+    uint32_t inPos         = 0;
+    uint32_t count         = 0;
+    int16_t value          = 0;
+
+    SLN_AMP_ResetDownsampler();
+    s_ampRefStep = (int64_t)((double)(3 * AMP_REF_POS_ONE) * (1.0 + drift));
+
+    for (uint32_t period = 0; period < RESAMPLER_PERIODS; period++)
+    {
+        count = SLN_AMP_GetDownsamplerInputCount();
+        HOST_TEST_CHECK(count <= AMP_REF_IN_MAX_SMPL_COUNT, "%u inputs requested, the buffer holds %u", count,
+                        AMP_REF_IN_MAX_SMPL_COUNT);
+        HOST_TEST_CHECK((drift != 0.0) || (count == AMP_REF_IN_SMPL_COUNT),
+                        "period %u requested %u inputs instead of %u", period, count, AMP_REF_IN_SMPL_COUNT);
+        count = MIN(count, AMP_REF_IN_MAX_SMPL_COUNT);
+
+        /* The amplifier stream is differential, every sample is followed by its opposite */
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            value = (int16_t)lrint(RESAMPLER_TONE_AMPLITUDE *
+                                   sin(2.0 * PI * freqHz * (inPos + idx) / (PCM_AMP_SAMPLE_RATE_HZ / 2)));
+            s_amp48KhzData[2 * idx]     = value;
+            s_amp48KhzData[2 * idx + 1] = (int16_t)-value;
+        }
+        inPos += count;
+
+        start = HOST_TEST_Now();
+        SLN_AMP_DownsampleDiffData((uint8_t *)s_amp48KhzData, count, &s_out[period * PCM_SINGLE_CH_SMPL_COUNT]);
+        stop = HOST_TEST_Now();
+        spent.ns += stop.ns - start.ns;
+        spent.ticks += stop.ticks - start.ticks;
+    }
+
+    return spent;
+}
+
+static void test_pass_band(void)
+{
+    static const double kTones[] = {100.0, 1000.0, 3000.0, 5000.0, 6000.0};
+    double residual              = 0.0;
+    double amplitude             = 0.0;
+    double snr                   = 0.0;
+    double gain                  = 0.0;
+
+    for (uint32_t idx = 0; idx < sizeof(kTones) / sizeof(kTones[0]); idx++)
+    {
+        (void)run_tone(kTones[idx], 0.0);
+        amplitude = HOST_TEST_FitTone(&s_out[RESAMPLER_WARMUP_PERIODS * PCM_SINGLE_CH_SMPL_COUNT],
+                                      RESAMPLER_FIT_SMPL_COUNT, kTones[idx] / PCM_SAMPLE_RATE_HZ, &residual);
+        snr  = 10.0 * log10((amplitude * amplitude / 2.0) / residual);
+        gain = 20.0 * log10(amplitude / RESAMPLER_TONE_AMPLITUDE);
+
+        printf("  %5.0fHz: gain %+.3fdB, SNR %.1fdB\n", kTones[idx], gain, snr);
+        HOST_TEST_CHECK(snr >= RESAMPLER_MIN_SNR_DB, "%.0fHz SNR %.1fdB, expected at least %.1fdB", kTones[idx], snr,
+                        RESAMPLER_MIN_SNR_DB);
+        HOST_TEST_CHECK(fabs(gain) <= RESAMPLER_MAX_GAIN_DB, "%.0fHz gain %+.3fdB", kTones[idx], gain);
+    }
+}
+
+static void test_alias_rejection(void)
+{
+    static const double kTones[] = {9000.0, 9500.0, 10000.0, 11000.0, 11500.0};
+    double alias                 = 0.0;
+    double rejection             = 0.0;
+
+    for (uint32_t idx = 0; idx < sizeof(kTones) / sizeof(kTones[0]); idx++)
+    {
+        (void)run_tone(kTones[idx], 0.0);
+
+        /* A tone above 8KHz folds to 16KHz - f */
+        alias = HOST_TEST_FitTone(&s_out[RESAMPLER_WARMUP_PERIODS * PCM_SINGLE_CH_SMPL_COUNT], RESAMPLER_FIT_SMPL_COUNT,
+                                  (PCM_SAMPLE_RATE_HZ - kTones[idx]) / PCM_SAMPLE_RATE_HZ, NULL);
+        rejection = 20.0 * log10(RESAMPLER_TONE_AMPLITUDE / MAX(alias, 1e-9));
+
+        printf("  %5.0fHz -> %4.0fHz alias: rejection %.1fdB\n", kTones[idx], PCM_SAMPLE_RATE_HZ - kTones[idx],
+               rejection);
+        HOST_TEST_CHECK(rejection >= RESAMPLER_MIN_REJECTION_DB, "%.0fHz rejection %.1fdB, expected at least %.1fdB",
+                        kTones[idx], rejection, RESAMPLER_MIN_REJECTION_DB);
+    }
+}
+
+static void test_drift(void)
+{
+    static const double kDrifts[] = {RESAMPLER_DRIFT_PPM, -RESAMPLER_DRIFT_PPM};
+    const double toneHz           = 1000.0;
+    double residual               = 0.0;
+    double amplitude              = 0.0;
+    double snr                    = 0.0;
+
+    for (uint32_t idx = 0; idx < sizeof(kDrifts) / sizeof(kDrifts[0]); idx++)
+    {
+        (void)run_tone(toneHz, kDrifts[idx] / 1e6);
+
+        /* Reading the input faster raises the frequency of the output */
+        amplitude = HOST_TEST_FitTone(&s_out[RESAMPLER_WARMUP_PERIODS * PCM_SINGLE_CH_SMPL_COUNT],
+                                      RESAMPLER_FIT_SMPL_COUNT,
+                                      toneHz * (1.0 + kDrifts[idx] / 1e6) / PCM_SAMPLE_RATE_HZ, &residual);
+        snr = 10.0 * log10((amplitude * amplitude / 2.0) / residual);
+
+        printf("  %5.0fHz at %+.0fppm: SNR %.1fdB\n", toneHz, kDrifts[idx], snr);
+        HOST_TEST_CHECK(snr >= RESAMPLER_MIN_DRIFT_SNR_DB, "%+.0fppm SNR %.1fdB, expected at least %.1fdB",
+                        kDrifts[idx], snr, RESAMPLER_MIN_DRIFT_SNR_DB);
+    }
+}
+
+static void bench(void)
+{
+    const uint32_t runs    = 20;
+    host_test_time_t total = {0};
+    host_test_time_t spent = {0};
+
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        spent = run_tone(1000.0, 0.0);
+        total.ns += spent.ns;
+        total.ticks += spent.ticks;
+    }
+
+    printf("  %u MACs per %dms period without drift, %llu ns and %llu host ticks per period\n",
+           AMP_REF_RESAMPLER_PHASE_TAPS * PCM_SINGLE_CH_SMPL_COUNT, SLN_MIC_PERIOD_MS,
+           (unsigned long long)(total.ns / (runs * RESAMPLER_PERIODS)),
+           (unsigned long long)(total.ticks / (runs * RESAMPLER_PERIODS)));
+}
+
+int main(void)
+{
+    printf("Pass band:\n");
+    test_pass_band();
+    printf("Aliasing rejection:\n");
+    test_alias_rejection();
+    printf("Drift compensation:\n");
+    test_drift();
+    printf("Cost:\n");
+    bench();
+
+    return HOST_TEST_Result("test_amp_resampler");
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2024 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host test of the I2S mics scaling and high pass filter, I2S_MIC_ProcessMicStream.
+ * The output is compared with a reference made of the float I2S_MIC_MicHighPassFilter the Q14 one replaced,
+ * fed with the same planar 32 bits raw samples:
+ * - random input (noise, a low tone and a DC offset per mic) must stay within HPF_TEST_MAX_LSB_ERROR
+ *   of the reference, and within HPF_TEST_MAX_MEAN_LSB_ERROR on average, once the start up is over;
+ * - the host cost of one period of both versions is printed.
+ * Build and run with run_host_tests.sh */
+
+#include "host_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sln_i2s_mic_processing.c"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define HPF_TEST_PERIODS (2000 / SLN_MIC_PERIOD_MS)
+
+/* The float filter starts with y[0] = x[0] and the Q14 one from a zero state.
+ * The difference decays with the filter time constant (about 43 samples), 100ms is well past it. */
+#define HPF_TEST_WARMUP_PERIODS (100 / SLN_MIC_PERIOD_MS)
+
+/* The reference truncates its output toward zero and the Q14 filter rounds down, feeding its fraction back:
+ * negative outputs are one LSB lower, so about half of the samples differ by one LSB.
+ * Rounding alpha to Q14 (16001 / 16384) does not add a visible error. */
+#define HPF_TEST_MAX_LSB_ERROR      1
+#define HPF_TEST_MAX_MEAN_LSB_ERROR 0.6
+
+/* Amplitudes after the scaling, in 16 bits LSB. The sum stays clear of the saturation. */
+#define HPF_TEST_NOISE_AMPLITUDE 6000
+#define HPF_TEST_TONE_AMPLITUDE  6000.0
+#define HPF_TEST_DC_AMPLITUDE    8000
+
+#define HPF_BENCH_RUNS 5000
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int32_t s_raw[SLN_MIC_COUNT * I2S_MIC_RAW_FRAME_SAMPLES_COUNT];
+static int16_t s_out[SLN_MIC_COUNT * PCM_SINGLE_CH_SMPL_COUNT];
+static int16_t s_refOut[SLN_MIC_COUNT * PCM_SINGLE_CH_SMPL_COUNT];
+
+/* Reference state, from I2S_MIC_MicHighPassFilter */
+static float s_micFilteredArray[I2S_MIC_RAW_FRAME_SAMPLES_COUNT] = {0};
+static float s_refLastRecord[SLN_MIC_COUNT]                      = {0};
+static float s_refLastFilter[SLN_MIC_COUNT]                      = {0};
+static uint8_t s_refFirstTime[SLN_MIC_COUNT]                     = {0};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+/* The float high pass filter that I2S_MIC_ProcessMicStream used before the Q14 one */
+static void ref_high_pass_filter(int16_t *samples, uint32_t samplesCnt, uint8_t micId)
+{
+    float RC    = 1.0 / (HPF_CUT_OFF_HZ * 2 * 3.14);
+    float dt    = 1.0 / HPF_SAMPLE_RATE;
+    float alpha = RC / (RC + dt);
+
+    memset(s_micFilteredArray, 0, sizeof(s_micFilteredArray));
+
+    if (s_refFirstTime[micId] == 0)
+    {
+        s_refFirstTime[micId] = 1;
+        s_micFilteredArray[0] = samples[0];
+    }
+    else
+    {
+        s_micFilteredArray[0] = alpha * (s_refLastFilter[micId] + samples[0] - s_refLastRecord[micId]);
+    }
+
+    for (uint32_t i = 1; i < samplesCnt; i++)
+    {
+        s_micFilteredArray[i] = alpha * (s_micFilteredArray[i - 1] + samples[i] - samples[i - 1]);
+    }
+
+    s_refLastRecord[micId] = samples[samplesCnt - 1];
+    s_refLastFilter[micId] = s_micFilteredArray[samplesCnt - 1];
+
+    for (uint32_t i = 0; i < samplesCnt; i++)
+    {
+        samples[i] = (int16_t)(s_micFilteredArray[i]);
+    }
+}
+
+/* The scaling loop followed by the float filter, reading the planar layout of the linked DMA channels */
+static void ref_process_mic_stream(const int32_t *in, int16_t *out)
+{
+    int16_t *currentMicOut = NULL;
+
+    for (uint8_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        currentMicOut = &out[micId * PCM_SINGLE_CH_SMPL_COUNT];
+
+        for (uint32_t i = 0; i < PCM_SINGLE_CH_SMPL_COUNT; i++)
+        {
+            currentMicOut[i] = ((in[micId * I2S_MIC_RAW_FRAME_SAMPLES_COUNT + i] * I2S_MIC_AMP_FACTOR) >> 16);
+        }
+
+        ref_high_pass_filter(currentMicOut, PCM_SINGLE_CH_SMPL_COUNT, micId);
+    }
+}
+
+/* One period of raw samples: each mic gets its own DC offset, a low tone and noise */
+static void fill_period(uint32_t period, const int32_t *dc)
+{
+    int32_t scaled = 0;
+    uint32_t n     = 0;
+
+    for (uint8_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        for (uint32_t i = 0; i < I2S_MIC_RAW_FRAME_SAMPLES_COUNT; i++)
+        {
+            n      = period * I2S_MIC_RAW_FRAME_SAMPLES_COUNT + i;
+            scaled = dc[micId] + HOST_TEST_RandRange(-HPF_TEST_NOISE_AMPLITUDE, HPF_TEST_NOISE_AMPLITUDE) +
+                     (int32_t)lrint(HPF_TEST_TONE_AMPLITUDE * sin(2.0 * PI * (200.0 * (micId + 1)) * n / HPF_SAMPLE_RATE));
+
+            /* Raw samples are left aligned in 32 bits, the scaling divides them by 2^16 / I2S_MIC_AMP_FACTOR */
+            s_raw[micId * I2S_MIC_RAW_FRAME_SAMPLES_COUNT + i] =
+                (int32_t)(((int64_t)scaled << 16) / I2S_MIC_AMP_FACTOR) + HOST_TEST_RandRange(0, 0xFFF);
+        }
+    }
+}
+
+static void test_against_float(void)
+{
+    int32_t dc[SLN_MIC_COUNT] = {0};
+    uint32_t maxError         = 0;
+    uint64_t sumError         = 0;
+    uint64_t compared         = 0;
+    uint32_t error            = 0;
+    double meanError          = 0.0;
+
+    for (uint8_t micId = 0; micId < SLN_MIC_COUNT; micId++)
+    {
+        dc[micId] = HOST_TEST_RandRange(-HPF_TEST_DC_AMPLITUDE, HPF_TEST_DC_AMPLITUDE);
+    }
+
+    for (uint32_t period = 0; period < HPF_TEST_PERIODS; period++)
+    {
+        fill_period(period, dc);
+
+        I2S_MIC_ProcessMicStream((uint8_t *)s_raw, s_out);
+        ref_process_mic_stream(s_raw, s_refOut);
+
+        if (period < HPF_TEST_WARMUP_PERIODS)
+        {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < SLN_MIC_COUNT * PCM_SINGLE_CH_SMPL_COUNT; i++)
+        {
+            error    = (uint32_t)abs(s_out[i] - s_refOut[i]);
+            maxError = MAX(maxError, error);
+            sumError += error;
+            compared++;
+        }
+    }
+
+    meanError = (double)sumError / (double)compared;
+
+    printf("  %llu samples on %d mics: max error %u LSB, mean error %.3f LSB\n", (unsigned long long)compared,
+           SLN_MIC_COUNT, maxError, meanError);
+    HOST_TEST_CHECK(maxError <= HPF_TEST_MAX_LSB_ERROR, "max error %u LSB, expected at most %d", maxError,
+                    HPF_TEST_MAX_LSB_ERROR);
+    HOST_TEST_CHECK(meanError <= HPF_TEST_MAX_MEAN_LSB_ERROR, "mean error %.3f LSB, expected at most %.3f",
+                    meanError, HPF_TEST_MAX_MEAN_LSB_ERROR);
+}
+
+static void bench(void)
+{
+    const int32_t dc[SLN_MIC_COUNT] = {0};
+    host_test_time_t start          = {0};
+    uint64_t refNs                  = 0;
+    uint64_t newNs                  = 0;
+
+    fill_period(0, dc);
+
+    start = HOST_TEST_Now();
+    for (uint32_t run = 0; run < HPF_BENCH_RUNS; run++)
+    {
+        ref_process_mic_stream(s_raw, s_refOut);
+    }
+    refNs = HOST_TEST_Now().ns - start.ns;
+
+    start = HOST_TEST_Now();
+    for (uint32_t run = 0; run < HPF_BENCH_RUNS; run++)
+    {
+        I2S_MIC_ProcessMicStream((uint8_t *)s_raw, s_out);
+    }
+    newNs = HOST_TEST_Now().ns - start.ns;
+
+    printf("  %dms period on %d mics: float %llu ns, Q14 %llu ns (x%.1f)\n", SLN_MIC_PERIOD_MS, SLN_MIC_COUNT,
+           (unsigned long long)(refNs / HPF_BENCH_RUNS), (unsigned long long)(newNs / HPF_BENCH_RUNS),
+           (double)refNs / (double)MAX(newNs, 1U));
+}
+
+int main(void)
+{
+    printf("Against the float filter:\n");
+    test_against_float();
+    printf("Cost:\n");
+    bench();
+
+    return HOST_TEST_Result("test_i2s_mic_hpf");
+}